@@ -0,0 +1,432 @@
+/*
+ *		articulation.c - ODE Ruby Binding - Articulation Class
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 20:31:47 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+
+
+/* --------------------------------------------------
+ *	Memory-management functions
+ * -------------------------------------------------- */
+
+/*
+ * Allocation function
+ */
+static ode_ARTICULATION *
+ode_articulation_alloc()
+{
+	ode_ARTICULATION *ptr = ALLOC( ode_ARTICULATION );
+
+	ptr->object	= Qnil;
+	ptr->joints	= Qnil;
+	ptr->servos	= Qnil;
+	ptr->dofs	= NULL;
+	ptr->count	= 0;
+
+	debugMsg(( "Initialized ode_ARTICULATION <%p>", ptr ));
+	return ptr;
+}
+
+
+/*
+ * GC Mark function
+ */
+static void
+ode_articulation_gc_mark( ptr )
+	 ode_ARTICULATION *ptr;
+{
+	debugMsg(( "Marking an ODE::Articulation" ));
+
+	if ( ptr ) {
+		rb_gc_mark( ptr->joints );
+		rb_gc_mark( ptr->servos );
+	}
+}
+
+
+/*
+ * GC Free function
+ */
+static void
+ode_articulation_gc_free( ptr )
+	 ode_ARTICULATION *ptr;
+{
+	if ( ptr ) {
+		debugMsg(( "Destroying Articulation <%p>", ptr ));
+		if ( ptr->dofs ) xfree( ptr->dofs );
+		ptr->dofs = NULL;
+
+		xfree( ptr );
+		ptr = NULL;
+	}
+}
+
+
+/*
+ * Object validity checker. Returns the data pointer.
+ */
+static ode_ARTICULATION *
+check_articulation( self )
+	 VALUE	self;
+{
+	debugMsg(( "Checking an Articulation object (%d).", self ));
+	Check_Type( self, T_DATA );
+
+    if ( !rb_obj_is_kind_of(self, ode_cOdeArticulation) ) {
+		rb_raise( rb_eTypeError, "wrong argument type %s (expected ODE::Articulation)",
+				  rb_class2name(CLASS_OF( self )) );
+    }
+
+	return DATA_PTR( self );
+}
+
+
+/*
+ * Fetch the data pointer and check it for sanity.
+ */
+static ode_ARTICULATION *
+get_articulation( self )
+	 VALUE self;
+{
+	ode_ARTICULATION *ptr = check_articulation( self );
+
+	debugMsg(( "Fetching an ode_ARTICULATION (%p).", ptr ));
+	if ( !ptr )
+		rb_raise( rb_eRuntimeError, "uninitialized articulation" );
+
+	return ptr;
+}
+
+
+/*
+ * Raise an ODE::ObsoleteJointError if any of the articulation's joints has
+ * been made obsolete.
+ */
+static void
+ode_articulation_check_joints( ptr )
+	 ode_ARTICULATION	*ptr;
+{
+	long	i;
+
+	for ( i = 0; i < ptr->count; i++ )
+		if ( RTEST(ptr->dofs[i].joint->obsolete) )
+			rb_raise( ode_eOdeObsoleteJointError,
+					  "Cannot use a joint which has been marked obsolete." );
+}
+
+
+/*
+ * Create the articulation's servos, one for each of its degrees of freedom,
+ * if it hasn't got them yet. They're only attached to the articulation once
+ * all of them exist, so if creating one raises, the next call starts over.
+ */
+static void
+ode_articulation_make_servos( ptr )
+	 ode_ARTICULATION	*ptr;
+{
+	VALUE	args[2], servos;
+	long	i;
+
+	if ( RTEST(ptr->servos) ) return;
+	ode_articulation_check_joints( ptr );
+
+	servos = rb_ary_new2( ptr->count );
+	for ( i = 0; i < ptr->count; i++ ) {
+		args[0] = ptr->dofs[i].joint->object;
+		args[1] = INT2FIX( ptr->dofs[i].axis );
+		rb_ary_push( servos, rb_class_new_instance(2, args, ode_cOdeServo) );
+	}
+
+	for ( i = 0; i < ptr->count; i++ )
+		ptr->dofs[i].servo = ode_get_servo( RARRAY(servos)->ptr[i] );
+	ptr->servos = servos;
+}
+
+
+
+/* --------------------------------------------------
+ * Class Methods
+ * -------------------------------------------------- */
+
+/*
+ * allocate()
+ * --
+ * Allocate a new ODE::Articulation object.
+ */
+static VALUE
+ode_articulation_s_alloc( klass )
+{
+	debugMsg(( "Wrapping an uninitialized ODE::Articulation pointer." ));
+	return Data_Wrap_Struct( klass, ode_articulation_gc_mark, ode_articulation_gc_free, 0 );
+}
+
+
+
+/* --------------------------------------------------
+ * Instance Methods
+ * -------------------------------------------------- */
+
+/*
+ * ODE::Articulation#initialize( joints )
+ * --
+ * Create a new articulation from the given Array of <tt>joints</tt> (which
+ * may be ODE::HingeJoints, ODE::SliderJoints, ODE::UniversalJoints, or
+ * ODE::Hinge2Joints). Its degrees of freedom are the joints' axes in the
+ * order the joints are given: one for a hinge or slider, one for a Hinge2
+ * (its first axis, the only one ODE gives the angle of), and two for a
+ * universal joint.
+ */
+static VALUE
+ode_articulation_init( self, joints )
+	 VALUE self, joints;
+{
+	ode_ARTICULATION	*ptr;
+	ode_JOINT			*joint;
+	long				i, count = 0;
+	int					type, axes, axis;
+
+	if ( check_articulation(self) )
+		rb_raise( rb_eRuntimeError, "Cannot re-initialize an articulation." );
+
+	Check_Type( joints, T_ARRAY );
+
+	/* Count the degrees of freedom first, checking the joint types */
+	for ( i = 0; i < RARRAY(joints)->len; i++ ) {
+		joint = ode_get_joint( RARRAY(joints)->ptr[i] );
+		if ( (axes = ode_servo_axis_count(dJointGetType(joint->id))) == 0 )
+			rb_raise( rb_eTypeError, "can't articulate a %s",
+					  rb_class2name(CLASS_OF( RARRAY(joints)->ptr[i] )) );
+		count += axes;
+	}
+
+	DATA_PTR(self) = ptr = ode_articulation_alloc();
+	ptr->object = self;
+	ptr->joints = rb_ary_dup( joints );
+	ptr->dofs = ALLOC_N( ode_ARTICULATIONDOF, count );
+
+	for ( i = 0; i < RARRAY(joints)->len; i++ ) {
+		joint = ode_get_joint( RARRAY(joints)->ptr[i] );
+		type = dJointGetType( joint->id );
+		axes = ode_servo_axis_count( type );
+
+		for ( axis = 1; axis <= axes; axis++ ) {
+			ptr->dofs[ ptr->count ].joint = joint;
+			ptr->dofs[ ptr->count ].type = type;
+			ptr->dofs[ ptr->count ].axis = axis;
+			ptr->dofs[ ptr->count ].servo = NULL;
+			ptr->count++;
+		}
+	}
+
+	return self;
+}
+
+
+/*
+ * ODE::Articulation#joints
+ * --
+ * Returns the articulation's joints.
+ */
+static VALUE
+ode_articulation_joints( self )
+	 VALUE self;
+{
+	return rb_ary_dup( get_articulation(self)->joints );
+}
+
+
+/*
+ * ODE::Articulation#dof
+ * --
+ * Returns the articulation's number of degrees of freedom.
+ */
+static VALUE
+ode_articulation_dof( self )
+	 VALUE self;
+{
+	return LONG2NUM( get_articulation(self)->count );
+}
+
+
+/*
+ * ODE::Articulation#coordinates
+ * --
+ * Returns an Array of <tt>[joint, axis]</tt> pairs describing the
+ * articulation's degrees of freedom, in the order of its state vectors.
+ */
+static VALUE
+ode_articulation_coordinates( self )
+	 VALUE self;
+{
+	ode_ARTICULATION	*ptr = get_articulation( self );
+	VALUE				ary = rb_ary_new2( ptr->count );
+	long				i;
+
+	for ( i = 0; i < ptr->count; i++ )
+		rb_ary_push( ary, rb_assoc_new(ptr->dofs[i].joint->object,
+									   INT2FIX(ptr->dofs[i].axis)) );
+
+	return ary;
+}
+
+
+/*
+ * ODE::Articulation#stateInto( buffer=nil )
+ * --
+ * Returns the articulation's joint-space state as a String of native doubles:
+ * the position of each of its degrees of freedom (in #coordinates order),
+ * followed by their rates. Unpack it with 'd*'. If a <tt>buffer</tt> String
+ * is given, its contents are replaced with the state and it's returned
+ * instead.
+ */
+static VALUE
+ode_articulation_state_into( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_ARTICULATION	*ptr = get_articulation( self );
+	VALUE				buffer;
+	double				*out;
+	dReal				pos, rate;
+	long				i;
+
+	ode_articulation_check_joints( ptr );
+
+	if ( rb_scan_args(argc, argv, "01", &buffer) && RTEST(buffer) )
+		StringValue( buffer );
+	else
+		buffer = rb_str_new( 0, 0 );
+
+	rb_str_modify( buffer );
+	rb_str_resize( buffer, ptr->count * 2 * sizeof(double) );
+	out = (double *)RSTRING( buffer )->ptr;
+
+	for ( i = 0; i < ptr->count; i++ ) {
+		ode_servo_axis_state( ptr->dofs[i].joint, ptr->dofs[i].type, ptr->dofs[i].axis,
+							  &pos, &rate );
+		out[i] = pos;
+		out[ ptr->count + i ] = rate;
+	}
+
+	return buffer;
+}
+
+
+/*
+ * ODE::Articulation#servos
+ * --
+ * Returns the ODE::Servo objects which drive each of the articulation's
+ * degrees of freedom, in #coordinates order. They're created (and enabled)
+ * the first time they're needed, with a #maxForce of 0, so set their gains
+ * and forces before stepping.
+ */
+static VALUE
+ode_articulation_servos( self )
+	 VALUE self;
+{
+	ode_ARTICULATION	*ptr = get_articulation( self );
+
+	ode_articulation_make_servos( ptr );
+	return rb_ary_dup( ptr->servos );
+}
+
+
+/*
+ * ODE::Articulation#setTargets( buffer )
+ * --
+ * Set the targets of the articulation's #servos from a String of native
+ * doubles laid out like #stateInto's: a target position for each degree of
+ * freedom, optionally followed by a target velocity for each. An Array of
+ * Numerics is also accepted. Returns the number of degrees of freedom set.
+ */
+static VALUE
+ode_articulation_set_targets( self, buffer )
+	 VALUE self, buffer;
+{
+	ode_ARTICULATION	*ptr = get_articulation( self );
+	VALUE				scratch;
+	double				*packed = NULL;
+	long				i, len;
+
+	ode_articulation_check_joints( ptr );
+
+	if ( TYPE(buffer) == T_STRING ) {
+		len = RSTRING( buffer )->len / (long)sizeof(double);
+		if ( len * (long)sizeof(double) != RSTRING(buffer)->len ) len = -1;
+		packed = (double *)RSTRING( buffer )->ptr;
+	} else {
+		Check_Type( buffer, T_ARRAY );
+		len = RARRAY( buffer )->len;
+	}
+
+	if ( len != ptr->count && len != ptr->count * 2 )
+		rb_raise( rb_eArgError, "expected %ld or %ld targets",
+				  ptr->count, ptr->count * 2 );
+
+	/* Convert an Array up front, so a bad element doesn't leave the
+	   targets half set */
+	if ( !packed ) {
+		scratch = rb_str_new( 0, len * sizeof(double) );
+		packed = (double *)RSTRING( scratch )->ptr;
+		for ( i = 0; i < len; i++ )
+			packed[i] = NUM2DBL( RARRAY(buffer)->ptr[i] );
+	}
+
+	ode_articulation_make_servos( ptr );
+
+	for ( i = 0; i < len; i++ ) {
+		dReal value = (dReal)packed[i];
+
+		if ( i < ptr->count )
+			ptr->dofs[i].servo->target = value;
+		else
+			ptr->dofs[ i - ptr->count ].servo->targetVel = value;
+	}
+
+	return LONG2NUM( ptr->count );
+}
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_articulation()
+{
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeArticulation = rb_define_class_under( ode_mOde, "Articulation", rb_cObject );
+#endif
+
+	rb_define_alloc_func( ode_cOdeArticulation, ode_articulation_s_alloc );
+
+	rb_define_method( ode_cOdeArticulation, "initialize", ode_articulation_init, 1 );
+
+	rb_define_method( ode_cOdeArticulation, "joints", ode_articulation_joints, 0 );
+	rb_define_method( ode_cOdeArticulation, "dof", ode_articulation_dof, 0 );
+	rb_define_alias ( ode_cOdeArticulation, "size", "dof" );
+	rb_define_method( ode_cOdeArticulation, "coordinates", ode_articulation_coordinates, 0 );
+	rb_define_method( ode_cOdeArticulation, "stateInto", ode_articulation_state_into, -1 );
+	rb_define_alias ( ode_cOdeArticulation, "state_into", "stateInto" );
+	rb_define_alias ( ode_cOdeArticulation, "state", "stateInto" );
+	rb_define_method( ode_cOdeArticulation, "servos", ode_articulation_servos, 0 );
+	rb_define_method( ode_cOdeArticulation, "setTargets", ode_articulation_set_targets, 1 );
+	rb_define_alias ( ode_cOdeArticulation, "set_targets", "setTargets" );
+	rb_define_alias ( ode_cOdeArticulation, "targets=", "setTargets" );
+}
+
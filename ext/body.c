@@ -27,6 +27,8 @@
  * Macros and constants
  * -------------------------------------------------- */
 
+/* Serial number of the last body created, for identifying bodies in events */
+static unsigned long ode_body_serial = 0;
 
 
 /* --------------------------------------------------
@@ -41,9 +43,12 @@ ode_body_alloc()
 {
 	ode_BODY *ptr = ALLOC( ode_BODY );
 
-	ptr->id		= NULL;
-	ptr->world	= Qnil;
-	ptr->mass	= Qnil;
+	ptr->id			= NULL;
+	ptr->world		= Qnil;
+	ptr->mass		= Qnil;
+	ptr->serial		= ++ode_body_serial;
+	ptr->worldIndex	= -1;
+	ptr->enabled	= 1;
 
 	debugMsg(( "Initialized ode_BODY <%p>", ptr ));
 	return ptr;
@@ -83,6 +88,10 @@ ode_body_gc_mark( ptr )
 				debugMsg(( "Getting joint struct." ));
 				jointStruct = (ode_JOINT *)dJointGetData( jointId );
 
+				/* Contact joints created natively (eg., by Space#collide)
+				   have no Ruby object */
+				if ( !jointStruct ) continue;
+
 				debugMsg(( "Marking joint <%p>", jointStruct->object ));
 				rb_gc_mark( jointStruct->object );
 			}
@@ -112,10 +121,13 @@ ode_body_gc_free( ptr )
 		   world this body belongs to is still a data object. If it's not, it
 		   must be assumed that this is happening as Ruby is shutting down. */
 		if ( TYPE(ptr->world) == T_DATA ) {
-			dWorldID	worldId = (dWorldID)DATA_PTR( ptr->world );
+			ode_WORLD	*worldPtr = (ode_WORLD *)DATA_PTR( ptr->world );
 
-			debugMsg(( "Destroying body <%p> (worldID = <%p>)", ptr, worldId ));
-			if ( worldId ) dBodyDestroy( ptr->id );
+			debugMsg(( "Destroying body <%p> (world = <%p>)", ptr, worldPtr ));
+			if ( worldPtr && worldPtr->id ) {
+				ode_world_remove_body( worldPtr, ptr );
+				dBodyDestroy( ptr->id );
+			}
 		}
 
 		ptr->object = Qnil;
@@ -231,6 +243,7 @@ ode_body_init( self, world )
 
 		/* Set the data pointer to this */
 		dBodySetData( ptr->id, ptr );
+		ode_world_add_body( ode_get_world_struct(world), ptr );
 	}
 
 	/* Can't initialize twice, as a body cannot be removed from a world. */
@@ -627,6 +640,22 @@ ode_body_enabled_p( self )
 		return Qfalse;
 }
 
+
+/*
+ * serial
+ * --
+ * Returns the body's serial number, which is unique among the bodies
+ * created in this process. Events drained with ODE::World#drainEvents refer
+ * to bodies by this number.
+ */
+static VALUE
+ode_body_serial_num( self )
+	 VALUE self;
+{
+	ode_BODY	*ptr = get_body( self );
+	return ULONG2NUM( ptr->serial );
+}
+
 /*
  * finiteRotationMode
  * --
@@ -1377,6 +1406,9 @@ ode_body_get_joint( self, index )
 	joint = dBodyGetJoint( ptr->id, i );
 	jointStruct = (ode_JOINT *)dJointGetData( (dJointID)joint );
 
+	/* Natively-created contact joints don't have an object */
+	if ( !jointStruct ) return Qnil;
+
 	return jointStruct->object;
 }
 
@@ -1385,7 +1417,8 @@ ode_body_get_joint( self, index )
  * joints()
  * --
  * Returns an Array of ODE::Joint objects that are attached to the receiving
- * body.
+ * body. Contact joints created natively by ODE::Space#collide have no Ruby
+ * object, and so aren't included.
  */
 static VALUE
 ode_body_joints( self )
@@ -1404,7 +1437,7 @@ ode_body_joints( self )
 	for ( i = 0 ; i < jointCount ; i++ ) {
 		joint = dBodyGetJoint( ptr->id, i );
 		jointStruct = (ode_JOINT *)dJointGetData( (dJointID)joint );
-		rb_ary_store( jointAry, i, jointStruct->object );
+		if ( jointStruct ) rb_ary_push( jointAry, jointStruct->object );
 	}
 
 	return jointAry;
@@ -1527,6 +1560,7 @@ ode_init_body( void ) {
 	rb_define_method( ode_cOdeBody, "enable", ode_body_enable, 0 );
 	rb_define_method( ode_cOdeBody, "disable", ode_body_disable, 0 );
 	rb_define_method( ode_cOdeBody, "enabled?", ode_body_enabled_p, 0 );
+	rb_define_method( ode_cOdeBody, "serial", ode_body_serial_num, 0 );
 
 	rb_define_method( ode_cOdeBody, "finiteRotationMode", ode_body_finite_rotation_mode, 0 );
 	rb_define_method( ode_cOdeBody, "finiteRotationMode=", ode_body_finite_rotation_mode_eq, 1 );
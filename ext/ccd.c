@@ -0,0 +1,505 @@
+/*
+ *		ccd.c - ODE Ruby Binding - Continuous collision detection
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 17:58:31 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+#include <math.h>
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* The state of one body's sweep */
+typedef struct {
+	dGeomID			ray;
+	dBodyID			body;
+	dReal			radius;
+	const dReal		*vel;
+	ode_GEOMETRY	*geom;
+	dContactGeom	hit;
+} ode_CCDQUERY;
+
+
+
+/* --------------------------------------------------
+ * Memory-management functions
+ * -------------------------------------------------- */
+
+/*
+ * Create the continuous collision detection state for a world.
+ */
+static ode_CCD *
+ode_ccd_new()
+{
+	ode_CCD *ccd = ALLOC( ode_CCD );
+
+	ccd->count			= 0;
+	ccd->capacity		= 8;
+	ccd->bodies			= ALLOC_N( ode_CCDBODY, ccd->capacity );
+	ccd->hitCount		= 0;
+	ccd->hitCapacity	= 8;
+	ccd->hits			= ALLOC_N( ode_CCDHIT, ccd->hitCapacity );
+	ccd->ray			= dCreateRay( 0, 1 );
+	ccd->space			= Qnil;
+#ifdef HAVE_DGEOMRAYSETCLOSESTHIT
+	dGeomRaySetClosestHit( ccd->ray, 1 );
+#endif
+
+	debugMsg(( "Created CCD state <%p>", ccd ));
+	return ccd;
+}
+
+
+/*
+ * Free the given continuous collision detection state.
+ */
+void
+ode_ccd_free( ccd )
+	 ode_CCD *ccd;
+{
+	debugMsg(( "Freeing CCD state <%p>", ccd ));
+
+	dGeomDestroy( ccd->ray );
+	xfree( ccd->hits );
+	xfree( ccd->bodies );
+	xfree( ccd );
+}
+
+
+/*
+ * Mark the swept space and the objects in the last step's hits.
+ */
+void
+ode_ccd_mark( ccd )
+	 ode_CCD *ccd;
+{
+	long i;
+
+	rb_gc_mark( ccd->space );
+	for ( i = 0; i < ccd->hitCount; i++ ) {
+		rb_gc_mark( ccd->hits[i].body );
+		rb_gc_mark( ccd->hits[i].geom );
+	}
+}
+
+
+
+/* --------------------------------------------------
+ * Sweeping
+ * -------------------------------------------------- */
+
+/*
+ * Find the entry for the given body in the list of swept bodies, or -1.
+ */
+static long
+ode_ccd_find_body( ccd, body )
+	 ode_CCD	*ccd;
+	 ode_BODY	*body;
+{
+	long i;
+
+	for ( i = 0; i < ccd->count; i++ )
+		if ( ccd->bodies[i].body == body ) return i;
+
+	return -1;
+}
+
+
+/*
+ * Destroy the contact joint made for the given swept body's last hit, if
+ * it has one.
+ */
+static void
+ode_ccd_clear_contact( entry )
+	 ode_CCDBODY *entry;
+{
+	if ( !entry->contact ) return;
+
+	dJointDestroy( entry->contact );
+	entry->contact = 0;
+}
+
+
+/*
+ * Stop sweeping the given body.
+ */
+void
+ode_ccd_remove_body( ccd, body )
+	 ode_CCD	*ccd;
+	 ode_BODY	*body;
+{
+	long i = ode_ccd_find_body( ccd, body );
+
+	if ( i >= 0 ) {
+		ode_ccd_clear_contact( ccd->bodies + i );
+		ccd->bodies[i] = ccd->bodies[ --ccd->count ];
+	}
+}
+
+
+/*
+ * Note where each swept body is before a step.
+ */
+void
+ode_ccd_prestep( ccd )
+	 ode_CCD *ccd;
+{
+	long i;
+
+	for ( i = 0; i < ccd->count; i++ )
+		memcpy( ccd->bodies[i].prev, dBodyGetPosition(ccd->bodies[i].body->id),
+				sizeof(dReal) * 3 );
+}
+
+
+/*
+ * Near callback for a sweep: keep the nearest hit of the ray against
+ * anything but the swept body's own geometries and sensors, descending into
+ * spaces. A hit closer to the start than the body's radius means it was
+ * already touching there, so it's ignored if the body is now moving away
+ * from the surface.
+ */
+static void
+ode_ccd_sweep_callback( query, o1, o2 )
+	 ode_CCDQUERY	*query;
+	 dGeomID		o1, o2;
+{
+	dGeomID			other = ( o1 == query->ray ) ? o2 : o1;
+	ode_GEOMETRY	*geom;
+	dContactGeom	hit;
+
+	if ( dGeomIsSpace(other) ) {
+		dSpaceCollide2( query->ray, other, query,
+						(dNearCallback *)ode_ccd_sweep_callback );
+		return;
+	}
+
+	if ( dGeomGetBody(other) == query->body ) return;
+	if ( !(geom = dGeomGetData(other)) || geom->sensor ) return;
+
+	if ( !dCollide(query->ray, other, 1, &hit, sizeof(dContactGeom)) ) return;
+	if ( hit.depth < query->radius &&
+		 query->vel[0]*hit.normal[0] + query->vel[1]*hit.normal[1] +
+		 query->vel[2]*hit.normal[2] > 0 )
+		return;
+
+	if ( !query->geom || hit.depth < query->hit.depth ) {
+		query->hit = hit;
+		query->geom = geom;
+	}
+}
+
+
+/*
+ * Record a hit for the current step.
+ */
+static ode_CCDHIT *
+ode_ccd_add_hit( ccd )
+	 ode_CCD *ccd;
+{
+	if ( ccd->hitCount == ccd->hitCapacity ) {
+		ccd->hitCapacity *= 2;
+		REALLOC_N( ccd->hits, ode_CCDHIT, ccd->hitCapacity );
+	}
+
+	return ccd->hits + ccd->hitCount++;
+}
+
+
+/*
+ * After a step, sweep the center of each swept body which moved further
+ * than its radius along a ray from where it was to where it is, against the
+ * world's CCD space. If the ray hits something closer than the radius from
+ * the end, move the body back to the time of impact, record the hit, and
+ * make a contact joint there (with the hit geometry's surface) which acts
+ * on the body during the next step, so it bounces and slides as it would
+ * have if the discrete collision had caught it. The contacts made after the
+ * last step are destroyed first, as that step has used them.
+ */
+void
+ode_ccd_poststep( world )
+	 ode_WORLD *world;
+{
+	ode_CCD			*ccd = world->ccd;
+	ode_CCDBODY		*entry;
+	ode_CCDQUERY	query;
+	ode_CCDHIT		*hit;
+	ode_EVENT		*event;
+	dContact		contact;
+	const dReal		*pos;
+	dVector3		dir;
+	dReal			travel, toiDist;
+	long			i;
+
+	for ( i = 0; i < ccd->count; i++ )
+		ode_ccd_clear_contact( ccd->bodies + i );
+
+	ccd->hitCount = 0;
+	if ( !RTEST(ccd->space) ) return;
+
+	query.ray = ccd->ray;
+
+	for ( i = 0; i < ccd->count; i++ ) {
+		entry = ccd->bodies + i;
+		if ( !dBodyIsEnabled(entry->body->id) ) continue;
+
+		pos = dBodyGetPosition( entry->body->id );
+		dir[0] = pos[0] - entry->prev[0];
+		dir[1] = pos[1] - entry->prev[1];
+		dir[2] = pos[2] - entry->prev[2];
+		travel = (dReal)sqrt( dir[0]*dir[0] + dir[1]*dir[1] + dir[2]*dir[2] );
+
+		/* Slow enough for the discrete collision to catch it */
+		if ( travel <= entry->radius || travel == 0 ) continue;
+
+		dir[0] /= travel; dir[1] /= travel; dir[2] /= travel;
+		dGeomRaySet( ccd->ray, entry->prev[0], entry->prev[1], entry->prev[2],
+					 dir[0], dir[1], dir[2] );
+		dGeomRaySetLength( ccd->ray, travel + entry->radius );
+
+		query.body = entry->body->id;
+		query.radius = entry->radius;
+		query.vel = dBodyGetLinearVel( entry->body->id );
+		query.geom = NULL;
+		dSpaceCollide2( ccd->ray, ode_get_space(ccd->space)->id, &query,
+						(dNearCallback *)ode_ccd_sweep_callback );
+		if ( !query.geom ) continue;
+
+		/* Back up to where the body's radius touches the surface */
+		toiDist = query.hit.depth - entry->radius;
+		if ( toiDist < 0 ) toiDist = 0;
+		dBodySetPosition( entry->body->id,
+						  entry->prev[0] + dir[0] * toiDist,
+						  entry->prev[1] + dir[1] * toiDist,
+						  entry->prev[2] + dir[2] * toiDist );
+
+		/* The body now just touches the surface, so the contact has no
+		   depth; the joint takes away its velocity into the surface */
+		MEMZERO( &contact, dContact, 1 );
+		if ( RTEST(query.geom->surface) ) {
+			contact.surface = *( ode_get_surface(query.geom->surface) );
+		} else {
+			contact.surface.mu = dInfinity;
+		}
+		contact.geom = query.hit;
+		contact.geom.depth = 0;
+		contact.geom.g1 = 0;
+		contact.geom.g2 = query.geom->id;
+
+		entry->contact = dJointCreateContact( world->id, 0, &contact );
+		dJointAttach( entry->contact, entry->body->id, dGeomGetBody(query.geom->id) );
+
+		hit = ode_ccd_add_hit( ccd );
+		hit->body = entry->body->object;
+		hit->geom = query.geom->object;
+		memcpy( hit->pos, query.hit.pos, sizeof(dReal) * 3 );
+		memcpy( hit->normal, query.hit.normal, sizeof(dReal) * 3 );
+		hit->toi = toiDist / travel;
+
+		if ( world->events ) {
+			event = ode_eventqueue_push( world->events, ODE_EVENT_CCD_HIT,
+										 world->stepCount, entry->body->serial,
+										 query.geom->serial );
+			event->payload[0] = hit->pos[0];
+			event->payload[1] = hit->pos[1];
+			event->payload[2] = hit->pos[2];
+			event->payload[3] = hit->toi;
+		}
+	}
+}
+
+
+
+/* --------------------------------------------------
+ * Instance Methods
+ * -------------------------------------------------- */
+
+/*
+ * Return the CCD state of the given world, creating it if necessary.
+ */
+static ode_CCD *
+ode_ccd_for_world( world )
+	 ode_WORLD *world;
+{
+	if ( !world->ccd ) world->ccd = ode_ccd_new();
+	return world->ccd;
+}
+
+
+/*
+ * ODE::Body#ccdRadius
+ * --
+ * Returns the radius the body is swept with for continuous collision
+ * detection, or nil if it isn't (see #ccdRadius=).
+ */
+static VALUE
+ode_body_ccd_radius( self )
+	 VALUE self;
+{
+	ode_BODY	*ptr = ode_get_body( self );
+	ode_WORLD	*world = ode_get_world_struct( ptr->world );
+	long		i;
+
+	if ( !world->ccd || (i = ode_ccd_find_body(world->ccd, ptr)) < 0 )
+		return Qnil;
+
+	return rb_float_new( world->ccd->bodies[i].radius );
+}
+
+
+/*
+ * ODE::Body#ccdRadius=( radius )
+ * --
+ * Mark the body as fast-moving: after each step of its world, if it moved
+ * further than <tt>radius</tt> (which should be about the size of its
+ * geometry; 0 sweeps just its center), a ray is cast from where it was to
+ * where it is against the world's ODE::World#ccdSpace. If the ray hits
+ * something, the body is moved back to the time of impact, the hit is
+ * recorded (see ODE::World#ccdHits), and a contact with the geometry it hit
+ * (using that geometry's surface) acts on it during the next step. This
+ * keeps fast bodies from tunnelling through thin geometries without raising
+ * the step rate. Setting it to nil turns it off.
+ */
+static VALUE
+ode_body_ccd_radius_eq( self, radius )
+	 VALUE self, radius;
+{
+	ode_BODY	*ptr = ode_get_body( self );
+	ode_WORLD	*world = ode_get_world_struct( ptr->world );
+	ode_CCD		*ccd;
+	long		i;
+
+	if ( NIL_P(radius) ) {
+		if ( world->ccd ) ode_ccd_remove_body( world->ccd, ptr );
+		return radius;
+	}
+
+	CheckPositiveNumber( NUM2DBL(radius), "radius" );
+	ccd = ode_ccd_for_world( world );
+
+	if ( (i = ode_ccd_find_body(ccd, ptr)) < 0 ) {
+		if ( ccd->count == ccd->capacity ) {
+			ccd->capacity *= 2;
+			REALLOC_N( ccd->bodies, ode_CCDBODY, ccd->capacity );
+		}
+		i = ccd->count++;
+		ccd->bodies[i].body = ptr;
+		ccd->bodies[i].contact = 0;
+		memcpy( ccd->bodies[i].prev, dBodyGetPosition(ptr->id), sizeof(dReal) * 3 );
+	}
+
+	ccd->bodies[i].radius = (dReal)NUM2DBL( radius );
+
+	return radius;
+}
+
+
+/*
+ * ODE::World#ccdSpace
+ * --
+ * Returns the space fast-moving bodies are swept against (see #ccdSpace=).
+ */
+static VALUE
+ode_world_ccd_space( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = ode_get_world_struct( self );
+	return ptr->ccd ? ptr->ccd->space : Qnil;
+}
+
+
+/*
+ * ODE::World#ccdSpace=( space )
+ * --
+ * Set the space (usually the one holding the static level geometry) that
+ * bodies with continuous collision detection turned on are swept against
+ * after each step (see ODE::Body#ccdRadius=). Nil turns the sweeps off.
+ */
+static VALUE
+ode_world_ccd_space_eq( self, space )
+	 VALUE self, space;
+{
+	ode_WORLD	*ptr = ode_get_world_struct( self );
+
+	if ( !NIL_P(space) ) ode_get_space( space );
+	ode_ccd_for_world( ptr )->space = space;
+
+	return space;
+}
+
+
+/*
+ * ODE::World#ccdHits
+ * --
+ * Returns the hits found by continuous collision detection during the last
+ * step as an Array of Arrays of the form:
+ *
+ *   [ body, geometry, position, normal, timeOfImpact ]
+ *
+ * where <tt>timeOfImpact</tt> is a fraction of the step.
+ */
+static VALUE
+ode_world_ccd_hits( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = ode_get_world_struct( self );
+	ode_CCDHIT	*hit;
+	VALUE		ary = rb_ary_new();
+	long		i;
+
+	if ( !ptr->ccd ) return ary;
+
+	for ( i = 0; i < ptr->ccd->hitCount; i++ ) {
+		hit = ptr->ccd->hits + i;
+		rb_ary_push( ary, rb_ary_new3(5,
+			hit->body, hit->geom,
+			ode_vector3_to_rArray(hit->pos),
+			ode_vector3_to_rArray(hit->normal),
+			rb_float_new(hit->toi)) );
+	}
+
+	return ary;
+}
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_ccd()
+{
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeWorld = rb_define_class_under( ode_mOde, "World", rb_cObject );
+	ode_cOdeBody = rb_define_class_under( ode_mOde, "Body", rb_cObject );
+#endif
+
+	rb_define_method( ode_cOdeBody, "ccdRadius", ode_body_ccd_radius, 0 );
+	rb_define_alias ( ode_cOdeBody, "ccd_radius", "ccdRadius" );
+	rb_define_method( ode_cOdeBody, "ccdRadius=", ode_body_ccd_radius_eq, 1 );
+	rb_define_alias ( ode_cOdeBody, "ccd_radius=", "ccdRadius=" );
+
+	rb_define_method( ode_cOdeWorld, "ccdSpace", ode_world_ccd_space, 0 );
+	rb_define_alias ( ode_cOdeWorld, "ccd_space", "ccdSpace" );
+	rb_define_method( ode_cOdeWorld, "ccdSpace=", ode_world_ccd_space_eq, 1 );
+	rb_define_alias ( ode_cOdeWorld, "ccd_space=", "ccdSpace=" );
+	rb_define_method( ode_cOdeWorld, "ccdHits", ode_world_ccd_hits, 0 );
+	rb_define_alias ( ode_cOdeWorld, "ccd_hits", "ccdHits" );
+}
+
@@ -0,0 +1,564 @@
+/*
+ *		collision.c - ODE Ruby Binding - Native collision pass (ODE::Space#collide)
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 14:02:11 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+#ifdef HAVE_THREADED_COLLISION
+#include <pthread.h>
+#include <signal.h>
+#include <errno.h>
+#endif
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* Number of candidate pairs a collision thread claims at a time */
+#define ODE_COLLISION_CHUNK		16
+
+/* Most collision threads that can be started */
+#define ODE_COLLISION_MAX_THREADS	64
+
+/* dCollide() flags for just testing whether a pair involving a sensor
+   overlaps */
+#ifdef CONTACTS_UNIMPORTANT
+#	define ODE_SENSOR_COLLIDE_FLAGS	( 1 | CONTACTS_UNIMPORTANT )
+#else
+#	define ODE_SENSOR_COLLIDE_FLAGS	1
+#endif
+
+#define IsSensorPair( pair )	( (pair)->geom1->sensor || (pair)->geom2->sensor )
+
+/* A candidate pair from the broadphase and the contacts generated for it */
+typedef struct {
+	ode_GEOMETRY	*geom1, *geom2;
+	int				count, reused;
+	dContactGeom	*contacts;
+} ode_COLLISIONPAIR;
+
+/* The candidate pairs gathered during one collision pass */
+typedef struct {
+	ode_COLLISIONPAIR	*pairs;
+	long				count, capacity;
+	int					maxContacts;
+	long				next;
+} ode_COLLISIONPASS;
+
+
+#ifdef HAVE_THREADED_COLLISION
+/* The collision thread pool */
+static struct {
+	pthread_mutex_t		lock;
+	pthread_cond_t		work, done;
+	int					threadCount, activeCount, registered, busy;
+	unsigned long		generation;
+	ode_COLLISIONPASS	*pass;
+} ode_collision_pool = {
+	PTHREAD_MUTEX_INITIALIZER,
+	PTHREAD_COND_INITIALIZER,
+	PTHREAD_COND_INITIALIZER,
+	0, 0, 0, 0, 0, NULL
+};
+#endif /* HAVE_THREADED_COLLISION */
+
+
+
+/* --------------------------------------------------
+ * Broadphase
+ * -------------------------------------------------- */
+
+/*
+ * Near callback for the broadphase: record each candidate pair of non-space
+ * geometries, recursing into pairs involving spaces.
+ */
+static void
+ode_collision_gather_pair( data, o1, o2 )
+	 void		*data;
+	 dGeomID	o1, o2;
+{
+	ode_COLLISIONPASS	*pass = (ode_COLLISIONPASS *)data;
+	ode_COLLISIONPAIR	*pair;
+	ode_GEOMETRY		*geom1, *geom2, *tmp;
+
+	if ( dGeomIsSpace(o1) || dGeomIsSpace(o2) ) {
+		dSpaceCollide2( o1, o2, data, (dNearCallback *)ode_collision_gather_pair );
+		return;
+	}
+
+	/* Geometries on the same body, and pairs of static geometries, can't
+	   generate any useful contacts */
+	if ( dGeomGetBody(o1) == dGeomGetBody(o2) ) return;
+
+	geom1 = (ode_GEOMETRY *)dGeomGetData( o1 );
+	geom2 = (ode_GEOMETRY *)dGeomGetData( o2 );
+
+	/* Order the pair by creation so the contacts don't depend on the
+	   broadphase's ordering */
+	if ( geom1->serial > geom2->serial ) {
+		tmp = geom1; geom1 = geom2; geom2 = tmp;
+	}
+
+	if ( pass->count == pass->capacity ) {
+		pass->capacity *= 2;
+		REALLOC_N( pass->pairs, ode_COLLISIONPAIR, pass->capacity );
+	}
+
+	pair = pass->pairs + pass->count++;
+	pair->geom1		= geom1;
+	pair->geom2		= geom2;
+	pair->count		= 0;
+	pair->reused	= 0;
+	pair->contacts	= NULL;
+}
+
+
+/*
+ * Gather the candidate pairs for the given space, and for every space nested
+ * in it.
+ */
+static void
+ode_collision_gather( space, pass )
+	 dSpaceID			space;
+	 ode_COLLISIONPASS	*pass;
+{
+	int		i, geomCount;
+	dGeomID	geom;
+
+	dSpaceCollide( space, pass, (dNearCallback *)ode_collision_gather_pair );
+
+	geomCount = dSpaceGetNumGeoms( space );
+	for ( i = 0; i < geomCount; i++ ) {
+		geom = dSpaceGetGeom( space, i );
+		if ( dGeomIsSpace(geom) )
+			ode_collision_gather( (dSpaceID)geom, pass );
+	}
+}
+
+
+/*
+ * qsort() comparison function for ordering pairs by their geometries'
+ * serial numbers.
+ */
+static int
+ode_collision_pair_cmp( a, b )
+	 const void *a, *b;
+{
+	const ode_COLLISIONPAIR *p1 = a, *p2 = b;
+
+	if ( p1->geom1->serial != p2->geom1->serial )
+		return p1->geom1->serial < p2->geom1->serial ? -1 : 1;
+	if ( p1->geom2->serial != p2->geom2->serial )
+		return p1->geom2->serial < p2->geom2->serial ? -1 : 1;
+	return 0;
+}
+
+
+
+/* --------------------------------------------------
+ * Narrowphase
+ * -------------------------------------------------- */
+
+/*
+ * Generate contacts for the candidate pairs [start, end) of the pass, skipping
+ * those whose contacts were reused from the last pass. Each pair writes to its
+ * own slice of the contact buffer, so any number of these can run at once on
+ * disjoint ranges.
+ */
+static void
+ode_collision_narrowphase( pass, start, end )
+	 ode_COLLISIONPASS	*pass;
+	 long				start, end;
+{
+	ode_COLLISIONPAIR	*pair;
+	long				i;
+
+	for ( i = start; i < end; i++ ) {
+		pair = pass->pairs + i;
+		if ( pair->reused ) continue;
+
+		if ( IsSensorPair(pair) ) {
+			pair->count = dCollide( pair->geom1->id, pair->geom2->id,
+									ODE_SENSOR_COLLIDE_FLAGS, pair->contacts,
+									sizeof(dContactGeom) );
+			continue;
+		}
+
+		pair->count = dCollide( pair->geom1->id, pair->geom2->id,
+								pass->maxContacts, pair->contacts,
+								sizeof(dContactGeom) );
+		pair->count = ode_manifold_reduce( pair->contacts, pair->count,
+										   pair->geom1, pair->geom2 );
+	}
+}
+
+
+#ifdef HAVE_THREADED_COLLISION
+
+/*
+ * Claim chunks of the current pass's pairs and run the narrowphase on them
+ * until there are none left.
+ */
+static void
+ode_collision_run_chunks( pass )
+	 ode_COLLISIONPASS	*pass;
+{
+	long	start;
+
+	for ( ;; ) {
+		pthread_mutex_lock( &ode_collision_pool.lock );
+		start = pass->next;
+		pass->next += ODE_COLLISION_CHUNK;
+		pthread_mutex_unlock( &ode_collision_pool.lock );
+
+		if ( start >= pass->count ) break;
+		ode_collision_narrowphase( pass, start,
+			start + ODE_COLLISION_CHUNK < pass->count ?
+				start + ODE_COLLISION_CHUNK : pass->count );
+	}
+}
+
+
+/*
+ * Collision thread body. Never touches the Ruby interpreter.
+ */
+static void *
+ode_collision_worker( arg )
+	 void *arg;
+{
+	int				id = (int)(long)arg;
+	unsigned long	seen;
+	sigset_t		signals;
+
+	/* Leave signal handling to the interpreter's thread */
+	sigfillset( &signals );
+	pthread_sigmask( SIG_BLOCK, &signals, NULL );
+
+	/* Give the thread its own collider caches */
+	dAllocateODEDataForThread( dAllocateMaskAll );
+
+	/* Join the pool; a pass that's already underway won't wait for this
+	   thread */
+	pthread_mutex_lock( &ode_collision_pool.lock );
+	seen = ode_collision_pool.generation;
+	ode_collision_pool.registered++;
+
+	for ( ;; ) {
+		while ( ode_collision_pool.generation == seen )
+			pthread_cond_wait( &ode_collision_pool.work, &ode_collision_pool.lock );
+		seen = ode_collision_pool.generation;
+
+		if ( id < ode_collision_pool.activeCount ) {
+			pthread_mutex_unlock( &ode_collision_pool.lock );
+			ode_collision_run_chunks( ode_collision_pool.pass );
+			pthread_mutex_lock( &ode_collision_pool.lock );
+		}
+
+		if ( --ode_collision_pool.busy == 0 )
+			pthread_cond_signal( &ode_collision_pool.done );
+	}
+
+	return NULL;
+}
+
+
+/*
+ * Run the narrowphase for the whole pass across the thread pool, with the
+ * calling thread taking a share of the work.
+ */
+static void
+ode_collision_narrowphase_threaded( pass )
+	 ode_COLLISIONPASS	*pass;
+{
+	pthread_mutex_lock( &ode_collision_pool.lock );
+	pass->next = 0;
+	ode_collision_pool.pass = pass;
+	ode_collision_pool.busy = ode_collision_pool.registered;
+	ode_collision_pool.generation++;
+	pthread_cond_broadcast( &ode_collision_pool.work );
+	pthread_mutex_unlock( &ode_collision_pool.lock );
+
+	ode_collision_run_chunks( pass );
+
+	pthread_mutex_lock( &ode_collision_pool.lock );
+	while ( ode_collision_pool.busy )
+		pthread_cond_wait( &ode_collision_pool.done, &ode_collision_pool.lock );
+	ode_collision_pool.pass = NULL;
+	pthread_mutex_unlock( &ode_collision_pool.lock );
+}
+
+#endif /* HAVE_THREADED_COLLISION */
+
+
+
+/* --------------------------------------------------
+ * Class Methods
+ * -------------------------------------------------- */
+
+/*
+ * ODE::Space::collisionThreads
+ * --
+ * Returns the number of threads (in addition to the calling one) that
+ * ODE::Space#collide spreads narrowphase collision across.
+ */
+static VALUE
+ode_space_s_collision_threads( klass )
+	 VALUE klass;
+{
+#ifdef HAVE_THREADED_COLLISION
+	return INT2FIX( ode_collision_pool.activeCount );
+#else
+	return INT2FIX( 0 );
+#endif
+}
+
+
+/*
+ * ODE::Space::collisionThreads=( count )
+ * --
+ * Set the number of threads (in addition to the calling one) that
+ * ODE::Space#collide spreads narrowphase collision across. Threads are
+ * started as needed and kept for the life of the process; lowering the count
+ * just idles the extras. Setting it to 0 does all collision in the calling
+ * thread. Raises NotImplementedError if the extension was built without
+ * threaded collision support (see ODE::Features).
+ */
+static VALUE
+ode_space_s_collision_threads_eq( klass, count )
+	 VALUE klass, count;
+{
+	int		threads;
+
+	CheckNumberBetween( NUM2DBL(count), "count", 0.0, (double)ODE_COLLISION_MAX_THREADS );
+	threads = NUM2INT( count );
+
+#ifdef HAVE_THREADED_COLLISION
+	pthread_mutex_lock( &ode_collision_pool.lock );
+	while ( ode_collision_pool.threadCount < threads ) {
+		pthread_t	thread;
+		int			status;
+
+		if (( status = pthread_create(&thread, NULL, ode_collision_worker,
+									  (void *)(long)ode_collision_pool.threadCount) )) {
+			pthread_mutex_unlock( &ode_collision_pool.lock );
+			errno = status;
+			rb_sys_fail( "pthread_create" );
+		}
+
+		pthread_detach( thread );
+		ode_collision_pool.threadCount++;
+	}
+	ode_collision_pool.activeCount = threads;
+	pthread_mutex_unlock( &ode_collision_pool.lock );
+#else
+	if ( threads ) rb_notimplement();
+#endif
+
+	return count;
+}
+
+
+
+/* --------------------------------------------------
+ * Instance Methods
+ * -------------------------------------------------- */
+
+/*
+ * ODE::Space#collide( world, jointGroup, maxContacts=5 )
+ * --
+ * Run a complete collision pass over the receiving space (and any spaces
+ * nested in it) without calling back into Ruby: gather the candidate pairs
+ * from the broadphase, generate up to <tt>maxContacts</tt> contacts for each
+ * (across the collision threads, if any -- see ::collisionThreads=), and
+ * attach a contact joint for each contact to the bodies involved in the
+ * specified <tt>world</tt> and <tt>jointGroup</tt> (an ODE::JointGroup).
+ *
+ * The contacts use the surface of the first geometry of the pair that has
+ * one, or the defaults of a new ODE::Surface. The joints are created in the order of the
+ * geometries' creation, so the result doesn't depend on the broadphase or
+ * the thread scheduling. They have no Ruby objects; emptying the joint group
+ * destroys them as usual. If the world is tracking contacts (see
+ * ODE::World#trackContacts=), the pairs are recorded in its contact table. If
+ * it has contact reuse turned on (see ODE::World#contactReuse=), pairs whose
+ * bodies are resting use the contacts they were given last time instead of
+ * being collided again. Each pair's contacts are reduced according to the
+ * manifold reduction rule for their surfaces, if any (see
+ * ODE::Surface::setManifoldReduction). Pairs involving a sensor geometry
+ * (see ODE::Geometry#sensor=) are only tested for overlap, and recorded in
+ * the world's sensor table instead of getting joints.
+ *
+ * Returns the number of contact joints created.
+ */
+static VALUE
+ode_space_collide( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_GEOMETRY		*ptr = ode_get_space( self );
+	ode_JOINTGROUP		*jointGroup;
+	ode_COLLISIONPASS	pass;
+	ode_COLLISIONPAIR	*pair;
+	ode_WORLD			*world;
+	dContact			contact;
+	dSurfaceParameters	defaultSurface;
+	dJointID			joint;
+	VALUE				worldObj, jointGroupObj, maxContacts;
+	long				i, entry, contactCount = 0;
+	int					j;
+
+	rb_scan_args( argc, argv, "21", &worldObj, &jointGroupObj, &maxContacts );
+
+	world = ode_get_world_struct( worldObj );
+	jointGroup = ode_get_jointGroup( jointGroupObj );
+
+	if ( RTEST(maxContacts) ) {
+		CheckPositiveNonZeroNumber( NUM2DBL(maxContacts), "maxContacts" );
+		pass.maxContacts = NUM2INT( maxContacts );
+	} else {
+		pass.maxContacts = 5;
+	}
+
+	/* Broadphase */
+	pass.count		= 0;
+	pass.capacity	= 64;
+	pass.next		= 0;
+	pass.pairs		= ALLOC_N( ode_COLLISIONPAIR, pass.capacity );
+	ode_collision_gather( (dSpaceID)ptr->id, &pass );
+
+	debugMsg(( "Space#collide: %ld candidate pairs", pass.count ));
+	if ( !pass.count ) {
+		xfree( pass.pairs );
+		return INT2FIX( 0 );
+	}
+
+	qsort( pass.pairs, pass.count, sizeof(ode_COLLISIONPAIR), ode_collision_pair_cmp );
+
+	/* Narrowphase, with each pair getting its own slice of the buffer */
+	pass.pairs[0].contacts = ALLOC_N( dContactGeom, pass.count * pass.maxContacts );
+	for ( i = 1; i < pass.count; i++ )
+		pass.pairs[i].contacts = pass.pairs[0].contacts + i * pass.maxContacts;
+
+	/* Pairs whose bodies haven't moved since their contacts were generated
+	   can use them again */
+	if ( world->reuse ) {
+		for ( i = 0; i < pass.count; i++ ) {
+			pair = pass.pairs + i;
+			if ( IsSensorPair(pair) ) continue;
+			j = ode_contactreuse_fetch( world->reuse, pair->geom1, pair->geom2,
+										pass.maxContacts, pair->contacts,
+										world->stepCount );
+			if ( j >= 0 ) {
+				pair->count = j;
+				pair->reused = 1;
+			}
+		}
+	}
+
+#ifdef HAVE_THREADED_COLLISION
+	if ( ode_collision_pool.activeCount && pass.count > ODE_COLLISION_CHUNK )
+		ode_collision_narrowphase_threaded( &pass );
+	else
+#endif
+		ode_collision_narrowphase( &pass, 0, pass.count );
+
+	if ( world->reuse ) {
+		for ( i = 0; i < pass.count; i++ ) {
+			pair = pass.pairs + i;
+			if ( !pair->reused && !IsSensorPair(pair) )
+				ode_contactreuse_store( world->reuse, pair->geom1, pair->geom2,
+										pass.maxContacts, pair->contacts, pair->count,
+										world->stepCount );
+		}
+	}
+
+	/* Create the joints in pair order */
+	MEMZERO( &defaultSurface, dSurfaceParameters, 1 );
+	defaultSurface.mu = dInfinity;
+	MEMZERO( &contact, dContact, 1 );
+
+	for ( i = 0; i < pass.count; i++ ) {
+		pair = pass.pairs + i;
+		if ( !pair->count ) continue;
+
+		/* Sensors just note what's overlapping them */
+		if ( IsSensorPair(pair) ) {
+			if ( pair->geom1->sensor )
+				ode_contacttable_touch( ode_world_sensor_table(world), pair->geom1,
+										pair->geom2, world->stepCount );
+			else
+				ode_contacttable_touch( ode_world_sensor_table(world), pair->geom2,
+										pair->geom1, world->stepCount );
+			continue;
+		}
+
+		if ( RTEST(pair->geom1->surface) )
+			contact.surface = *( ode_get_surface(pair->geom1->surface) );
+		else if ( RTEST(pair->geom2->surface) )
+			contact.surface = *( ode_get_surface(pair->geom2->surface) );
+		else
+			contact.surface = defaultSurface;
+
+		/* Record the pair as touching if the world is tracking contacts */
+		if ( world->contacts )
+			entry = ode_contacttable_touch( world->contacts, pair->geom1, pair->geom2,
+											world->stepCount );
+
+		for ( j = 0; j < pair->count; j++ ) {
+			contact.geom = pair->contacts[j];
+			joint = dJointCreateContact( world->id, jointGroup->id, &contact );
+			dJointAttach( joint,
+						  dGeomGetBody(pair->geom1->id),
+						  dGeomGetBody(pair->geom2->id) );
+			if ( world->contacts )
+				dJointSetFeedback( joint, ode_contacttable_feedback(world->contacts, entry) );
+			contactCount++;
+		}
+	}
+
+	xfree( pass.pairs[0].contacts );
+	xfree( pass.pairs );
+
+	return LONG2NUM( contactCount );
+}
+
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_collision()
+{
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeGeometry		= rb_define_class_under( ode_mOde, "Geometry", rb_cObject );
+	ode_cOdeSpace			= rb_define_class_under( ode_mOde, "Space", ode_cOdeGeometry );
+#endif
+
+	rb_define_singleton_method( ode_cOdeSpace, "collisionThreads",
+								ode_space_s_collision_threads, 0 );
+	rb_define_singleton_method( ode_cOdeSpace, "collision_threads",
+								ode_space_s_collision_threads, 0 );
+	rb_define_singleton_method( ode_cOdeSpace, "collisionThreads=",
+								ode_space_s_collision_threads_eq, 1 );
+	rb_define_singleton_method( ode_cOdeSpace, "collision_threads=",
+								ode_space_s_collision_threads_eq, 1 );
+
+	rb_define_method( ode_cOdeSpace, "collide", ode_space_collide, -1 );
+}
+
@@ -0,0 +1,318 @@
+/*
+ *		contactreuse.c - ODE Ruby Binding - Cache of contacts for resting pairs
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 15:48:02 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+#include <math.h>
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* Empty hash index slot */
+#define ODE_CONTACTREUSE_EMPTY		-1
+
+
+
+/* --------------------------------------------------
+ * Memory-management functions
+ * -------------------------------------------------- */
+
+/*
+ * Create a new, empty contact reuse cache which considers a body to be at rest
+ * while it has moved less than <tt>linear</tt> and turned less than
+ * <tt>angular</tt> radians since its pair's contacts were generated.
+ */
+ode_CONTACTREUSE *
+ode_contactreuse_new( linear, angular )
+	 dReal linear, angular;
+{
+	ode_CONTACTREUSE *reuse = ALLOC( ode_CONTACTREUSE );
+	long i;
+
+	reuse->count			= 0;
+	reuse->capacity			= 32;
+	reuse->entries			= ALLOC_N( ode_REUSEENTRY, reuse->capacity );
+	reuse->indexSize		= 64;
+	reuse->index			= ALLOC_N( long, reuse->indexSize );
+	reuse->linearThreshold	= linear;
+	reuse->angularThreshold	= angular;
+	reuse->cosHalfAngle		= (dReal)cos( angular / 2.0 );
+	reuse->hits				= 0;
+	reuse->misses			= 0;
+
+	for ( i = 0; i < reuse->indexSize; i++ )
+		reuse->index[i] = ODE_CONTACTREUSE_EMPTY;
+
+	debugMsg(( "Created contact reuse cache <%p>", reuse ));
+	return reuse;
+}
+
+
+/*
+ * Free the given contact reuse cache.
+ */
+void
+ode_contactreuse_free( reuse )
+	 ode_CONTACTREUSE *reuse;
+{
+	long i;
+
+	debugMsg(( "Freeing contact reuse cache <%p>", reuse ));
+
+	for ( i = 0; i < reuse->count; i++ )
+		xfree( reuse->entries[i].contacts );
+
+	xfree( reuse->index );
+	xfree( reuse->entries );
+	xfree( reuse );
+}
+
+
+
+/* --------------------------------------------------
+ * Cache functions
+ * -------------------------------------------------- */
+
+/*
+ * Rebuild the hash index of the cache with room for at least twice the
+ * number of entries in it.
+ */
+static void
+ode_contactreuse_reindex( reuse )
+	 ode_CONTACTREUSE *reuse;
+{
+	long			i, slot, mask;
+	ode_REUSEENTRY	*entry;
+
+	while ( reuse->indexSize < reuse->count * 2 + 2 )
+		reuse->indexSize *= 2;
+	REALLOC_N( reuse->index, long, reuse->indexSize );
+
+	mask = reuse->indexSize - 1;
+	for ( i = 0; i < reuse->indexSize; i++ )
+		reuse->index[i] = ODE_CONTACTREUSE_EMPTY;
+
+	for ( i = 0; i < reuse->count; i++ ) {
+		entry = reuse->entries + i;
+		slot = ODE_PAIR_HASH( entry->serial1, entry->serial2 ) & mask;
+		while ( reuse->index[slot] != ODE_CONTACTREUSE_EMPTY )
+			slot = ( slot + 1 ) & mask;
+		reuse->index[slot] = i;
+	}
+}
+
+
+/*
+ * Find the index slot for the pair (<tt>geom1</tt>, <tt>geom2</tt>): either
+ * the one holding its entry, or the empty one it would go in.
+ */
+static long
+ode_contactreuse_slot( reuse, geom1, geom2 )
+	 ode_CONTACTREUSE	*reuse;
+	 ode_GEOMETRY		*geom1, *geom2;
+{
+	ode_REUSEENTRY	*entry;
+	long			slot, mask = reuse->indexSize - 1;
+
+	slot = ODE_PAIR_HASH( geom1->serial, geom2->serial ) & mask;
+	while ( reuse->index[slot] != ODE_CONTACTREUSE_EMPTY ) {
+		entry = reuse->entries + reuse->index[slot];
+		if ( entry->serial1 == geom1->serial && entry->serial2 == geom2->serial )
+			break;
+		slot = ( slot + 1 ) & mask;
+	}
+
+	return slot;
+}
+
+
+/*
+ * Fetch the current pose of the given geometry into <tt>pos</tt> and
+ * <tt>quat</tt>: its body's if it has one, or its own if it's a static (or
+ * kinematic) geometry. Returns false for planes, which have no pose.
+ */
+static int
+ode_contactreuse_pose( geom, pos, quat )
+	 dGeomID		geom;
+	 dVector3		pos;
+	 dQuaternion	quat;
+{
+	dBodyID	body = dGeomGetBody( geom );
+
+	if ( body ) {
+		memcpy( pos, dBodyGetPosition(body), sizeof(dReal) * 3 );
+		memcpy( quat, dBodyGetQuaternion(body), sizeof(dQuaternion) );
+	} else if ( dGeomGetClass(geom) == dPlaneClass ) {
+		return 0;
+	} else {
+		memcpy( pos, dGeomGetPosition(geom), sizeof(dReal) * 3 );
+		dGeomGetQuaternion( geom, quat );
+	}
+
+	return 1;
+}
+
+
+/*
+ * Returns true if the given geometry (or its body, if it has one) is still
+ * within the cache's thresholds of the given pose. Disabled bodies are at
+ * rest; static geometries are only at rest until they're moved.
+ */
+static int
+ode_contactreuse_at_rest( reuse, geom, pos, quat )
+	 ode_CONTACTREUSE	*reuse;
+	 dGeomID			geom;
+	 dVector3			pos;
+	 dQuaternion		quat;
+{
+	dBodyID		body = dGeomGetBody( geom );
+	dVector3	curPos;
+	dQuaternion	curQuat;
+	dReal		dx, dy, dz, dot;
+
+	if ( body && !dBodyIsEnabled(body) ) return 1;
+	if ( !ode_contactreuse_pose(geom, curPos, curQuat) ) return 1;
+
+	dx = curPos[0] - pos[0];
+	dy = curPos[1] - pos[1];
+	dz = curPos[2] - pos[2];
+	if ( dx*dx + dy*dy + dz*dz > reuse->linearThreshold * reuse->linearThreshold )
+		return 0;
+
+	dot = curQuat[0]*quat[0] + curQuat[1]*quat[1] + curQuat[2]*quat[2] + curQuat[3]*quat[3];
+	if ( fabs(dot) < reuse->cosHalfAngle )
+		return 0;
+
+	return 1;
+}
+
+
+/*
+ * Copy the cached contacts for the pair (<tt>geom1</tt>, <tt>geom2</tt>) into
+ * <tt>contacts</tt> and return how many there were, if the pair's cached
+ * contacts were generated with the same <tt>maxContacts</tt> and both of its
+ * bodies are still at rest. Otherwise returns -1 and the caller should
+ * collide the pair and ode_contactreuse_store() the result.
+ */
+int
+ode_contactreuse_fetch( reuse, geom1, geom2, maxContacts, contacts, tick )
+	 ode_CONTACTREUSE	*reuse;
+	 ode_GEOMETRY		*geom1, *geom2;
+	 int				maxContacts;
+	 dContactGeom		*contacts;
+	 unsigned long		tick;
+{
+	ode_REUSEENTRY	*entry;
+	long			slot = ode_contactreuse_slot( reuse, geom1, geom2 );
+
+	if ( reuse->index[slot] == ODE_CONTACTREUSE_EMPTY ) {
+		reuse->misses++;
+		return -1;
+	}
+
+	entry = reuse->entries + reuse->index[slot];
+	if ( entry->maxContacts != maxContacts ||
+		 !ode_contactreuse_at_rest(reuse, geom1->id, entry->pos1, entry->quat1) ||
+		 !ode_contactreuse_at_rest(reuse, geom2->id, entry->pos2, entry->quat2) )
+	{
+		reuse->misses++;
+		return -1;
+	}
+
+	MEMCPY( contacts, entry->contacts, dContactGeom, entry->count );
+	entry->lastTick = tick;
+	reuse->hits++;
+
+	return entry->count;
+}
+
+
+/*
+ * Cache the <tt>count</tt> <tt>contacts</tt> generated for the pair
+ * (<tt>geom1</tt>, <tt>geom2</tt>) along with the current poses of its
+ * bodies.
+ */
+void
+ode_contactreuse_store( reuse, geom1, geom2, maxContacts, contacts, count, tick )
+	 ode_CONTACTREUSE	*reuse;
+	 ode_GEOMETRY		*geom1, *geom2;
+	 int				maxContacts, count;
+	 dContactGeom		*contacts;
+	 unsigned long		tick;
+{
+	ode_REUSEENTRY	*entry;
+	long			slot = ode_contactreuse_slot( reuse, geom1, geom2 );
+
+	if ( reuse->index[slot] == ODE_CONTACTREUSE_EMPTY ) {
+		if ( reuse->count == reuse->capacity ) {
+			reuse->capacity *= 2;
+			REALLOC_N( reuse->entries, ode_REUSEENTRY, reuse->capacity );
+		}
+
+		entry = reuse->entries + reuse->count;
+		entry->serial1		= geom1->serial;
+		entry->serial2		= geom2->serial;
+		entry->contacts		= NULL;
+		entry->maxContacts	= 0;
+
+		reuse->index[slot] = reuse->count++;
+		if ( reuse->count * 2 + 2 > reuse->indexSize )
+			ode_contactreuse_reindex( reuse );
+	} else {
+		entry = reuse->entries + reuse->index[slot];
+	}
+
+	if ( entry->maxContacts != maxContacts ) {
+		REALLOC_N( entry->contacts, dContactGeom, maxContacts );
+		entry->maxContacts = maxContacts;
+	}
+
+	MEMCPY( entry->contacts, contacts, dContactGeom, count );
+	entry->count = count;
+	entry->lastTick = tick;
+
+	ode_contactreuse_pose( geom1->id, entry->pos1, entry->quat1 );
+	ode_contactreuse_pose( geom2->id, entry->pos2, entry->quat2 );
+}
+
+
+/*
+ * Drop the entries for pairs which weren't candidates during the world step
+ * numbered <tt>tick</tt>; their geometries have separated (or gone away).
+ */
+void
+ode_contactreuse_step( reuse, tick )
+	 ode_CONTACTREUSE	*reuse;
+	 unsigned long		tick;
+{
+	long	i, kept;
+
+	for ( kept = 0, i = 0; i < reuse->count; i++ ) {
+		if ( reuse->entries[i].lastTick != tick )
+			xfree( reuse->entries[i].contacts );
+		else if ( kept++ != i )
+			reuse->entries[ kept - 1 ] = reuse->entries[i];
+	}
+
+	if ( kept != reuse->count ) {
+		reuse->count = kept;
+		ode_contactreuse_reindex( reuse );
+	}
+}
+
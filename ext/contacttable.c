@@ -0,0 +1,391 @@
+/*
+ *		contacttable.c - ODE Ruby Binding - Table of touching geometry pairs
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 15:10:37 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+#include <math.h>
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* Number of joint feedback slots allocated at a time. Slots are never moved
+   once handed to ODE, so they're kept in fixed-size blocks. */
+#define ODE_FEEDBACK_BLOCK_SIZE		256
+
+/* Empty hash index slot */
+#define ODE_CONTACTTABLE_EMPTY		-1
+
+
+
+/* --------------------------------------------------
+ * Memory-management functions
+ * -------------------------------------------------- */
+
+/*
+ * Create a new, empty contact pair table which queues events of the types
+ * <tt>beginEvent</tt> and <tt>endEvent</tt> for its changes when it's given
+ * an event queue.
+ */
+ode_CONTACTTABLE *
+ode_contacttable_new( beginEvent, endEvent )
+	 int beginEvent, endEvent;
+{
+	ode_CONTACTTABLE *table = ALLOC( ode_CONTACTTABLE );
+	long i;
+
+	table->count			= 0;
+	table->capacity			= 32;
+	table->pairs			= ALLOC_N( ode_CONTACTPAIR, table->capacity );
+	table->indexSize		= 64;
+	table->index			= ALLOC_N( long, table->indexSize );
+	table->changeCount		= 0;
+	table->changeCapacity	= 32;
+	table->changes			= ALLOC_N( ode_CONTACTCHANGE, table->changeCapacity );
+	table->feedbackBlocks	= NULL;
+	table->feedbackCount	= 0;
+	table->feedbackBlockCount = 0;
+	table->events			= NULL;
+	table->beginEvent		= beginEvent;
+	table->endEvent			= endEvent;
+
+	for ( i = 0; i < table->indexSize; i++ )
+		table->index[i] = ODE_CONTACTTABLE_EMPTY;
+
+	debugMsg(( "Created contact table <%p>", table ));
+	return table;
+}
+
+
+/*
+ * Free the given contact pair table. Any contact joints still pointing at its
+ * feedback slots must already be gone.
+ */
+void
+ode_contacttable_free( table )
+	 ode_CONTACTTABLE *table;
+{
+	long i;
+
+	debugMsg(( "Freeing contact table <%p>", table ));
+
+	for ( i = 0; i < table->feedbackBlockCount; i++ )
+		xfree( table->feedbackBlocks[i] );
+	if ( table->feedbackBlocks ) xfree( table->feedbackBlocks );
+
+	xfree( table->changes );
+	xfree( table->index );
+	xfree( table->pairs );
+	xfree( table );
+}
+
+
+/*
+ * Forget every pair and pending change in the given table, keeping its
+ * feedback slots (and any contact joints' pointers into them) intact.
+ */
+void
+ode_contacttable_clear( table )
+	 ode_CONTACTTABLE *table;
+{
+	long i;
+
+	table->count = 0;
+	table->changeCount = 0;
+	table->feedbackCount = 0;
+
+	for ( i = 0; i < table->indexSize; i++ )
+		table->index[i] = ODE_CONTACTTABLE_EMPTY;
+}
+
+
+/*
+ * Mark the geometries referred to by the table and its pending changes.
+ */
+void
+ode_contacttable_mark( table )
+	 ode_CONTACTTABLE *table;
+{
+	long i;
+
+	for ( i = 0; i < table->count; i++ ) {
+		rb_gc_mark( table->pairs[i].geom1 );
+		rb_gc_mark( table->pairs[i].geom2 );
+	}
+
+	for ( i = 0; i < table->changeCount; i++ ) {
+		rb_gc_mark( table->changes[i].pair.geom1 );
+		rb_gc_mark( table->changes[i].pair.geom2 );
+	}
+}
+
+
+
+/* --------------------------------------------------
+ * Table functions
+ * -------------------------------------------------- */
+
+/*
+ * Rebuild the hash index of the table with room for at least twice the
+ * number of pairs in it.
+ */
+static void
+ode_contacttable_reindex( table )
+	 ode_CONTACTTABLE *table;
+{
+	long			i, slot, mask;
+	ode_CONTACTPAIR	*pair;
+
+	while ( table->indexSize < table->count * 2 + 2 )
+		table->indexSize *= 2;
+	REALLOC_N( table->index, long, table->indexSize );
+
+	mask = table->indexSize - 1;
+	for ( i = 0; i < table->indexSize; i++ )
+		table->index[i] = ODE_CONTACTTABLE_EMPTY;
+
+	for ( i = 0; i < table->count; i++ ) {
+		pair = table->pairs + i;
+		slot = ODE_PAIR_HASH( pair->serial1, pair->serial2 ) & mask;
+		while ( table->index[slot] != ODE_CONTACTTABLE_EMPTY )
+			slot = ( slot + 1 ) & mask;
+		table->index[slot] = i;
+	}
+}
+
+
+/*
+ * Queue an event for a change in the given pair if the table has an event
+ * queue, or append a change record for it otherwise.
+ */
+static void
+ode_contacttable_add_change( table, pair, began )
+	 ode_CONTACTTABLE	*table;
+	 ode_CONTACTPAIR	*pair;
+	 int				began;
+{
+	ode_EVENT	*event;
+
+	if ( table->events ) {
+		event = ode_eventqueue_push( table->events,
+			began ? table->beginEvent : table->endEvent,
+			pair->lastTick, pair->serial1, pair->serial2 );
+		event->payload[0] = pair->impulse;
+		event->payload[1] = (double)pair->firstTick;
+		return;
+	}
+
+	if ( table->changeCount == table->changeCapacity ) {
+		table->changeCapacity *= 2;
+		REALLOC_N( table->changes, ode_CONTACTCHANGE, table->changeCapacity );
+	}
+
+	table->changes[ table->changeCount ].pair = *pair;
+	table->changes[ table->changeCount ].began = began;
+	table->changeCount++;
+}
+
+
+/*
+ * Note that the geometries <tt>geom1</tt> and <tt>geom2</tt> (in serial
+ * order) are touching on the given <tt>tick</tt>, adding them to the table
+ * (and recording a change) if they weren't already. Returns the index of the
+ * pair's entry, valid until the next ode_contacttable_step().
+ */
+long
+ode_contacttable_touch( table, geom1, geom2, tick )
+	 ode_CONTACTTABLE	*table;
+	 ode_GEOMETRY		*geom1, *geom2;
+	 unsigned long		tick;
+{
+	ode_CONTACTPAIR	*pair;
+	long			slot, mask = table->indexSize - 1;
+
+	slot = ODE_PAIR_HASH( geom1->serial, geom2->serial ) & mask;
+	while ( table->index[slot] != ODE_CONTACTTABLE_EMPTY ) {
+		pair = table->pairs + table->index[slot];
+		if ( pair->serial1 == geom1->serial && pair->serial2 == geom2->serial ) {
+			pair->lastTick = tick;
+			return table->index[slot];
+		}
+		slot = ( slot + 1 ) & mask;
+	}
+
+	/* A new pair */
+	if ( table->count == table->capacity ) {
+		table->capacity *= 2;
+		REALLOC_N( table->pairs, ode_CONTACTPAIR, table->capacity );
+	}
+
+	pair = table->pairs + table->count;
+	pair->geom1		= geom1->object;
+	pair->geom2		= geom2->object;
+	pair->serial1	= geom1->serial;
+	pair->serial2	= geom2->serial;
+	pair->firstTick	= tick;
+	pair->lastTick	= tick;
+	pair->impulse	= 0;
+	pair->useForce1	= dGeomGetBody( geom1->id ) != 0;
+
+	table->index[slot] = table->count++;
+	if ( table->count * 2 + 2 > table->indexSize )
+		ode_contacttable_reindex( table );
+
+	ode_contacttable_add_change( table, pair, 1 );
+
+	return table->count - 1;
+}
+
+
+/*
+ * Return a joint feedback slot for a contact joint belonging to the pair at
+ * index <tt>entry</tt>. The slot's forces are added to the pair's impulse at
+ * the next ode_contacttable_step().
+ */
+dJointFeedback *
+ode_contacttable_feedback( table, entry )
+	 ode_CONTACTTABLE	*table;
+	 long				entry;
+{
+	ode_CONTACTFEEDBACK	*slot;
+	long				block = table->feedbackCount / ODE_FEEDBACK_BLOCK_SIZE;
+
+	if ( block == table->feedbackBlockCount ) {
+		REALLOC_N( table->feedbackBlocks, ode_CONTACTFEEDBACK *, block + 1 );
+		table->feedbackBlocks[ block ] =
+			ALLOC_N( ode_CONTACTFEEDBACK, ODE_FEEDBACK_BLOCK_SIZE );
+		table->feedbackBlockCount++;
+	}
+
+	slot = table->feedbackBlocks[ block ] +
+		( table->feedbackCount % ODE_FEEDBACK_BLOCK_SIZE );
+	table->feedbackCount++;
+
+	slot->entry = entry;
+	MEMZERO( &slot->feedback, dJointFeedback, 1 );
+
+	return &slot->feedback;
+}
+
+
+/*
+ * Settle the table after the world step numbered <tt>tick</tt> (of size
+ * <tt>stepsize</tt>): add up the impulses of the step's contact joints, and
+ * drop (recording a change for) every pair that didn't touch during it. The
+ * cost is linear in the number of touching pairs and makes no Ruby calls.
+ */
+void
+ode_contacttable_step( table, tick, stepsize )
+	 ode_CONTACTTABLE	*table;
+	 unsigned long		tick;
+	 dReal				stepsize;
+{
+	ode_CONTACTFEEDBACK	*slot;
+	ode_CONTACTPAIR		*pair;
+	dReal				*force;
+	long				i, kept;
+
+	for ( i = 0; i < table->feedbackCount; i++ ) {
+		slot = table->feedbackBlocks[ i / ODE_FEEDBACK_BLOCK_SIZE ] +
+			( i % ODE_FEEDBACK_BLOCK_SIZE );
+		pair = table->pairs + slot->entry;
+		force = pair->useForce1 ? slot->feedback.f1 : slot->feedback.f2;
+
+		pair->impulse += (dReal)sqrt( force[0]*force[0] + force[1]*force[1] +
+									  force[2]*force[2] ) * stepsize;
+	}
+	table->feedbackCount = 0;
+
+	for ( kept = 0, i = 0; i < table->count; i++ ) {
+		pair = table->pairs + i;
+		if ( pair->lastTick != tick )
+			ode_contacttable_add_change( table, pair, 0 );
+		else if ( kept++ != i )
+			table->pairs[ kept - 1 ] = *pair;
+	}
+
+	if ( kept != table->count ) {
+		table->count = kept;
+		ode_contacttable_reindex( table );
+	}
+}
+
+
+/*
+ * Convert the given pair to a Ruby Array, prefixed with the <tt>type</tt>
+ * Symbol if it's non-nil.
+ */
+static VALUE
+ode_contacttable_pair_to_ary( pair, type )
+	 ode_CONTACTPAIR	*pair;
+	 VALUE				type;
+{
+	VALUE ary = rb_ary_new2( 6 );
+
+	if ( RTEST(type) ) rb_ary_push( ary, type );
+	rb_ary_push( ary, pair->geom1 );
+	rb_ary_push( ary, pair->geom2 );
+	rb_ary_push( ary, ULONG2NUM(pair->firstTick) );
+	rb_ary_push( ary, ULONG2NUM(pair->lastTick) );
+	rb_ary_push( ary, rb_float_new(pair->impulse) );
+
+	return ary;
+}
+
+
+/*
+ * Return the changes recorded since the last call as an Array of
+ * [type, geom1, geom2, firstTick, lastTick, impulse] Arrays, and clear
+ * them. The type is a Symbol named <tt>beginName</tt> or <tt>endName</tt>.
+ */
+VALUE
+ode_contacttable_drain_changes( table, beginName, endName )
+	 ode_CONTACTTABLE	*table;
+	 const char			*beginName, *endName;
+{
+	VALUE	ary = rb_ary_new2( table->changeCount );
+	VALUE	beginSym = ID2SYM( rb_intern(beginName) ),
+			endSym = ID2SYM( rb_intern(endName) );
+	long	i;
+
+	for ( i = 0; i < table->changeCount; i++ )
+		rb_ary_push( ary, ode_contacttable_pair_to_ary(&table->changes[i].pair,
+			table->changes[i].began ? beginSym : endSym) );
+
+	table->changeCount = 0;
+	return ary;
+}
+
+
+/*
+ * Return the pairs currently in the table as an Array of
+ * [geom1, geom2, firstTick, lastTick, impulse] Arrays.
+ */
+VALUE
+ode_contacttable_pairs( table )
+	 ode_CONTACTTABLE	*table;
+{
+	VALUE	ary = rb_ary_new2( table->count );
+	long	i;
+
+	for ( i = 0; i < table->count; i++ )
+		rb_ary_push( ary, ode_contacttable_pair_to_ary(table->pairs + i, Qnil) );
+
+	return ary;
+}
+
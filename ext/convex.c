@@ -0,0 +1,909 @@
+/*
+ *		convex.c - ODE Ruby Binding - ODE::ConvexData, ODE::Geometry::Convex and
+ *				   ODE::Mass::Convex
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 13:15:48 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+#include <math.h>
+#include <limits.h>
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* A triangle of the hull under construction */
+typedef struct {
+	int		v[3];
+	double	n[3], d;
+	int		alive;
+} ode_HULLFACE;
+
+/* Growable face list */
+typedef struct {
+	ode_HULLFACE	*faces;
+	int				count, capacity;
+} ode_HULLFACES;
+
+/* Arguments for building a hull under rb_ensure() */
+typedef struct {
+	ode_CONVEXDATA	*ptr;
+	double			*pts;
+	int				count, done;
+} ode_CONVEXHULLARGS;
+
+/* Rows of Numerics being copied into a C array under rb_protect() */
+typedef struct {
+	VALUE	rows;
+	int		width;
+	double	*values;
+	long	count;
+} ode_CONVEXROWS;
+
+
+/* --------------------------------------------------
+ * Memory-management functions
+ * -------------------------------------------------- */
+
+/*
+ * Allocation function
+ */
+static ode_CONVEXDATA *
+ode_convexdata_alloc()
+{
+	ode_CONVEXDATA *ptr = ALLOC( ode_CONVEXDATA );
+
+	ptr->object		= Qnil;
+	ptr->planes		= NULL;
+	ptr->points		= NULL;
+	ptr->polygons	= NULL;
+	ptr->planeCount	= 0;
+	ptr->pointCount	= 0;
+
+	debugMsg(( "Initialized ode_CONVEXDATA <%p>", ptr ));
+	return ptr;
+}
+
+
+/*
+ * GC free function
+ */
+static void
+ode_convexdata_gc_free( ptr )
+	 ode_CONVEXDATA *ptr;
+{
+	debugMsg(( "Freeing an ODE::ConvexData." ));
+
+	if ( ptr ) {
+		if ( ptr->planes ) xfree( ptr->planes );
+		if ( ptr->points ) xfree( ptr->points );
+		if ( ptr->polygons ) xfree( ptr->polygons );
+
+		ptr->planes		= NULL;
+		ptr->points		= NULL;
+		ptr->polygons	= NULL;
+		ptr->object		= Qnil;
+
+		xfree( ptr );
+		ptr = NULL;
+	}
+
+	else {
+		debugMsg(( "Not freeing NULL pointer." ));
+	}
+}
+
+
+/*
+ * Object validity checker. Returns the data pointer.
+ */
+static ode_CONVEXDATA *
+check_convexdata( self )
+	 VALUE	self;
+{
+	debugMsg(( "Checking a ConvexData object (%d).", self ));
+	Check_Type( self, T_DATA );
+
+    if ( !IsConvexData(self) ) {
+		rb_raise( rb_eTypeError, "wrong argument type %s (expected ODE::ConvexData)",
+				  rb_class2name(CLASS_OF( self )) );
+    }
+
+	return DATA_PTR( self );
+}
+
+
+/*
+ * Fetch the data pointer and check it for sanity.
+ */
+static ode_CONVEXDATA *
+get_convexdata( self )
+	 VALUE self;
+{
+	ode_CONVEXDATA *ptr = check_convexdata( self );
+
+	debugMsg(( "Fetching an ode_CONVEXDATA (%p).", ptr ));
+	if ( !ptr )
+		rb_raise( rb_eRuntimeError, "uninitialized convex data" );
+
+	return ptr;
+}
+
+
+/*
+ * Publicly-usable convex data fetcher.
+ */
+ode_CONVEXDATA *
+ode_get_convexdata( self )
+	 VALUE self;
+{
+	return get_convexdata( self );
+}
+
+
+
+/* --------------------------------------------------
+ * Hull construction
+ * -------------------------------------------------- */
+
+/*
+ * Add a face with vertices a, b, c to the face list, wound so that its normal
+ * points away from the given interior point.
+ */
+static void
+ode_hull_add_face( list, pts, a, b, c, interior )
+	 ode_HULLFACES	*list;
+	 const double	*pts, *interior;
+	 int			a, b, c;
+{
+	ode_HULLFACE	*face;
+	double			e1[3], e2[3], len;
+
+	if ( list->count == list->capacity ) {
+		list->capacity *= 2;
+		REALLOC_N( list->faces, ode_HULLFACE, list->capacity );
+	}
+	face = list->faces + list->count++;
+
+	Sub3( e1, pts + b*3, pts + a*3 );
+	Sub3( e2, pts + c*3, pts + a*3 );
+	Cross3( face->n, e1, e2 );
+	len = sqrt( Dot3(face->n, face->n) );
+	if ( len > 0 ) {
+		face->n[0] /= len; face->n[1] /= len; face->n[2] /= len;
+	}
+	face->d = Dot3( face->n, pts + a*3 );
+
+	face->v[0] = a;
+	face->v[1] = b;
+	face->v[2] = c;
+	face->alive = 1;
+
+	/* Flip it if it faces the interior */
+	if ( Dot3(face->n, interior) - face->d > 0 ) {
+		face->v[1] = c;
+		face->v[2] = b;
+		face->n[0] = -face->n[0]; face->n[1] = -face->n[1]; face->n[2] = -face->n[2];
+		face->d = -face->d;
+	}
+}
+
+
+/*
+ * Compute the convex hull of the <tt>count</tt> points in <tt>pts</tt> by
+ * incremental construction, storing the result in the given ode_CONVEXDATA in
+ * the form dCreateConvex() expects: planes as (nx,ny,nz,d) quads, the points
+ * actually on the hull, and each face as a vertex count followed by its
+ * counter-clockwise (seen from outside) vertex indices. Faces are triangles.
+ */
+static void
+ode_convexdata_build_hull( ptr, pts, count )
+	 ode_CONVEXDATA	*ptr;
+	 const double	*pts;
+	 int			count;
+{
+	ode_HULLFACES	list;
+	double			interior[3], e1[3], e2[3], n[3], dist, best, extent = 0, eps;
+	int				i, j, k, i0 = 0, i1 = -1, i2 = -1, i3 = -1, f, alive;
+	int				*edges, edgeCount, *remap;
+
+	if ( count < 4 )
+		rb_raise( rb_eArgError, "a convex hull needs at least 4 points (got %d)", count );
+
+	/* Pick a starting tetrahedron: the extreme point in X, the point furthest
+	   from it, the point furthest from that line, and the point furthest from
+	   that plane. */
+	for ( i = 1; i < count; i++ )
+		if ( pts[i*3] < pts[i0*3] ) i0 = i;
+
+	for ( best = 0, i = 0; i < count; i++ ) {
+		Sub3( e1, pts + i*3, pts + i0*3 );
+		if ( (dist = Dot3(e1, e1)) > best ) { best = dist; i1 = i; }
+	}
+	extent = sqrt( best );
+	eps = 1e-9 * (extent > 1.0 ? extent : 1.0);
+
+	for ( best = 0, i = 0; i1 >= 0 && i < count; i++ ) {
+		Sub3( e1, pts + i1*3, pts + i0*3 );
+		Sub3( e2, pts + i*3, pts + i0*3 );
+		Cross3( n, e1, e2 );
+		if ( (dist = Dot3(n, n)) > best ) { best = dist; i2 = i; }
+	}
+
+	if ( i2 >= 0 ) {
+		Sub3( e1, pts + i1*3, pts + i0*3 );
+		Sub3( e2, pts + i2*3, pts + i0*3 );
+		Cross3( n, e1, e2 );
+		for ( best = eps * extent * extent, i = 0; i < count; i++ ) {
+			Sub3( e1, pts + i*3, pts + i0*3 );
+			if ( (dist = fabs(Dot3(n, e1))) > best ) { best = dist; i3 = i; }
+		}
+	}
+
+	if ( i1 < 0 || i2 < 0 || i3 < 0 )
+		rb_raise( rb_eArgError, "can't build a convex hull from coplanar points" );
+
+	for ( i = 0; i < 3; i++ )
+		interior[i] = ( pts[i0*3+i] + pts[i1*3+i] + pts[i2*3+i] + pts[i3*3+i] ) / 4.0;
+
+	list.capacity = 64;
+	list.count = 0;
+	list.faces = ALLOC_N( ode_HULLFACE, list.capacity );
+	edges = ALLOC_N( int, 2 );
+
+	ode_hull_add_face( &list, pts, i0, i1, i2, interior );
+	ode_hull_add_face( &list, pts, i0, i1, i3, interior );
+	ode_hull_add_face( &list, pts, i0, i2, i3, interior );
+	ode_hull_add_face( &list, pts, i1, i2, i3, interior );
+
+	/* Add each remaining point that lies outside the current hull, replacing
+	   the faces it can see with a fan from their horizon to the point. */
+	for ( i = 0; i < count; i++ ) {
+		if ( i == i0 || i == i1 || i == i2 || i == i3 ) continue;
+
+		edgeCount = 0;
+		for ( f = 0; f < list.count; f++ ) {
+			if ( !list.faces[f].alive ) continue;
+			if ( Dot3(list.faces[f].n, pts + i*3) - list.faces[f].d <= eps ) continue;
+
+			list.faces[f].alive = 0;
+			REALLOC_N( edges, int, (edgeCount + 3) * 2 );
+			for ( j = 0; j < 3; j++ ) {
+				edges[ edgeCount*2 ]	 = list.faces[f].v[j];
+				edges[ edgeCount*2 + 1 ] = list.faces[f].v[(j+1) % 3];
+				edgeCount++;
+			}
+		}
+		if ( !edgeCount ) continue;
+
+		/* Edges shared by two visible faces appear once in each direction;
+		   the ones that don't are the horizon. */
+		for ( j = 0; j < edgeCount; j++ ) {
+			for ( k = 0; k < edgeCount; k++ ) {
+				if ( edges[k*2] == edges[j*2 + 1] && edges[k*2 + 1] == edges[j*2] )
+					break;
+			}
+			if ( k == edgeCount )
+				ode_hull_add_face( &list, pts, edges[j*2], edges[j*2 + 1], i, interior );
+		}
+	}
+
+	/* Compact the surviving faces and the points they use into ODE's layout */
+	remap = ALLOC_N( int, count );
+	for ( i = 0; i < count; i++ ) remap[i] = -1;
+
+	for ( alive = 0, f = 0; f < list.count; f++ ) {
+		if ( !list.faces[f].alive ) continue;
+		alive++;
+		for ( j = 0; j < 3; j++ ) remap[ list.faces[f].v[j] ] = 0;
+	}
+
+	ptr->pointCount = 0;
+	for ( i = 0; i < count; i++ )
+		if ( remap[i] == 0 ) remap[i] = ptr->pointCount++;
+
+	ptr->planeCount = alive;
+	ptr->points		= ALLOC_N( dReal, ptr->pointCount * 3 );
+	ptr->planes		= ALLOC_N( dReal, ptr->planeCount * 4 );
+	ptr->polygons	= ALLOC_N( unsigned int, ptr->planeCount * 4 );
+
+	for ( i = 0; i < count; i++ ) {
+		if ( remap[i] < 0 ) continue;
+		for ( j = 0; j < 3; j++ )
+			ptr->points[ remap[i]*3 + j ] = (dReal)pts[ i*3 + j ];
+	}
+
+	for ( k = 0, f = 0; f < list.count; f++ ) {
+		if ( !list.faces[f].alive ) continue;
+		for ( j = 0; j < 3; j++ )
+			ptr->planes[ k*4 + j ] = (dReal)list.faces[f].n[j];
+		ptr->planes[ k*4 + 3 ] = (dReal)list.faces[f].d;
+
+		ptr->polygons[ k*4 ] = 3;
+		for ( j = 0; j < 3; j++ )
+			ptr->polygons[ k*4 + 1 + j ] = remap[ list.faces[f].v[j] ];
+		k++;
+	}
+
+	xfree( remap );
+	xfree( edges );
+	xfree( list.faces );
+
+	debugMsg(( "Built convex hull of %d points: %d points, %d faces",
+			   count, ptr->pointCount, ptr->planeCount ));
+}
+
+
+/*
+ * rb_ensure() body for building a hull from an ode_CONVEXHULLARGS.
+ */
+static VALUE
+ode_convexdata_build_hull_body( arg )
+	 VALUE arg;
+{
+	ode_CONVEXHULLARGS *hull = (ode_CONVEXHULLARGS *)arg;
+
+	ode_convexdata_build_hull( hull->ptr, hull->pts, hull->count );
+	hull->done = 1;
+
+	return Qnil;
+}
+
+
+/*
+ * rb_ensure() cleanup for building a hull: free the point cloud, and the
+ * data struct too if the hull couldn't be built.
+ */
+static VALUE
+ode_convexdata_build_hull_ensure( arg )
+	 VALUE arg;
+{
+	ode_CONVEXHULLARGS *hull = (ode_CONVEXHULLARGS *)arg;
+
+	xfree( hull->pts );
+	hull->pts = NULL;
+	if ( !hull->done ) {
+		ode_convexdata_gc_free( hull->ptr );
+		hull->ptr = NULL;
+	}
+
+	return Qnil;
+}
+
+
+/*
+ * Compute the mass properties of a solid of uniform <tt>density</tt> bounded by
+ * the hull, by summing the signed tetrahedra formed by each (fanned) face and
+ * the origin. The inertia tensor is about the origin of the hull's frame.
+ */
+static void
+ode_convexdata_mass_properties( ptr, density, mass, center, inertia )
+	 ode_CONVEXDATA	*ptr;
+	 double			density, *mass, *center, *inertia;
+{
+	double			a[3], b[3], c[3], bc[3], det, volume = 0, cov[9];
+	const dReal		*p;
+	unsigned int	*poly = ptr->polygons, f, v, i, j;
+
+	for ( i = 0; i < 3; i++ ) center[i] = 0;
+	for ( i = 0; i < 9; i++ ) cov[i] = 0;
+
+	for ( f = 0; f < ptr->planeCount; f++ ) {
+		p = ptr->points + poly[1] * 3;
+		a[0] = p[0]; a[1] = p[1]; a[2] = p[2];
+
+		for ( v = 1; v + 1 < poly[0]; v++ ) {
+			p = ptr->points + poly[1 + v] * 3;
+			b[0] = p[0]; b[1] = p[1]; b[2] = p[2];
+			p = ptr->points + poly[2 + v] * 3;
+			c[0] = p[0]; c[1] = p[1]; c[2] = p[2];
+
+			Cross3( bc, b, c );
+			det = Dot3( a, bc );
+			volume += det / 6.0;
+
+			for ( i = 0; i < 3; i++ )
+				center[i] += det * ( a[i] + b[i] + c[i] ) / 24.0;
+
+			/* Covariance of the tetrahedron (0,a,b,c): det/120 * (sum of
+			   products over the vertices, with the diagonal terms doubled) */
+			for ( i = 0; i < 3; i++ )
+				for ( j = 0; j < 3; j++ )
+					cov[i*3 + j] += det / 120.0 *
+						( 2.0 * (a[i]*a[j] + b[i]*b[j] + c[i]*c[j]) +
+						  a[i]*b[j] + a[j]*b[i] + a[i]*c[j] + a[j]*c[i] +
+						  b[i]*c[j] + b[j]*c[i] );
+		}
+
+		poly += poly[0] + 1;
+	}
+
+	if ( volume <= 0 )
+		rb_raise( rb_eRuntimeError, "convex hull has no volume" );
+
+	*mass = density * volume;
+	for ( i = 0; i < 3; i++ ) center[i] /= volume;
+
+	/* I = trace(C) * E - C */
+	for ( i = 0; i < 3; i++ )
+		for ( j = 0; j < 3; j++ )
+			inertia[i*3 + j] = density *
+				( (i == j ? cov[0] + cov[4] + cov[8] : 0) - cov[i*3 + j] );
+}
+
+
+/*
+ * Copy the rows described by the given ode_CONVEXROWS into its values buffer.
+ * Called under rb_protect() by ode_convexdata_unpack_rows().
+ */
+static VALUE
+ode_convexdata_fill_rows( arg )
+	 VALUE arg;
+{
+	ode_CONVEXROWS	*fill = (ode_CONVEXROWS *)arg;
+	VALUE			row;
+	long			i, j;
+
+	for ( i = 0; i < RARRAY(fill->rows)->len; i++ ) {
+		row = *(RARRAY(fill->rows)->ptr + i);
+		if ( !fill->width ) fill->values[ fill->count++ ] = RARRAY(row)->len;
+		for ( j = 0; j < RARRAY(row)->len; j++ )
+			fill->values[ fill->count++ ] = NUM2DBL( *(RARRAY(row)->ptr + j) );
+	}
+
+	return Qnil;
+}
+
+
+/*
+ * Fetch a Ruby Array of Arrays of Numerics into a freshly-allocated C array,
+ * checking that each inner Array has <tt>width</tt> elements (or any number,
+ * if <tt>width</tt> is 0, in which case each row is prefixed with its length).
+ * Returns the number of rows; the number of values is left in
+ * <tt>valueCount</tt>.
+ */
+static int
+ode_convexdata_unpack_rows( rows, width, name, values, valueCount )
+	 VALUE		rows;
+	 int		width;
+	 const char	*name;
+	 double		**values;
+	 long		*valueCount;
+{
+	ode_CONVEXROWS	fill;
+	VALUE			row;
+	long			i, n = 0;
+	int				state = 0;
+
+	Check_Type( rows, T_ARRAY );
+	for ( i = 0; i < RARRAY(rows)->len; i++ ) {
+		row = *(RARRAY(rows)->ptr + i);
+		Check_Type( row, T_ARRAY );
+		if ( width && RARRAY(row)->len != width )
+			rb_raise( rb_eArgError, "wrong number of elements in %s %ld (%ld for %d)",
+					  name, i, RARRAY(row)->len, width );
+		else if ( !width && RARRAY(row)->len < 3 )
+			rb_raise( rb_eArgError, "%s %ld has fewer than 3 vertices", name, i );
+		n += RARRAY(row)->len + (width ? 0 : 1);
+	}
+
+	*values = ALLOC_N( double, n ? n : 1 );
+	fill.rows = rows;
+	fill.width = width;
+	fill.values = *values;
+	fill.count = 0;
+
+	/* Converting the elements can raise, so don't leak the buffer if it does */
+	rb_protect( ode_convexdata_fill_rows, (VALUE)&fill, &state );
+	if ( state ) {
+		xfree( *values );
+		*values = NULL;
+		rb_jump_tag( state );
+	}
+
+	*valueCount = fill.count;
+	return RARRAY(rows)->len;
+}
+
+
+
+/* --------------------------------------------------
+ * Class Methods
+ * -------------------------------------------------- */
+
+/*
+ * Allocator
+ */
+static VALUE
+ode_convexdata_s_alloc( klass )
+	 VALUE klass;
+{
+	debugMsg(( "Wrapping an uninitialized ODE::ConvexData pointer." ));
+	return Data_Wrap_Struct( klass, 0, ode_convexdata_gc_free, 0 );
+}
+
+
+/*
+ * ODE::ConvexData::fromPlanes( planes, points, polygons )
+ * --
+ * Create a new ConvexData object from an explicit hull description:
+ * <tt>planes</tt> is an Array of <tt>[nx, ny, nz, d]</tt> face planes (with
+ * outward-facing unit normals), <tt>points</tt> an Array of <tt>[x, y,
+ * z]</tt> vertices, and <tt>polygons</tt> an Array of vertex-index Arrays,
+ * one per plane, wound counter-clockwise as seen from outside the hull.
+ */
+static VALUE
+ode_convexdata_s_from_planes( klass, planes, points, polygons )
+	 VALUE klass, planes, points, polygons;
+{
+	VALUE			self = rb_obj_alloc( klass );
+	ode_CONVEXDATA	*ptr;
+	double			*values = NULL;
+	long			count, i;
+	int				rows;
+
+	DATA_PTR(self) = ptr = ode_convexdata_alloc();
+	ptr->object = self;
+
+	/* Points */
+	rows = ode_convexdata_unpack_rows( points, 3, "point", &values, &count );
+	ptr->pointCount = rows;
+	ptr->points = ALLOC_N( dReal, count ? count : 1 );
+	for ( i = 0; i < count; i++ ) ptr->points[i] = (dReal)values[i];
+	xfree( values );
+
+	/* Planes */
+	rows = ode_convexdata_unpack_rows( planes, 4, "plane", &values, &count );
+	ptr->planeCount = rows;
+	ptr->planes = ALLOC_N( dReal, count ? count : 1 );
+	for ( i = 0; i < count; i++ ) ptr->planes[i] = (dReal)values[i];
+	xfree( values );
+
+	/* Polygons */
+	rows = ode_convexdata_unpack_rows( polygons, 0, "polygon", &values, &count );
+	if ( rows != (int)ptr->planeCount ) {
+		xfree( values );
+		rb_raise( rb_eArgError, "%d polygons given for %d planes", rows, ptr->planeCount );
+	}
+	ptr->polygons = ALLOC_N( unsigned int, count ? count : 1 );
+	for ( i = 0; i < count; i++ ) ptr->polygons[i] = (unsigned int)values[i];
+	xfree( values );
+
+	/* Check the indices, skipping the counts */
+	for ( i = 0; i < count; i += ptr->polygons[i] + 1 ) {
+		long j;
+		for ( j = 1; j <= (long)ptr->polygons[i]; j++ )
+			if ( ptr->polygons[i + j] >= ptr->pointCount )
+				rb_raise( rb_eIndexError, "polygon vertex index %u out of range (0...%u)",
+						  ptr->polygons[i + j], ptr->pointCount );
+	}
+
+	return self;
+}
+
+
+
+/* --------------------------------------------------
+ * Instance Methods
+ * -------------------------------------------------- */
+
+/* --- ODE::ConvexData ------------------------------ */
+
+/*
+ * ODE::ConvexData::new( points, precision=:single )
+ * --
+ * Create a new ConvexData object from the convex hull of the given packed
+ * point cloud (triples of native floats, or doubles if <tt>precision</tt> is
+ * <tt>:double</tt>). The hull is computed once, natively, and may be shared by
+ * any number of ODE::Geometry::Convex objects.
+ */
+static VALUE
+ode_convexdata_init( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_CONVEXDATA	*ptr;
+	ode_CONVEXHULLARGS hull;
+	VALUE			points, precision;
+	double			*pts;
+	long			stride, count, i;
+	int				isDouble;
+
+	rb_scan_args( argc, argv, "11", &points, &precision );
+
+	if ( (ptr = check_convexdata(self)) )
+		rb_raise( rb_eRuntimeError, "convex data already initialized" );
+
+	StringValue( points );
+	isDouble = ode_precision_flag( precision );
+	stride = isDouble ? sizeof(double) * 3 : sizeof(float) * 3;
+	if ( RSTRING(points)->len % stride )
+		rb_raise( rb_eArgError, "point buffer length (%ld) is not a multiple of %ld",
+				  RSTRING(points)->len, stride );
+
+	count = RSTRING(points)->len / stride;
+	if ( count > INT_MAX / 3 )
+		rb_raise( rb_eArgError, "too many points (%ld)", count );
+
+	/* The point cloud can be arbitrarily large, so it goes on the heap, and is
+	   freed whether or not building the hull raises */
+	pts = ALLOC_N( double, count * 3 > 0 ? count * 3 : 1 );
+	for ( i = 0; i < count * 3; i++ )
+		pts[i] = isDouble ?
+			*( (double *)RSTRING(points)->ptr + i ) :
+			*( (float *)RSTRING(points)->ptr + i );
+
+	hull.ptr = ptr = ode_convexdata_alloc();
+	hull.pts = pts;
+	hull.count = (int)count;
+	hull.done = 0;
+	rb_ensure( ode_convexdata_build_hull_body, (VALUE)&hull,
+			   ode_convexdata_build_hull_ensure, (VALUE)&hull );
+
+	/* Only attach the data once the hull's been built */
+	DATA_PTR(self) = ptr;
+	ptr->object = self;
+
+	return self;
+}
+
+
+/*
+ * ODE::ConvexData#pointCount
+ * --
+ * Returns the number of vertices on the hull.
+ */
+static VALUE
+ode_convexdata_point_count( self )
+	 VALUE self;
+{
+	ode_CONVEXDATA	*ptr = get_convexdata( self );
+	return INT2FIX( ptr->pointCount );
+}
+
+
+/*
+ * ODE::ConvexData#planeCount
+ * --
+ * Returns the number of faces of the hull.
+ */
+static VALUE
+ode_convexdata_plane_count( self )
+	 VALUE self;
+{
+	ode_CONVEXDATA	*ptr = get_convexdata( self );
+	return INT2FIX( ptr->planeCount );
+}
+
+
+/*
+ * ODE::ConvexData#points
+ * --
+ * Returns the vertices of the hull as an Array of ODE::Position objects.
+ */
+static VALUE
+ode_convexdata_points( self )
+	 VALUE self;
+{
+	ode_CONVEXDATA	*ptr = get_convexdata( self );
+	VALUE			ary = rb_ary_new2( ptr->pointCount ), pos;
+	unsigned int	i;
+
+	for ( i = 0; i < ptr->pointCount; i++ ) {
+		Vec3ToOdePosition( ptr->points + i*3, pos );
+		rb_ary_store( ary, i, pos );
+	}
+
+	return ary;
+}
+
+
+/*
+ * ODE::ConvexData#volume
+ * --
+ * Returns the volume enclosed by the hull.
+ */
+static VALUE
+ode_convexdata_volume( self )
+	 VALUE self;
+{
+	ode_CONVEXDATA	*ptr = get_convexdata( self );
+	double			mass, center[3], inertia[9];
+
+	ode_convexdata_mass_properties( ptr, 1.0, &mass, center, inertia );
+	return rb_float_new( mass );
+}
+
+
+/*
+ * ODE::ConvexData#centroid
+ * --
+ * Returns the centroid of the volume enclosed by the hull as an
+ * ODE::Position.
+ */
+static VALUE
+ode_convexdata_centroid( self )
+	 VALUE self;
+{
+	ode_CONVEXDATA	*ptr = get_convexdata( self );
+	double			mass, center[3], inertia[9];
+	VALUE			pos;
+
+	ode_convexdata_mass_properties( ptr, 1.0, &mass, center, inertia );
+	Vec3ToOdePosition( center, pos );
+
+	return pos;
+}
+
+
+
+/* --- ODE::Geometry::Convex ------------------------------ */
+
+/*
+ * ODE::Geometry::Convex::new( data, space=nil )
+ * --
+ * Create a new convex hull collision geometry from the given ODE::ConvexData,
+ * inserting it into the specified space, if given. Any number of geometries
+ * can share one data object.
+ */
+static VALUE
+ode_geometry_convex_init( argc, argv, self )
+	 int		argc;
+	 VALUE		*argv, self;
+{
+#ifdef HAVE_CONVEX_GEOM
+	VALUE			data, spaceObj;
+	dSpaceID		space = 0;
+	ode_GEOMETRY	*geometry = 0;
+	ode_CONVEXDATA	*hull;
+
+	debugMsg(( "Calling super()" ));
+	rb_call_super( 0, 0 );
+	debugMsg(( "Back from super()" ));
+
+	/* Fetch the ode_GEOMETRY pointer */
+	geometry = ode_get_geom( self );
+	if ( !geometry ) rb_bug( "Superclass's initialize didn't return a valid Geometry." );
+
+	if ( rb_scan_args(argc, argv, "11", &data, &spaceObj) == 2 ) {
+		SetContainer( spaceObj, space, geometry );
+	}
+
+	hull = get_convexdata( data );
+
+	debugMsg(( "Creating new Convex geometry." ));
+	geometry->id = dCreateConvex( space,
+								  hull->planes, hull->planeCount,
+								  hull->points, hull->pointCount,
+								  hull->polygons );
+
+	/* Set the ode_GEOMETRY pointer as the data pointer of the dGeomID, and
+	   keep the hull alive as long as the geometry refers to it */
+	dGeomSetData( geometry->id, geometry );
+	rb_iv_set( self, "@data", data );
+
+	return self;
+#else
+	rb_notimplement();
+#endif /* HAVE_CONVEX_GEOM */
+}
+
+
+/*
+ * ODE::Geometry::Convex#data
+ * --
+ * Returns the ODE::ConvexData the geometry was created with.
+ */
+static VALUE
+ode_geometry_convex_data( self )
+	 VALUE self;
+{
+	return rb_iv_get( self, "@data" );
+}
+
+
+
+/* --- ODE::Mass::Convex ------------------------------ */
+
+/*
+ * ODE::Mass::Convex::new( density, convexData, totalmass=nil )
+ * --
+ * Create a mass object with the mass distribution of a solid of the given
+ * <tt>density</tt> filling the specified ODE::ConvexData hull, adjusted to
+ * <tt>totalmass</tt> if given. The center of gravity is the hull's centroid
+ * in its own frame; since ODE wants body masses centered on the body's
+ * origin, translate the mass by the negated #cog (and offset the geometry to
+ * match) if the hull isn't centered.
+ */
+static VALUE
+ode_mass_convex_init( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_MASS		*ptr;
+	ode_CONVEXDATA	*hull;
+	VALUE			density, data, totalmass;
+	double			mass, center[3], I[9];
+
+	rb_scan_args( argc, argv, "21", &density, &data, &totalmass );
+
+	CheckPositiveNonZeroNumber( NUM2DBL(density), "density" );
+	hull = get_convexdata( data );
+
+	rb_call_super( 0, 0 );
+	ptr = ode_get_mass( self );
+
+	ode_convexdata_mass_properties( hull, NUM2DBL(density), &mass, center, I );
+	dMassSetParameters( ptr->massptr, (dReal)mass,
+						(dReal)center[0], (dReal)center[1], (dReal)center[2],
+						(dReal)I[0], (dReal)I[4], (dReal)I[8],
+						(dReal)I[1], (dReal)I[2], (dReal)I[5] );
+
+	/* If a totalmass argument was given, check and set it */
+	if ( RTEST(totalmass) ) {
+		CheckPositiveNonZeroNumber( NUM2DBL(totalmass), "totalmass" );
+		dMassAdjust( ptr->massptr, (dReal)NUM2DBL(totalmass) );
+	}
+
+	return self;
+}
+
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_convex()
+{
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeConvexData		= rb_define_class_under( ode_mOde, "ConvexData", rb_cObject );
+	ode_cOdeGeometry		= rb_define_class_under( ode_mOde, "Geometry", rb_cObject );
+	ode_cOdePlaceable		= rb_define_class_under( ode_cOdeGeometry, "Placeable", ode_cOdeGeometry );
+	ode_cOdeGeometryConvex	= rb_define_class_under( ode_cOdeGeometry, "Convex", ode_cOdePlaceable );
+	ode_cOdeMass			= rb_define_class_under( ode_mOde, "Mass", rb_cObject );
+	ode_cOdeMassConvex		= rb_define_class_under( ode_cOdeMass, "Convex", ode_cOdeMass );
+#endif
+
+	/* ODE::ConvexData */
+	rb_define_alloc_func( ode_cOdeConvexData, ode_convexdata_s_alloc );
+	rb_define_singleton_method( ode_cOdeConvexData, "fromPlanes", ode_convexdata_s_from_planes, 3 );
+	rb_define_singleton_method( ode_cOdeConvexData, "from_planes", ode_convexdata_s_from_planes, 3 );
+
+	rb_define_method( ode_cOdeConvexData, "initialize", ode_convexdata_init, -1 );
+
+	rb_define_method( ode_cOdeConvexData, "pointCount", ode_convexdata_point_count, 0 );
+	rb_define_alias ( ode_cOdeConvexData, "point_count", "pointCount" );
+	rb_define_method( ode_cOdeConvexData, "planeCount", ode_convexdata_plane_count, 0 );
+	rb_define_alias ( ode_cOdeConvexData, "plane_count", "planeCount" );
+	rb_define_method( ode_cOdeConvexData, "points", ode_convexdata_points, 0 );
+	rb_define_method( ode_cOdeConvexData, "volume", ode_convexdata_volume, 0 );
+	rb_define_method( ode_cOdeConvexData, "centroid", ode_convexdata_centroid, 0 );
+
+	/* ODE::Geometry::Convex */
+	rb_define_method( ode_cOdeGeometryConvex, "initialize", ode_geometry_convex_init, -1 );
+	rb_enable_super ( ode_cOdeGeometryConvex, "initialize" );
+
+	rb_define_method( ode_cOdeGeometryConvex, "data", ode_geometry_convex_data, 0 );
+
+	/* ODE::Mass::Convex */
+	rb_define_method( ode_cOdeMassConvex, "initialize", ode_mass_convex_init, -1 );
+	rb_enable_super ( ode_cOdeMassConvex, "initialize" );
+}
+
@@ -0,0 +1,765 @@
+/*
+ *		distance.c - ODE Ruby Binding - Closest-point and distance queries
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 18:36:07 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+#include <math.h>
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* Most iterations of GJK before settling for the best so far */
+#define ODE_GJK_MAX_ITERATIONS		32
+
+/* Relative tolerance GJK stops at */
+#define ODE_GJK_TOLERANCE			1e-6
+
+/* Number of contacts asked for when measuring penetration */
+#define ODE_DISTANCE_MAX_CONTACTS	8
+
+/* Shape kinds, by their core (the shape minus its rounding radius) */
+#define ODE_SHAPE_POINT		0	/* Sphere */
+#define ODE_SHAPE_SEGMENT	1	/* Capsule */
+#define ODE_SHAPE_BOX		2
+#define ODE_SHAPE_HULL		3	/* Convex */
+#define ODE_SHAPE_PLANE		4
+
+#define Set3( r, a )		{ (r)[0] = (a)[0]; (r)[1] = (a)[1]; (r)[2] = (a)[2]; }
+
+/* A geometry's shape, in world coordinates */
+typedef struct {
+	int				kind;
+	const dReal		*pos, *rot;
+	dReal			radius, halfLength;
+	dVector3		half, axis;
+	dVector4		plane;
+	ode_CONVEXDATA	*hull;
+} ode_SHAPE;
+
+/* The result of a query */
+typedef struct {
+	dReal		distance;
+	dVector3	point1, point2;
+} ode_DISTANCE;
+
+/* A vertex of the GJK simplex, with the support points it came from */
+typedef struct {
+	dVector3	w, a, b;
+} ode_GJKVERTEX;
+
+
+
+/* --------------------------------------------------
+ * Shapes
+ * -------------------------------------------------- */
+
+/*
+ * Fill in the <tt>shape</tt> for the given geometry, raising a
+ * GeometryError for geometries distance queries don't handle.
+ */
+static void
+ode_distance_get_shape( geom, shape )
+	 ode_GEOMETRY	*geom;
+	 ode_SHAPE		*shape;
+{
+	dReal	length;
+
+	shape->radius = 0;
+	shape->halfLength = 0;
+
+	switch ( dGeomGetClass(geom->id) ) {
+	case dSphereClass:
+		shape->kind = ODE_SHAPE_POINT;
+		shape->radius = dGeomSphereGetRadius( geom->id );
+		break;
+
+	case dCCylinderClass:
+		shape->kind = ODE_SHAPE_SEGMENT;
+		dGeomCCylinderGetParams( geom->id, &shape->radius, &length );
+		shape->halfLength = length / 2;
+		break;
+
+	case dBoxClass:
+		shape->kind = ODE_SHAPE_BOX;
+		dGeomBoxGetLengths( geom->id, shape->half );
+		shape->half[0] /= 2; shape->half[1] /= 2; shape->half[2] /= 2;
+		break;
+
+#ifdef HAVE_CONVEX_GEOM
+	case dConvexClass:
+		shape->kind = ODE_SHAPE_HULL;
+		shape->hull = ode_get_convexdata( rb_iv_get(geom->object, "@data") );
+		break;
+#endif
+
+	case dPlaneClass:
+		shape->kind = ODE_SHAPE_PLANE;
+		dGeomPlaneGetParams( geom->id, shape->plane );
+		shape->pos = shape->rot = NULL;
+		return;
+
+	default:
+		rb_raise( ode_eOdeGeometryError,
+				  "distance queries aren't supported for %s geometries",
+				  rb_class2name(CLASS_OF( geom->object )) );
+	}
+
+	shape->pos = dGeomGetPosition( geom->id );
+	shape->rot = dGeomGetRotation( geom->id );
+	shape->axis[0] = shape->rot[2];
+	shape->axis[1] = shape->rot[6];
+	shape->axis[2] = shape->rot[10];
+}
+
+
+/*
+ * Set <tt>result</tt> to the point of the shape's core furthest in the
+ * direction <tt>dir</tt>.
+ */
+static void
+ode_distance_support( shape, dir, result )
+	 ode_SHAPE		*shape;
+	 const dReal	*dir;
+	 dVector3		result;
+{
+	const dReal	*rot = shape->rot;
+	dReal		s, best, dot, *p;
+	dVector3	local;
+	unsigned int i;
+
+	switch ( shape->kind ) {
+	case ODE_SHAPE_SEGMENT:
+		s = Dot3( dir, shape->axis ) >= 0 ? shape->halfLength : -shape->halfLength;
+		AddScaled3( result, shape->pos, s, shape->axis );
+		break;
+
+	case ODE_SHAPE_BOX:
+		Set3( result, shape->pos );
+		for ( i = 0; i < 3; i++ ) {
+			s = dir[0]*rot[i] + dir[1]*rot[4+i] + dir[2]*rot[8+i];
+			s = s >= 0 ? shape->half[i] : -shape->half[i];
+			result[0] += s * rot[i];
+			result[1] += s * rot[4+i];
+			result[2] += s * rot[8+i];
+		}
+		break;
+
+	case ODE_SHAPE_HULL:
+		/* Find the furthest point in the hull's own frame */
+		for ( i = 0; i < 3; i++ )
+			local[i] = dir[0]*rot[i] + dir[1]*rot[4+i] + dir[2]*rot[8+i];
+		p = shape->hull->points;
+		best = Dot3( local, p );
+		for ( i = 1; i < shape->hull->pointCount; i++ ) {
+			dot = Dot3( local, shape->hull->points + i*3 );
+			if ( dot > best ) {
+				best = dot;
+				p = shape->hull->points + i*3;
+			}
+		}
+		for ( i = 0; i < 3; i++ )
+			result[i] = shape->pos[i] + rot[i*4]*p[0] + rot[i*4+1]*p[1] + rot[i*4+2]*p[2];
+		break;
+
+	default:
+		Set3( result, shape->pos );
+	}
+}
+
+
+
+/* --------------------------------------------------
+ * Analytic queries
+ * -------------------------------------------------- */
+
+/*
+ * Fill in the result for two rounded points: <tt>p1</tt> and <tt>p2</tt>
+ * with radii <tt>r1</tt> and <tt>r2</tt>. This covers sphere, capsule, and
+ * (with the closest points of the cores) every rounded pair whose cores
+ * don't intersect.
+ */
+static void
+ode_distance_rounded( p1, r1, p2, r2, result )
+	 const dReal	*p1, *p2;
+	 dReal			r1, r2;
+	 ode_DISTANCE	*result;
+{
+	dVector3	n;
+	dReal		d;
+
+	Sub3( n, p2, p1 );
+	d = (dReal)sqrt( Dot3(n, n) );
+	if ( d > 0 ) {
+		n[0] /= d; n[1] /= d; n[2] /= d;
+	} else {
+		n[0] = 0; n[1] = 0; n[2] = 1;
+	}
+
+	result->distance = d - r1 - r2;
+	AddScaled3( result->point1, p1, r1, n );
+	AddScaled3( result->point2, p2, -r2, n );
+}
+
+
+/*
+ * Set <tt>result</tt> to the point on the segment (<tt>a</tt>, <tt>b</tt>)
+ * closest to <tt>p</tt>.
+ */
+static void
+ode_distance_closest_on_segment( a, b, p, result )
+	 const dReal	*a, *b, *p;
+	 dVector3		result;
+{
+	dVector3	ab, ap;
+	dReal		t, len2;
+
+	Sub3( ab, b, a );
+	Sub3( ap, p, a );
+	len2 = Dot3( ab, ab );
+	t = len2 > 0 ? Dot3( ap, ab ) / len2 : 0;
+	if ( t < 0 ) t = 0;
+	if ( t > 1 ) t = 1;
+	AddScaled3( result, a, t, ab );
+}
+
+
+/*
+ * Set <tt>c1</tt> and <tt>c2</tt> to the closest points of the segments
+ * (<tt>p1</tt>, <tt>q1</tt>) and (<tt>p2</tt>, <tt>q2</tt>).
+ */
+static void
+ode_distance_segments( p1, q1, p2, q2, c1, c2 )
+	 const dReal	*p1, *q1, *p2, *q2;
+	 dVector3		c1, c2;
+{
+	dVector3	d1, d2, r;
+	dReal		a, e, f, b, c, denom, s = 0, t = 0;
+
+	Sub3( d1, q1, p1 );
+	Sub3( d2, q2, p2 );
+	Sub3( r, p1, p2 );
+	a = Dot3( d1, d1 );
+	e = Dot3( d2, d2 );
+	f = Dot3( d2, r );
+
+	if ( a <= 0 && e <= 0 ) {
+		s = t = 0;
+	} else if ( a <= 0 ) {
+		s = 0;
+		t = f / e;
+	} else {
+		c = Dot3( d1, r );
+		if ( e <= 0 ) {
+			t = 0;
+			s = -c / a;
+		} else {
+			b = Dot3( d1, d2 );
+			denom = a*e - b*b;
+			s = denom != 0 ? ( b*f - c*e ) / denom : 0;
+			if ( s < 0 ) s = 0;
+			if ( s > 1 ) s = 1;
+			t = ( b*s + f ) / e;
+			if ( t < 0 ) {
+				t = 0;
+				s = -c / a;
+			} else if ( t > 1 ) {
+				t = 1;
+				s = ( b - c ) / a;
+			}
+		}
+	}
+
+	if ( s < 0 ) s = 0;
+	if ( s > 1 ) s = 1;
+	if ( t < 0 ) t = 0;
+	if ( t > 1 ) t = 1;
+
+	AddScaled3( c1, p1, s, d1 );
+	AddScaled3( c2, p2, t, d2 );
+}
+
+
+/*
+ * Set <tt>a</tt> and <tt>b</tt> to the end points of a segment shape's core.
+ */
+static void
+ode_distance_segment_ends( shape, a, b )
+	 ode_SHAPE	*shape;
+	 dVector3	a, b;
+{
+	AddScaled3( a, shape->pos, -shape->halfLength, shape->axis );
+	AddScaled3( b, shape->pos, shape->halfLength, shape->axis );
+}
+
+
+/*
+ * Distance between a plane and any other shape: the other shape's support
+ * point against the plane's normal is its closest (or deepest) point.
+ */
+static void
+ode_distance_plane( plane, shape, result )
+	 ode_SHAPE		*plane, *shape;
+	 ode_DISTANCE	*result;
+{
+	dVector3	p, back;
+	dReal		d;
+
+	back[0] = -plane->plane[0];
+	back[1] = -plane->plane[1];
+	back[2] = -plane->plane[2];
+	ode_distance_support( shape, back, p );
+	AddScaled3( p, p, shape->radius, back );
+
+	d = Dot3( plane->plane, p ) - plane->plane[3];
+	result->distance = d;
+	AddScaled3( result->point1, p, -d, plane->plane );
+	Set3( result->point2, p );
+}
+
+
+/*
+ * Distance between a sphere (or the closest point of a capsule's core, with
+ * its radius) at <tt>center</tt> and a box.
+ */
+static void
+ode_distance_sphere_box( center, radius, box, result )
+	 const dReal	*center;
+	 dReal			radius;
+	 ode_SHAPE		*box;
+	 ode_DISTANCE	*result;
+{
+	const dReal	*rot = box->rot;
+	dVector3	rel, local, clamped, n;
+	dReal		depth, minDepth;
+	int			i, face = 0, inside = 1;
+
+	Sub3( rel, center, box->pos );
+	for ( i = 0; i < 3; i++ ) {
+		local[i] = rel[0]*rot[i] + rel[1]*rot[4+i] + rel[2]*rot[8+i];
+		clamped[i] = local[i];
+		if ( clamped[i] < -box->half[i] ) { clamped[i] = -box->half[i]; inside = 0; }
+		if ( clamped[i] > box->half[i] ) { clamped[i] = box->half[i]; inside = 0; }
+	}
+
+	/* The center's inside the box: push out through the nearest face */
+	if ( inside ) {
+		minDepth = box->half[0] - fabs( local[0] );
+		for ( i = 1; i < 3; i++ ) {
+			depth = box->half[i] - fabs( local[i] );
+			if ( depth < minDepth ) {
+				minDepth = depth;
+				face = i;
+			}
+		}
+		clamped[face] = local[face] >= 0 ? box->half[face] : -box->half[face];
+	}
+
+	for ( i = 0; i < 3; i++ )
+		result->point2[i] = box->pos[i] +
+			rot[i*4]*clamped[0] + rot[i*4+1]*clamped[1] + rot[i*4+2]*clamped[2];
+
+	if ( inside ) {
+		n[0] = rot[face]; n[1] = rot[4+face]; n[2] = rot[8+face];
+		if ( local[face] < 0 ) { n[0] = -n[0]; n[1] = -n[1]; n[2] = -n[2]; }
+		result->distance = -( minDepth + radius );
+		AddScaled3( result->point1, center, -radius, n );
+	} else {
+		ode_distance_rounded( center, radius, result->point2, 0, result );
+	}
+}
+
+
+
+/* --------------------------------------------------
+ * GJK
+ * -------------------------------------------------- */
+
+/*
+ * Reduce the <tt>count</tt> vertices of the simplex to the smallest subset
+ * whose hull contains the point closest to the origin, set <tt>v</tt> to that
+ * point and <tt>lambda</tt> to its barycentric weights, and return the new
+ * count (or 4 if the origin is inside the tetrahedron).
+ */
+static int
+ode_gjk_solve( simplex, count, lambda, v )
+	 ode_GJKVERTEX	*simplex;
+	 int			count;
+	 dReal			*lambda;
+	 dVector3		v;
+{
+	ode_GJKVERTEX	best[3], tri[3];
+	dReal			bestLambda[3], triLambda[3], bestDist = -1, dist;
+	dVector3		ab, ac, ap, bp, cp, n, triV;
+	dReal			d1, d2, d3, d4, d5, d6, va, vb, vc, denom, t, side, other;
+	int				i, j, k, bestCount = 0, triCount, faces[4][4] = {
+		{0,1,2,3}, {0,3,1,2}, {0,2,3,1}, {1,3,2,0}
+	};
+
+	switch ( count ) {
+	case 1:
+		lambda[0] = 1;
+		Set3( v, simplex[0].w );
+		return 1;
+
+	case 2:
+		Sub3( ab, simplex[1].w, simplex[0].w );
+		denom = Dot3( ab, ab );
+		t = denom > 0 ? -Dot3( simplex[0].w, ab ) / denom : 0;
+		if ( t <= 0 ) {
+			lambda[0] = 1;
+			Set3( v, simplex[0].w );
+			return 1;
+		}
+		if ( t >= 1 ) {
+			simplex[0] = simplex[1];
+			lambda[0] = 1;
+			Set3( v, simplex[0].w );
+			return 1;
+		}
+		lambda[0] = 1 - t;
+		lambda[1] = t;
+		AddScaled3( v, simplex[0].w, t, ab );
+		return 2;
+
+	case 3:
+		/* Closest point on a triangle to the origin, by Voronoi region */
+		Sub3( ab, simplex[1].w, simplex[0].w );
+		Sub3( ac, simplex[2].w, simplex[0].w );
+		ap[0] = -simplex[0].w[0]; ap[1] = -simplex[0].w[1]; ap[2] = -simplex[0].w[2];
+		d1 = Dot3( ab, ap ); d2 = Dot3( ac, ap );
+		if ( d1 <= 0 && d2 <= 0 ) return ode_gjk_solve( simplex, 1, lambda, v );
+
+		bp[0] = -simplex[1].w[0]; bp[1] = -simplex[1].w[1]; bp[2] = -simplex[1].w[2];
+		d3 = Dot3( ab, bp ); d4 = Dot3( ac, bp );
+		if ( d3 >= 0 && d4 <= d3 ) {
+			simplex[0] = simplex[1];
+			return ode_gjk_solve( simplex, 1, lambda, v );
+		}
+
+		vc = d1*d4 - d3*d2;
+		if ( vc <= 0 && d1 >= 0 && d3 <= 0 )
+			return ode_gjk_solve( simplex, 2, lambda, v );
+
+		cp[0] = -simplex[2].w[0]; cp[1] = -simplex[2].w[1]; cp[2] = -simplex[2].w[2];
+		d5 = Dot3( ab, cp ); d6 = Dot3( ac, cp );
+		if ( d6 >= 0 && d5 <= d6 ) {
+			simplex[0] = simplex[2];
+			return ode_gjk_solve( simplex, 1, lambda, v );
+		}
+
+		vb = d5*d2 - d1*d6;
+		if ( vb <= 0 && d2 >= 0 && d6 <= 0 ) {
+			simplex[1] = simplex[2];
+			return ode_gjk_solve( simplex, 2, lambda, v );
+		}
+
+		va = d3*d6 - d5*d4;
+		if ( va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0 ) {
+			simplex[0] = simplex[1];
+			simplex[1] = simplex[2];
+			return ode_gjk_solve( simplex, 2, lambda, v );
+		}
+
+		denom = 1 / ( va + vb + vc );
+		lambda[1] = vb * denom;
+		lambda[2] = vc * denom;
+		lambda[0] = 1 - lambda[1] - lambda[2];
+		for ( i = 0; i < 3; i++ )
+			v[i] = simplex[0].w[i] + ab[i]*lambda[1] + ac[i]*lambda[2];
+		return 3;
+
+	default:
+		/* Tetrahedron: the closest point is on a face the origin is outside
+		   of, or the origin is inside */
+		for ( i = 0; i < 4; i++ ) {
+			for ( j = 0; j < 3; j++ ) tri[j] = simplex[ faces[i][j] ];
+
+			Sub3( ab, tri[1].w, tri[0].w );
+			Sub3( ac, tri[2].w, tri[0].w );
+			n[0] = ab[1]*ac[2] - ab[2]*ac[1];
+			n[1] = ab[2]*ac[0] - ab[0]*ac[2];
+			n[2] = ab[0]*ac[1] - ab[1]*ac[0];
+			side = -Dot3( n, tri[0].w );
+			Sub3( ap, simplex[faces[i][3]].w, tri[0].w );
+			other = Dot3( n, ap );
+			if ( side * other > 0 ) continue;
+
+			triCount = ode_gjk_solve( tri, 3, triLambda, triV );
+			dist = Dot3( triV, triV );
+			if ( bestDist < 0 || dist < bestDist ) {
+				bestDist = dist;
+				bestCount = triCount;
+				Set3( v, triV );
+				for ( k = 0; k < triCount; k++ ) {
+					best[k] = tri[k];
+					bestLambda[k] = triLambda[k];
+				}
+			}
+		}
+
+		if ( bestDist < 0 ) return 4;
+
+		for ( k = 0; k < bestCount; k++ ) {
+			simplex[k] = best[k];
+			lambda[k] = bestLambda[k];
+		}
+		return bestCount;
+	}
+}
+
+
+/*
+ * Find the distance between the cores of two convex shapes and their
+ * closest points with GJK. Returns 0 if the cores intersect.
+ */
+static int
+ode_gjk_distance( shape1, shape2, result )
+	 ode_SHAPE		*shape1, *shape2;
+	 ode_DISTANCE	*result;
+{
+	ode_GJKVERTEX	simplex[4];
+	dReal			lambda[4], vv, vw;
+	dVector3		v, dir;
+	int				count = 1, i, iter;
+
+	Sub3( dir, shape2->pos, shape1->pos );
+	ode_distance_support( shape1, dir, simplex[0].a );
+	dir[0] = -dir[0]; dir[1] = -dir[1]; dir[2] = -dir[2];
+	ode_distance_support( shape2, dir, simplex[0].b );
+	Sub3( simplex[0].w, simplex[0].a, simplex[0].b );
+	lambda[0] = 1;
+	Set3( v, simplex[0].w );
+
+	for ( iter = 0; iter < ODE_GJK_MAX_ITERATIONS; iter++ ) {
+		vv = Dot3( v, v );
+		if ( vv < ODE_GJK_TOLERANCE * ODE_GJK_TOLERANCE ) return 0;
+
+		/* Support of the Minkowski difference against v */
+		dir[0] = -v[0]; dir[1] = -v[1]; dir[2] = -v[2];
+		ode_distance_support( shape1, dir, simplex[count].a );
+		ode_distance_support( shape2, v, simplex[count].b );
+		Sub3( simplex[count].w, simplex[count].a, simplex[count].b );
+
+		vw = Dot3( v, simplex[count].w );
+		if ( vv - vw <= ODE_GJK_TOLERANCE * vv ) break;
+
+		count = ode_gjk_solve( simplex, count + 1, lambda, v );
+		if ( count == 4 ) return 0;
+	}
+
+	MEMZERO( result->point1, dReal, 3 );
+	MEMZERO( result->point2, dReal, 3 );
+	for ( i = 0; i < count; i++ ) {
+		AddScaled3( result->point1, result->point1, lambda[i], simplex[i].a );
+		AddScaled3( result->point2, result->point2, lambda[i], simplex[i].b );
+	}
+	result->distance = (dReal)sqrt( Dot3(v, v) );
+
+	return 1;
+}
+
+
+
+/* --------------------------------------------------
+ * Queries
+ * -------------------------------------------------- */
+
+/*
+ * Measure how deeply two overlapping geometries penetrate with their
+ * deepest contact. Both points are set to the contact's position.
+ */
+static void
+ode_distance_penetration( geom1, geom2, result )
+	 ode_GEOMETRY	*geom1, *geom2;
+	 ode_DISTANCE	*result;
+{
+	dContactGeom	contacts[ ODE_DISTANCE_MAX_CONTACTS ];
+	int				count, i, deepest = 0;
+
+	count = dCollide( geom1->id, geom2->id, ODE_DISTANCE_MAX_CONTACTS,
+					  contacts, sizeof(dContactGeom) );
+	if ( !count ) {
+		result->distance = 0;
+		return;
+	}
+
+	for ( i = 1; i < count; i++ )
+		if ( contacts[i].depth > contacts[deepest].depth ) deepest = i;
+
+	result->distance = -contacts[deepest].depth;
+	Set3( result->point1, contacts[deepest].pos );
+	Set3( result->point2, contacts[deepest].pos );
+}
+
+
+/*
+ * Fill in the distance between <tt>geom1</tt> and <tt>geom2</tt> and their
+ * closest points (negative when they overlap, with the deepest points),
+ * using an analytic test for pairs of spheres, capsules, boxes and planes
+ * where there is one, and GJK otherwise.
+ */
+static void
+ode_distance_query( geom1, geom2, result )
+	 ode_GEOMETRY	*geom1, *geom2;
+	 ode_DISTANCE	*result;
+{
+	ode_SHAPE		shape1, shape2, *s1 = &shape1, *s2 = &shape2, *tmp;
+	dVector3		a1, b1, a2, b2, c1, c2;
+	int				swapped = 0;
+
+	ode_distance_get_shape( geom1, s1 );
+	ode_distance_get_shape( geom2, s2 );
+
+	/* Put the simpler shape first */
+	if ( s1->kind > s2->kind ) {
+		tmp = s1; s1 = s2; s2 = tmp;
+		swapped = 1;
+	}
+
+	if ( s1->kind == ODE_SHAPE_PLANE )
+		rb_raise( ode_eOdeGeometryError, "can't measure the distance between two planes" );
+
+	if ( s2->kind == ODE_SHAPE_PLANE ) {
+		ode_distance_plane( s2, s1, result );
+		swapped = !swapped;
+	}
+	else if ( s1->kind == ODE_SHAPE_POINT && s2->kind == ODE_SHAPE_POINT ) {
+		ode_distance_rounded( s1->pos, s1->radius, s2->pos, s2->radius, result );
+	}
+	else if ( s1->kind == ODE_SHAPE_POINT && s2->kind == ODE_SHAPE_SEGMENT ) {
+		ode_distance_segment_ends( s2, a2, b2 );
+		ode_distance_closest_on_segment( a2, b2, s1->pos, c2 );
+		ode_distance_rounded( s1->pos, s1->radius, c2, s2->radius, result );
+	}
+	else if ( s1->kind == ODE_SHAPE_SEGMENT && s2->kind == ODE_SHAPE_SEGMENT ) {
+		ode_distance_segment_ends( s1, a1, b1 );
+		ode_distance_segment_ends( s2, a2, b2 );
+		ode_distance_segments( a1, b1, a2, b2, c1, c2 );
+		ode_distance_rounded( c1, s1->radius, c2, s2->radius, result );
+	}
+	else if ( s1->kind == ODE_SHAPE_POINT && s2->kind == ODE_SHAPE_BOX ) {
+		ode_distance_sphere_box( s1->pos, s1->radius, s2, result );
+	}
+	else if ( ode_gjk_distance(s1, s2, result) ) {
+		Set3( c1, result->point1 );
+		Set3( c2, result->point2 );
+		ode_distance_rounded( c1, s1->radius, c2, s2->radius, result );
+	}
+	else {
+		ode_distance_penetration( geom1, geom2, result );
+		return;
+	}
+
+	if ( swapped ) {
+		Set3( c1, result->point1 );
+		Set3( result->point1, result->point2 );
+		Set3( result->point2, c1 );
+	}
+}
+
+
+/*
+ * Convert a query result to a Ruby Array.
+ */
+static VALUE
+ode_distance_to_ary( result )
+	 ode_DISTANCE	*result;
+{
+	return rb_ary_new3( 3,
+						rb_float_new(result->distance),
+						ode_vector3_to_rArray(result->point1),
+						ode_vector3_to_rArray(result->point2) );
+}
+
+
+
+/* --------------------------------------------------
+ * Instance Methods
+ * -------------------------------------------------- */
+
+/*
+ * ODE::Geometry#distanceTo( otherGeometry )
+ * --
+ * Returns the separation between the receiving geometry and
+ * <tt>otherGeometry</tt> as an Array of the form:
+ *
+ *   [ distance, closestPointOnReceiver, closestPointOnOther ]
+ *
+ * If they overlap, the distance is negative: the depth of the penetration,
+ * with the deepest points. Spheres, capsules, boxes, planes, and convex hulls
+ * are supported: pairs of spheres, capsules and boxes and anything against a
+ * plane are measured analytically, and the rest with the GJK algorithm.
+ */
+static VALUE
+ode_geometry_distance_to( self, other )
+	 VALUE self, other;
+{
+	ode_DISTANCE	result;
+
+	ode_distance_query( ode_get_geom(self), ode_get_geom(other), &result );
+	return ode_distance_to_ary( &result );
+}
+
+
+/*
+ * ODE::Geometry#distancesTo( geometries )
+ * --
+ * Returns the result of #distanceTo for each of the given
+ * <tt>geometries</tt>, in the same order.
+ */
+static VALUE
+ode_geometry_distances_to( self, geometries )
+	 VALUE self, geometries;
+{
+	ode_GEOMETRY	*geom = ode_get_geom( self );
+	ode_DISTANCE	result;
+	VALUE			ary;
+	long			i;
+
+	Check_Type( geometries, T_ARRAY );
+	ary = rb_ary_new2( RARRAY(geometries)->len );
+
+	for ( i = 0; i < RARRAY(geometries)->len; i++ ) {
+		ode_distance_query( geom, ode_get_geom(RARRAY(geometries)->ptr[i]), &result );
+		rb_ary_push( ary, ode_distance_to_ary(&result) );
+	}
+
+	return ary;
+}
+
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_distance()
+{
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeGeometry = rb_define_class_under( ode_mOde, "Geometry", rb_cObject );
+#endif
+
+	rb_define_method( ode_cOdeGeometry, "distanceTo", ode_geometry_distance_to, 1 );
+	rb_define_alias ( ode_cOdeGeometry, "distance_to", "distanceTo" );
+	rb_define_method( ode_cOdeGeometry, "distancesTo", ode_geometry_distances_to, 1 );
+	rb_define_alias ( ode_cOdeGeometry, "distances_to", "distancesTo" );
+}
+
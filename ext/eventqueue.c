@@ -0,0 +1,126 @@
+/*
+ *		eventqueue.c - ODE Ruby Binding - Ring buffer of physics events
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 17:12:40 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+
+/* --------------------------------------------------
+ * Memory-management functions
+ * -------------------------------------------------- */
+
+/*
+ * Create a new, empty event queue which holds at most <tt>capacity</tt>
+ * events.
+ */
+ode_EVENTQUEUE *
+ode_eventqueue_new( capacity )
+	 long capacity;
+{
+	ode_EVENTQUEUE *queue = ALLOC( ode_EVENTQUEUE );
+
+	queue->capacity	= capacity;
+	queue->events	= ALLOC_N( ode_EVENT, capacity );
+	queue->head		= 0;
+	queue->count	= 0;
+	queue->dropped	= 0;
+
+	debugMsg(( "Created event queue <%p> for %ld events", queue, capacity ));
+	return queue;
+}
+
+
+/*
+ * Free the given event queue.
+ */
+void
+ode_eventqueue_free( queue )
+	 ode_EVENTQUEUE *queue;
+{
+	debugMsg(( "Freeing event queue <%p>", queue ));
+
+	xfree( queue->events );
+	xfree( queue );
+}
+
+
+
+/* --------------------------------------------------
+ * Queue functions
+ * -------------------------------------------------- */
+
+/*
+ * Append an event of the given <tt>type</tt> to the queue and return it so
+ * its payload can be filled in. If the queue is full, the oldest event is
+ * overwritten and counted as dropped.
+ */
+ode_EVENT *
+ode_eventqueue_push( queue, type, tick, index1, index2 )
+	 ode_EVENTQUEUE	*queue;
+	 int			type;
+	 unsigned long	tick, index1, index2;
+{
+	ode_EVENT	*event;
+
+	if ( queue->count == queue->capacity ) {
+		queue->head = ( queue->head + 1 ) % queue->capacity;
+		queue->count--;
+		queue->dropped++;
+	}
+
+	event = queue->events + ( (queue->head + queue->count) % queue->capacity );
+	queue->count++;
+
+	event->type		= (unsigned int)type;
+	event->tick		= (unsigned int)tick;
+	event->index1	= (unsigned int)index1;
+	event->index2	= (unsigned int)index2;
+	event->payload[0] = event->payload[1] = event->payload[2] = event->payload[3] = 0;
+
+	return event;
+}
+
+
+/*
+ * Copy the queued events into the String <tt>buffer</tt> (replacing its
+ * contents), oldest first, and empty the queue. Returns the buffer.
+ */
+VALUE
+ode_eventqueue_drain( queue, buffer )
+	 ode_EVENTQUEUE	*queue;
+	 VALUE			buffer;
+{
+	long	first = queue->count;
+	char	*ptr;
+
+	rb_str_modify( buffer );
+	rb_str_resize( buffer, queue->count * sizeof(ode_EVENT) );
+	ptr = RSTRING(buffer)->ptr;
+
+	/* The events may wrap around the end of the ring */
+	if ( queue->head + first > queue->capacity )
+		first = queue->capacity - queue->head;
+
+	MEMCPY( ptr, queue->events + queue->head, ode_EVENT, first );
+	MEMCPY( ptr + first * sizeof(ode_EVENT), queue->events, ode_EVENT,
+			queue->count - first );
+
+	queue->head = 0;
+	queue->count = 0;
+
+	return buffer;
+}
+
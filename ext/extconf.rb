@@ -107,10 +107,52 @@ if have_library_no_append( "ode", "dCreateCylinder")
 	$CFLAGS << " -DHAVE_CYLINDER_GEOM"
 end
 
+if have_library_no_append( "ode", "dCreateTriMesh" )
+	puts "  Enabling TriMesh geometry class"
+	$CFLAGS << " -DHAVE_TRIMESH_GEOM"
+end
+
+if have_library_no_append( "ode", "dCreateHeightfield" )
+	puts "  Enabling Heightfield geometry class"
+	$CFLAGS << " -DHAVE_HEIGHTFIELD_GEOM"
+end
+
+if have_library_no_append( "ode", "dCreateConvex" )
+	puts "  Enabling Convex geometry class"
+	$CFLAGS << " -DHAVE_CONVEX_GEOM"
+end
+
+# Without closest-hit rays, a ray cast against a TriMesh returns whichever
+# triangle it finds first
+if have_library_no_append( "ode", "dGeomRaySetClosestHit" )
+	$CFLAGS << " -DHAVE_DGEOMRAYSETCLOSESTHIT"
+end
+
+# Newer ODEs need to be initialized, and to have collider data allocated for
+# each thread which calls into them
+if have_library_no_append( "ode", "dInitODE2" )
+	$CFLAGS << " -DHAVE_DINITODE2"
+end
+
+# Narrowphase collision across a thread pool needs ODE's per-thread collider
+# data as well as pthreads
+if have_header( "pthread.h" ) && have_library( "pthread", "pthread_create" ) &&
+		have_library_no_append( "ode", "dAllocateODEDataForThread" )
+	puts "  Enabling threaded narrowphase collision"
+	$CFLAGS << " -DHAVE_THREADED_COLLISION"
+end
+
+# Memory-mapped TriMeshData
+have_header( "sys/mman.h" )
+
 puts "  Ruby 1.8.x allocation framework"
 $CFLAGS << " -DNEW_ALLOC"
 	
 
+# Install the public header alongside the extension for other C extensions
+# that hook into it
+$INSTALLFILES = [ ["rubyode.h", "$(RUBYARCHDIR)"] ]
+
 # Write the Makefile
 create_makefile( "ode" )
 
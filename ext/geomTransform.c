@@ -0,0 +1,722 @@
+/*
+ *		geomTransform.c - ODE Ruby Binding - ODE::Geometry::Transform and
+ *						  ODE::Geometry::Compound classes
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 19:02:51 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+#include <math.h>
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* The contact count part of dCollide()'s flags */
+#define ODE_COMPOUND_NUMC_MASK		0xffff
+
+/* A child shape of a compound, and its pose in the compound's frame */
+typedef struct {
+	ode_GEOMETRY	*geom;
+	dVector3		pos;
+	dMatrix3		rot;
+	dReal			density;
+} ode_COMPOUNDCHILD;
+
+/* The class data ODE keeps with each compound's dGeomID: its children, and
+   the bounds of all of them in the compound's frame */
+typedef struct {
+	ode_COMPOUNDCHILD	*children;
+	long				count, capacity;
+	dReal				bounds[6];
+} ode_COMPOUND;
+
+/* The geometry class number ODE assigned to compounds */
+static int ode_compound_class = -1;
+
+
+/* --------------------------------------------------
+ * Utility functions
+ * -------------------------------------------------- */
+
+/*
+ * Check that the given <tt>child</tt> can be put into the Transform or
+ * Compound <tt>self</tt>: it must be a placeable geometry that isn't already
+ * in a space (or another Transform or Compound), isn't attached to a body,
+ * and isn't <tt>self</tt> or any Transform or Compound <tt>self</tt> is
+ * inside of, since the loop that would make can't be collided or measured.
+ */
+static ode_GEOMETRY *
+ode_geomtransform_check_child( self, child )
+	 VALUE self, child;
+{
+	ode_GEOMETRY	*ptr;
+	VALUE			container;
+
+	CheckKindOf( child, ode_cOdePlaceable );
+	ptr = ode_get_geom( child );
+
+	for ( container = self; RTEST(container) && !IsSpace(container);
+		  container = ode_get_geom(container)->container )
+		if ( container == child )
+			rb_raise( ode_eOdeGeometryError,
+					  "can't put a geometry inside itself" );
+
+	if ( RTEST(ptr->container) )
+		rb_raise( ode_eOdeGeometryError,
+				  "geometry is already in a space, transform, or compound" );
+	if ( dGeomGetBody(ptr->id) )
+		rb_raise( ode_eOdeGeometryError, "geometry is attached to a body" );
+
+	return ptr;
+}
+
+
+
+/* --------------------------------------------------
+ * Compound geometry class functions
+ * -------------------------------------------------- */
+
+/*
+ * Return the class data of the given compound geometry.
+ */
+static ode_COMPOUND *
+ode_compound_data( id )
+	 dGeomID id;
+{
+	return (ode_COMPOUND *)dGeomGetClassData( id );
+}
+
+
+/*
+ * Move the compound's children to their world poses, and bring their AABBs
+ * up to date with them.
+ */
+static void
+ode_compound_place_children( id )
+	 dGeomID id;
+{
+	ode_COMPOUND		*compound = ode_compound_data( id );
+	ode_COMPOUNDCHILD	*child;
+	const dReal			*pos = dGeomGetPosition( id ), *rot = dGeomGetRotation( id );
+	dMatrix3			R;
+	dReal				aabb[6];
+	long				n;
+	int					i, j;
+
+	for ( n = 0; n < compound->count; n++ ) {
+		child = compound->children + n;
+
+		MEMZERO( R, dReal, 12 );
+		for ( i = 0; i < 3; i++ )
+			for ( j = 0; j < 3; j++ )
+				R[i*4+j] = rot[i*4]*child->rot[j] + rot[i*4+1]*child->rot[4+j] +
+					rot[i*4+2]*child->rot[8+j];
+
+		dGeomSetRotation( child->geom->id, R );
+		dGeomSetPosition( child->geom->id,
+						  pos[0] + rot[0]*child->pos[0] + rot[1]*child->pos[1] + rot[2]*child->pos[2],
+						  pos[1] + rot[4]*child->pos[0] + rot[5]*child->pos[1] + rot[6]*child->pos[2],
+						  pos[2] + rot[8]*child->pos[0] + rot[9]*child->pos[1] + rot[10]*child->pos[2] );
+		dGeomGetAABB( child->geom->id, aabb );
+	}
+}
+
+
+/*
+ * Recompute the bounds of the compound's children in its own frame, and
+ * tell ODE the compound's AABB needs recomputing.
+ */
+static void
+ode_compound_update_bounds( id )
+	 dGeomID id;
+{
+	ode_COMPOUND		*compound = ode_compound_data( id );
+	ode_COMPOUNDCHILD	*child;
+	const dReal			*pos = dGeomGetPosition( id );
+	dReal				aabb[6];
+	long				n;
+	int					i;
+
+	MEMZERO( compound->bounds, dReal, 6 );
+
+	for ( n = 0; n < compound->count; n++ ) {
+		child = compound->children + n;
+		dGeomSetRotation( child->geom->id, child->rot );
+		dGeomSetPosition( child->geom->id, child->pos[0], child->pos[1], child->pos[2] );
+		dGeomGetAABB( child->geom->id, aabb );
+
+		for ( i = 0; i < 6; i += 2 ) {
+			if ( n == 0 || aabb[i] < compound->bounds[i] )
+				compound->bounds[i] = aabb[i];
+			if ( n == 0 || aabb[i+1] > compound->bounds[i+1] )
+				compound->bounds[i+1] = aabb[i+1];
+		}
+	}
+
+	dGeomSetPosition( id, pos[0], pos[1], pos[2] );
+}
+
+
+/*
+ * dGetAABBFn for compounds: the cached bounds, rotated into the world. ODE
+ * only calls this when the compound has moved, and does so from the
+ * broadphase before any pairs are collided, so it's also where the children
+ * are moved along with it; the collider then only reads their poses, and can
+ * run for several pairs at once.
+ */
+static void
+ode_compound_aabb( id, aabb )
+	 dGeomID	id;
+	 dReal		aabb[6];
+{
+	ode_COMPOUND	*compound = ode_compound_data( id );
+	const dReal		*pos = dGeomGetPosition( id ), *rot = dGeomGetRotation( id );
+	dReal			center[3], half[3], c, h;
+	int				i, j;
+
+	ode_compound_place_children( id );
+
+	for ( j = 0; j < 3; j++ ) {
+		center[j] = ( compound->bounds[j*2] + compound->bounds[j*2+1] ) / 2;
+		half[j] = ( compound->bounds[j*2+1] - compound->bounds[j*2] ) / 2;
+	}
+
+	for ( i = 0; i < 3; i++ ) {
+		c = pos[i];
+		h = 0;
+		for ( j = 0; j < 3; j++ ) {
+			c += rot[i*4+j] * center[j];
+			h += fabs( rot[i*4+j] ) * half[j];
+		}
+		aabb[i*2] = c - h;
+		aabb[i*2+1] = c + h;
+	}
+}
+
+
+/*
+ * dColliderFn for compounds: collide each child with the other geometry,
+ * reporting the contacts as the compound's. Fetching the compound's AABB
+ * places the children first if it's moved since it was last computed, which
+ * only happens when it's collided directly rather than through a space.
+ */
+static int
+ode_compound_collide( o1, o2, flags, contacts, skip )
+	 dGeomID		o1, o2;
+	 int			flags, skip;
+	 dContactGeom	*contacts;
+{
+	ode_COMPOUND	*compound = ode_compound_data( o1 );
+	dContactGeom	*contact;
+	dReal			aabb[6];
+	int				max = flags & ODE_COMPOUND_NUMC_MASK, count = 0, found, i;
+	long			n;
+
+	dGeomGetAABB( o1, aabb );
+
+	for ( n = 0; n < compound->count && count < max; n++ ) {
+		contact = (dContactGeom *)( (char *)contacts + count * skip );
+		found = dCollide( compound->children[n].geom->id, o2,
+						  (flags & ~ODE_COMPOUND_NUMC_MASK) | (max - count),
+						  contact, skip );
+
+		for ( i = 0; i < found; i++ )
+			((dContactGeom *)( (char *)contact + i * skip ))->g1 = o1;
+		count += found;
+	}
+
+	return count;
+}
+
+
+/*
+ * dGetColliderFnFn for compounds: the same collider for every class.
+ */
+static dColliderFn *
+ode_compound_get_collider( num )
+	 int num;
+{
+	return ode_compound_collide;
+}
+
+
+/*
+ * dGeomDtorFn for compounds.
+ */
+static void
+ode_compound_dtor( id )
+	 dGeomID id;
+{
+	ode_COMPOUND	*compound = ode_compound_data( id );
+
+	debugMsg(( "Freeing compound children for <%p>", id ));
+	if ( compound->children ) xfree( compound->children );
+	compound->children = NULL;
+}
+
+
+/*
+ * Set <tt>mass</tt> to the combined mass of the compound's children, each
+ * filled with its density, in the compound's frame. Children with no volume
+ * (rays, meshes, and the like) don't contribute.
+ */
+static void
+ode_compound_mass( id, mass )
+	 dGeomID	id;
+	 dMass		*mass;
+{
+	ode_COMPOUND		*compound = ode_compound_data( id );
+	ode_COMPOUNDCHILD	*child;
+	dMass				part;
+	dVector3			lengths;
+	dReal				radius, length;
+	long				n;
+#ifdef HAVE_CONVEX_GEOM
+	VALUE				args[2];
+#endif
+
+	dMassSetZero( mass );
+
+	for ( n = 0; n < compound->count; n++ ) {
+		child = compound->children + n;
+		dMassSetZero( &part );
+
+		switch ( dGeomGetClass(child->geom->id) ) {
+		case dSphereClass:
+			dMassSetSphere( &part, child->density, dGeomSphereGetRadius(child->geom->id) );
+			break;
+
+		case dBoxClass:
+			dGeomBoxGetLengths( child->geom->id, lengths );
+			dMassSetBox( &part, child->density, lengths[0], lengths[1], lengths[2] );
+			break;
+
+		case dCCylinderClass:
+			dGeomCCylinderGetParams( child->geom->id, &radius, &length );
+			dMassSetCapsule( &part, child->density, 3, radius, length );
+			break;
+
+#ifdef HAVE_CONVEX_GEOM
+		case dConvexClass:
+			args[0] = rb_float_new( child->density );
+			args[1] = rb_iv_get( child->geom->object, "@data" );
+			part = *( ode_get_mass(rb_class_new_instance(2, args, ode_cOdeMassConvex))->massptr );
+			break;
+#endif
+
+		default:
+			if ( dGeomGetClass(child->geom->id) == ode_compound_class )
+				ode_compound_mass( child->geom->id, &part );
+		}
+
+		if ( part.mass <= 0 ) continue;
+
+		dMassRotate( &part, child->rot );
+		dMassTranslate( &part, child->pos[0], child->pos[1], child->pos[2] );
+		if ( mass->mass > 0 )
+			dMassAdd( mass, &part );
+		else
+			*mass = part;
+	}
+}
+
+
+
+/* --------------------------------------------------
+ *	Instance Methods
+ * -------------------------------------------------- */
+
+/* --- ODE::Geometry::Transform ------------------------------ */
+
+/*
+ * ODE::Geometry::Transform::new( geometry=nil, space=nil )
+ * --
+ * Create a new geometry transform, inserting it into the specified space, if
+ * given. A transform encapsulates one other placeable geometry (see
+ * #geometry=), whose position and rotation are then taken to be relative to
+ * the transform's. Several transforms attached to the same body make a
+ * rigid shape with offset parts. Contacts with the encapsulated geometry are
+ * reported as the transform's.
+ */
+static VALUE
+ode_geometry_transform_init( argc, argv, self )
+	 int		argc;
+	 VALUE		*argv, self;
+{
+	VALUE			child, spaceObj;
+	dSpaceID		space = 0;
+	ode_GEOMETRY	*geometry = 0;
+
+	debugMsg(( "Calling super()" ));
+	rb_call_super( 0, 0 );
+	debugMsg(( "Back from super()" ));
+
+	geometry = ode_get_geom( self );
+	if ( !geometry ) rb_bug( "Superclass's initialize didn't return a valid Geometry." );
+
+	if ( rb_scan_args(argc, argv, "02", &child, &spaceObj) == 2 ) {
+		SetContainer( spaceObj, space, geometry );
+	}
+
+	debugMsg(( "Creating new Transform geometry." ));
+	geometry->id = dCreateGeomTransform( space );
+	dGeomTransformSetCleanup( geometry->id, 0 );
+	dGeomTransformSetInfo( geometry->id, 1 );
+	dGeomSetData( geometry->id, geometry );
+
+	rb_iv_set( self, "@geometry", Qnil );
+	if ( RTEST(child) )
+		rb_funcall( self, rb_intern("geometry="), 1, child );
+
+	return self;
+}
+
+
+/*
+ * ODE::Geometry::Transform#geometry
+ * --
+ * Returns the geometry encapsulated by the transform, or <tt>nil</tt> if it
+ * doesn't have one.
+ */
+static VALUE
+ode_geometry_transform_geometry( self )
+	 VALUE self;
+{
+	return rb_iv_get( self, "@geometry" );
+}
+
+
+/*
+ * ODE::Geometry::Transform#geometry=( geometry )
+ * --
+ * Set the geometry encapsulated by the transform, replacing any it already
+ * had, or remove it if <tt>geometry</tt> is <tt>nil</tt>. The geometry must
+ * be placeable, not in a space, and not attached to a body; its #container
+ * becomes the transform.
+ */
+static VALUE
+ode_geometry_transform_geometry_eq( self, child )
+	 VALUE self, child;
+{
+	ode_GEOMETRY	*geometry = ode_get_geom( self ), *childPtr = NULL;
+	VALUE			old = rb_iv_get( self, "@geometry" );
+
+	if ( RTEST(child) && child != old )
+		childPtr = ode_geomtransform_check_child( self, child );
+
+	if ( RTEST(old) )
+		ode_get_geom( old )->container = Qnil;
+
+	if ( childPtr ) {
+		dGeomTransformSetGeom( geometry->id, childPtr->id );
+		childPtr->container = self;
+	} else if ( !RTEST(child) ) {
+		dGeomTransformSetGeom( geometry->id, 0 );
+	} else {
+		ode_get_geom( child )->container = self;
+	}
+
+	rb_iv_set( self, "@geometry", child );
+	return child;
+}
+
+
+
+/* --- ODE::Geometry::Compound ------------------------------ */
+
+/*
+ * ODE::Geometry::Compound::new( space=nil )
+ * --
+ * Create a new, empty compound geometry, inserting it into the specified
+ * space, if given. A compound is a single rigid shape made of any number of
+ * placeable child geometries, each at a fixed pose relative to the compound
+ * (see #add). It takes one slot in its space, with an AABB computed from the
+ * bounds of its children (which are only recalculated when they change), and
+ * contacts with any of its children are reported as its own. The children
+ * are moved along with the compound when its AABB is next computed, which
+ * happens at the start of the next collision pass after it moves. Attaching a
+ * compound to a body gives the body the combined mass of the children (see
+ * #body=).
+ */
+static VALUE
+ode_geometry_compound_init( argc, argv, self )
+	 int		argc;
+	 VALUE		*argv, self;
+{
+	VALUE			spaceObj;
+	ode_GEOMETRY	*geometry = 0;
+	ode_COMPOUND	*compound;
+
+	debugMsg(( "Calling super()" ));
+	rb_call_super( 0, 0 );
+	debugMsg(( "Back from super()" ));
+
+	geometry = ode_get_geom( self );
+	if ( !geometry ) rb_bug( "Superclass's initialize didn't return a valid Geometry." );
+
+	rb_scan_args( argc, argv, "01", &spaceObj );
+
+	debugMsg(( "Creating new Compound geometry." ));
+	geometry->id = dCreateGeom( ode_compound_class );
+	compound = ode_compound_data( geometry->id );
+	compound->children = NULL;
+	compound->count = compound->capacity = 0;
+	MEMZERO( compound->bounds, dReal, 6 );
+
+	dGeomSetData( geometry->id, geometry );
+	rb_iv_set( self, "@geometries", rb_ary_new() );
+
+	if ( RTEST(spaceObj) ) {
+		dSpaceAdd( (dSpaceID)ode_get_space(spaceObj)->id, geometry->id );
+		geometry->container = spaceObj;
+	}
+
+	return self;
+}
+
+
+/*
+ * ODE::Geometry::Compound#add( geometry, position=[0,0,0], rotation=nil, density=1.0 )
+ * --
+ * Add the given placeable <tt>geometry</tt> to the compound at the specified
+ * <tt>position</tt> and <tt>rotation</tt> (an ODE::Quaternion) relative to
+ * the compound's, filled with material of the given <tt>density</tt> for
+ * working out the compound's mass. The geometry must not be in a space or
+ * attached to a body; its #container becomes the compound. Returns the
+ * compound.
+ */
+static VALUE
+ode_geometry_compound_add( argc, argv, self )
+	 int		argc;
+	 VALUE		*argv, self;
+{
+	ode_GEOMETRY		*geometry = ode_get_geom( self ), *childPtr;
+	ode_COMPOUND		*compound = ode_compound_data( geometry->id );
+	ode_COMPOUNDCHILD	*child;
+	VALUE				childObj, position, rotation, density, ary;
+	dQuaternion			quat;
+	int					i;
+
+	rb_scan_args( argc, argv, "13", &childObj, &position, &rotation, &density );
+	childPtr = ode_geomtransform_check_child( self, childObj );
+	if ( RTEST(density) )
+		CheckPositiveNonZeroNumber( NUM2DBL(density), "density" );
+
+	if ( compound->count == compound->capacity ) {
+		compound->capacity = compound->capacity ? compound->capacity * 2 : 4;
+		REALLOC_N( compound->children, ode_COMPOUNDCHILD, compound->capacity );
+	}
+	child = compound->children + compound->count;
+
+	child->geom = childPtr;
+	child->density = RTEST( density ) ? (dReal)NUM2DBL( density ) : 1.0;
+
+	if ( RTEST(position) ) {
+		ary = ode_obj_to_ary3( position, "position" );
+		SetVec3FromArray( child->pos, ary );
+	} else {
+		MEMZERO( child->pos, dReal, 3 );
+	}
+
+	if ( RTEST(rotation) ) {
+		ary = ode_obj_to_ary4( rotation, "rotation" );
+		for ( i = 0; i < 4; i++ )
+			quat[i] = (dReal)NUM2DBL( *(RARRAY(ary)->ptr + i) );
+		dQtoR( quat, child->rot );
+	} else {
+		dRSetIdentity( child->rot );
+	}
+
+	compound->count++;
+	childPtr->container = self;
+	rb_ary_push( rb_iv_get(self, "@geometries"), childObj );
+
+	ode_compound_update_bounds( geometry->id );
+	return self;
+}
+
+
+/*
+ * ODE::Geometry::Compound#remove( geometry )
+ * --
+ * Remove the given <tt>geometry</tt> from the compound. Returns the geometry,
+ * or <tt>nil</tt> if it wasn't one of the compound's children.
+ */
+static VALUE
+ode_geometry_compound_remove( self, childObj )
+	 VALUE self, childObj;
+{
+	ode_GEOMETRY		*geometry = ode_get_geom( self ), *childPtr;
+	ode_COMPOUND		*compound = ode_compound_data( geometry->id );
+	long				n;
+
+	childPtr = ode_get_geom( childObj );
+	for ( n = 0; n < compound->count; n++ ) {
+		if ( compound->children[n].geom != childPtr ) continue;
+
+		MEMMOVE( compound->children + n, compound->children + n + 1,
+				 ode_COMPOUNDCHILD, compound->count - n - 1 );
+		compound->count--;
+
+		childPtr->container = Qnil;
+		rb_ary_delete( rb_iv_get(self, "@geometries"), childObj );
+		ode_compound_update_bounds( geometry->id );
+
+		return childObj;
+	}
+
+	return Qnil;
+}
+
+
+/*
+ * ODE::Geometry::Compound#geometries
+ * --
+ * Returns an Array of the compound's child geometries, in the order they
+ * were added.
+ */
+static VALUE
+ode_geometry_compound_geometries( self )
+	 VALUE self;
+{
+	return rb_ary_dup( rb_iv_get(self, "@geometries") );
+}
+
+
+/*
+ * ODE::Geometry::Compound#mass
+ * --
+ * Returns a new ODE::Mass with the combined mass of the compound's
+ * children in the compound's frame, each filled with the density it was
+ * added with. Spheres, boxes, capsules, convex hulls and nested compounds
+ * have mass; other children don't contribute.
+ */
+static VALUE
+ode_geometry_compound_mass_get( self )
+	 VALUE self;
+{
+	ode_GEOMETRY	*geometry = ode_get_geom( self );
+	VALUE			massObj = rb_class_new_instance( 0, 0, ode_cOdeMass );
+
+	ode_compound_mass( geometry->id, ode_get_mass(massObj)->massptr );
+	return massObj;
+}
+
+
+/*
+ * ODE::Geometry::Compound#body=( body )
+ * --
+ * Attach the compound to the given <tt>body</tt> (or detach it if
+ * <tt>body</tt> is <tt>nil</tt>), and set the body's mass to the compound's
+ * (see #mass). Since ODE wants a body's center of mass at its origin, if the
+ * compound's isn't, the children are shifted to center them on it and the
+ * body is moved by the same amount, so nothing moves in the world.
+ */
+static VALUE
+ode_geometry_compound_body_eq( self, body )
+	 VALUE self, body;
+{
+	ode_GEOMETRY	*geometry = ode_get_geom( self );
+	ode_COMPOUND	*compound = ode_compound_data( geometry->id );
+	ode_BODY		*bodyPtr;
+	const dReal		*pos, *rot;
+	dMass			mass;
+	dReal			*c;
+	long			n;
+
+	if ( !RTEST(body) ) {
+		dGeomSetBody( geometry->id, 0 );
+		return body;
+	}
+
+	bodyPtr = ode_get_body( body );
+	dGeomSetBody( geometry->id, bodyPtr->id );
+
+	ode_compound_mass( geometry->id, &mass );
+	if ( mass.mass <= 0 ) return body;
+
+	c = mass.c;
+	if ( c[0] != 0 || c[1] != 0 || c[2] != 0 ) {
+		for ( n = 0; n < compound->count; n++ ) {
+			compound->children[n].pos[0] -= c[0];
+			compound->children[n].pos[1] -= c[1];
+			compound->children[n].pos[2] -= c[2];
+		}
+
+		pos = dBodyGetPosition( bodyPtr->id );
+		rot = dBodyGetRotation( bodyPtr->id );
+		dBodySetPosition( bodyPtr->id,
+						  pos[0] + rot[0]*c[0] + rot[1]*c[1] + rot[2]*c[2],
+						  pos[1] + rot[4]*c[0] + rot[5]*c[1] + rot[6]*c[2],
+						  pos[2] + rot[8]*c[0] + rot[9]*c[1] + rot[10]*c[2] );
+
+		dMassTranslate( &mass, -c[0], -c[1], -c[2] );
+		ode_compound_update_bounds( geometry->id );
+	}
+
+	/* Make sure the body has its ODE::Mass first, as creating it resets the
+	   body's mass */
+	rb_funcall( body, rb_intern("mass"), 0 );
+	dBodySetMass( bodyPtr->id, &mass );
+	return body;
+}
+
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_geometry_transform()
+{
+	dGeomClass	compoundClass;
+
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeGeometry = rb_define_class_under( ode_mOde, "Geometry", rb_cObject );
+	ode_cOdePlaceable = rb_define_class_under( ode_cOdeGeometry, "Placeable", ode_cOdeGeometry );
+	ode_cOdeGeometryTransform = rb_define_class_under( ode_cOdeGeometry, "Transform", ode_cOdePlaceable );
+	ode_cOdeGeometryCompound = rb_define_class_under( ode_cOdeGeometry, "Compound", ode_cOdePlaceable );
+#endif
+
+	/* Register the compound geometry class with ODE */
+	compoundClass.bytes		= sizeof( ode_COMPOUND );
+	compoundClass.collider	= ode_compound_get_collider;
+	compoundClass.aabb		= ode_compound_aabb;
+	compoundClass.aabb_test	= NULL;
+	compoundClass.dtor		= ode_compound_dtor;
+	ode_compound_class = dCreateGeomClass( &compoundClass );
+
+	/* ODE::Geometry::Transform */
+	rb_define_method( ode_cOdeGeometryTransform, "initialize", ode_geometry_transform_init, -1 );
+	rb_enable_super ( ode_cOdeGeometryTransform, "initialize" );
+
+	rb_define_method( ode_cOdeGeometryTransform, "geometry", ode_geometry_transform_geometry, 0 );
+	rb_define_method( ode_cOdeGeometryTransform, "geometry=", ode_geometry_transform_geometry_eq, 1 );
+
+	/* ODE::Geometry::Compound */
+	rb_define_method( ode_cOdeGeometryCompound, "initialize", ode_geometry_compound_init, -1 );
+	rb_enable_super ( ode_cOdeGeometryCompound, "initialize" );
+
+	rb_define_method( ode_cOdeGeometryCompound, "add", ode_geometry_compound_add, -1 );
+	rb_define_method( ode_cOdeGeometryCompound, "remove", ode_geometry_compound_remove, 1 );
+	rb_define_method( ode_cOdeGeometryCompound, "geometries", ode_geometry_compound_geometries, 0 );
+	rb_define_method( ode_cOdeGeometryCompound, "mass", ode_geometry_compound_mass_get, 0 );
+	rb_define_method( ode_cOdeGeometryCompound, "body=", ode_geometry_compound_body_eq, 1 );
+}
+
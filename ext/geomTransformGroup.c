@@ -120,6 +120,10 @@ ode_geomtg_alloc() {
 	ptr->object		= Qnil;
 	ptr->container	= Qnil;
 	ptr->body		= Qnil;
+	ptr->stamp		= 0;
+	ptr->serial		= ode_geometry_next_serial();
+	ptr->nearCallback	= NULL;
+	ptr->sensor		= 0;
 
 	debugMsg(( "Initialized ode_GEOMETRY <%p> for an ODE::GeometryTransformGroup.", ptr ));
 	return ptr;
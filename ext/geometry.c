@@ -34,23 +34,27 @@ static unsigned int X = 0;
 static unsigned int Y = 1;
 static unsigned int Z = 2;
 
-#define SetContainer( obj, sptr, gs ) {\
-	(gs)->container = obj; \
-	if ( RTEST(obj) ) { \
-		(sptr) = (dSpaceID)(ode_get_space(obj)->id); \
-		debugMsg(( "Setting container space to <%p>.", (sptr) )); \
-	} else { \
-		(sptr) = 0; \
-		debugMsg(( "Unsetting container space." )); \
-	} \
-}
 
-#define IsGeom( obj ) rb_obj_is_kind_of( (obj), ode_cOdeGeometry )
+/* Source of the creation-order serial numbers used to order geometries
+   deterministically, eg., when sorting collision results */
+static unsigned long ode_geometry_serial = 0;
+
 
 /* --------------------------------------------------
  * Memory-management functions
  * -------------------------------------------------- */
 
+/*
+ * Return the next geometry serial number. Used by all the allocators of
+ * ode_GEOMETRY structs (spaces, too).
+ */
+unsigned long
+ode_geometry_next_serial()
+{
+	return ++ode_geometry_serial;
+}
+
+
 /*
  * Allocation function
  */
@@ -65,6 +69,10 @@ ode_geometry_alloc()
 	ptr->container	= Qnil;
 	ptr->body		= Qnil;
 	ptr->surface	= Qnil;
+	ptr->stamp		= 0;
+	ptr->serial		= ode_geometry_next_serial();
+	ptr->nearCallback	= NULL;
+	ptr->sensor		= 0;
 	
 	debugMsg(( "Initialized ode_GEOMETRY <%p>", ptr ));
 	return ptr;
@@ -456,6 +464,56 @@ ode_geometry_enabled_p( self )
 }
 
 
+/*
+ * ODE::Geometry#serial
+ * --
+ * Returns the geometry's serial number, which is unique among the geometries
+ * (and spaces) created in this process. Events drained with
+ * ODE::World#drainEvents refer to geometries by this number.
+ */
+static VALUE
+ode_geometry_serial_num( self )
+	 VALUE self;
+{
+	ode_GEOMETRY	*ptr = get_geom( self );
+	return ULONG2NUM( ptr->serial );
+}
+
+
+/*
+ * ODE::Geometry#sensor?
+ * --
+ * Returns true if the geometry is a sensor (see #sensor=).
+ */
+static VALUE
+ode_geometry_sensor_p( self )
+	 VALUE self;
+{
+	ode_GEOMETRY	*ptr = get_geom( self );
+	return ptr->sensor ? Qtrue : Qfalse;
+}
+
+
+/*
+ * ODE::Geometry#sensor=( flag )
+ * --
+ * Make the geometry a sensor (a trigger volume), or an ordinary geometry
+ * again. ODE::Space#collide doesn't generate contacts for pairs involving a
+ * sensor; it just tests whether they overlap, and records the geometries
+ * entering and leaving each sensor in the world (see
+ * ODE::World#sensorChanges and ODE::World#drainEvents).
+ */
+static VALUE
+ode_geometry_sensor_eq( self, flag )
+	 VALUE self, flag;
+{
+	ode_GEOMETRY	*ptr = get_geom( self );
+
+	ptr->sensor = RTEST( flag ) ? 1 : 0;
+	return flag;
+}
+
+
 /*
  * ODE::Geometry#surface
  * --
@@ -521,7 +579,10 @@ ode_geometry_body_eq( self )
  * <tt>otherGeometry</tt> in the form of at most <tt>maxContacts</tt>
  * ODE::Contact objects, yielding each in turn to the given
  * <tt>contactHandler</tt>. This corresponds to (and is really just a wrapper
- * around) the dCollide() function in the C API.
+ * around) the dCollide() function in the C API, except that the contacts
+ * are reduced according to the manifold reduction rule for the two
+ * geometries' surfaces, if there is one (see
+ * ODE::Surface::setManifoldReduction).
  */
 static VALUE
 ode_geometry_collide( argc, argv, self )
@@ -564,6 +625,7 @@ ode_geometry_collide( argc, argv, self )
 	/* Allocate contacts and generate contact information. */
 	cgeoms = ALLOCA_N( dContactGeom, (flags & 0xffff) );
 	contactCount = dCollide( geom1->id, geom2->id, flags, cgeoms, sizeof(dContactGeom) );
+	contactCount = ode_manifold_reduce( cgeoms, contactCount, geom1, geom2 );
 
 	/* Yield to the block for each contact object */
 	for ( i = 0; i < contactCount; i++ ) {
@@ -1841,7 +1903,8 @@ void ode_init_geometry() {
 	ode_cOdeGeometryRay		= rb_define_class_under( ode_cOdeGeometry, "Ray", ode_cOdeRay );
 	ode_cOdeGeometryCylinder = rb_define_class_under( ode_cOdeGeometry, "Cylinder", ode_cOdePlaceable );
 
-	ode_cOdeGeometryTransform = rb_define_class_under( ode_cOdeGeometry, "Transform", ode_cOdeGeometry );
+	ode_cOdeGeometryTransform = rb_define_class_under( ode_cOdeGeometry, "Transform", ode_cOdePlaceable );
+	ode_cOdeGeometryCompound = rb_define_class_under( ode_cOdeGeometry, "Compound", ode_cOdePlaceable );
 	ode_cOdeGeometryTransformGroup = rb_define_class_under( ode_cOdeGeometry, "TransformGroup", ode_cOdeGeometry );
 
 	ode_cOdeSpace			= rb_define_class_under( ode_mOde, "Space", ode_cOdeGeometry );
@@ -1888,6 +1951,9 @@ void ode_init_geometry() {
 	rb_define_method( ode_cOdeGeometry, "disable", ode_geometry_disable, 0 );
 	rb_define_method( ode_cOdeGeometry, "enabled?", ode_geometry_enabled_p, 0 );
 
+	rb_define_method( ode_cOdeGeometry, "serial", ode_geometry_serial_num, 0 );
+	rb_define_method( ode_cOdeGeometry, "sensor?", ode_geometry_sensor_p, 0 );
+	rb_define_method( ode_cOdeGeometry, "sensor=", ode_geometry_sensor_eq, 1 );
 	rb_define_method( ode_cOdeGeometry, "surface", ode_geometry_surface, 0 );
 	rb_define_method( ode_cOdeGeometry, "surface=", ode_geometry_surface_eq, 1 );
 	rb_define_method( ode_cOdeGeometry, "body", ode_geometry_body, 0 );
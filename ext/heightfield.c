@@ -0,0 +1,563 @@
+/*
+ *		heightfield.c - ODE Ruby Binding - ODE::HeightfieldData and ODE::Geometry::Heightfield
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 11:40:05 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* Supported sample sizes: int16, float, double */
+#define SampleSizeShort		sizeof(short)
+#define SampleSizeSingle	sizeof(float)
+#define SampleSizeDouble	sizeof(double)
+
+
+/* --------------------------------------------------
+ * Memory-management functions
+ * -------------------------------------------------- */
+
+/*
+ * Allocation function
+ */
+static ode_HEIGHTFIELDDATA *
+ode_heightfielddata_alloc()
+{
+	ode_HEIGHTFIELDDATA *ptr = ALLOC( ode_HEIGHTFIELDDATA );
+
+	ptr->id				= 0;
+	ptr->object			= Qnil;
+	ptr->samples		= NULL;
+	ptr->widthSamples	= 0;
+	ptr->depthSamples	= 0;
+	ptr->sampleSize		= 0;
+	ptr->minSample		= 0;
+	ptr->maxSample		= 0;
+
+	debugMsg(( "Initialized ode_HEIGHTFIELDDATA <%p>", ptr ));
+	return ptr;
+}
+
+
+/*
+ * GC free function
+ */
+static void
+ode_heightfielddata_gc_free( ptr )
+	 ode_HEIGHTFIELDDATA *ptr;
+{
+	debugMsg(( "Freeing an ODE::HeightfieldData." ));
+
+	if ( ptr ) {
+#ifdef HAVE_HEIGHTFIELD_GEOM
+		if ( ptr->id )
+			dGeomHeightfieldDataDestroy( ptr->id );
+#endif
+		if ( ptr->samples )
+			xfree( ptr->samples );
+
+		ptr->id			= NULL;
+		ptr->samples	= NULL;
+		ptr->object		= Qnil;
+
+		xfree( ptr );
+		ptr = NULL;
+	}
+
+	else {
+		debugMsg(( "Not freeing NULL pointer." ));
+	}
+}
+
+
+/*
+ * Object validity checker. Returns the data pointer.
+ */
+static ode_HEIGHTFIELDDATA *
+check_heightfielddata( self )
+	 VALUE	self;
+{
+	debugMsg(( "Checking a HeightfieldData object (%d).", self ));
+	Check_Type( self, T_DATA );
+
+    if ( !IsHeightfieldData(self) ) {
+		rb_raise( rb_eTypeError, "wrong argument type %s (expected ODE::HeightfieldData)",
+				  rb_class2name(CLASS_OF( self )) );
+    }
+
+	return DATA_PTR( self );
+}
+
+
+/*
+ * Fetch the data pointer and check it for sanity.
+ */
+static ode_HEIGHTFIELDDATA *
+get_heightfielddata( self )
+	 VALUE self;
+{
+	ode_HEIGHTFIELDDATA *ptr = check_heightfielddata( self );
+
+	debugMsg(( "Fetching an ode_HEIGHTFIELDDATA (%p).", ptr ));
+	if ( !ptr )
+		rb_raise( rb_eRuntimeError, "uninitialized heightfield data" );
+
+	return ptr;
+}
+
+
+/*
+ * Publicly-usable heightfield data fetcher.
+ */
+ode_HEIGHTFIELDDATA *
+ode_get_heightfielddata( self )
+	 VALUE self;
+{
+	return get_heightfielddata( self );
+}
+
+
+/*
+ * Return the sample at the given offset into the sample buffer as a dReal.
+ */
+static dReal
+ode_heightfielddata_sample_at( ptr, offset )
+	 ode_HEIGHTFIELDDATA	*ptr;
+	 long					offset;
+{
+	switch ( ptr->sampleSize ) {
+	case SampleSizeShort:
+		return (dReal)*( (short *)ptr->samples + offset );
+	case SampleSizeSingle:
+		return (dReal)*( (float *)ptr->samples + offset );
+	default:
+		return (dReal)*( (double *)ptr->samples + offset );
+	}
+}
+
+
+/*
+ * Widen the recorded sample bounds to include the samples in the given
+ * rectangle, and pass them on to ODE so the geometry's AABB covers them.
+ * Bounds are never narrowed, so updates only cost as much as the rectangle.
+ */
+static void
+ode_heightfielddata_widen_bounds( ptr, x, z, w, d, reset )
+	 ode_HEIGHTFIELDDATA	*ptr;
+	 int					x, z, w, d, reset;
+{
+	dReal	sample;
+	int		i, j;
+
+	for ( j = z; j < z + d; j++ ) {
+		for ( i = x; i < x + w; i++ ) {
+			sample = ode_heightfielddata_sample_at( ptr, (long)j * ptr->widthSamples + i );
+
+			if ( reset ) {
+				ptr->minSample = ptr->maxSample = sample;
+				reset = 0;
+			}
+			else if ( sample < ptr->minSample )
+				ptr->minSample = sample;
+			else if ( sample > ptr->maxSample )
+				ptr->maxSample = sample;
+		}
+	}
+
+#ifdef HAVE_HEIGHTFIELD_GEOM
+	dGeomHeightfieldDataSetBounds( ptr->id, ptr->minSample, ptr->maxSample );
+#endif
+}
+
+
+
+/* --------------------------------------------------
+ * Class Methods
+ * -------------------------------------------------- */
+
+/*
+ * Allocator
+ */
+static VALUE
+ode_heightfielddata_s_alloc( klass )
+	 VALUE klass;
+{
+	debugMsg(( "Wrapping an uninitialized ODE::HeightfieldData pointer." ));
+	return Data_Wrap_Struct( klass, 0, ode_heightfielddata_gc_free, 0 );
+}
+
+
+
+/* --------------------------------------------------
+ * Instance Methods
+ * -------------------------------------------------- */
+
+/* --- ODE::HeightfieldData ------------------------------ */
+
+/*
+ * ODE::HeightfieldData::new( samples, widthSamples, depthSamples, width, depth,
+ *                            scale=1.0, offset=0.0, thickness=1.0, wrap=false )
+ * --
+ * Create a new heightfield data object from the packed <tt>samples</tt>
+ * String, which contains <tt>widthSamples</tt> * <tt>depthSamples</tt> native
+ * int16 (<tt>pack('s*')</tt>), float (<tt>pack('f*')</tt>) or double
+ * (<tt>pack('d*')</tt>) height samples in row-major order (rows run along the
+ * X axis; each row is one Z step). The sample type is inferred from the
+ * length of the buffer. The samples are spread over a <tt>width</tt> by
+ * <tt>depth</tt> area, and each is multiplied by <tt>scale</tt> and
+ * <tt>offset</tt> is added to it to arrive at the height. <tt>thickness</tt>
+ * is the depth of the solid below the lowest sample, and if <tt>wrap</tt> is
+ * true the field tiles infinitely.
+ *
+ * The samples are copied once into a buffer owned by the data object, which
+ * ODE then references directly; see #update for modifying them in place.
+ */
+static VALUE
+ode_heightfielddata_init( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+#ifdef HAVE_HEIGHTFIELD_GEOM
+	ode_HEIGHTFIELDDATA	*ptr;
+	VALUE				samples, widthSamples, depthSamples, width, depth,
+						scale, offset, thickness, wrap;
+	dReal				scaleVal = 1.0, offsetVal = 0.0, thicknessVal = 1.0;
+	long				count;
+	int					sampleSize;
+
+	rb_scan_args( argc, argv, "54", &samples, &widthSamples, &depthSamples, &width, &depth,
+				  &scale, &offset, &thickness, &wrap );
+
+	if ( (ptr = check_heightfielddata(self)) )
+		rb_raise( rb_eRuntimeError, "heightfield data already initialized" );
+
+	StringValue( samples );
+	CheckPositiveNonZeroNumber( NUM2DBL(width), "width" );
+	CheckPositiveNonZeroNumber( NUM2DBL(depth), "depth" );
+	if ( NUM2INT(widthSamples) < 2 || NUM2INT(depthSamples) < 2 )
+		rb_raise( rb_eRangeError, "heightfield must be at least 2x2 samples" );
+	if ( RTEST(scale) ) scaleVal = (dReal)NUM2DBL( scale );
+	if ( RTEST(offset) ) offsetVal = (dReal)NUM2DBL( offset );
+	if ( RTEST(thickness) ) {
+		thicknessVal = (dReal)NUM2DBL( thickness );
+		CheckPositiveNumber( thicknessVal, "thickness" );
+	}
+
+	/* Infer the sample type from the buffer length */
+	count = (long)NUM2INT( widthSamples ) * NUM2INT( depthSamples );
+	if ( RSTRING(samples)->len % count )
+		rb_raise( rb_eArgError, "sample buffer length (%ld) is not a multiple of %ld",
+				  RSTRING(samples)->len, count );
+	sampleSize = RSTRING(samples)->len / count;
+	if ( sampleSize != SampleSizeShort &&
+		 sampleSize != SampleSizeSingle &&
+		 sampleSize != SampleSizeDouble )
+		rb_raise( rb_eArgError, "unsupported sample size %d (expected 2, 4 or 8 bytes)",
+				  sampleSize );
+
+	DATA_PTR(self) = ptr = ode_heightfielddata_alloc();
+	ptr->object			= self;
+	ptr->widthSamples	= NUM2INT( widthSamples );
+	ptr->depthSamples	= NUM2INT( depthSamples );
+	ptr->sampleSize		= sampleSize;
+
+	ptr->samples = ALLOC_N( char, RSTRING(samples)->len );
+	MEMCPY( ptr->samples, RSTRING(samples)->ptr, char, RSTRING(samples)->len );
+
+	/* Build the data without copying (ODE refers to our buffer) */
+	ptr->id = dGeomHeightfieldDataCreate();
+	switch ( ptr->sampleSize ) {
+	case SampleSizeShort:
+		dGeomHeightfieldDataBuildShort( ptr->id, (short *)ptr->samples, 0,
+										(dReal)NUM2DBL(width), (dReal)NUM2DBL(depth),
+										ptr->widthSamples, ptr->depthSamples,
+										scaleVal, offsetVal, thicknessVal, RTEST(wrap) );
+		break;
+	case SampleSizeSingle:
+		dGeomHeightfieldDataBuildSingle( ptr->id, (float *)ptr->samples, 0,
+										 (dReal)NUM2DBL(width), (dReal)NUM2DBL(depth),
+										 ptr->widthSamples, ptr->depthSamples,
+										 scaleVal, offsetVal, thicknessVal, RTEST(wrap) );
+		break;
+	default:
+		dGeomHeightfieldDataBuildDouble( ptr->id, (double *)ptr->samples, 0,
+										 (dReal)NUM2DBL(width), (dReal)NUM2DBL(depth),
+										 ptr->widthSamples, ptr->depthSamples,
+										 scaleVal, offsetVal, thicknessVal, RTEST(wrap) );
+	}
+
+	ode_heightfielddata_widen_bounds( ptr, 0, 0, ptr->widthSamples, ptr->depthSamples, 1 );
+
+	return self;
+#else
+	rb_notimplement();
+#endif /* HAVE_HEIGHTFIELD_GEOM */
+}
+
+
+/*
+ * ODE::HeightfieldData#widthSamples
+ * --
+ * Returns the number of samples along the X axis.
+ */
+static VALUE
+ode_heightfielddata_width_samples( self )
+	 VALUE self;
+{
+	ode_HEIGHTFIELDDATA	*ptr = get_heightfielddata( self );
+	return INT2FIX( ptr->widthSamples );
+}
+
+
+/*
+ * ODE::HeightfieldData#depthSamples
+ * --
+ * Returns the number of samples along the Z axis.
+ */
+static VALUE
+ode_heightfielddata_depth_samples( self )
+	 VALUE self;
+{
+	ode_HEIGHTFIELDDATA	*ptr = get_heightfielddata( self );
+	return INT2FIX( ptr->depthSamples );
+}
+
+
+/*
+ * ODE::HeightfieldData#sampleSize
+ * --
+ * Returns the size of each sample in bytes (2, 4 or 8).
+ */
+static VALUE
+ode_heightfielddata_sample_size( self )
+	 VALUE self;
+{
+	ode_HEIGHTFIELDDATA	*ptr = get_heightfielddata( self );
+	return INT2FIX( ptr->sampleSize );
+}
+
+
+/*
+ * ODE::HeightfieldData#sample( x, z )
+ * --
+ * Returns the (unscaled) sample at column <tt>x</tt> and row <tt>z</tt>.
+ */
+static VALUE
+ode_heightfielddata_sample( self, x, z )
+	 VALUE self, x, z;
+{
+	ode_HEIGHTFIELDDATA	*ptr = get_heightfielddata( self );
+	int					xi = NUM2INT( x ), zi = NUM2INT( z );
+
+	if ( xi < 0 || xi >= ptr->widthSamples || zi < 0 || zi >= ptr->depthSamples )
+		rb_raise( rb_eIndexError, "sample (%d,%d) out of range", xi, zi );
+
+	return rb_float_new( ode_heightfielddata_sample_at(ptr, (long)zi * ptr->widthSamples + xi) );
+}
+
+
+/*
+ * ODE::HeightfieldData#bounds
+ * --
+ * Returns the lowest and highest (unscaled) samples as a two-element
+ * Array. Since #update only ever widens the bounds, this may be wider than
+ * the actual range of the current samples.
+ */
+static VALUE
+ode_heightfielddata_bounds( self )
+	 VALUE self;
+{
+	ode_HEIGHTFIELDDATA	*ptr = get_heightfielddata( self );
+	return rb_ary_new3( 2, rb_float_new(ptr->minSample), rb_float_new(ptr->maxSample) );
+}
+
+
+/*
+ * ODE::HeightfieldData#update( x, z, width, depth, samples )
+ * --
+ * Overwrite the <tt>width</tt> by <tt>depth</tt> rectangle of samples whose
+ * corner is at column <tt>x</tt>, row <tt>z</tt> with the packed
+ * <tt>samples</tt>, which must be of the same type as those the data was
+ * created with. The samples are modified in place, so the change is seen by
+ * every geometry using the data as of the next collision; no rebuild is
+ * needed. Geometries that have already cached a bounding box should be told
+ * via ODE::Geometry::Heightfield#update instead if the new samples fall
+ * outside the previous #bounds.
+ */
+static VALUE
+ode_heightfielddata_update( self, x, z, width, depth, samples )
+	 VALUE self, x, z, width, depth, samples;
+{
+	ode_HEIGHTFIELDDATA	*ptr = get_heightfielddata( self );
+	int					xi = NUM2INT( x ), zi = NUM2INT( z ),
+						w = NUM2INT( width ), d = NUM2INT( depth ),
+						row;
+	long				rowBytes;
+	char				*src, *dst;
+
+	StringValue( samples );
+	if ( xi < 0 || zi < 0 || w < 1 || d < 1 ||
+		 xi + w > ptr->widthSamples || zi + d > ptr->depthSamples )
+		rb_raise( rb_eIndexError, "rectangle (%d,%d)+(%d,%d) is outside the %dx%d heightfield",
+				  xi, zi, w, d, ptr->widthSamples, ptr->depthSamples );
+
+	rowBytes = (long)w * ptr->sampleSize;
+	if ( RSTRING(samples)->len != rowBytes * d )
+		rb_raise( rb_eArgError, "sample buffer length (%ld) doesn't match rectangle (%ld)",
+				  RSTRING(samples)->len, rowBytes * d );
+
+	/* Copy the rectangle a row at a time */
+	src = RSTRING(samples)->ptr;
+	for ( row = zi; row < zi + d; row++ ) {
+		dst = (char *)ptr->samples +
+			((long)row * ptr->widthSamples + xi) * ptr->sampleSize;
+		memcpy( dst, src, rowBytes );
+		src += rowBytes;
+	}
+
+	ode_heightfielddata_widen_bounds( ptr, xi, zi, w, d, 0 );
+
+	return self;
+}
+
+
+
+/* --- ODE::Geometry::Heightfield ------------------------------ */
+
+/*
+ * ODE::Geometry::Heightfield::new( data, space=nil )
+ * --
+ * Create a new heightfield terrain geometry from the given
+ * ODE::HeightfieldData, inserting it into the specified space, if given. The
+ * heightfield's up axis is its local Y axis.
+ */
+static VALUE
+ode_geometry_heightfield_init( argc, argv, self )
+	 int		argc;
+	 VALUE		*argv, self;
+{
+#ifdef HAVE_HEIGHTFIELD_GEOM
+	VALUE				data, spaceObj;
+	dSpaceID			space = 0;
+	ode_GEOMETRY		*geometry = 0;
+	ode_HEIGHTFIELDDATA	*fieldData;
+
+	debugMsg(( "Calling super()" ));
+	rb_call_super( 0, 0 );
+	debugMsg(( "Back from super()" ));
+
+	/* Fetch the ode_GEOMETRY pointer */
+	geometry = ode_get_geom( self );
+	if ( !geometry ) rb_bug( "Superclass's initialize didn't return a valid Geometry." );
+
+	if ( rb_scan_args(argc, argv, "11", &data, &spaceObj) == 2 ) {
+		SetContainer( spaceObj, space, geometry );
+	}
+
+	fieldData = get_heightfielddata( data );
+
+	debugMsg(( "Creating new Heightfield geometry." ));
+	geometry->id = dCreateHeightfield( space, fieldData->id, 1 );
+
+	/* Set the ode_GEOMETRY pointer as the data pointer of the dGeomID, and
+	   keep the heightfield data alive as long as the geometry refers to it */
+	dGeomSetData( geometry->id, geometry );
+	rb_iv_set( self, "@data", data );
+
+	return self;
+#else
+	rb_notimplement();
+#endif /* HAVE_HEIGHTFIELD_GEOM */
+}
+
+
+/*
+ * ODE::Geometry::Heightfield#data
+ * --
+ * Returns the ODE::HeightfieldData the geometry was created with.
+ */
+static VALUE
+ode_geometry_heightfield_data( self )
+	 VALUE self;
+{
+	return rb_iv_get( self, "@data" );
+}
+
+
+/*
+ * ODE::Geometry::Heightfield#update( x, z, width, depth, samples )
+ * --
+ * Update a rectangle of the heightfield's samples in place (see
+ * ODE::HeightfieldData#update) and invalidate the geometry's cached bounding
+ * box so raised terrain is picked up by the broadphase.
+ */
+static VALUE
+ode_geometry_heightfield_update( self, x, z, width, depth, samples )
+	 VALUE self, x, z, width, depth, samples;
+{
+	ode_GEOMETRY	*geometry = ode_get_geom( self );
+	const dReal		*pos;
+
+	ode_heightfielddata_update( rb_iv_get(self, "@data"), x, z, width, depth, samples );
+
+	/* Re-setting the position is the public way of marking the geom dirty */
+	pos = dGeomGetPosition( geometry->id );
+	dGeomSetPosition( geometry->id, pos[0], pos[1], pos[2] );
+
+	return self;
+}
+
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_heightfield()
+{
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeHeightfieldData	= rb_define_class_under( ode_mOde, "HeightfieldData", rb_cObject );
+	ode_cOdeGeometry		= rb_define_class_under( ode_mOde, "Geometry", rb_cObject );
+	ode_cOdePlaceable		= rb_define_class_under( ode_cOdeGeometry, "Placeable", ode_cOdeGeometry );
+	ode_cOdeGeometryHeightfield = rb_define_class_under( ode_cOdeGeometry, "Heightfield", ode_cOdePlaceable );
+#endif
+
+	/* ODE::HeightfieldData */
+	rb_define_alloc_func( ode_cOdeHeightfieldData, ode_heightfielddata_s_alloc );
+	rb_define_method( ode_cOdeHeightfieldData, "initialize", ode_heightfielddata_init, -1 );
+
+	rb_define_method( ode_cOdeHeightfieldData, "widthSamples", ode_heightfielddata_width_samples, 0 );
+	rb_define_alias ( ode_cOdeHeightfieldData, "width_samples", "widthSamples" );
+	rb_define_method( ode_cOdeHeightfieldData, "depthSamples", ode_heightfielddata_depth_samples, 0 );
+	rb_define_alias ( ode_cOdeHeightfieldData, "depth_samples", "depthSamples" );
+	rb_define_method( ode_cOdeHeightfieldData, "sampleSize", ode_heightfielddata_sample_size, 0 );
+	rb_define_alias ( ode_cOdeHeightfieldData, "sample_size", "sampleSize" );
+	rb_define_method( ode_cOdeHeightfieldData, "sample", ode_heightfielddata_sample, 2 );
+	rb_define_method( ode_cOdeHeightfieldData, "bounds", ode_heightfielddata_bounds, 0 );
+	rb_define_method( ode_cOdeHeightfieldData, "update", ode_heightfielddata_update, 5 );
+
+	/* ODE::Geometry::Heightfield */
+	rb_define_method( ode_cOdeGeometryHeightfield, "initialize", ode_geometry_heightfield_init, -1 );
+	rb_enable_super ( ode_cOdeGeometryHeightfield, "initialize" );
+
+	rb_define_method( ode_cOdeGeometryHeightfield, "data", ode_geometry_heightfield_data, 0 );
+	rb_define_method( ode_cOdeGeometryHeightfield, "update", ode_geometry_heightfield_update, 5 );
+}
+
@@ -0,0 +1,748 @@
+/*
+ *		ikchain.c - ODE Ruby Binding - IKChain Class
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 22:06:53 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+#include <math.h>
+#include <time.h>
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* Default limits of a solve */
+#define ODE_IK_DEFAULT_ITERATIONS	16
+#define ODE_IK_DEFAULT_TOLERANCE	1e-3
+
+/* Rotations smaller than this are skipped */
+#define ODE_IK_EPSILON				1e-9
+
+/* One rotational degree of freedom of the chain, in the order from its root
+   to its tip: a hinge, one axis of a universal joint, or a ball joint (which
+   rotates about whichever axis it needs) */
+typedef struct {
+	ode_JOINT	*joint, *motor;
+	int			type, axis;			/* ODE joint type, and its axis (0 for a ball) */
+	int			sign, motorSign;	/* Which way the joint's rate turns the tip side */
+	dVector3	anchor, direction;	/* Working copies, in world coordinates */
+	dReal		delta[3];			/* Solved angle, or rotation vector for a ball */
+} ode_IKDOF;
+
+/* ODE::IKChain struct */
+typedef struct {
+	VALUE		object, joints, effector;
+	ode_IKDOF	*dofs;
+	long		count;
+	dVector3	offset, tip;
+	dReal		error;
+	int			iterations;
+} ode_IKCHAIN;
+
+
+
+/* --------------------------------------------------
+ *	Memory-management functions
+ * -------------------------------------------------- */
+
+/*
+ * Allocation function
+ */
+static ode_IKCHAIN *
+ode_ikchain_alloc()
+{
+	ode_IKCHAIN *ptr = ALLOC( ode_IKCHAIN );
+
+	ptr->object		= Qnil;
+	ptr->joints		= Qnil;
+	ptr->effector	= Qnil;
+	ptr->dofs		= NULL;
+	ptr->count		= 0;
+	ptr->error		= 0;
+	ptr->iterations	= 0;
+	ptr->offset[0] = ptr->offset[1] = ptr->offset[2] = 0;
+
+	debugMsg(( "Initialized ode_IKCHAIN <%p>", ptr ));
+	return ptr;
+}
+
+
+/*
+ * GC Mark function
+ */
+static void
+ode_ikchain_gc_mark( ptr )
+	 ode_IKCHAIN *ptr;
+{
+	debugMsg(( "Marking an ODE::IKChain" ));
+
+	if ( ptr ) {
+		rb_gc_mark( ptr->joints );
+		rb_gc_mark( ptr->effector );
+	}
+}
+
+
+/*
+ * GC Free function
+ */
+static void
+ode_ikchain_gc_free( ptr )
+	 ode_IKCHAIN *ptr;
+{
+	if ( ptr ) {
+		debugMsg(( "Destroying IKChain <%p>", ptr ));
+		if ( ptr->dofs ) xfree( ptr->dofs );
+		ptr->dofs = NULL;
+
+		xfree( ptr );
+		ptr = NULL;
+	}
+}
+
+
+/*
+ * Object validity checker. Returns the data pointer.
+ */
+static ode_IKCHAIN *
+check_ikchain( self )
+	 VALUE	self;
+{
+	debugMsg(( "Checking an IKChain object (%d).", self ));
+	Check_Type( self, T_DATA );
+
+    if ( !rb_obj_is_kind_of(self, ode_cOdeIKChain) ) {
+		rb_raise( rb_eTypeError, "wrong argument type %s (expected ODE::IKChain)",
+				  rb_class2name(CLASS_OF( self )) );
+    }
+
+	return DATA_PTR( self );
+}
+
+
+/*
+ * Fetch the data pointer and check it for sanity.
+ */
+static ode_IKCHAIN *
+get_ikchain( self )
+	 VALUE self;
+{
+	ode_IKCHAIN *ptr = check_ikchain( self );
+
+	debugMsg(( "Fetching an ode_IKCHAIN (%p).", ptr ));
+	if ( !ptr )
+		rb_raise( rb_eRuntimeError, "uninitialized IK chain" );
+
+	return ptr;
+}
+
+
+
+/* --------------------------------------------------
+ * Solving
+ * -------------------------------------------------- */
+
+/*
+ * Return the number of degrees of freedom the chain gives a joint of the
+ * given ODE joint type, or 0 if it can't be part of a chain.
+ */
+static int
+ode_ikchain_dof_count( type )
+	 int	type;
+{
+	switch ( type ) {
+	case dJointTypeHinge:
+	case dJointTypeBall:
+		return 1;
+
+	case dJointTypeUniversal:
+		return 2;
+
+	default:
+		return 0;
+	}
+}
+
+
+/*
+ * Return +1 if <tt>body</tt> is the first body of the given joint, -1 if
+ * it's the second, and 0 if it's neither. Since ODE measures joint rates as
+ * the first body's angular velocity relative to the second's, this is the
+ * sign of the rate which turns <tt>body</tt> forward.
+ */
+static int
+ode_ikchain_body_sign( id, body )
+	 dJointID	id;
+	 dBodyID	body;
+{
+	if ( dJointGetBody(id, 0) == body ) return 1;
+	if ( dJointGetBody(id, 1) == body ) return -1;
+	return 0;
+}
+
+
+/*
+ * Load the anchors and axes of the chain's degrees of freedom and the
+ * position of its tip from the current state of the world.
+ */
+static void
+ode_ikchain_load( ptr )
+	 ode_IKCHAIN	*ptr;
+{
+	ode_IKDOF	*dof;
+	long		i;
+
+	for ( i = 0; i < ptr->count; i++ ) {
+		dof = ptr->dofs + i;
+		if ( RTEST(dof->joint->obsolete) || (dof->motor && RTEST(dof->motor->obsolete)) )
+			rb_raise( ode_eOdeObsoleteJointError,
+					  "Cannot use a joint which has been marked obsolete." );
+
+		switch ( dof->type ) {
+		case dJointTypeHinge:
+			dJointGetHingeAnchor( dof->joint->id, dof->anchor );
+			dJointGetHingeAxis( dof->joint->id, dof->direction );
+			break;
+
+		case dJointTypeUniversal:
+			dJointGetUniversalAnchor( dof->joint->id, dof->anchor );
+			if ( dof->axis == 1 )
+				dJointGetUniversalAxis1( dof->joint->id, dof->direction );
+			else
+				dJointGetUniversalAxis2( dof->joint->id, dof->direction );
+			break;
+
+		case dJointTypeBall:
+			dJointGetBallAnchor( dof->joint->id, dof->anchor );
+			break;
+		}
+
+		dof->delta[0] = dof->delta[1] = dof->delta[2] = 0;
+	}
+
+	dBodyGetRelPointPos( ode_get_body(ptr->effector)->id,
+						 ptr->offset[0], ptr->offset[1], ptr->offset[2], ptr->tip );
+}
+
+
+/*
+ * Rotate <tt>v</tt> by <tt>angle</tt> about the unit vector <tt>axis</tt>
+ * (Rodrigues' formula).
+ */
+static void
+ode_ikchain_rotate( v, axis, angle )
+	 dReal			*v;
+	 const dReal	*axis;
+	 dReal			angle;
+{
+	dVector3	kxv, r;
+	dReal		c = dCos( angle ), s = dSin( angle ), kdv = Dot3( axis, v );
+	int			i;
+
+	Cross3( kxv, axis, v );
+	for ( i = 0; i < 3; i++ )
+		r[i] = v[i] * c + kxv[i] * s + axis[i] * kdv * ( 1 - c );
+	v[0] = r[0]; v[1] = r[1]; v[2] = r[2];
+}
+
+
+/*
+ * Rotate the point <tt>p</tt> by <tt>angle</tt> about the line through
+ * <tt>center</tt> along the unit vector <tt>axis</tt>.
+ */
+static void
+ode_ikchain_rotate_point( p, center, axis, angle )
+	 dReal			*p;
+	 const dReal	*center, *axis;
+	 dReal			angle;
+{
+	dVector3	rel;
+
+	Sub3( rel, p, center );
+	ode_ikchain_rotate( rel, axis, angle );
+	p[0] = center[0] + rel[0];
+	p[1] = center[1] + rel[1];
+	p[2] = center[2] + rel[2];
+}
+
+
+/*
+ * Return the distance from the chain's working tip to <tt>target</tt>.
+ */
+static dReal
+ode_ikchain_error( ptr, target )
+	 ode_IKCHAIN	*ptr;
+	 const dReal	*target;
+{
+	dVector3	d;
+
+	Sub3( d, target, ptr->tip );
+	return dSqrt( Dot3(d, d) );
+}
+
+
+/*
+ * Turn the degree of freedom <tt>k</tt> as far as it can to bring the tip
+ * towards <tt>target</tt>, carrying the rest of the chain beyond it along.
+ */
+static void
+ode_ikchain_turn( ptr, k, target )
+	 ode_IKCHAIN	*ptr;
+	 long			k;
+	 const dReal	*target;
+{
+	ode_IKDOF	*dof = ptr->dofs + k;
+	dVector3	e, t, axis, c;
+	dReal		angle, s, along;
+	long		j;
+
+	Sub3( e, ptr->tip, dof->anchor );
+	Sub3( t, target, dof->anchor );
+
+	if ( dof->type == dJointTypeBall ) {
+		Cross3( c, e, t );
+		s = dSqrt( Dot3(c, c) );
+		if ( s < ODE_IK_EPSILON ) return;
+		axis[0] = c[0] / s; axis[1] = c[1] / s; axis[2] = c[2] / s;
+		angle = dAtan2( s, Dot3(e, t) );
+	}
+
+	/* Hinge axes: project both onto the plane of rotation */
+	else {
+		axis[0] = dof->direction[0]; axis[1] = dof->direction[1]; axis[2] = dof->direction[2];
+		along = Dot3( e, axis );
+		AddScaled3( e, e, -along, axis );
+		along = Dot3( t, axis );
+		AddScaled3( t, t, -along, axis );
+
+		Cross3( c, e, t );
+		angle = dAtan2( Dot3(axis, c), Dot3(e, t) );
+	}
+
+	if ( dFabs(angle) < ODE_IK_EPSILON ) return;
+
+	ode_ikchain_rotate_point( ptr->tip, dof->anchor, axis, angle );
+	for ( j = k + 1; j < ptr->count; j++ ) {
+		ode_ikchain_rotate_point( ptr->dofs[j].anchor, dof->anchor, axis, angle );
+		ode_ikchain_rotate( ptr->dofs[j].direction, axis, angle );
+	}
+
+	if ( dof->type == dJointTypeBall ) {
+		AddScaled3( dof->delta, dof->delta, angle, axis );
+	} else {
+		dof->delta[0] += angle;
+	}
+}
+
+
+/*
+ * Solve the chain for the given target with cyclic coordinate descent,
+ * stopping once the tip is within <tt>tolerance</tt> of it, after
+ * <tt>maxIterations</tt> sweeps, or once <tt>budget</tt> seconds of CPU time
+ * have been spent (if <tt>budget</tt> is positive).
+ */
+static void
+ode_ikchain_solve( ptr, target, maxIterations, tolerance, budget )
+	 ode_IKCHAIN	*ptr;
+	 const dReal	*target;
+	 int			maxIterations;
+	 dReal			tolerance;
+	 double			budget;
+{
+	clock_t		start = clock();
+	long		k;
+
+	ode_ikchain_load( ptr );
+	ptr->iterations = 0;
+
+	while ( ptr->iterations < maxIterations ) {
+		if ( ode_ikchain_error(ptr, target) <= tolerance ) break;
+		if ( budget > 0 && (double)(clock() - start) / CLOCKS_PER_SEC > budget ) break;
+
+		for ( k = ptr->count - 1; k >= 0; k-- )
+			ode_ikchain_turn( ptr, k, target );
+		ptr->iterations++;
+	}
+
+	ptr->error = ode_ikchain_error( ptr, target );
+}
+
+
+
+/* --------------------------------------------------
+ * Class Methods
+ * -------------------------------------------------- */
+
+/*
+ * allocate()
+ * --
+ * Allocate a new ODE::IKChain object.
+ */
+static VALUE
+ode_ikchain_s_alloc( klass )
+{
+	debugMsg(( "Wrapping an uninitialized ODE::IKChain pointer." ));
+	return Data_Wrap_Struct( klass, ode_ikchain_gc_mark, ode_ikchain_gc_free, 0 );
+}
+
+
+
+/* --------------------------------------------------
+ * Instance Methods
+ * -------------------------------------------------- */
+
+/*
+ * ODE::IKChain#initialize( joints, effector, offset=[0,0,0] )
+ * --
+ * Create a new inverse-kinematics chain from the given Array of
+ * <tt>joints</tt>, in order from the root of the chain to its tip, which
+ * ends at the point <tt>offset</tt> (relative to the body) on the
+ * <tt>effector</tt> ODE::Body. Each joint must share a body with the next
+ * one, and the last must be attached to the effector. The joints can be
+ * ODE::HingeJoints, ODE::UniversalJoints, and ODE::BallJoints. Since a ball
+ * joint hasn't got a motor, a ball joint can be given as a
+ * <tt>[ball, motor]</tt> pair with an ODE::AngularMotorJoint between the
+ * same bodies for #applyVelocities to drive.
+ */
+static VALUE
+ode_ikchain_init( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_IKCHAIN	*ptr;
+	ode_IKDOF	*dof;
+	ode_JOINT	*joint, *motor, *next;
+	VALUE		joints, effector, offset, entry;
+	dBodyID		tipBody;
+	long		i, count = 0;
+	int			type, dofs, sign, n;
+
+	rb_scan_args( argc, argv, "21", &joints, &effector, &offset );
+	Check_Type( joints, T_ARRAY );
+	ode_get_body( effector );
+
+	/* Count the degrees of freedom first, checking the joint types */
+	for ( i = 0; i < RARRAY(joints)->len; i++ ) {
+		entry = RARRAY( joints )->ptr[i];
+		if ( TYPE(entry) == T_ARRAY ) {
+			if ( RARRAY(entry)->len != 2 )
+				rb_raise( rb_eArgError, "expected a [ball, motor] pair" );
+			if ( dJointGetType(ode_get_joint(RARRAY(entry)->ptr[0])->id) != dJointTypeBall ||
+				 dJointGetType(ode_get_joint(RARRAY(entry)->ptr[1])->id) != dJointTypeAMotor )
+				rb_raise( rb_eTypeError, "expected a [BallJoint, AngularMotorJoint] pair" );
+			entry = RARRAY( entry )->ptr[0];
+		}
+
+		if ( (dofs = ode_ikchain_dof_count(dJointGetType(ode_get_joint(entry)->id))) == 0 )
+			rb_raise( rb_eTypeError, "can't put a %s in an IK chain",
+					  rb_class2name(CLASS_OF( entry )) );
+		count += dofs;
+	}
+
+	if ( count == 0 )
+		rb_raise( rb_eArgError, "an IK chain needs at least one joint" );
+
+	DATA_PTR(self) = ptr = ode_ikchain_alloc();
+	ptr->object = self;
+	ptr->joints = rb_ary_dup( joints );
+	ptr->effector = effector;
+	ptr->dofs = ALLOC_N( ode_IKDOF, count );
+	if ( RTEST(offset) ) {
+		offset = ode_obj_to_ary3( offset, "offset" );
+		SetVec3FromArray( ptr->offset, offset );
+	}
+
+	for ( i = 0; i < RARRAY(joints)->len; i++ ) {
+		entry = RARRAY( joints )->ptr[i];
+		motor = NULL;
+		if ( TYPE(entry) == T_ARRAY ) {
+			motor = ode_get_joint( RARRAY(entry)->ptr[1] );
+			entry = RARRAY( entry )->ptr[0];
+		}
+		joint = ode_get_joint( entry );
+		type = dJointGetType( joint->id );
+
+		/* Find the joint's body on the tip side: the one it shares with the
+		   next joint, or the effector */
+		if ( i < RARRAY(joints)->len - 1 ) {
+			entry = RARRAY( joints )->ptr[i+1];
+			if ( TYPE(entry) == T_ARRAY ) entry = RARRAY( entry )->ptr[0];
+			next = ode_get_joint( entry );
+
+			if ( dJointGetBody(joint->id, 0) &&
+				 ode_ikchain_body_sign(next->id, dJointGetBody(joint->id, 0)) )
+				tipBody = dJointGetBody( joint->id, 0 );
+			else
+				tipBody = dJointGetBody( joint->id, 1 );
+
+			if ( tipBody && !ode_ikchain_body_sign(next->id, tipBody) )
+				tipBody = 0;
+		} else {
+			tipBody = ode_get_body( effector )->id;
+		}
+
+		if ( !tipBody || (sign = ode_ikchain_body_sign(joint->id, tipBody)) == 0 )
+			rb_raise( rb_eArgError, "joint %ld isn't connected to the rest of the chain", i );
+
+		/* A universal joint's axis on the tip side turns after the other */
+		dofs = ode_ikchain_dof_count( type );
+		for ( n = 0; n < dofs; n++ ) {
+			dof = ptr->dofs + ptr->count++;
+			dof->joint = joint;
+			dof->motor = motor;
+			dof->type = type;
+			dof->sign = sign;
+			dof->motorSign = motor ? ode_ikchain_body_sign( motor->id, tipBody ) : 0;
+			if ( type == dJointTypeUniversal )
+				dof->axis = sign < 0 ? n + 1 : 2 - n;
+			else
+				dof->axis = type == dJointTypeHinge ? 1 : 0;
+		}
+	}
+
+	return self;
+}
+
+
+/*
+ * ODE::IKChain#joints
+ * --
+ * Returns the chain's joints, as they were given to ::new.
+ */
+static VALUE
+ode_ikchain_joints( self )
+	 VALUE self;
+{
+	return rb_ary_dup( get_ikchain(self)->joints );
+}
+
+
+/*
+ * ODE::IKChain#effector
+ * --
+ * Returns the body at the tip of the chain.
+ */
+static VALUE
+ode_ikchain_effector( self )
+	 VALUE self;
+{
+	return get_ikchain( self )->effector;
+}
+
+
+/*
+ * ODE::IKChain#solve( target, iterations=16, tolerance=0.001, budget=nil )
+ * --
+ * Work out how far each joint of the chain should turn to bring the tip to
+ * the <tt>target</tt> position, using cyclic coordinate descent on a copy of
+ * the chain's current pose (the bodies aren't moved). Stops once the tip is
+ * within <tt>tolerance</tt> of the target, after <tt>iterations</tt> sweeps
+ * of the chain, or once <tt>budget</tt> seconds of CPU time have been spent.
+ * Returns the remaining distance from the tip to the target. The result is
+ * available from #deltas and can be applied with #applyVelocities.
+ */
+static VALUE
+ode_ikchain_solve_m( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_IKCHAIN	*ptr = get_ikchain( self );
+	VALUE		targetObj, iterations, tolerance, budget;
+	dVector3	target;
+	int			maxIterations = ODE_IK_DEFAULT_ITERATIONS;
+	dReal		tol = ODE_IK_DEFAULT_TOLERANCE;
+	double		seconds = 0;
+
+	rb_scan_args( argc, argv, "13", &targetObj, &iterations, &tolerance, &budget );
+	targetObj = ode_obj_to_ary3( targetObj, "target" );
+	SetVec3FromArray( target, targetObj );
+
+	if ( RTEST(iterations) ) {
+		maxIterations = NUM2INT( iterations );
+		CheckPositiveNumber( (double)maxIterations, "iterations" );
+	}
+	if ( RTEST(tolerance) ) {
+		tol = (dReal)NUM2DBL( tolerance );
+		CheckPositiveNumber( tol, "tolerance" );
+	}
+	if ( RTEST(budget) ) {
+		seconds = NUM2DBL( budget );
+		CheckPositiveNonZeroNumber( seconds, "budget" );
+	}
+
+	ode_ikchain_solve( ptr, target, maxIterations, tol, seconds );
+	return rb_float_new( ptr->error );
+}
+
+
+/*
+ * ODE::IKChain#error
+ * --
+ * Returns the distance from the tip to the target left by the last #solve.
+ */
+static VALUE
+ode_ikchain_error_m( self )
+	 VALUE self;
+{
+	return rb_float_new( get_ikchain(self)->error );
+}
+
+
+/*
+ * ODE::IKChain#iterations
+ * --
+ * Returns the number of sweeps of the chain the last #solve made.
+ */
+static VALUE
+ode_ikchain_iterations( self )
+	 VALUE self;
+{
+	return INT2FIX( get_ikchain(self)->iterations );
+}
+
+
+/*
+ * ODE::IKChain#deltas
+ * --
+ * Returns the result of the last #solve: an Array with an entry for each of
+ * the chain's joints, which is the angle to turn a hinge by, an Array of
+ * the angles to turn a universal joint's first and second axes by, or the
+ * rotation (as a rotation vector, in world coordinates) to turn the tip side
+ * of a ball joint by.
+ */
+static VALUE
+ode_ikchain_deltas( self )
+	 VALUE self;
+{
+	ode_IKCHAIN	*ptr = get_ikchain( self );
+	ode_IKDOF	*dof;
+	VALUE		ary = rb_ary_new(), pair;
+	long		i;
+
+	for ( i = 0; i < ptr->count; i++ ) {
+		dof = ptr->dofs + i;
+
+		switch ( dof->type ) {
+		case dJointTypeHinge:
+			rb_ary_push( ary, rb_float_new(dof->delta[0] * dof->sign) );
+			break;
+
+		case dJointTypeUniversal:
+			pair = rb_ary_new2( 2 );
+			rb_ary_store( pair, dof->axis - 1, rb_float_new(dof->delta[0] * dof->sign) );
+			rb_ary_store( pair, ptr->dofs[i+1].axis - 1,
+						  rb_float_new(ptr->dofs[i+1].delta[0] * dof->sign) );
+			rb_ary_push( ary, pair );
+			i++;
+			break;
+
+		case dJointTypeBall:
+			rb_ary_push( ary, ode_vector3_to_rArray(dof->delta) );
+			break;
+		}
+	}
+
+	return ary;
+}
+
+
+/*
+ * ODE::IKChain#applyVelocities( timestep, gain=1.0 )
+ * --
+ * Set the motor velocities of the chain's joints so they'll make the turns
+ * found by the last #solve over the given <tt>timestep</tt>, scaled by
+ * <tt>gain</tt>. Hinges and universal joints get their own motors' velocity
+ * set; ball joints given with an ODE::AngularMotorJoint have each of its
+ * axes set to the rotation's component along it (so the motor's axes should
+ * be perpendicular), and those without one are left alone. The motors'
+ * fMax must be set for them to have any effect.
+ */
+static VALUE
+ode_ikchain_apply_velocities( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_IKCHAIN	*ptr = get_ikchain( self );
+	ode_IKDOF	*dof;
+	VALUE		timestep, gainObj;
+	dVector3	axis;
+	dReal		dt, gain = 1.0, scale;
+	long		i;
+	int			n;
+
+	rb_scan_args( argc, argv, "11", &timestep, &gainObj );
+	dt = (dReal)NUM2DBL( timestep );
+	CheckPositiveNonZeroNumber( dt, "timestep" );
+	if ( RTEST(gainObj) ) gain = (dReal)NUM2DBL( gainObj );
+	scale = gain / dt;
+
+	for ( i = 0; i < ptr->count; i++ ) {
+		dof = ptr->dofs + i;
+		if ( RTEST(dof->joint->obsolete) ) continue;
+
+		switch ( dof->type ) {
+		case dJointTypeHinge:
+			dJointSetHingeParam( dof->joint->id, dParamVel,
+								 dof->sign * dof->delta[0] * scale );
+			break;
+
+		case dJointTypeUniversal:
+			dJointSetUniversalParam( dof->joint->id, dParamVel + dParamGroup * (dof->axis - 1),
+									 dof->sign * dof->delta[0] * scale );
+			break;
+
+		case dJointTypeBall:
+			if ( !dof->motor || RTEST(dof->motor->obsolete) || !dof->motorSign ) break;
+			for ( n = 0; n < dJointGetAMotorNumAxes(dof->motor->id); n++ ) {
+				dJointGetAMotorAxis( dof->motor->id, n, axis );
+				dJointSetAMotorParam( dof->motor->id, dParamVel + dParamGroup * n,
+									  dof->motorSign * Dot3(axis, dof->delta) * scale );
+			}
+			break;
+		}
+	}
+
+	return self;
+}
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_ikchain()
+{
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeIKChain = rb_define_class_under( ode_mOde, "IKChain", rb_cObject );
+#endif
+
+	rb_define_alloc_func( ode_cOdeIKChain, ode_ikchain_s_alloc );
+
+	rb_define_method( ode_cOdeIKChain, "initialize", ode_ikchain_init, -1 );
+
+	rb_define_method( ode_cOdeIKChain, "joints", ode_ikchain_joints, 0 );
+	rb_define_method( ode_cOdeIKChain, "effector", ode_ikchain_effector, 0 );
+	rb_define_method( ode_cOdeIKChain, "solve", ode_ikchain_solve_m, -1 );
+	rb_define_method( ode_cOdeIKChain, "error", ode_ikchain_error_m, 0 );
+	rb_define_method( ode_cOdeIKChain, "iterations", ode_ikchain_iterations, 0 );
+	rb_define_method( ode_cOdeIKChain, "deltas", ode_ikchain_deltas, 0 );
+	rb_define_method( ode_cOdeIKChain, "applyVelocities", ode_ikchain_apply_velocities, -1 );
+	rb_define_alias ( ode_cOdeIKChain, "apply_velocities", "applyVelocities" );
+}
+
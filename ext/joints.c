@@ -27,6 +27,34 @@ static VALUE body2Sym;
 static VALUE torqueSym;
 static VALUE forceSym;
 
+/* ParameterizedJoint parameters, for the batch and Hash accessors */
+typedef struct {
+	const char	*name, *altName;
+	int			param, range;
+} ode_JOINTPARAM;
+
+#define ODE_PARAM_ANY			0
+#define ODE_PARAM_NONNEGATIVE	1
+#define ODE_PARAM_UNIT			2
+
+static ode_JOINTPARAM ode_joint_params[] = {
+	{ "loStop",			"lo_stop",			dParamLoStop,			ODE_PARAM_ANY },
+	{ "hiStop",			"hi_stop",			dParamHiStop,			ODE_PARAM_ANY },
+	{ "vel",			"vel",				dParamVel,				ODE_PARAM_ANY },
+	{ "fMax",			"f_max",			dParamFMax,				ODE_PARAM_NONNEGATIVE },
+	{ "fudgeFactor",	"fudge_factor",		dParamFudgeFactor,		ODE_PARAM_UNIT },
+	{ "bounce",			"bounce",			dParamBounce,			ODE_PARAM_UNIT },
+	{ "CFM",			"cfm",				dParamCFM,				ODE_PARAM_UNIT },
+	{ "stopERP",		"stop_erp",			dParamStopERP,			ODE_PARAM_UNIT },
+	{ "stopCFM",		"stop_cfm",			dParamStopCFM,			ODE_PARAM_UNIT },
+	{ "suspensionERP",	"suspension_erp",	dParamSuspensionERP,	ODE_PARAM_UNIT },
+	{ "suspensionCFM",	"suspension_cfm",	dParamSuspensionCFM,	ODE_PARAM_UNIT },
+	{ NULL, NULL, 0, 0 }
+};
+
+/* Parameter names (Symbols) -> table index and axis */
+static VALUE ode_joint_param_index = Qnil;
+
 /* --------------------------------------------------
  *  Forward declarations
  * -------------------------------------------------- */
@@ -56,12 +84,48 @@ ode_joint_alloc()
 	ptr->obsolete	= Qnil;
 	ptr->id			= NULL;
 	ptr->feedback	= NULL;
+	ptr->feedbackIndex = -1;
+	ptr->breakForce	= 0;
+	ptr->breakTorque = 0;
+	ptr->breakSteps	= 1;
+	ptr->overSteps	= 0;
 
 	debugMsg(( "Initialized ode_JOINT <%p>", ptr ));
 	return ptr;
 }
 
 
+/*
+ * Return the struct of the world the given joint belongs to, or NULL if it
+ * has already been destroyed (eg., when Ruby is shutting down).
+ */
+static ode_WORLD *
+ode_joint_world_struct( ptr )
+	 ode_JOINT *ptr;
+{
+	ode_WORLD	*worldPtr;
+
+	if ( TYPE(ptr->world) != T_DATA ) return NULL;
+	worldPtr = (ode_WORLD *)DATA_PTR( ptr->world );
+
+	return ( worldPtr && worldPtr->id ) ? worldPtr : NULL;
+}
+
+
+/*
+ * Stop exporting feedback for the given joint from its world.
+ */
+static void
+ode_joint_unregister_feedback( ptr )
+	 ode_JOINT *ptr;
+{
+	ode_WORLD	*worldPtr;
+
+	if ( ptr->feedbackIndex >= 0 && (worldPtr = ode_joint_world_struct(ptr)) )
+		ode_world_remove_feedback_joint( worldPtr, ptr );
+}
+
+
 /*
  * GC Mark function
  */
@@ -109,6 +173,7 @@ ode_joint_gc_free( ptr )
 		ptr->contact	= Qnil;
 		ptr->obsolete	= Qnil;
 
+		ode_joint_unregister_feedback( ptr );
 		if ( ptr->feedback ) xfree( ptr->feedback );
 		ptr->feedback	= NULL;
 
@@ -429,8 +494,12 @@ static VALUE
 ode_joint_make_obsolete( self )
 	 VALUE	self;
 {
-	ode_JOINT *ptr = get_joint( self );
+	ode_JOINT *ptr = check_joint( self );
+
+	/* Joints which broke are already obsolete when their group is emptied */
+	if ( !ptr ) rb_raise( rb_eRuntimeError, "uninitialized joint" );
 
+	ode_joint_unregister_feedback( ptr );
 	ptr->obsolete = Qtrue;
 	return Qtrue;
 }
@@ -515,7 +584,9 @@ ode_joint_feedback_enabled( self, value )
 	if ( RTEST(value) ) {
 		if ( ! ptr->feedback ) {
 			ptr->feedback = ALLOC( dJointFeedback );
+			MEMZERO( ptr->feedback, dJointFeedback, 1 );
 			dJointSetFeedback( ptr->id, ptr->feedback );
+			ode_world_add_feedback_joint( ode_get_world_struct(ptr->world), ptr );
 		} else {
 			rval = Qtrue;
 		}
@@ -523,6 +594,7 @@ ode_joint_feedback_enabled( self, value )
 
 	/* Otherwise, unset the feedback struct and free it */
 	else if ( ptr->feedback ) {
+		ode_joint_unregister_feedback( ptr );
 		dJointSetFeedback( ptr->id, 0 );
 		xfree( ptr->feedback );
 		ptr->feedback = 0;
@@ -534,6 +606,157 @@ ode_joint_feedback_enabled( self, value )
 }
 
 
+/*
+ * ODE::Joint#feedbackIndex
+ * --
+ * Returns the index of the joint's record in the buffer returned by
+ * ODE::World#jointFeedback, or <tt>nil</tt> if feedback isn't enabled for it.
+ */
+static VALUE
+ode_joint_feedback_index( self )
+	 VALUE self;
+{
+	ode_JOINT	*ptr = get_joint( self );
+
+	if ( ptr->feedbackIndex < 0 ) return Qnil;
+	return LONG2NUM( ptr->feedbackIndex );
+}
+
+
+/*
+ * Set one of the joint's break thresholds from a Ruby value (nil or a
+ * number the caller has checked is positive), turning feedback on if it's
+ * set.
+ */
+static void
+ode_joint_set_threshold( self, threshold, value )
+	 VALUE		self, value;
+	 dReal		*threshold;
+{
+	if ( NIL_P(value) ) {
+		*threshold = 0;
+		return;
+	}
+
+	*threshold = (dReal)NUM2DBL( value );
+	rb_funcall( self, rb_intern("feedback="), 1, Qtrue );
+}
+
+
+/*
+ * ODE::Joint#breakForce
+ * --
+ * Returns the force over which the joint breaks, or <tt>nil</tt> if it
+ * doesn't break under force.
+ */
+static VALUE
+ode_joint_break_force( self )
+	 VALUE self;
+{
+	ode_JOINT	*ptr = get_joint( self );
+
+	if ( ptr->breakForce <= 0 ) return Qnil;
+	return rb_float_new( ptr->breakForce );
+}
+
+
+/*
+ * ODE::Joint#breakForce=( force )
+ * --
+ * Make the joint break when the force it applies to either of its bodies is
+ * over <tt>force</tt> for #breakSteps steps in a row, or stop it breaking
+ * under force if <tt>force</tt> is <tt>nil</tt>. Setting a threshold turns
+ * feedback on (turning feedback off again stops the joint breaking).
+ * Thresholds are checked natively after every ODE::World#step; a joint that
+ * breaks is detached from its bodies, marked obsolete, and listed in
+ * ODE::World#brokenJoints.
+ */
+static VALUE
+ode_joint_break_force_eq( self, force )
+	 VALUE self, force;
+{
+	ode_JOINT	*ptr = get_joint( self );
+
+	if ( !NIL_P(force) )
+		CheckPositiveNonZeroNumber( NUM2DBL(force), "force" );
+	ode_joint_set_threshold( self, &ptr->breakForce, force );
+	return force;
+}
+
+
+/*
+ * ODE::Joint#breakTorque
+ * --
+ * Returns the torque over which the joint breaks, or <tt>nil</tt> if it
+ * doesn't break under torque.
+ */
+static VALUE
+ode_joint_break_torque( self )
+	 VALUE self;
+{
+	ode_JOINT	*ptr = get_joint( self );
+
+	if ( ptr->breakTorque <= 0 ) return Qnil;
+	return rb_float_new( ptr->breakTorque );
+}
+
+
+/*
+ * ODE::Joint#breakTorque=( torque )
+ * --
+ * Make the joint break when the torque it applies to either of its bodies
+ * is over <tt>torque</tt> for #breakSteps steps in a row, or stop it
+ * breaking under torque if <tt>torque</tt> is <tt>nil</tt>. See
+ * #breakForce=.
+ */
+static VALUE
+ode_joint_break_torque_eq( self, torque )
+	 VALUE self, torque;
+{
+	ode_JOINT	*ptr = get_joint( self );
+
+	if ( !NIL_P(torque) )
+		CheckPositiveNonZeroNumber( NUM2DBL(torque), "torque" );
+	ode_joint_set_threshold( self, &ptr->breakTorque, torque );
+	return torque;
+}
+
+
+/*
+ * ODE::Joint#breakSteps
+ * --
+ * Returns the number of steps in a row the joint's force or torque must be
+ * over its threshold for it to break (1 by default).
+ */
+static VALUE
+ode_joint_break_steps( self )
+	 VALUE self;
+{
+	ode_JOINT	*ptr = get_joint( self );
+	return INT2FIX( ptr->breakSteps );
+}
+
+
+/*
+ * ODE::Joint#breakSteps=( steps )
+ * --
+ * Set the number of steps in a row the joint's force or torque must be over
+ * its threshold for it to break, which filters out momentary spikes.
+ */
+static VALUE
+ode_joint_break_steps_eq( self, steps )
+	 VALUE self, steps;
+{
+	ode_JOINT	*ptr = get_joint( self );
+
+	CheckPositiveNonZeroNumber( NUM2DBL(steps), "steps" );
+	ptr->breakSteps = NUM2INT( steps );
+	ptr->overSteps = 0;
+
+	return steps;
+}
+
+
 /*
  *	Fetch the cached feedback hash from the joint, or create and cache a new
  *	one.
@@ -1355,6 +1578,336 @@ ode_paramJoint_SuspensionCFM_eq( self, value )
 
 
 
+/* --- ODE::ParameterizedJoint batch access ------------------------------ */
+
+/*
+ * Look up the get and set functions for the given ParameterizedJoint by its
+ * ODE joint type, and return the number of axes it has.
+ */
+int
+ode_paramJoint_functions( ptr, getParam, setParam )
+	 ode_JOINT	*ptr;
+	 dReal		(**getParam)( dJointID, int );
+	 void		(**setParam)( dJointID, int, dReal );
+{
+	switch ( dJointGetType(ptr->id) ) {
+	case dJointTypeHinge:
+		*getParam = dJointGetHingeParam;
+		*setParam = dJointSetHingeParam;
+		return 1;
+
+	case dJointTypeHinge2:
+		*getParam = dJointGetHinge2Param;
+		*setParam = dJointSetHinge2Param;
+		return 2;
+
+	case dJointTypeSlider:
+		*getParam = dJointGetSliderParam;
+		*setParam = dJointSetSliderParam;
+		return 1;
+
+	case dJointTypeAMotor:
+		*getParam = dJointGetAMotorParam;
+		*setParam = dJointSetAMotorParam;
+		return 3;
+
+	default:
+		rb_raise( rb_eTypeError, "wrong argument type %s (expected ODE::ParameterizedJoint)",
+				  rb_class2name(CLASS_OF( ptr->object )) );
+	}
+
+	return 0;
+}
+
+
+/*
+ * Look up the given parameter name (a Symbol or String, like :loStop,
+ * :lo_stop, or :lo_stop2) in the parameter table. Returns the table entry,
+ * and sets <tt>axis</tt> to the axis given by the name's suffix, or leaves it
+ * alone if it doesn't have one.
+ */
+static ode_JOINTPARAM *
+ode_paramJoint_lookup( name, axis )
+	 VALUE	name;
+	 int	*axis;
+{
+	VALUE	code;
+
+	if ( TYPE(name) == T_STRING )
+		name = ID2SYM( rb_intern(RSTRING(name)->ptr) );
+
+	code = rb_hash_aref( ode_joint_param_index, name );
+	if ( NIL_P(code) )
+		rb_raise( rb_eArgError, "unknown joint parameter %s",
+				  RSTRING(rb_inspect(name))->ptr );
+
+	if ( FIX2INT(code) >> 8 )
+		*axis = FIX2INT( code ) >> 8;
+
+	return ode_joint_params + ( FIX2INT(code) & 0xff );
+}
+
+
+/*
+ * Check <tt>value</tt> against the range of the given parameter.
+ */
+static dReal
+ode_paramJoint_check_value( param, value )
+	 ode_JOINTPARAM	*param;
+	 double			value;
+{
+	if ( param->range == ODE_PARAM_NONNEGATIVE )
+		CheckPositiveNumber( value, "value" );
+	if ( param->range == ODE_PARAM_UNIT )
+		CheckNumberBetween( value, "value", 0.0, 1.0 );
+
+	return (dReal)value;
+}
+
+
+/*
+ * Return the dParam number of the given parameter on the specified axis of
+ * a joint with <tt>axes</tt> axes, raising an IndexError if it hasn't got
+ * that axis.
+ */
+static int
+ode_paramJoint_param_number( ptr, param, axis, axes )
+	 ode_JOINT		*ptr;
+	 ode_JOINTPARAM	*param;
+	 int			axis, axes;
+{
+	if ( axis < 1 || axis > axes )
+		rb_raise( rb_eIndexError, "No such axis %d for %s",
+				  axis, rb_class2name(CLASS_OF(ptr->object)) );
+
+	return param->param + dParamGroup * ( axis - 1 );
+}
+
+
+/*
+ * ODE::ParameterizedJoint::setParams( joints, param, axis, values )
+ * --
+ * Set the parameter named by <tt>param</tt> (eg., <tt>:vel</tt> or
+ * <tt>:fMax</tt>) on the given <tt>axis</tt> of each of the <tt>joints</tt>
+ * to the corresponding value in <tt>values</tt>, which is either an Array of
+ * Numerics or a String of native doubles (as packed with 'd*'). Joints of
+ * different kinds can be mixed. Every joint and value is checked before any
+ * are set. Returns the number of joints set.
+ */
+static VALUE
+ode_paramJoint_s_set_params( klass, joints, name, axisObj, values )
+	 VALUE klass, joints, name, axisObj, values;
+{
+	ode_JOINTPARAM	*param;
+	ode_JOINT		*ptr;
+	dReal			(* getParam)( dJointID, int );
+	void			(* setParam)( dJointID, int, dReal );
+	double			*packed = NULL, value;
+	dReal			*checked;
+	VALUE			scratch;
+	long			i;
+	int				axis = NUM2INT( axisObj ), axes;
+
+	Check_Type( joints, T_ARRAY );
+	param = ode_paramJoint_lookup( name, &axis );
+
+	if ( TYPE(values) == T_STRING ) {
+		if ( RSTRING(values)->len != RARRAY(joints)->len * (long)sizeof(double) )
+			rb_raise( rb_eArgError, "expected %ld packed values, got %ld bytes",
+					  RARRAY(joints)->len, RSTRING(values)->len );
+		packed = (double *)RSTRING( values )->ptr;
+	} else {
+		Check_Type( values, T_ARRAY );
+		if ( RARRAY(values)->len != RARRAY(joints)->len )
+			rb_raise( rb_eArgError, "expected %ld values, got %ld",
+					  RARRAY(joints)->len, RARRAY(values)->len );
+	}
+
+	/* Check (and convert) everything first, so a bad joint or value
+	   doesn't leave the batch half set */
+	scratch = rb_str_new( 0, RARRAY(joints)->len * sizeof(dReal) );
+	checked = (dReal *)RSTRING( scratch )->ptr;
+
+	for ( i = 0; i < RARRAY(joints)->len; i++ ) {
+		ptr = get_joint( RARRAY(joints)->ptr[i] );
+		axes = ode_paramJoint_functions( ptr, &getParam, &setParam );
+		ode_paramJoint_param_number( ptr, param, axis, axes );
+
+		value = packed ? packed[i] : NUM2DBL( RARRAY(values)->ptr[i] );
+		checked[i] = ode_paramJoint_check_value( param, value );
+	}
+
+	for ( i = 0; i < RARRAY(joints)->len; i++ ) {
+		ptr = get_joint( RARRAY(joints)->ptr[i] );
+		axes = ode_paramJoint_functions( ptr, &getParam, &setParam );
+		(setParam)( ptr->id, ode_paramJoint_param_number(ptr, param, axis, axes),
+					checked[i] );
+	}
+
+	return LONG2NUM( RARRAY(joints)->len );
+}
+
+
+/*
+ * ODE::ParameterizedJoint::getParams( joints, param, axis=1, buffer=nil )
+ * --
+ * Returns the value of the parameter named by <tt>param</tt> on the given
+ * <tt>axis</tt> of each of the <tt>joints</tt>, as a String of native
+ * doubles (unpack it with 'd*'). If a <tt>buffer</tt> String is given, its
+ * contents are replaced with the values and it's returned instead.
+ */
+static VALUE
+ode_paramJoint_s_get_params( argc, argv, klass )
+	 int	argc;
+	 VALUE	*argv, klass;
+{
+	VALUE			joints, name, axisObj, buffer;
+	ode_JOINTPARAM	*param;
+	ode_JOINT		*ptr;
+	dReal			(* getParam)( dJointID, int );
+	void			(* setParam)( dJointID, int, dReal );
+	double			*out;
+	long			i;
+	int				axis = 1, axes;
+
+	rb_scan_args( argc, argv, "22", &joints, &name, &axisObj, &buffer );
+	Check_Type( joints, T_ARRAY );
+	if ( RTEST(axisObj) ) axis = NUM2INT( axisObj );
+	param = ode_paramJoint_lookup( name, &axis );
+
+	if ( NIL_P(buffer) )
+		buffer = rb_str_new( 0, 0 );
+	else
+		StringValue( buffer );
+
+	rb_str_modify( buffer );
+	rb_str_resize( buffer, RARRAY(joints)->len * sizeof(double) );
+	out = (double *)RSTRING( buffer )->ptr;
+
+	for ( i = 0; i < RARRAY(joints)->len; i++ ) {
+		ptr = get_joint( RARRAY(joints)->ptr[i] );
+		axes = ode_paramJoint_functions( ptr, &getParam, &setParam );
+		out[i] = (getParam)( ptr->id, ode_paramJoint_param_number(ptr, param, axis, axes) );
+	}
+
+	return buffer;
+}
+
+
+/*
+ * ODE::ParameterizedJoint#params( axis=1 )
+ * --
+ * Returns a Hash of all of the joint's parameters on the given axis, keyed
+ * by Symbols like <tt>:lo_stop</tt>.
+ */
+static VALUE
+ode_paramJoint_params( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_JOINT		*ptr = get_joint( self );
+	dReal			(* getParam)( dJointID, int );
+	void			(* setParam)( dJointID, int, dReal );
+	ode_JOINTPARAM	*param;
+	VALUE			axisObj, hash = rb_hash_new();
+	int				axis = 1, axes;
+
+	if ( rb_scan_args(argc, argv, "01", &axisObj) ) axis = NUM2INT( axisObj );
+	axes = ode_paramJoint_functions( ptr, &getParam, &setParam );
+
+	for ( param = ode_joint_params; param->name; param++ )
+		rb_hash_aset( hash, ID2SYM(rb_intern(param->altName)),
+					  rb_float_new((getParam)( ptr->id,
+						  ode_paramJoint_param_number(ptr, param, axis, axes) )) );
+
+	return hash;
+}
+
+
+/*
+ * ODE::ParameterizedJoint#params=( hash )
+ * --
+ * Set several of the joint's parameters at once from a Hash keyed by their
+ * names, eg.,
+ *
+ *   joint.params = { :lo_stop => -0.5, :hi_stop => 0.5, :vel2 => 1.0 }
+ *
+ * A name's numeric suffix (as in <tt>:vel2</tt>) selects the axis; names
+ * without one set the first axis. Every name and value is checked before
+ * any are set.
+ */
+static VALUE
+ode_paramJoint_params_eq( self, hash )
+	 VALUE self, hash;
+{
+	ode_JOINT		*ptr = get_joint( self );
+	dReal			(* getParam)( dJointID, int );
+	void			(* setParam)( dJointID, int, dReal );
+	ode_JOINTPARAM	*param;
+	VALUE			keys, key, numberScratch, valueScratch;
+	dReal			*checked;
+	int				*numbers;
+	long			i;
+	int				axis, axes;
+
+	Check_Type( hash, T_HASH );
+	axes = ode_paramJoint_functions( ptr, &getParam, &setParam );
+	keys = rb_funcall( hash, rb_intern("keys"), 0 );
+
+	numberScratch = rb_str_new( 0, RARRAY(keys)->len * sizeof(int) );
+	valueScratch = rb_str_new( 0, RARRAY(keys)->len * sizeof(dReal) );
+	numbers = (int *)RSTRING( numberScratch )->ptr;
+	checked = (dReal *)RSTRING( valueScratch )->ptr;
+
+	for ( i = 0; i < RARRAY(keys)->len; i++ ) {
+		key = RARRAY(keys)->ptr[i];
+		axis = 1;
+		param = ode_paramJoint_lookup( key, &axis );
+
+		numbers[i] = ode_paramJoint_param_number( ptr, param, axis, axes );
+		checked[i] = ode_paramJoint_check_value( param, NUM2DBL(rb_hash_aref(hash, key)) );
+	}
+
+	for ( i = 0; i < RARRAY(keys)->len; i++ )
+		(setParam)( ptr->id, numbers[i], checked[i] );
+
+	return hash;
+}
+
+
+/*
+ * Build the index of parameter names used by ode_paramJoint_lookup(): each
+ * name in both of its spellings, bare and with axis suffixes, mapped to its
+ * table index with the axis in the high bits.
+ */
+static void
+ode_paramJoint_build_index()
+{
+	ode_JOINTPARAM	*param;
+	const char		*names[2];
+	char			buf[64];
+	int				index, axis, n;
+
+	ode_joint_param_index = rb_hash_new();
+	rb_global_variable( &ode_joint_param_index );
+
+	for ( param = ode_joint_params, index = 0; param->name; param++, index++ ) {
+		names[0] = param->name;
+		names[1] = param->altName;
+
+		for ( n = 0; n < 2; n++ ) {
+			rb_hash_aset( ode_joint_param_index, ID2SYM(rb_intern(names[n])), INT2FIX(index) );
+			for ( axis = 1; axis <= 3; axis++ ) {
+				snprintf( buf, sizeof(buf), "%s%d", names[n], axis );
+				rb_hash_aset( ode_joint_param_index, ID2SYM(rb_intern(buf)),
+							  INT2FIX(index | (axis << 8)) );
+			}
+		}
+	}
+}
+
+
+
 /* --- ODE::HingeJoint ------------------------------ */
 
 /*
@@ -2204,6 +2757,20 @@ ode_init_joints( void )
 	rb_define_alias ( ode_cOdeJoint, "feedback_enabled=", "feedback=" );
 	rb_define_method( ode_cOdeJoint, "feedback?", ode_joint_feedback_enabled_p, 0 );
 	rb_define_alias ( ode_cOdeJoint, "feedback_enabled?", "feedback?" );
+	rb_define_method( ode_cOdeJoint, "feedbackIndex", ode_joint_feedback_index, 0 );
+	rb_define_alias ( ode_cOdeJoint, "feedback_index", "feedbackIndex" );
+	rb_define_method( ode_cOdeJoint, "breakForce", ode_joint_break_force, 0 );
+	rb_define_alias ( ode_cOdeJoint, "break_force", "breakForce" );
+	rb_define_method( ode_cOdeJoint, "breakForce=", ode_joint_break_force_eq, 1 );
+	rb_define_alias ( ode_cOdeJoint, "break_force=", "breakForce=" );
+	rb_define_method( ode_cOdeJoint, "breakTorque", ode_joint_break_torque, 0 );
+	rb_define_alias ( ode_cOdeJoint, "break_torque", "breakTorque" );
+	rb_define_method( ode_cOdeJoint, "breakTorque=", ode_joint_break_torque_eq, 1 );
+	rb_define_alias ( ode_cOdeJoint, "break_torque=", "breakTorque=" );
+	rb_define_method( ode_cOdeJoint, "breakSteps", ode_joint_break_steps, 0 );
+	rb_define_alias ( ode_cOdeJoint, "break_steps", "breakSteps" );
+	rb_define_method( ode_cOdeJoint, "breakSteps=", ode_joint_break_steps_eq, 1 );
+	rb_define_alias ( ode_cOdeJoint, "break_steps=", "breakSteps=" );
 
 	/* ODE::BallJoint class */
 	rb_define_method( ode_cOdeBallJoint, "initialize", ode_ballJoint_init, -1 );
@@ -2322,6 +2889,15 @@ ode_init_joints( void )
 	rb_define_method( ode_cOdeParamJoint, "suspensionCFM2=", ode_paramJoint_SuspensionCFM_eq, 1 );
 	rb_define_method( ode_cOdeParamJoint, "suspensionCFM3=", ode_paramJoint_SuspensionCFM_eq, 1 );
 
+	/* Batch and Hash access */
+	ode_paramJoint_build_index();
+	rb_define_singleton_method( ode_cOdeParamJoint, "setParams", ode_paramJoint_s_set_params, 4 );
+	rb_define_singleton_method( ode_cOdeParamJoint, "set_params", ode_paramJoint_s_set_params, 4 );
+	rb_define_singleton_method( ode_cOdeParamJoint, "getParams", ode_paramJoint_s_get_params, -1 );
+	rb_define_singleton_method( ode_cOdeParamJoint, "get_params", ode_paramJoint_s_get_params, -1 );
+	rb_define_method( ode_cOdeParamJoint, "params", ode_paramJoint_params, -1 );
+	rb_define_method( ode_cOdeParamJoint, "params=", ode_paramJoint_params_eq, 1 );
+
 
 	/* ODE::HingeJoint class */
 	rb_define_const( ode_cOdeHingeJoint, "Axes", INT2FIX(1) );
@@ -0,0 +1,301 @@
+/*
+ *		manifold.c - ODE Ruby Binding - Contact manifold reduction
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 16:21:54 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+#include <math.h>
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* Reduction settings for a pair of surfaces (either of which may be nil,
+   matching any surface) */
+typedef struct {
+	VALUE	surface1, surface2;
+	int		maxPoints;
+	dReal	tolerance;
+} ode_MANIFOLDRULE;
+
+/* The reduction settings, and an Array which keeps their surfaces alive */
+static ode_MANIFOLDRULE	*ode_manifold_rules = NULL;
+static long				ode_manifold_rule_count = 0;
+static VALUE			ode_manifold_surfaces = Qnil;
+
+
+/* --------------------------------------------------
+ * Reduction
+ * -------------------------------------------------- */
+
+/*
+ * Find the rule that applies to the given pair of surfaces (nil for a
+ * geometry without one): an exact match in either order, then one that
+ * matches one surface and has nil for the other, then the nil/nil default.
+ * Returns NULL if none applies.
+ */
+static ode_MANIFOLDRULE *
+ode_manifold_find_rule( surface1, surface2 )
+	 VALUE surface1, surface2;
+{
+	ode_MANIFOLDRULE	*rule, *partial = NULL, *fallback = NULL;
+	long				i;
+
+	for ( i = 0; i < ode_manifold_rule_count; i++ ) {
+		rule = ode_manifold_rules + i;
+
+		if ( (rule->surface1 == surface1 && rule->surface2 == surface2) ||
+			 (rule->surface1 == surface2 && rule->surface2 == surface1) )
+			return rule;
+
+		if ( NIL_P(rule->surface1) && NIL_P(rule->surface2) )
+			fallback = rule;
+		else if ( NIL_P(rule->surface2) &&
+				  (rule->surface1 == surface1 || rule->surface1 == surface2) )
+			partial = rule;
+		else if ( NIL_P(rule->surface1) &&
+				  (rule->surface2 == surface1 || rule->surface2 == surface2) )
+			partial = rule;
+	}
+
+	return partial ? partial : fallback;
+}
+
+
+/*
+ * Area of the triangle (a, b, c), doubled.
+ */
+static dReal
+ode_manifold_area2( a, b, c )
+	 const dReal *a, *b, *c;
+{
+	dReal	ab[3], ac[3], n[3];
+
+	Sub3( ab, b, a );
+	Sub3( ac, c, a );
+	Cross3( n, ab, ac );
+
+	return (dReal)sqrt( Dot3(n, n) );
+}
+
+
+/*
+ * Reduce the <tt>count</tt> contacts between <tt>geom1</tt> and
+ * <tt>geom2</tt> in place according to the rule for their surfaces, if there
+ * is one: first merge contacts closer together than the rule's tolerance
+ * (keeping the deeper one), then, if there are still more than its maximum,
+ * keep the deepest contact and the ones which span the largest area with it.
+ * Returns the new number of contacts. Makes no Ruby calls, so it's safe to
+ * call from the collision threads.
+ */
+int
+ode_manifold_reduce( contacts, count, geom1, geom2 )
+	 dContactGeom	*contacts;
+	 int			count;
+	 ode_GEOMETRY	*geom1, *geom2;
+{
+	ode_MANIFOLDRULE	*rule;
+	dContactGeom		tmp;
+	dReal				d[3], tol2, score, best, area;
+	int					i, j, k, kept, chosen, bestIndex;
+
+	if ( count < 2 || !ode_manifold_rule_count ) return count;
+	if ( !(rule = ode_manifold_find_rule(geom1->surface, geom2->surface)) )
+		return count;
+
+	/* Merge close contacts, keeping the deepest of each cluster */
+	tol2 = rule->tolerance * rule->tolerance;
+	if ( tol2 > 0 ) {
+		for ( kept = 0, i = 0; i < count; i++ ) {
+			for ( j = 0; j < kept; j++ ) {
+				Sub3( d, contacts[i].pos, contacts[j].pos );
+				if ( Dot3(d, d) <= tol2 ) break;
+			}
+
+			if ( j < kept ) {
+				if ( contacts[i].depth > contacts[j].depth )
+					contacts[j] = contacts[i];
+			} else {
+				contacts[ kept++ ] = contacts[i];
+			}
+		}
+		count = kept;
+	}
+
+	if ( count <= rule->maxPoints ) return count;
+
+	/* Move the deepest contact to the front */
+	for ( bestIndex = 0, i = 1; i < count; i++ )
+		if ( contacts[i].depth > contacts[bestIndex].depth ) bestIndex = i;
+	tmp = contacts[0]; contacts[0] = contacts[bestIndex]; contacts[bestIndex] = tmp;
+
+	/* Then greedily choose the contact which adds the most area to those
+	   already chosen: the furthest from the deepest for the second, and the
+	   largest triangle with any two chosen ones after that */
+	for ( chosen = 1; chosen < rule->maxPoints; chosen++ ) {
+		best = -1;
+		bestIndex = chosen;
+
+		for ( i = chosen; i < count; i++ ) {
+			if ( chosen == 1 ) {
+				Sub3( d, contacts[i].pos, contacts[0].pos );
+				score = Dot3( d, d );
+			} else {
+				score = 0;
+				for ( j = 0; j < chosen; j++ )
+					for ( k = j + 1; k < chosen; k++ ) {
+						area = ode_manifold_area2( contacts[j].pos, contacts[k].pos,
+												   contacts[i].pos );
+						if ( area > score ) score = area;
+					}
+			}
+
+			if ( score > best ) {
+				best = score;
+				bestIndex = i;
+			}
+		}
+
+		tmp = contacts[chosen];
+		contacts[chosen] = contacts[bestIndex];
+		contacts[bestIndex] = tmp;
+	}
+
+	return rule->maxPoints;
+}
+
+
+
+/* --------------------------------------------------
+ * Class Methods
+ * -------------------------------------------------- */
+
+/*
+ * ODE::Surface::setManifoldReduction( surface1, surface2, maxPoints, tolerance=0.0 )
+ * --
+ * Reduce the contacts generated between geometries with the given surfaces
+ * (ODE::Surface objects, or nil to match any surface) by ODE::Space#collide
+ * and ODE::Geometry#collideWith: contacts closer together than
+ * <tt>tolerance</tt> are merged into the deepest of them, and of what's left,
+ * only the deepest and the <tt>maxPoints - 1</tt> others spanning the most
+ * area with it are kept. Fewer contacts means fewer constraint rows for the
+ * world step to solve. Setting <tt>maxPoints</tt> to nil removes the rule.
+ *
+ * The rule for an exact pair of surfaces wins over one naming only one of
+ * them, which in turn wins over the default set with two nils.
+ */
+static VALUE
+ode_surface_s_set_manifold_reduction( argc, argv, klass )
+	 int	argc;
+	 VALUE	*argv, klass;
+{
+	VALUE				surface1, surface2, maxPoints, tolerance;
+	ode_MANIFOLDRULE	*rule = NULL;
+	long				i;
+
+	rb_scan_args( argc, argv, "31", &surface1, &surface2, &maxPoints, &tolerance );
+
+	if ( !NIL_P(surface1) ) CheckKindOf( surface1, ode_cOdeSurface );
+	if ( !NIL_P(surface2) ) CheckKindOf( surface2, ode_cOdeSurface );
+	if ( !NIL_P(maxPoints) )
+		CheckPositiveNonZeroNumber( NUM2DBL(maxPoints), "maxPoints" );
+	if ( RTEST(tolerance) )
+		CheckPositiveNumber( NUM2DBL(tolerance), "tolerance" );
+
+	for ( i = 0; i < ode_manifold_rule_count; i++ ) {
+		if ( (ode_manifold_rules[i].surface1 == surface1 &&
+			  ode_manifold_rules[i].surface2 == surface2) ||
+			 (ode_manifold_rules[i].surface1 == surface2 &&
+			  ode_manifold_rules[i].surface2 == surface1) ) {
+			rule = ode_manifold_rules + i;
+			break;
+		}
+	}
+
+	/* Removing a rule */
+	if ( NIL_P(maxPoints) ) {
+		if ( rule ) {
+			*rule = ode_manifold_rules[ --ode_manifold_rule_count ];
+			rb_ary_clear( ode_manifold_surfaces );
+			for ( i = 0; i < ode_manifold_rule_count; i++ ) {
+				rb_ary_push( ode_manifold_surfaces, ode_manifold_rules[i].surface1 );
+				rb_ary_push( ode_manifold_surfaces, ode_manifold_rules[i].surface2 );
+			}
+		}
+		return Qnil;
+	}
+
+	if ( !rule ) {
+		REALLOC_N( ode_manifold_rules, ode_MANIFOLDRULE, ode_manifold_rule_count + 1 );
+		rule = ode_manifold_rules + ode_manifold_rule_count++;
+		rule->surface1 = surface1;
+		rule->surface2 = surface2;
+		rb_ary_push( ode_manifold_surfaces, surface1 );
+		rb_ary_push( ode_manifold_surfaces, surface2 );
+	}
+
+	rule->maxPoints = NUM2INT( maxPoints );
+	rule->tolerance = RTEST(tolerance) ? (dReal)NUM2DBL( tolerance ) : 0;
+
+	return rb_ary_new3( 2, maxPoints, rb_float_new(rule->tolerance) );
+}
+
+
+/*
+ * ODE::Surface::manifoldReduction( surface1, surface2 )
+ * --
+ * Returns the <tt>[maxPoints, tolerance]</tt> of the manifold reduction rule
+ * which applies to contacts between geometries with the given surfaces (or
+ * nil), or nil if none does. See ::setManifoldReduction.
+ */
+static VALUE
+ode_surface_s_manifold_reduction( klass, surface1, surface2 )
+	 VALUE klass, surface1, surface2;
+{
+	ode_MANIFOLDRULE	*rule = ode_manifold_find_rule( surface1, surface2 );
+
+	if ( !rule ) return Qnil;
+	return rb_ary_new3( 2, INT2FIX(rule->maxPoints), rb_float_new(rule->tolerance) );
+}
+
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_manifold()
+{
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeSurface = rb_define_class_under( ode_mOde, "Surface", rb_cObject );
+#endif
+
+	ode_manifold_surfaces = rb_ary_new();
+	rb_global_variable( &ode_manifold_surfaces );
+
+	rb_define_singleton_method( ode_cOdeSurface, "setManifoldReduction",
+								ode_surface_s_set_manifold_reduction, -1 );
+	rb_define_singleton_method( ode_cOdeSurface, "set_manifold_reduction",
+								ode_surface_s_set_manifold_reduction, -1 );
+	rb_define_singleton_method( ode_cOdeSurface, "manifoldReduction",
+								ode_surface_s_manifold_reduction, 2 );
+	rb_define_singleton_method( ode_cOdeSurface, "manifold_reduction",
+								ode_surface_s_manifold_reduction, 2 );
+}
+
@@ -49,11 +49,19 @@ VALUE ode_cOdeHingeJoint;
 VALUE ode_cOdeHinge2Joint;
 VALUE ode_cOdeSliderJoint;
 VALUE ode_cOdeAMotorJoint;
+VALUE ode_cOdeServo;
+VALUE ode_cOdeArticulation;
+VALUE ode_cOdeTimeline;
+VALUE ode_cOdeIKChain;
+VALUE ode_cOdeSpring;
+VALUE ode_cOdeRope;
+VALUE ode_cOdeVehicle;
 
 VALUE ode_cOdeMass;
 VALUE ode_cOdeMassBox;
 VALUE ode_cOdeMassSphere;
 VALUE ode_cOdeMassCapsule;
+VALUE ode_cOdeMassConvex;
 
 VALUE ode_cOdeContact;
 VALUE ode_cOdePlaceable;
@@ -64,7 +72,11 @@ VALUE ode_cOdeGeometryPlane;
 VALUE ode_cOdeGeometryCapCyl;
 VALUE ode_cOdeGeometryCylinder;	/* Optional ODE extension */
 VALUE ode_cOdeGeometryRay;
+VALUE ode_cOdeGeometryTriMesh;	/* Optional ODE feature */
+VALUE ode_cOdeGeometryHeightfield; /* Optional ODE feature */
+VALUE ode_cOdeGeometryConvex;	/* Optional ODE feature */
 VALUE ode_cOdeGeometryTransform;
+VALUE ode_cOdeGeometryCompound;
 VALUE ode_cOdeGeometryTransformGroup; /* Optional ODE extension */
 VALUE ode_cOdeSpace;
 VALUE ode_cOdeHashSpace;
@@ -72,6 +84,10 @@ VALUE ode_cOdeHashSpace;
 VALUE ode_cOdeSurface;
 VALUE ode_cOdeContact;
 
+VALUE ode_cOdeTriMeshData;
+VALUE ode_cOdeHeightfieldData;
+VALUE ode_cOdeConvexData;
+
 /* 
  * Hack to work around various Ruby variables being static.
  */
@@ -245,6 +261,30 @@ ode_check_arity( block, minArity )
 }
 
 
+/*
+ * Map a buffer precision Symbol (:single or :double) to a boolean 'isDouble'
+ * flag. A <tt>nil</tt> precision means :single.
+ */
+int
+ode_precision_flag( precision )
+	 VALUE precision;
+{
+	ID	id;
+
+	if ( !RTEST(precision) ) return 0;
+
+	id = rb_to_id( precision );
+	if ( id == rb_intern("single") || id == rb_intern("float") )
+		return 0;
+	else if ( id == rb_intern("double") )
+		return 1;
+
+	rb_raise( rb_eArgError, "unknown buffer precision '%s' (expected :single or :double)",
+			  rb_id2name(id) );
+}
+
+
+#if DEBUG
 /*
  * Return a string containing the class name associated with a given dGeomID.
  */ 
@@ -276,6 +316,12 @@ ode_get_geom_class( obj )
 		class = "Infinite plane (non-placeable)";
 		break;
 
+#ifdef HAVE_CONVEX_GEOM
+	case dConvexClass:
+		class = "Convex hull";
+		break;
+#endif
+
 	case dGeomTransformClass:
 		class = "Geometry transform";
 		break;
@@ -288,6 +334,12 @@ ode_get_geom_class( obj )
 		class = "Triangle mesh";
 		break;
 
+#ifdef HAVE_HEIGHTFIELD_GEOM
+	case dHeightfieldClass:
+		class = "Heightfield";
+		break;
+#endif
+
 	case dSimpleSpaceClass:
 		class = "Simple space";
 		break;
@@ -302,6 +354,7 @@ ode_get_geom_class( obj )
 
 	return class;
 }
+#endif /* DEBUG */
 
 
 /*
@@ -315,12 +368,9 @@ ode_near_callback( callback, o1, o2 )
 	 dGeomID		o1, o2;
 {
 	ode_GEOMETRY		*geom1, *geom2;
-	static const char	*class1, *class2;
 
-	class1 = ode_get_geom_class( o1 );
-	class2 = ode_get_geom_class( o2 );
-
-	debugMsg(( "In near callback with %p (%s) and %p (%s).", o1, class1, o2, class2 ));
+	debugMsg(( "In near callback with %p (%s) and %p (%s).",
+			   o1, ode_get_geom_class(o1), o2, ode_get_geom_class(o2) ));
 
 	geom1 = dGeomGetData( o1 );
 	geom2 = dGeomGetData( o2 );
@@ -343,6 +393,16 @@ Init_ode()
 
 	ode_debug( "Loading Ruby ODE binding" );
 
+#ifdef HAVE_DINITODE2
+	/* Initialize the library, and give the interpreter's thread its own
+	   collider data: it runs dCollide() for Ruby-level collision, ray casts,
+	   CCD sweeps and distance queries, as well as the parts of a collision
+	   pass the worker threads don't take. */
+	dInitODE2( 0 );
+	if ( !dAllocateODEDataForThread(dAllocateMaskAll) )
+		rb_raise( rb_eNoMemError, "couldn't allocate ODE thread data" );
+#endif
+
 	/* Modules */
 	ode_mOde = rb_define_module( "ODE" );
 
@@ -369,6 +429,26 @@ Init_ode()
 	rb_hash_aset( features, ID2SYM(rb_intern("GeomTransformGroup")), Qtrue );
 #else
 	rb_hash_aset( features, ID2SYM(rb_intern("GeomTransformGroup")), Qfalse );
+#endif	
+#ifdef HAVE_TRIMESH_GEOM
+	rb_hash_aset( features, ID2SYM(rb_intern("TriMesh")), Qtrue );
+#else
+	rb_hash_aset( features, ID2SYM(rb_intern("TriMesh")), Qfalse );
+#endif	
+#ifdef HAVE_HEIGHTFIELD_GEOM
+	rb_hash_aset( features, ID2SYM(rb_intern("Heightfield")), Qtrue );
+#else
+	rb_hash_aset( features, ID2SYM(rb_intern("Heightfield")), Qfalse );
+#endif	
+#ifdef HAVE_CONVEX_GEOM
+	rb_hash_aset( features, ID2SYM(rb_intern("Convex")), Qtrue );
+#else
+	rb_hash_aset( features, ID2SYM(rb_intern("Convex")), Qfalse );
+#endif	
+#ifdef HAVE_THREADED_COLLISION
+	rb_hash_aset( features, ID2SYM(rb_intern("ThreadedCollision")), Qtrue );
+#else
+	rb_hash_aset( features, ID2SYM(rb_intern("ThreadedCollision")), Qfalse );
 #endif	
 	rb_obj_freeze( features );
 	rb_const_set( ode_mOde, rb_intern("Features"), features );
@@ -427,11 +507,19 @@ Init_ode()
 	ode_cOdeHinge2Joint		= rb_define_class_under( ode_mOde, "Hinge2Joint", ode_cOdeParamJoint );
 	ode_cOdeSliderJoint		= rb_define_class_under( ode_mOde, "SliderJoint", ode_cOdeParamJoint );
 	ode_cOdeAMotorJoint		= rb_define_class_under( ode_mOde, "AngularMotorJoint", ode_cOdeParamJoint );
+	ode_cOdeServo			= rb_define_class_under( ode_mOde, "Servo", rb_cObject );
+	ode_cOdeArticulation	= rb_define_class_under( ode_mOde, "Articulation", rb_cObject );
+	ode_cOdeTimeline		= rb_define_class_under( ode_mOde, "Timeline", rb_cObject );
+	ode_cOdeIKChain			= rb_define_class_under( ode_mOde, "IKChain", rb_cObject );
+	ode_cOdeSpring			= rb_define_class_under( ode_mOde, "Spring", rb_cObject );
+	ode_cOdeRope			= rb_define_class_under( ode_mOde, "Rope", rb_cObject );
+	ode_cOdeVehicle			= rb_define_class_under( ode_mOde, "Vehicle", rb_cObject );
 
 	ode_cOdeMass			= rb_define_class_under( ode_mOde, "Mass", rb_cObject );
 	ode_cOdeMassBox			= rb_define_class_under( ode_cOdeMass, "Box", ode_cOdeMass );
 	ode_cOdeMassSphere		= rb_define_class_under( ode_cOdeMass, "Sphere", ode_cOdeMass );
 	ode_cOdeMassCapsule		= rb_define_class_under( ode_cOdeMass, "Capsule", ode_cOdeMass );
+	ode_cOdeMassConvex		= rb_define_class_under( ode_cOdeMass, "Convex", ode_cOdeMass );
 
 	/* ODE Collision classes */
 	ode_cOdeContact			= rb_define_class_under( ode_mOde, "Contact", rb_cObject );
@@ -445,8 +533,12 @@ Init_ode()
 	ode_cOdeGeometryCapCyl	= rb_define_class_under( ode_cOdeGeometry, "Capsule", ode_cOdePlaceable );
 	ode_cOdeGeometryCylinder = rb_define_class_under( ode_cOdeGeometry, "Cylinder", ode_cOdePlaceable );
 	ode_cOdeGeometryRay		= rb_define_class_under( ode_cOdeGeometry, "Ray", ode_cOdePlaceable );
+	ode_cOdeGeometryTriMesh	= rb_define_class_under( ode_cOdeGeometry, "TriMesh", ode_cOdePlaceable );
+	ode_cOdeGeometryHeightfield = rb_define_class_under( ode_cOdeGeometry, "Heightfield", ode_cOdePlaceable );
+	ode_cOdeGeometryConvex	= rb_define_class_under( ode_cOdeGeometry, "Convex", ode_cOdePlaceable );
 
-	ode_cOdeGeometryTransform = rb_define_class_under( ode_cOdeGeometry, "Transform", ode_cOdeGeometry );
+	ode_cOdeGeometryTransform = rb_define_class_under( ode_cOdeGeometry, "Transform", ode_cOdePlaceable );
+	ode_cOdeGeometryCompound = rb_define_class_under( ode_cOdeGeometry, "Compound", ode_cOdePlaceable );
 	ode_cOdeGeometryTransformGroup = rb_define_class_under( ode_cOdeGeometry, "TransformGroup", ode_cOdeGeometry );
 
 	ode_cOdeSpace			= rb_define_class_under( ode_mOde, "Space", ode_cOdeGeometry );
@@ -455,6 +547,10 @@ Init_ode()
 	ode_cOdeContact			= rb_define_class_under( ode_mOde, "Contact", rb_cObject );
 	ode_cOdeSurface			= rb_define_class_under( ode_mOde, "Surface", rb_cObject );
 
+	ode_cOdeTriMeshData		= rb_define_class_under( ode_mOde, "TriMeshData", rb_cObject );
+	ode_cOdeHeightfieldData	= rb_define_class_under( ode_mOde, "HeightfieldData", rb_cObject );
+	ode_cOdeConvexData		= rb_define_class_under( ode_mOde, "ConvexData", rb_cObject );
+
 	/* Init the other modules */
 	ode_init_world();
 	ode_init_space();
@@ -465,7 +561,21 @@ Init_ode()
 	ode_init_contact();
 	ode_init_surface();
 	ode_init_geometry();
+	ode_init_trimesh();
+	ode_init_heightfield();
+	ode_init_convex();
 	ode_init_space();
-/* 	ode_init_geometry_transform(); */
+	ode_init_collision();
+	ode_init_manifold();
+	ode_init_ccd();
+	ode_init_distance();
+	ode_init_servo();
+	ode_init_articulation();
+	ode_init_timeline();
+	ode_init_ikchain();
+	ode_init_spring();
+	ode_init_rope();
+	ode_init_vehicle();
+	ode_init_geometry_transform();
  	ode_init_geometry_transform_group();
 }
@@ -27,6 +27,7 @@
 // #include <version.h>			/* Check version for alloc framework */
 
 #include "ode/ode.h"
+#include "rubyode.h"
 
 /* Debugging functions/macros */
 #ifdef HAVE_STDARG_PROTOTYPES
@@ -92,11 +93,19 @@ extern VALUE ode_cOdeHingeJoint;
 extern VALUE ode_cOdeHinge2Joint;
 extern VALUE ode_cOdeSliderJoint;
 extern VALUE ode_cOdeAMotorJoint;
+extern VALUE ode_cOdeServo;
+extern VALUE ode_cOdeArticulation;
+extern VALUE ode_cOdeTimeline;
+extern VALUE ode_cOdeIKChain;
+extern VALUE ode_cOdeSpring;
+extern VALUE ode_cOdeRope;
+extern VALUE ode_cOdeVehicle;
 
 extern VALUE ode_cOdeMass;
 extern VALUE ode_cOdeMassBox;
 extern VALUE ode_cOdeMassSphere;
 extern VALUE ode_cOdeMassCapsule;
+extern VALUE ode_cOdeMassConvex;
 
 extern VALUE ode_cOdeContact;
 
@@ -108,7 +117,11 @@ extern VALUE ode_cOdeGeometryPlane;
 extern VALUE ode_cOdeGeometryCapCyl;
 extern VALUE ode_cOdeGeometryCylinder; /* Optional ODE extension */
 extern VALUE ode_cOdeGeometryRay;
+extern VALUE ode_cOdeGeometryTriMesh; /* Optional ODE feature */
+extern VALUE ode_cOdeGeometryHeightfield; /* Optional ODE feature */
+extern VALUE ode_cOdeGeometryConvex; /* Optional ODE feature */
 extern VALUE ode_cOdeGeometryTransform;
+extern VALUE ode_cOdeGeometryCompound;
 extern VALUE ode_cOdeGeometryTransformGroup; /* Optional ODE extension */
 extern VALUE ode_cOdeSpace;
 extern VALUE ode_cOdeHashSpace;
@@ -116,31 +129,223 @@ extern VALUE ode_cOdeHashSpace;
 extern VALUE ode_cOdeSurface;
 extern VALUE ode_cOdeContact;
 
+extern VALUE ode_cOdeTriMeshData;
+extern VALUE ode_cOdeHeightfieldData;
+extern VALUE ode_cOdeConvexData;
 
 
 /* -------------------------------------------------------
  *	Structures
  * ------------------------------------------------------- */
 
-/* ODE::Body struct */
+/* Physics event record, in a fixed layout (ODE::World::EVENT_FORMAT) so a
+   drained queue can be unpacked in Ruby */
 typedef struct {
-	dBodyID			id;
-	VALUE			object, world, mass;
-} ode_BODY;
+	unsigned int	type, tick;
+	unsigned int	index1, index2;
+	double			payload[4];
+} ode_EVENT;
 
-/* ODE::Mass object */
+/* Ring buffer of physics events */
 typedef struct {
-	dMass			*massptr;
-	VALUE			body;
-} ode_MASS;
+	ode_EVENT		*events;
+	long			capacity, head, count;
+	unsigned long	dropped;
+} ode_EVENTQUEUE;
+
+/* Contact pair table entry: a pair of geometries in contact */
+typedef struct {
+	VALUE			geom1, geom2;
+	unsigned long	serial1, serial2;
+	unsigned long	firstTick, lastTick;
+	dReal			impulse;
+	int				useForce1;
+} ode_CONTACTPAIR;
+
+/* Contact pair table change record */
+typedef struct {
+	ode_CONTACTPAIR	pair;
+	int				began;
+} ode_CONTACTCHANGE;
+
+/* Joint feedback slot for a contact joint, tagged with its pair */
+typedef struct {
+	long			entry;
+	dJointFeedback	feedback;
+} ode_CONTACTFEEDBACK;
+
+/* Contact pair table: the pairs currently touching, indexed by an
+   open-addressed hash of their geometries' serials */
+typedef struct {
+	ode_CONTACTPAIR		*pairs;
+	long				count, capacity;
+	long				*index, indexSize;
+	ode_CONTACTCHANGE	*changes;
+	long				changeCount, changeCapacity;
+	ode_CONTACTFEEDBACK	**feedbackBlocks;
+	long				feedbackCount, feedbackBlockCount;
+	ode_EVENTQUEUE		*events;
+	int					beginEvent, endEvent;
+} ode_CONTACTTABLE;
+
+/* Contact reuse cache entry: the contacts last generated for a pair, and the
+   poses of the pair's bodies when they were */
+typedef struct {
+	unsigned long	serial1, serial2, lastTick;
+	int				count, maxContacts;
+	dContactGeom	*contacts;
+	dVector3		pos1, pos2;
+	dQuaternion		quat1, quat2;
+} ode_REUSEENTRY;
+
+/* Contact reuse cache */
+typedef struct {
+	ode_REUSEENTRY	*entries;
+	long			count, capacity;
+	long			*index, indexSize;
+	dReal			linearThreshold, angularThreshold, cosHalfAngle;
+	unsigned long	hits, misses;
+} ode_CONTACTREUSE;
+
+/* A body whose motion is swept for continuous collision detection */
+typedef struct {
+	ode_BODY		*body;
+	dReal			radius;
+	dVector3		prev;
+	dJointID		contact;
+} ode_CCDBODY;
+
+/* A continuous collision detection hit */
+typedef struct {
+	VALUE			body, geom;
+	dVector3		pos, normal;
+	dReal			toi;
+} ode_CCDHIT;
+
+/* Continuous collision detection state of a world */
+typedef struct {
+	ode_CCDBODY		*bodies;
+	long			count, capacity;
+	ode_CCDHIT		*hits;
+	long			hitCount, hitCapacity;
+	dGeomID			ray;
+	VALUE			space;
+} ode_CCD;
 
 /* ODE::Joint structs */
 typedef struct {
 	dJointID		id;
 	dJointFeedback	*feedback;
 	VALUE			object, jointGroup, world, body1, body2, fbhash, contact, obsolete;
+	long			feedbackIndex;
+	dReal			breakForce, breakTorque;
+	int				breakSteps, overSteps;
 } ode_JOINT;
 
+/* ODE::Servo struct */
+typedef struct {
+	VALUE			object, joint, world;
+	ode_JOINT		*jointptr;
+	int				type, axis;
+	dReal			target, targetVel, kp, kd, maxForce;
+	long			worldIndex;
+} ode_SERVO;
+
+/* One degree of freedom of an ODE::Articulation */
+typedef struct {
+	ode_JOINT		*joint;
+	int				type, axis;
+	ode_SERVO		*servo;
+} ode_ARTICULATIONDOF;
+
+/* ODE::Articulation struct */
+typedef struct {
+	VALUE				object, joints, servos;
+	ode_ARTICULATIONDOF	*dofs;
+	long				count;
+} ode_ARTICULATION;
+
+/* ODE::Timeline struct */
+typedef struct {
+	VALUE			object, joint, world;
+	ode_JOINT		*jointptr;
+	int				axis, mode, interpolation, loop;
+	double			*times, *values;
+	long			count;
+	double			time;
+	long			worldIndex;
+} ode_TIMELINE;
+
+/* One link of an ODE::Spring */
+typedef struct {
+	dBodyID			body1, body2;
+	dVector3		anchor1, anchor2;
+	dReal			restLength, stiffness, damping;
+	int				mode;
+	dReal			length, rate, force;
+} ode_SPRING;
+
+/* ODE::Spring struct */
+typedef struct {
+	VALUE			object, world, bodies;
+	ode_SPRING		*springs;
+	long			count, capacity;
+	long			worldIndex;
+} ode_SPRINGSET;
+
+/* One raycast wheel of an ODE::Vehicle */
+typedef struct {
+	dVector3		mount;
+	dReal			radius, restLength, stiffness, damping, friction;
+	dReal			steerFactor, driveFactor;
+	dReal			length, steer, spinAngle, spinRate, load, longForce, latForce;
+	int				contact;
+} ode_WHEEL;
+
+/* ODE::Vehicle struct */
+typedef struct {
+	VALUE			object, chassis, space, world;
+	dBodyID			body;
+	dGeomID			ray;
+	dVector3		up, forward;
+	ode_WHEEL		*wheels;
+	long			count, capacity;
+	dReal			steering, drive, brake;
+	long			worldIndex;
+} ode_VEHICLE;
+
+/* ODE::World struct */
+typedef struct {
+	dWorldID			id;
+	VALUE				object;
+	unsigned long		stepCount;
+	dReal				lastStepSize;
+	ode_CONTACTTABLE	*contacts, *sensors, *retiredContacts;
+	ode_CONTACTREUSE	*reuse;
+	ode_EVENTQUEUE		*events;
+	ode_CCD				*ccd;
+	ode_BODY			**bodies;
+	long				bodyCount, bodyCapacity;
+	ode_JOINT			**feedbackJoints;
+	long				feedbackCount, feedbackCapacity;
+	VALUE				brokenJoints;
+	ode_SERVO			**servos;
+	long				servoCount, servoCapacity;
+	ode_TIMELINE		**timelines;
+	long				timelineCount, timelineCapacity;
+	VALUE				completedTimelines;
+	ode_SPRINGSET		**springSets;
+	long				springSetCount, springSetCapacity;
+	ode_VEHICLE			**vehicles;
+	long				vehicleCount, vehicleCapacity;
+} ode_WORLD;
+
+/* ODE::Mass object */
+typedef struct {
+	dMass			*massptr;
+	VALUE			body;
+} ode_MASS;
+
 /* JointGroup linked list entry */
 typedef struct jointListNode {
 	struct jointListNode *next;
@@ -153,11 +358,31 @@ typedef struct {
 	ode_JOINTLIST	*jointList;
 } ode_JOINTGROUP;
 
-/* ODE::Geometry struct (for ODE::Spaces, too) */
+/* ODE::TriMeshData struct */
+typedef struct {
+	dTriMeshDataID	id;
+	VALUE			object, vertices, indices;
+	void			*mapping;
+	size_t			mappingLength;
+	int				vertexCount, indexCount, isDouble;
+} ode_TRIMESHDATA;
+
+/* ODE::HeightfieldData struct */
 typedef struct {
-	dGeomID			id;
-	VALUE			object, body, surface, container;
-} ode_GEOMETRY;  
+	dHeightfieldDataID	id;
+	VALUE				object;
+	void				*samples;
+	int					widthSamples, depthSamples, sampleSize;
+	dReal				minSample, maxSample;
+} ode_HEIGHTFIELDDATA;
+
+/* ODE::ConvexData struct (in the layout dCreateConvex() expects) */
+typedef struct {
+	VALUE			object;
+	dReal			*planes, *points;
+	unsigned int	*polygons;
+	unsigned int	planeCount, pointCount;
+} ode_CONVEXDATA;
 
 /* ODE::Contact struct */
 typedef struct {
@@ -243,6 +468,40 @@ typedef struct {
 #define IsSurface( obj ) rb_obj_is_kind_of( (obj), ode_cOdeSurface )
 #define IsMass( obj ) rb_obj_is_kind_of( (obj), ode_cOdeMass )
 #define IsGeomTg( obj ) rb_obj_is_kind_of( (obj), ode_cOdeGeometryTransformGroup )
+#define IsGeom( obj ) rb_obj_is_kind_of( (obj), ode_cOdeGeometry )
+#define IsTriMeshData( obj ) rb_obj_is_kind_of( (obj), ode_cOdeTriMeshData )
+#define IsHeightfieldData( obj ) rb_obj_is_kind_of( (obj), ode_cOdeHeightfieldData )
+#define IsConvexData( obj ) rb_obj_is_kind_of( (obj), ode_cOdeConvexData )
+
+
+/* Physics event types */
+#define ODE_EVENT_CONTACT_BEGIN		1
+#define ODE_EVENT_CONTACT_END		2
+#define ODE_EVENT_BODY_SLEEP		3
+#define ODE_EVENT_BODY_WAKE			4
+#define ODE_EVENT_SENSOR_ENTER		5
+#define ODE_EVENT_SENSOR_EXIT		6
+#define ODE_EVENT_CCD_HIT			7
+#define ODE_EVENT_JOINT_BREAK		8
+#define ODE_EVENT_TIMELINE_DONE		9
+
+/* Hash a pair of geometry serials, for the tables keyed by geometry pair */
+#define ODE_PAIR_HASH( s1, s2 ) \
+	( ((s1) * 2654435761UL) ^ ((s2) * 40503UL) )
+
+/* Set the container of the geometry struct <tt>gs</tt> to the space object
+   <tt>obj</tt>, and set <tt>sptr</tt> to its dSpaceID (or 0 if obj is
+   nil). Used by the geometry constructors. */
+#define SetContainer( obj, sptr, gs ) {\
+	(gs)->container = obj; \
+	if ( RTEST(obj) ) { \
+		(sptr) = (dSpaceID)(ode_get_space(obj)->id); \
+		debugMsg(( "Setting container space to <%p>.", (sptr) )); \
+	} else { \
+		(sptr) = 0; \
+		debugMsg(( "Unsetting container space." )); \
+	} \
+}
 
 
 /* Test that obj is .kind_of?( klass ) and raise a TypeError if not. */
@@ -315,6 +574,22 @@ typedef struct {
 	*(vec+2) = (dReal)NUM2DBL( *(RARRAY(ary)->ptr+2) ); \
 }
 
+/* Arithmetic on plain dReal[3]s (no ODE::Vector involved) */
+#define Dot3( a, b )		( (a)[0]*(b)[0] + (a)[1]*(b)[1] + (a)[2]*(b)[2] )
+#define Sub3( r, a, b ) {\
+	(r)[0] = (a)[0] - (b)[0]; (r)[1] = (a)[1] - (b)[1]; (r)[2] = (a)[2] - (b)[2];\
+}
+#define Cross3( r, a, b ) {\
+	(r)[0] = (a)[1]*(b)[2] - (a)[2]*(b)[1];\
+	(r)[1] = (a)[2]*(b)[0] - (a)[0]*(b)[2];\
+	(r)[2] = (a)[0]*(b)[1] - (a)[1]*(b)[0];\
+}
+#define AddScaled3( r, a, s, b ) {\
+	(r)[0] = (a)[0] + (s)*(b)[0];\
+	(r)[1] = (a)[1] + (s)*(b)[1];\
+	(r)[2] = (a)[2] + (s)*(b)[2];\
+}
+
 /* Turn a dVector3 into an ODE::Force */
 #define Vec3ToOdeForce( vec, odeforce ) {\
   do {\
@@ -364,6 +639,22 @@ extern void ode_init_space			_(( void ));
 extern void ode_init_contact		_(( void ));
 extern void ode_init_surface		_(( void ));
 extern void ode_init_geometry		_(( void ));
+extern void ode_init_geometry_transform _(( void ));
+extern void ode_init_geometry_transform_group _(( void ));
+extern void ode_init_trimesh		_(( void ));
+extern void ode_init_heightfield	_(( void ));
+extern void ode_init_convex			_(( void ));
+extern void ode_init_collision		_(( void ));
+extern void ode_init_manifold		_(( void ));
+extern void ode_init_ccd			_(( void ));
+extern void ode_init_distance		_(( void ));
+extern void ode_init_servo			_(( void ));
+extern void ode_init_articulation	_(( void ));
+extern void ode_init_timeline		_(( void ));
+extern void ode_init_ikchain		_(( void ));
+extern void ode_init_spring		_(( void ));
+extern void ode_init_rope			_(( void ));
+extern void ode_init_vehicle		_(( void ));
 
 /* -------------------------------------------------------
  * Global method function declarations
@@ -377,26 +668,89 @@ extern VALUE ode_obj_to_ary4				_(( VALUE, const char * ));
 extern void ode_quaternion_to_dMatrix3		_(( VALUE, dMatrix3 ));
 extern void ode_near_callback				_(( ode_CALLBACK *, dGeomID, dGeomID ));
 extern void ode_check_arity					_(( VALUE, int ));
+extern int ode_precision_flag				_(( VALUE ));
+
+/* ODE::Geometry class */
+extern unsigned long ode_geometry_next_serial _(( void ));
+
+/* Contact pair table */
+extern ode_CONTACTTABLE *ode_contacttable_new _(( int, int ));
+extern void ode_contacttable_free			_(( ode_CONTACTTABLE * ));
+extern void ode_contacttable_clear			_(( ode_CONTACTTABLE * ));
+extern void ode_contacttable_mark			_(( ode_CONTACTTABLE * ));
+extern long ode_contacttable_touch			_(( ode_CONTACTTABLE *, ode_GEOMETRY *, ode_GEOMETRY *, unsigned long ));
+extern dJointFeedback *ode_contacttable_feedback _(( ode_CONTACTTABLE *, long ));
+extern void ode_contacttable_step			_(( ode_CONTACTTABLE *, unsigned long, dReal ));
+extern VALUE ode_contacttable_drain_changes	_(( ode_CONTACTTABLE *, const char *, const char * ));
+extern VALUE ode_contacttable_pairs			_(( ode_CONTACTTABLE * ));
+
+/* Contact reuse cache */
+extern ode_CONTACTREUSE *ode_contactreuse_new _(( dReal, dReal ));
+extern void ode_contactreuse_free			_(( ode_CONTACTREUSE * ));
+extern int ode_contactreuse_fetch			_(( ode_CONTACTREUSE *, ode_GEOMETRY *, ode_GEOMETRY *, int, dContactGeom *, unsigned long ));
+extern void ode_contactreuse_store			_(( ode_CONTACTREUSE *, ode_GEOMETRY *, ode_GEOMETRY *, int, dContactGeom *, int, unsigned long ));
+extern void ode_contactreuse_step			_(( ode_CONTACTREUSE *, unsigned long ));
+
+/* Event queue */
+extern ode_EVENTQUEUE *ode_eventqueue_new	_(( long ));
+extern void ode_eventqueue_free				_(( ode_EVENTQUEUE * ));
+extern ode_EVENT *ode_eventqueue_push		_(( ode_EVENTQUEUE *, int, unsigned long, unsigned long, unsigned long ));
+extern VALUE ode_eventqueue_drain			_(( ode_EVENTQUEUE *, VALUE ));
+
+/* Continuous collision detection */
+extern void ode_ccd_free					_(( ode_CCD * ));
+extern void ode_ccd_mark					_(( ode_CCD * ));
+extern void ode_ccd_remove_body				_(( ode_CCD *, ode_BODY * ));
+extern void ode_ccd_prestep					_(( ode_CCD * ));
+extern void ode_ccd_poststep				_(( ode_WORLD * ));
+
+/* ODE::Servo class */
+extern void ode_servo_prestep				_(( ode_WORLD * ));
+extern int ode_servo_axis_count				_(( int ));
+extern void ode_servo_axis_state			_(( ode_JOINT *, int, int, dReal *, dReal * ));
+
+/* ODE::Timeline class */
+extern void ode_timeline_prestep			_(( ode_WORLD *, dReal ));
+
+/* ODE::Spring class */
+extern void ode_spring_prestep				_(( ode_WORLD * ));
+
+/* ODE::Vehicle class */
+extern void ode_vehicle_prestep				_(( ode_WORLD *, dReal ));
+
+/* Contact manifold reduction */
+extern int ode_manifold_reduce				_(( dContactGeom *, int, ode_GEOMETRY *, ode_GEOMETRY * ));
 
 /* ODE::Mass class */
 extern void ode_mass_set_body				_(( VALUE, VALUE ));
 
+/* ODE::Joint classes */
+extern int ode_paramJoint_functions			_(( ode_JOINT *, dReal (**)( dJointID, int ), void (**)( dJointID, int, dReal ) ));
+
 /* ODE::JointGroup class */
 extern void ode_jointGroup_register_joint	_(( VALUE, VALUE ));
 
 /* ODE::Contact class */
 extern void ode_contact_set_cgeom			_(( VALUE, dContactGeom * ));
 
-/* Fetchers */
-extern ode_GEOMETRY *ode_get_geom			_(( VALUE ));
-extern ode_GEOMETRY *ode_get_space			_(( VALUE ));
-extern ode_BODY *ode_get_body				_(( VALUE ));
-extern dWorldID ode_get_world				_(( VALUE ));
+/* ODE::World class */
+extern void ode_world_add_body				_(( ode_WORLD *, ode_BODY * ));
+extern void ode_world_remove_body			_(( ode_WORLD *, ode_BODY * ));
+extern ode_CONTACTTABLE *ode_world_sensor_table _(( ode_WORLD * ));
+extern void ode_world_add_feedback_joint	_(( ode_WORLD *, ode_JOINT * ));
+extern void ode_world_remove_feedback_joint _(( ode_WORLD *, ode_JOINT * ));
+
+/* Fetchers (see also rubyode.h) */
+extern ode_WORLD *ode_get_world_struct		_(( VALUE ));
 extern dSurfaceParameters *ode_get_surface	_(( VALUE ));
 extern ode_CONTACT *ode_get_contact			_(( VALUE ));
 extern ode_JOINT *ode_get_joint				_(( VALUE ));
+extern ode_SERVO *ode_get_servo				_(( VALUE ));
 extern ode_JOINTGROUP *ode_get_jointGroup	_(( VALUE ));
 extern ode_MASS *ode_get_mass				_(( VALUE ));
+extern ode_TRIMESHDATA *ode_get_trimeshdata	_(( VALUE ));
+extern ode_HEIGHTFIELDDATA *ode_get_heightfielddata _(( VALUE ));
+extern ode_CONVEXDATA *ode_get_convexdata	_(( VALUE ));
 
 #endif /* _R_ODE_H */
 
@@ -0,0 +1,670 @@
+/*
+ *		rope.c - ODE Ruby Binding - Rope Class
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 23:31:07 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* The number of doubles in one segment's record in a packed state buffer:
+   position, quaternion, linear velocity, angular velocity */
+#define ODE_ROPE_STATE_DOUBLES	13
+
+/* ODE::Rope struct */
+typedef struct {
+	VALUE		object, world, space, bodies, geometries, joints, jointClass;
+	dBodyID		*ids;
+	long		count;
+	dVector3	start, end;
+	dReal		segmentLength;
+} ode_ROPE;
+
+
+
+/* --------------------------------------------------
+ *	Memory-management functions
+ * -------------------------------------------------- */
+
+/*
+ * Allocation function
+ */
+static ode_ROPE *
+ode_rope_alloc()
+{
+	ode_ROPE *ptr = ALLOC( ode_ROPE );
+
+	ptr->object		= Qnil;
+	ptr->world		= Qnil;
+	ptr->space		= Qnil;
+	ptr->bodies		= Qnil;
+	ptr->geometries	= Qnil;
+	ptr->joints		= Qnil;
+	ptr->jointClass	= Qnil;
+	ptr->ids		= NULL;
+	ptr->count		= 0;
+	ptr->segmentLength = 0;
+
+	debugMsg(( "Initialized ode_ROPE <%p>", ptr ));
+	return ptr;
+}
+
+
+/*
+ * GC Mark function
+ */
+static void
+ode_rope_gc_mark( ptr )
+	 ode_ROPE *ptr;
+{
+	debugMsg(( "Marking an ODE::Rope" ));
+
+	if ( ptr ) {
+		rb_gc_mark( ptr->world );
+		rb_gc_mark( ptr->space );
+		rb_gc_mark( ptr->bodies );
+		rb_gc_mark( ptr->geometries );
+		rb_gc_mark( ptr->joints );
+		rb_gc_mark( ptr->jointClass );
+	}
+}
+
+
+/*
+ * GC Free function. The bodies, geometries and joints are Ruby objects of
+ * their own, and are destroyed when they're collected.
+ */
+static void
+ode_rope_gc_free( ptr )
+	 ode_ROPE *ptr;
+{
+	if ( ptr ) {
+		debugMsg(( "Destroying Rope <%p>", ptr ));
+		if ( ptr->ids ) xfree( ptr->ids );
+		ptr->ids = NULL;
+
+		xfree( ptr );
+		ptr = NULL;
+	}
+}
+
+
+/*
+ * Object validity checker. Returns the data pointer.
+ */
+static ode_ROPE *
+check_rope( self )
+	 VALUE	self;
+{
+	debugMsg(( "Checking a Rope object (%d).", self ));
+	Check_Type( self, T_DATA );
+
+    if ( !rb_obj_is_kind_of(self, ode_cOdeRope) ) {
+		rb_raise( rb_eTypeError, "wrong argument type %s (expected ODE::Rope)",
+				  rb_class2name(CLASS_OF( self )) );
+    }
+
+	return DATA_PTR( self );
+}
+
+
+/*
+ * Fetch the data pointer and check it for sanity.
+ */
+static ode_ROPE *
+get_rope( self )
+	 VALUE self;
+{
+	ode_ROPE *ptr = check_rope( self );
+
+	debugMsg(( "Fetching an ode_ROPE (%p).", ptr ));
+	if ( !ptr )
+		rb_raise( rb_eRuntimeError, "uninitialized rope" );
+
+	return ptr;
+}
+
+
+
+/* --------------------------------------------------
+ * Construction
+ * -------------------------------------------------- */
+
+/*
+ * Create a joint of the rope's joint class at <tt>anchor</tt> between
+ * <tt>body1</tt> and <tt>body2</tt> (either of which may be nil), with its
+ * axes (if it has any) across the rope's <tt>direction</tt>, and add it to
+ * the rope's joints.
+ */
+static VALUE
+ode_rope_make_joint( ptr, body1, body2, anchor, direction )
+	 ode_ROPE		*ptr;
+	 VALUE			body1, body2;
+	 const dReal	*anchor, *direction;
+{
+	VALUE		joint = rb_class_new_instance( 1, &ptr->world, ptr->jointClass );
+	ode_JOINT	*jointptr = ode_get_joint( joint );
+	dVector3	across1, across2;
+
+	dJointAttach( jointptr->id,
+				  RTEST(body1) ? ode_get_body(body1)->id : 0,
+				  RTEST(body2) ? ode_get_body(body2)->id : 0 );
+	jointptr->body1 = body1;
+	jointptr->body2 = body2;
+
+	dPlaneSpace( direction, across1, across2 );
+	switch ( dJointGetType(jointptr->id) ) {
+	case dJointTypeBall:
+		dJointSetBallAnchor( jointptr->id, anchor[0], anchor[1], anchor[2] );
+		break;
+
+	case dJointTypeUniversal:
+		dJointSetUniversalAnchor( jointptr->id, anchor[0], anchor[1], anchor[2] );
+		dJointSetUniversalAxis1( jointptr->id, across1[0], across1[1], across1[2] );
+		dJointSetUniversalAxis2( jointptr->id, across2[0], across2[1], across2[2] );
+		break;
+
+	case dJointTypeHinge:
+		dJointSetHingeAnchor( jointptr->id, anchor[0], anchor[1], anchor[2] );
+		dJointSetHingeAxis( jointptr->id, across1[0], across1[1], across1[2] );
+		break;
+	}
+
+	rb_ary_push( ptr->joints, joint );
+	return joint;
+}
+
+
+/*
+ * Return the unit vector along the rope from its start to its end.
+ */
+static void
+ode_rope_direction( ptr, direction )
+	 ode_ROPE	*ptr;
+	 dVector3	direction;
+{
+	dReal	len;
+	int		k;
+
+	for ( k = 0; k < 3; k++ ) direction[k] = ptr->end[k] - ptr->start[k];
+	len = dSqrt( direction[0]*direction[0] + direction[1]*direction[1] +
+				 direction[2]*direction[2] );
+	for ( k = 0; k < 3; k++ ) direction[k] /= len;
+}
+
+
+/*
+ * Check the given packed state <tt>buffer</tt> and return a pointer to its
+ * contents.
+ */
+static double *
+ode_rope_state_buffer( ptr, buffer, doubles )
+	 ode_ROPE	*ptr;
+	 VALUE		buffer;
+	 long		doubles;
+{
+	StringValue( buffer );
+	if ( RSTRING(buffer)->len != ptr->count * doubles * (long)sizeof(double) )
+		rb_raise( rb_eArgError, "expected %ld bytes of state, got %ld",
+				  ptr->count * doubles * (long)sizeof(double), RSTRING(buffer)->len );
+
+	return (double *)RSTRING( buffer )->ptr;
+}
+
+
+
+/* --------------------------------------------------
+ * Class Methods
+ * -------------------------------------------------- */
+
+/*
+ * allocate()
+ * --
+ * Allocate a new ODE::Rope object.
+ */
+static VALUE
+ode_rope_s_alloc( klass )
+{
+	debugMsg(( "Wrapping an uninitialized ODE::Rope pointer." ));
+	return Data_Wrap_Struct( klass, ode_rope_gc_mark, ode_rope_gc_free, 0 );
+}
+
+
+
+/* --------------------------------------------------
+ * Instance Methods
+ * -------------------------------------------------- */
+
+/*
+ * ODE::Rope#initialize( world, space, start, end, segments, mass, radius, jointClass=ODE::BallJoint )
+ * --
+ * Build a rope (or chain) of <tt>segments</tt> bodies in the given
+ * <tt>world</tt>, laid out in a straight line from the point
+ * <tt>start</tt> to the point <tt>end</tt>, each joined to the next at
+ * their shared end by a joint of the given <tt>jointClass</tt>: an
+ * ODE::BallJoint (the default), ODE::UniversalJoint, or ODE::HingeJoint.
+ * The <tt>mass</tt> is the total mass of the rope, which is shared evenly
+ * between the segments. If a <tt>space</tt> is given, each segment also
+ * gets an ODE::Geometry::Capsule of the given <tt>radius</tt> in it, which
+ * covers the segment end to end, so the segments must be longer than the
+ * rope is thick. Adjacent segments touch, so a collision callback should
+ * skip bodies which are ODE::Body#connectedTo? each other.
+ *
+ * The ends are free; fix them with #pinStart and #pinEnd.
+ */
+static VALUE
+ode_rope_init( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_ROPE	*ptr;
+	VALUE		world, space, start, end, segments, mass, radius, jointClass;
+	VALUE		body, geometry, args[3], prev = Qnil;
+	ode_BODY	*bodyptr;
+	dMass		segmentMass;
+	dMatrix3	rotation;
+	dVector3	startPos, endPos, direction, center, anchor;
+	dReal		length, segmentLength, cylinder, r;
+	long		n, i;
+	int			k;
+
+	rb_scan_args( argc, argv, "71", &world, &space, &start, &end, &segments, &mass,
+				  &radius, &jointClass );
+
+	if ( check_rope(self) )
+		rb_raise( rb_eRuntimeError, "Cannot re-initialize a rope once it's been built." );
+
+	ode_get_world( world );
+	if ( RTEST(space) && !IsSpace(space) )
+		rb_raise( rb_eTypeError, "no implicit conversion to ODE::Space from %s",
+				  rb_class2name(CLASS_OF( space )) );
+
+	start = ode_obj_to_ary3( start, "start" );
+	end = ode_obj_to_ary3( end, "end" );
+	n = NUM2LONG( segments );
+	CheckPositiveNonZeroNumber( n, "segments" );
+	CheckPositiveNonZeroNumber( NUM2DBL(mass), "mass" );
+	CheckPositiveNonZeroNumber( NUM2DBL(radius), "radius" );
+
+	if ( !RTEST(jointClass) )
+		jointClass = ode_cOdeBallJoint;
+	else if ( jointClass != ode_cOdeBallJoint && jointClass != ode_cOdeUniversalJoint &&
+			  jointClass != ode_cOdeHingeJoint )
+		rb_raise( rb_eArgError, "can't build a rope with %s joints",
+				  rb_class2name(jointClass) );
+
+	/* Check the layout before attaching anything, so a bad one doesn't
+	   leave a half-built rope behind */
+	SetVec3FromArray( startPos, start );
+	SetVec3FromArray( endPos, end );
+
+	for ( k = 0; k < 3; k++ ) direction[k] = endPos[k] - startPos[k];
+	length = dSqrt( direction[0]*direction[0] + direction[1]*direction[1] +
+					direction[2]*direction[2] );
+	if ( length < 1e-9 )
+		rb_raise( rb_eArgError, "the ends of a rope must be apart" );
+	for ( k = 0; k < 3; k++ ) direction[k] /= length;
+
+	r = (dReal)NUM2DBL( radius );
+	segmentLength = length / n;
+	cylinder = segmentLength - 2 * r;
+	if ( cylinder <= 0 )
+		rb_raise( rb_eArgError, "segments of length %f are too short for radius %f",
+				  segmentLength, r );
+
+	DATA_PTR(self) = ptr = ode_rope_alloc();
+	ptr->object			= self;
+	ptr->world			= world;
+	ptr->space			= space;
+	ptr->jointClass		= jointClass;
+	ptr->bodies			= rb_ary_new2( n );
+	ptr->geometries		= rb_ary_new2( RTEST(space) ? n : 0 );
+	ptr->joints			= rb_ary_new2( n + 1 );
+	ptr->segmentLength	= segmentLength;
+	for ( k = 0; k < 3; k++ ) {
+		ptr->start[k] = startPos[k];
+		ptr->end[k] = endPos[k];
+	}
+
+	/* Every segment has the same mass and orientation: capsules lie along
+	   their Z axis */
+	dMassSetCapsule( &segmentMass, 1, 3, r, cylinder );
+	dMassAdjust( &segmentMass, (dReal)(NUM2DBL(mass) / n) );
+	dRFromZAxis( rotation, direction[0], direction[1], direction[2] );
+
+	ptr->ids = ALLOC_N( dBodyID, n );
+	for ( i = 0; i < n; i++ ) {
+		body = rb_class_new_instance( 1, &world, ode_cOdeBody );
+		bodyptr = ode_get_body( body );
+		ptr->ids[i] = bodyptr->id;
+		ptr->count++;
+		rb_ary_push( ptr->bodies, body );
+
+		for ( k = 0; k < 3; k++ )
+			center[k] = ptr->start[k] + direction[k] * ptr->segmentLength * (i + 0.5);
+		dBodySetPosition( ptr->ids[i], center[0], center[1], center[2] );
+		dBodySetRotation( ptr->ids[i], rotation );
+		dBodySetMass( ptr->ids[i], &segmentMass );
+		bodyptr->mass = rb_class_new_instance( 0, 0, ode_cOdeMass );
+		ode_mass_set_body( bodyptr->mass, body );
+
+		if ( RTEST(space) ) {
+			args[0] = radius;
+			args[1] = rb_float_new( cylinder );
+			args[2] = space;
+			geometry = rb_class_new_instance( 3, args, ode_cOdeGeometryCapCyl );
+			dGeomSetBody( ode_get_geom(geometry)->id, ptr->ids[i] );
+			rb_ary_push( ptr->geometries, geometry );
+		}
+
+		if ( i > 0 ) {
+			for ( k = 0; k < 3; k++ )
+				anchor[k] = ptr->start[k] + direction[k] * ptr->segmentLength * i;
+			ode_rope_make_joint( ptr, prev, body, anchor, direction );
+		}
+
+		prev = body;
+	}
+
+	return self;
+}
+
+
+/*
+ * ODE::Rope#world
+ * --
+ * Returns the world the rope was built in.
+ */
+static VALUE
+ode_rope_world( self )
+	 VALUE self;
+{
+	return get_rope( self )->world;
+}
+
+
+/*
+ * ODE::Rope#bodies
+ * --
+ * Returns the rope's segments' bodies, from its start to its end.
+ */
+static VALUE
+ode_rope_bodies( self )
+	 VALUE self;
+{
+	return rb_ary_dup( get_rope(self)->bodies );
+}
+
+
+/*
+ * ODE::Rope#geometries
+ * --
+ * Returns the rope's segments' capsules, from its start to its end, or an
+ * empty Array if it was built without a space.
+ */
+static VALUE
+ode_rope_geometries( self )
+	 VALUE self;
+{
+	return rb_ary_dup( get_rope(self)->geometries );
+}
+
+
+/*
+ * ODE::Rope#joints
+ * --
+ * Returns the joints between the rope's segments, from its start to its
+ * end, followed by any that pin its ends.
+ */
+static VALUE
+ode_rope_joints( self )
+	 VALUE self;
+{
+	return rb_ary_dup( get_rope(self)->joints );
+}
+
+
+/*
+ * ODE::Rope#size
+ * --
+ * Returns the number of segments in the rope.
+ */
+static VALUE
+ode_rope_size( self )
+	 VALUE self;
+{
+	return LONG2NUM( get_rope(self)->count );
+}
+
+
+/*
+ * ODE::Rope#segmentLength
+ * --
+ * Returns the length of each of the rope's segments.
+ */
+static VALUE
+ode_rope_segment_length( self )
+	 VALUE self;
+{
+	return rb_float_new( get_rope(self)->segmentLength );
+}
+
+
+/*
+ * ODE::Rope#pinStart( body=nil )
+ * --
+ * Join the start of the rope to the given <tt>body</tt>, or to the static
+ * environment if it's <tt>nil</tt>, at the point it was built from. Returns
+ * the new joint.
+ */
+static VALUE
+ode_rope_pin_start( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_ROPE	*ptr = get_rope( self );
+	VALUE		body;
+	dVector3	direction;
+
+	rb_scan_args( argc, argv, "01", &body );
+	if ( RTEST(body) ) ode_get_body( body );
+
+	ode_rope_direction( ptr, direction );
+	return ode_rope_make_joint( ptr, body, RARRAY(ptr->bodies)->ptr[0], ptr->start, direction );
+}
+
+
+/*
+ * ODE::Rope#pinEnd( body=nil )
+ * --
+ * Join the end of the rope to the given <tt>body</tt>, or to the static
+ * environment if it's <tt>nil</tt>, at the point it was built to. Returns
+ * the new joint.
+ */
+static VALUE
+ode_rope_pin_end( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_ROPE	*ptr = get_rope( self );
+	VALUE		body;
+	dVector3	direction;
+
+	rb_scan_args( argc, argv, "01", &body );
+	if ( RTEST(body) ) ode_get_body( body );
+
+	ode_rope_direction( ptr, direction );
+	return ode_rope_make_joint( ptr, RARRAY(ptr->bodies)->ptr[ptr->count - 1], body,
+								ptr->end, direction );
+}
+
+
+/*
+ * ODE::Rope#positionsInto( buffer=nil )
+ * --
+ * Returns the positions of the rope's segments, from its start to its end,
+ * as a String of native doubles with three for each segment. Unpack it with
+ * 'd*'. If a <tt>buffer</tt> String is given, its contents are replaced
+ * with the positions and it's returned instead.
+ */
+static VALUE
+ode_rope_positions_into( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_ROPE	*ptr = get_rope( self );
+	VALUE		buffer;
+	double		*out;
+	const dReal	*pos;
+	long		i;
+
+	if ( rb_scan_args(argc, argv, "01", &buffer) && RTEST(buffer) )
+		StringValue( buffer );
+	else
+		buffer = rb_str_new( 0, 0 );
+
+	rb_str_modify( buffer );
+	rb_str_resize( buffer, ptr->count * 3 * sizeof(double) );
+	out = (double *)RSTRING( buffer )->ptr;
+
+	for ( i = 0; i < ptr->count; i++ ) {
+		pos = dBodyGetPosition( ptr->ids[i] );
+		*out++ = pos[0]; *out++ = pos[1]; *out++ = pos[2];
+	}
+
+	return buffer;
+}
+
+
+/*
+ * ODE::Rope#stateInto( buffer=nil )
+ * --
+ * Returns the state of the rope's segments, from its start to its end, as a
+ * String of native doubles with STATE_SIZE of them for each segment: its
+ * position (x, y, z), its quaternion (w, x, y, z), its linear velocity and
+ * its angular velocity. Unpack it with 'd*'. If a <tt>buffer</tt> String is
+ * given, its contents are replaced with the state and it's returned
+ * instead. The state can be restored with #setState.
+ */
+static VALUE
+ode_rope_state_into( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_ROPE	*ptr = get_rope( self );
+	VALUE		buffer;
+	double		*out;
+	const dReal	*v;
+	long		i;
+	int			k;
+
+	if ( rb_scan_args(argc, argv, "01", &buffer) && RTEST(buffer) )
+		StringValue( buffer );
+	else
+		buffer = rb_str_new( 0, 0 );
+
+	rb_str_modify( buffer );
+	rb_str_resize( buffer, ptr->count * ODE_ROPE_STATE_DOUBLES * sizeof(double) );
+	out = (double *)RSTRING( buffer )->ptr;
+
+	for ( i = 0; i < ptr->count; i++ ) {
+		v = dBodyGetPosition( ptr->ids[i] );
+		for ( k = 0; k < 3; k++ ) *out++ = v[k];
+		v = dBodyGetQuaternion( ptr->ids[i] );
+		for ( k = 0; k < 4; k++ ) *out++ = v[k];
+		v = dBodyGetLinearVel( ptr->ids[i] );
+		for ( k = 0; k < 3; k++ ) *out++ = v[k];
+		v = dBodyGetAngularVel( ptr->ids[i] );
+		for ( k = 0; k < 3; k++ ) *out++ = v[k];
+	}
+
+	return buffer;
+}
+
+
+/*
+ * ODE::Rope#setState( buffer )
+ * --
+ * Set the state of all of the rope's segments from a String of packed
+ * doubles in the format returned by #stateInto.
+ */
+static VALUE
+ode_rope_set_state( self, buffer )
+	 VALUE self, buffer;
+{
+	ode_ROPE	*ptr = get_rope( self );
+	double		*in = ode_rope_state_buffer( ptr, buffer, ODE_ROPE_STATE_DOUBLES );
+	dQuaternion	q;
+	long		i;
+	int			k;
+
+	for ( i = 0; i < ptr->count; i++, in += ODE_ROPE_STATE_DOUBLES ) {
+		for ( k = 0; k < 4; k++ ) q[k] = (dReal)in[3 + k];
+		dBodySetPosition( ptr->ids[i], in[0], in[1], in[2] );
+		dBodySetQuaternion( ptr->ids[i], q );
+		dBodySetLinearVel( ptr->ids[i], in[7], in[8], in[9] );
+		dBodySetAngularVel( ptr->ids[i], in[10], in[11], in[12] );
+	}
+
+	return buffer;
+}
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_rope()
+{
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeRope = rb_define_class_under( ode_mOde, "Rope", rb_cObject );
+#endif
+
+	rb_define_const( ode_cOdeRope, "STATE_SIZE", INT2FIX(ODE_ROPE_STATE_DOUBLES) );
+
+	rb_define_alloc_func( ode_cOdeRope, ode_rope_s_alloc );
+
+	rb_define_method( ode_cOdeRope, "initialize", ode_rope_init, -1 );
+
+	rb_define_method( ode_cOdeRope, "world", ode_rope_world, 0 );
+	rb_define_method( ode_cOdeRope, "bodies", ode_rope_bodies, 0 );
+	rb_define_method( ode_cOdeRope, "geometries", ode_rope_geometries, 0 );
+	rb_define_method( ode_cOdeRope, "joints", ode_rope_joints, 0 );
+	rb_define_method( ode_cOdeRope, "size", ode_rope_size, 0 );
+	rb_define_alias ( ode_cOdeRope, "segments", "size" );
+	rb_define_method( ode_cOdeRope, "segmentLength", ode_rope_segment_length, 0 );
+	rb_define_alias ( ode_cOdeRope, "segment_length", "segmentLength" );
+
+	rb_define_method( ode_cOdeRope, "pinStart", ode_rope_pin_start, -1 );
+	rb_define_alias ( ode_cOdeRope, "pin_start", "pinStart" );
+	rb_define_method( ode_cOdeRope, "pinEnd", ode_rope_pin_end, -1 );
+	rb_define_alias ( ode_cOdeRope, "pin_end", "pinEnd" );
+
+	rb_define_method( ode_cOdeRope, "positionsInto", ode_rope_positions_into, -1 );
+	rb_define_alias ( ode_cOdeRope, "positions_into", "positionsInto" );
+	rb_define_alias ( ode_cOdeRope, "positions", "positionsInto" );
+	rb_define_method( ode_cOdeRope, "stateInto", ode_rope_state_into, -1 );
+	rb_define_alias ( ode_cOdeRope, "state_into", "stateInto" );
+	rb_define_alias ( ode_cOdeRope, "state", "stateInto" );
+	rb_define_method( ode_cOdeRope, "setState", ode_rope_set_state, 1 );
+	rb_define_alias ( ode_cOdeRope, "set_state", "setState" );
+	rb_define_alias ( ode_cOdeRope, "state=", "setState" );
+}
+
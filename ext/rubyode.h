@@ -0,0 +1,103 @@
+/*
+ *		rubyode.h - ODE Ruby Binding - Public header for other C extensions
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 16:48:10 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ *	This is the part of the binding's internals that other C extensions may
+ *	use: the structs behind ODE::Body and ODE::Geometry (and ODE::Space), the
+ *	functions that fetch them from Ruby objects, and a way to handle a space's
+ *	near callbacks in C. It's installed alongside the extension; an extension
+ *	using it should <tt>require 'ode'</tt> before it's loaded so the symbols
+ *	below can be resolved.
+ *
+ */
+
+
+#ifndef _RUBYODE_H
+#define _RUBYODE_H 1
+
+#include <ruby.h>
+#include "ode/ode.h"
+
+/* Incremented whenever something in this header changes incompatibly */
+#define RUBYODE_API_VERSION 2
+
+
+/* -------------------------------------------------------
+ * Classes
+ * ------------------------------------------------------- */
+
+extern VALUE ode_cOdeWorld;
+extern VALUE ode_cOdeBody;
+extern VALUE ode_cOdeGeometry;
+extern VALUE ode_cOdeSpace;
+
+
+/* -------------------------------------------------------
+ *	Structures
+ * ------------------------------------------------------- */
+
+/* ODE::Body struct */
+typedef struct {
+	dBodyID			id;
+	VALUE			object, world, mass;
+	unsigned long	serial;
+	long			worldIndex;
+	int				enabled;
+} ode_BODY;
+
+struct ode_geometry;
+
+/* Native near callback: called with the <tt>data</tt> it was registered with
+   and the two potentially-colliding geometries, either of which may be a
+   space */
+typedef void (*ode_NEARFUNC) _(( void *, struct ode_geometry *, struct ode_geometry * ));
+
+/* A native near callback registered for a space */
+typedef struct {
+	ode_NEARFUNC	func;
+	void			*data;
+} ode_NEARCALLBACK;
+
+/* ODE::Geometry struct (for ODE::Spaces, too) */
+typedef struct ode_geometry {
+	dGeomID				id;
+	VALUE				object, body, surface, container;
+	unsigned long		stamp, serial;
+	ode_NEARCALLBACK	*nearCallback;
+	int					sensor;
+} ode_GEOMETRY;
+
+
+/* -------------------------------------------------------
+ * Functions
+ * ------------------------------------------------------- */
+
+/* Fetchers: each raises a TypeError if given the wrong kind of object */
+extern ode_GEOMETRY *ode_get_geom			_(( VALUE ));
+extern ode_GEOMETRY *ode_get_space			_(( VALUE ));
+extern ode_BODY *ode_get_body				_(( VALUE ));
+extern dWorldID ode_get_world				_(( VALUE ));
+
+/* Make <tt>func</tt> (called with <tt>data</tt>) the near callback
+   ODE::Space#eachAdjacentPair uses for the given space when it isn't given a
+   block, or remove it if <tt>func</tt> is NULL. The caller keeps ownership of
+   <tt>data</tt>. */
+extern void ode_space_set_near_callback		_(( VALUE, ode_NEARFUNC, void * ));
+
+/* The dNearCallback which dispatches to a registered native callback, for
+   passing to dSpaceCollide2() to descend into spaces with the same one */
+extern void ode_native_near_callback		_(( ode_NEARCALLBACK *, dGeomID, dGeomID ));
+
+#endif /* _RUBYODE_H */
+
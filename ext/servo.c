@@ -0,0 +1,758 @@
+/*
+ *		servo.c - ODE Ruby Binding - Servo Class
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 19:42:10 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* The size of one target record in a packed servo target buffer */
+#define ODE_SERVO_TARGET_DOUBLES	2
+
+
+
+/* --------------------------------------------------
+ *	Memory-management functions
+ * -------------------------------------------------- */
+
+/*
+ * Allocation function
+ */
+static ode_SERVO *
+ode_servo_alloc()
+{
+	ode_SERVO *ptr = ALLOC( ode_SERVO );
+
+	ptr->object		= Qnil;
+	ptr->joint		= Qnil;
+	ptr->world		= Qnil;
+	ptr->jointptr	= NULL;
+	ptr->type		= dJointTypeNone;
+	ptr->axis		= 1;
+	ptr->target		= 0;
+	ptr->targetVel	= 0;
+	ptr->kp			= 1;
+	ptr->kd			= 0;
+	ptr->maxForce	= 0;
+	ptr->worldIndex	= -1;
+
+	debugMsg(( "Initialized ode_SERVO <%p>", ptr ));
+	return ptr;
+}
+
+
+/*
+ * GC Mark function
+ */
+static void
+ode_servo_gc_mark( ptr )
+	 ode_SERVO *ptr;
+{
+	debugMsg(( "Marking an ODE::Servo" ));
+
+	if ( ptr ) {
+		rb_gc_mark( ptr->joint );
+		rb_gc_mark( ptr->world );
+	}
+}
+
+
+/*
+ * GC Free function. Enabled servos are kept alive by their world, so a servo
+ * that's being freed is either disabled or going down with its world, and
+ * doesn't need to be removed from it.
+ */
+static void
+ode_servo_gc_free( ptr )
+	 ode_SERVO *ptr;
+{
+	if ( ptr ) {
+		debugMsg(( "Destroying Servo <%p>", ptr ));
+		ptr->jointptr = NULL;
+		xfree( ptr );
+		ptr = NULL;
+	}
+}
+
+
+/*
+ * Object validity checker. Returns the data pointer.
+ */
+static ode_SERVO *
+check_servo( self )
+	 VALUE	self;
+{
+	debugMsg(( "Checking a Servo object (%d).", self ));
+	Check_Type( self, T_DATA );
+
+    if ( !rb_obj_is_kind_of(self, ode_cOdeServo) ) {
+		rb_raise( rb_eTypeError, "wrong argument type %s (expected ODE::Servo)",
+				  rb_class2name(CLASS_OF( self )) );
+    }
+
+	return DATA_PTR( self );
+}
+
+
+/*
+ * Fetch the data pointer and check it for sanity.
+ */
+static ode_SERVO *
+get_servo( self )
+	 VALUE self;
+{
+	ode_SERVO *ptr = check_servo( self );
+
+	debugMsg(( "Fetching an ode_SERVO (%p).", ptr ));
+	if ( !ptr )
+		rb_raise( rb_eRuntimeError, "uninitialized servo" );
+
+	return ptr;
+}
+
+
+/*
+ * Publicly-usable servo-fetcher.
+ */
+ode_SERVO *
+ode_get_servo( self )
+	 VALUE self;
+{
+	return get_servo(self);
+}
+
+
+
+/* --------------------------------------------------
+ * Stepping
+ * -------------------------------------------------- */
+
+/*
+ * Return the number of motor axes a servo can drive (and read the position
+ * and rate of) on a joint of the given ODE joint type, or 0 if it can't
+ * drive that kind of joint.
+ */
+int
+ode_servo_axis_count( type )
+	 int	type;
+{
+	switch ( type ) {
+	case dJointTypeHinge:
+	case dJointTypeSlider:
+	case dJointTypeHinge2:
+		return 1;
+
+	case dJointTypeUniversal:
+		return 2;
+
+	default:
+		return 0;
+	}
+}
+
+
+/*
+ * Return the current position and rate of the given <tt>axis</tt> of a joint
+ * of the specified ODE joint <tt>type</tt>.
+ */
+void
+ode_servo_axis_state( joint, type, axis, pos, rate )
+	 ode_JOINT	*joint;
+	 int		type, axis;
+	 dReal		*pos, *rate;
+{
+	dJointID	id = joint->id;
+
+	switch ( type ) {
+	case dJointTypeHinge:
+		*pos = dJointGetHingeAngle( id );
+		*rate = dJointGetHingeAngleRate( id );
+		break;
+
+	case dJointTypeSlider:
+		*pos = dJointGetSliderPosition( id );
+		*rate = dJointGetSliderPositionRate( id );
+		break;
+
+	case dJointTypeHinge2:
+		*pos = dJointGetHinge2Angle1( id );
+		*rate = dJointGetHinge2Angle1Rate( id );
+		break;
+
+	case dJointTypeUniversal:
+		if ( axis == 1 ) {
+			*pos = dJointGetUniversalAngle1( id );
+			*rate = dJointGetUniversalAngle1Rate( id );
+		} else {
+			*pos = dJointGetUniversalAngle2( id );
+			*rate = dJointGetUniversalAngle2Rate( id );
+		}
+		break;
+
+	default:
+		*pos = *rate = 0;
+	}
+}
+
+
+/*
+ * Set the motor velocity and maximum force of the servo's joint axis.
+ */
+static void
+ode_servo_drive_axis( ptr, vel, fmax )
+	 ode_SERVO	*ptr;
+	 dReal		vel, fmax;
+{
+	dJointID	id = ptr->jointptr->id;
+	int			offset = dParamGroup * ( ptr->axis - 1 );
+
+	switch ( ptr->type ) {
+	case dJointTypeHinge:
+		dJointSetHingeParam( id, dParamVel, vel );
+		dJointSetHingeParam( id, dParamFMax, fmax );
+		break;
+
+	case dJointTypeSlider:
+		dJointSetSliderParam( id, dParamVel, vel );
+		dJointSetSliderParam( id, dParamFMax, fmax );
+		break;
+
+	case dJointTypeHinge2:
+		dJointSetHinge2Param( id, dParamVel, vel );
+		dJointSetHinge2Param( id, dParamFMax, fmax );
+		break;
+
+	case dJointTypeUniversal:
+		dJointSetUniversalParam( id, dParamVel + offset, vel );
+		dJointSetUniversalParam( id, dParamFMax + offset, fmax );
+		break;
+	}
+}
+
+
+/*
+ * Return the motor velocity the servo commands for the current state of its
+ * joint.
+ */
+static dReal
+ode_servo_command( ptr )
+	 ode_SERVO	*ptr;
+{
+	dReal	pos, rate;
+
+	ode_servo_axis_state( ptr->jointptr, ptr->type, ptr->axis, &pos, &rate );
+	return ptr->targetVel + ptr->kp * ( ptr->target - pos ) +
+		ptr->kd * ( ptr->targetVel - rate );
+}
+
+
+/*
+ * Drive the motors of all of the world's enabled servos towards their
+ * targets. Called just before the world is stepped. Servos whose joints have
+ * been made obsolete are skipped.
+ */
+void
+ode_servo_prestep( world )
+	 ode_WORLD	*world;
+{
+	ode_SERVO	*ptr;
+	long		i;
+
+	for ( i = 0; i < world->servoCount; i++ ) {
+		ptr = world->servos[i];
+		if ( RTEST(ptr->jointptr->obsolete) ) continue;
+
+		ode_servo_drive_axis( ptr, ode_servo_command(ptr), ptr->maxForce );
+	}
+}
+
+
+/*
+ * Add the given servo to its world's list of servos.
+ */
+static void
+ode_servo_enable( ptr )
+	 ode_SERVO	*ptr;
+{
+	ode_WORLD	*world = ode_get_world_struct( ptr->world );
+
+	if ( ptr->worldIndex >= 0 ) return;
+
+	if ( world->servoCount == world->servoCapacity ) {
+		world->servoCapacity = world->servoCapacity ? world->servoCapacity * 2 : 32;
+		REALLOC_N( world->servos, ode_SERVO *, world->servoCapacity );
+	}
+
+	ptr->worldIndex = world->servoCount;
+	world->servos[ world->servoCount++ ] = ptr;
+}
+
+
+/*
+ * Remove the given servo from its world's list of servos. The last servo in
+ * the list takes its place.
+ */
+static void
+ode_servo_disable( ptr )
+	 ode_SERVO	*ptr;
+{
+	ode_WORLD	*world = ode_get_world_struct( ptr->world );
+	ode_SERVO	*last;
+
+	if ( ptr->worldIndex < 0 || ptr->worldIndex >= world->servoCount ||
+		 world->servos[ptr->worldIndex] != ptr )
+		return;
+
+	last = world->servos[ --world->servoCount ];
+	world->servos[ ptr->worldIndex ] = last;
+	last->worldIndex = ptr->worldIndex;
+	ptr->worldIndex = -1;
+}
+
+
+
+/* --------------------------------------------------
+ * Class Methods
+ * -------------------------------------------------- */
+
+/*
+ * allocate()
+ * --
+ * Allocate a new ODE::Servo object.
+ */
+static VALUE
+ode_servo_s_alloc( klass )
+{
+	debugMsg(( "Wrapping an uninitialized ODE::Servo pointer." ));
+	return Data_Wrap_Struct( klass, ode_servo_gc_mark, ode_servo_gc_free, 0 );
+}
+
+
+
+/* --------------------------------------------------
+ * Instance Methods
+ * -------------------------------------------------- */
+
+/*
+ * ODE::Servo#initialize( joint, axis=1 )
+ * --
+ * Create a new servo which drives the motor on the given <tt>axis</tt> of
+ * the specified <tt>joint</tt> (an ODE::HingeJoint, ODE::SliderJoint,
+ * ODE::UniversalJoint, or the first axis of an ODE::Hinge2Joint) towards
+ * its #target position and #targetVelocity. Just before each step of the
+ * joint's world, the servo sets the motor's velocity to:
+ *
+ *   targetVelocity + kp * (target - position) + kd * (targetVelocity - rate)
+ *
+ * and its maximum force to #maxForce. The servo starts out enabled, with a
+ * #kp of 1, a #kd of 0, and a #maxForce of 0 (which leaves the joint
+ * limp until it's set).
+ */
+static VALUE
+ode_servo_init( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_SERVO	*ptr;
+	ode_JOINT	*joint;
+	VALUE		jointObj, axisObj;
+	int			axes, axis = 1;
+
+	rb_scan_args( argc, argv, "11", &jointObj, &axisObj );
+
+	if ( check_servo(self) )
+		rb_raise( rb_eRuntimeError, "Cannot re-initialize a servo." );
+
+	joint = ode_get_joint( jointObj );
+	if ( RTEST(axisObj) ) axis = NUM2INT( axisObj );
+
+	if ( (axes = ode_servo_axis_count(dJointGetType(joint->id))) == 0 )
+		rb_raise( rb_eTypeError, "can't drive a %s with a servo",
+				  rb_class2name(CLASS_OF( jointObj )) );
+
+	if ( axis < 1 || axis > axes )
+		rb_raise( rb_eIndexError, "No such axis %d for %s",
+				  axis, rb_class2name(CLASS_OF(jointObj)) );
+
+	DATA_PTR(self) = ptr = ode_servo_alloc();
+	ptr->object = self;
+	ptr->joint = jointObj;
+	ptr->jointptr = joint;
+	ptr->world = joint->world;
+	ptr->type = dJointGetType( joint->id );
+	ptr->axis = axis;
+
+	ode_servo_enable( ptr );
+	return self;
+}
+
+
+/*
+ * ODE::Servo#joint
+ * --
+ * Returns the joint the servo drives.
+ */
+static VALUE
+ode_servo_joint( self )
+	 VALUE self;
+{
+	return get_servo( self )->joint;
+}
+
+
+/*
+ * ODE::Servo#axis
+ * --
+ * Returns the number of the joint axis the servo drives.
+ */
+static VALUE
+ode_servo_axis( self )
+	 VALUE self;
+{
+	return INT2FIX( get_servo(self)->axis );
+}
+
+
+/*
+ * ODE::Servo#target
+ * --
+ * Returns the position (an angle in radians, or a slider's position) the
+ * servo is driving its joint towards.
+ */
+static VALUE
+ode_servo_target( self )
+	 VALUE self;
+{
+	return rb_float_new( get_servo(self)->target );
+}
+
+
+/*
+ * ODE::Servo#target=( position )
+ * --
+ * Set the position the servo drives its joint towards.
+ */
+static VALUE
+ode_servo_target_eq( self, position )
+	 VALUE self, position;
+{
+	get_servo( self )->target = (dReal)NUM2DBL( position );
+	return position;
+}
+
+
+/*
+ * ODE::Servo#targetVelocity
+ * --
+ * Returns the rate the servo tries to move its joint at when it's on target.
+ */
+static VALUE
+ode_servo_target_velocity( self )
+	 VALUE self;
+{
+	return rb_float_new( get_servo(self)->targetVel );
+}
+
+
+/*
+ * ODE::Servo#targetVelocity=( rate )
+ * --
+ * Set the rate the servo tries to move its joint at when it's on target.
+ */
+static VALUE
+ode_servo_target_velocity_eq( self, rate )
+	 VALUE self, rate;
+{
+	get_servo( self )->targetVel = (dReal)NUM2DBL( rate );
+	return rate;
+}
+
+
+/*
+ * ODE::Servo#kp
+ * --
+ * Returns the servo's proportional gain.
+ */
+static VALUE
+ode_servo_kp( self )
+	 VALUE self;
+{
+	return rb_float_new( get_servo(self)->kp );
+}
+
+
+/*
+ * ODE::Servo#kp=( gain )
+ * --
+ * Set the servo's proportional gain, which must be non-negative.
+ */
+static VALUE
+ode_servo_kp_eq( self, gain )
+	 VALUE self, gain;
+{
+	ode_SERVO	*ptr = get_servo( self );
+
+	CheckPositiveNumber( NUM2DBL(gain), "kp" );
+	ptr->kp = (dReal)NUM2DBL( gain );
+
+	return gain;
+}
+
+
+/*
+ * ODE::Servo#kd
+ * --
+ * Returns the servo's derivative gain.
+ */
+static VALUE
+ode_servo_kd( self )
+	 VALUE self;
+{
+	return rb_float_new( get_servo(self)->kd );
+}
+
+
+/*
+ * ODE::Servo#kd=( gain )
+ * --
+ * Set the servo's derivative gain, which must be non-negative.
+ */
+static VALUE
+ode_servo_kd_eq( self, gain )
+	 VALUE self, gain;
+{
+	ode_SERVO	*ptr = get_servo( self );
+
+	CheckPositiveNumber( NUM2DBL(gain), "kd" );
+	ptr->kd = (dReal)NUM2DBL( gain );
+
+	return gain;
+}
+
+
+/*
+ * ODE::Servo#maxForce
+ * --
+ * Returns the maximum force (or torque) the servo's motor may use.
+ */
+static VALUE
+ode_servo_max_force( self )
+	 VALUE self;
+{
+	return rb_float_new( get_servo(self)->maxForce );
+}
+
+
+/*
+ * ODE::Servo#maxForce=( force )
+ * --
+ * Set the maximum force (or torque) the servo's motor may use, which must be
+ * non-negative.
+ */
+static VALUE
+ode_servo_max_force_eq( self, force )
+	 VALUE self, force;
+{
+	ode_SERVO	*ptr = get_servo( self );
+
+	CheckPositiveNumber( NUM2DBL(force), "maxForce" );
+	ptr->maxForce = (dReal)NUM2DBL( force );
+
+	return force;
+}
+
+
+/*
+ * ODE::Servo#command
+ * --
+ * Returns the motor velocity the servo would command for the current state
+ * of its joint.
+ */
+static VALUE
+ode_servo_command_m( self )
+	 VALUE self;
+{
+	ode_SERVO	*ptr = get_servo( self );
+
+	ode_get_joint( ptr->joint );
+	return rb_float_new( ode_servo_command(ptr) );
+}
+
+
+/*
+ * ODE::Servo#enabled?
+ * --
+ * Returns true if the servo drives its joint when the world is stepped.
+ */
+static VALUE
+ode_servo_enabled_p( self )
+	 VALUE self;
+{
+	return get_servo( self )->worldIndex >= 0 ? Qtrue : Qfalse;
+}
+
+
+/*
+ * ODE::Servo#enabled=( flag )
+ * --
+ * Enable or disable the servo. While it's enabled, its world holds on to it,
+ * so a servo needn't be referenced anywhere else to keep working. Disabling
+ * it leaves the joint's motor as the servo last set it.
+ */
+static VALUE
+ode_servo_enabled_eq( self, flag )
+	 VALUE self, flag;
+{
+	ode_SERVO	*ptr = get_servo( self );
+
+	if ( RTEST(flag) )
+		ode_servo_enable( ptr );
+	else
+		ode_servo_disable( ptr );
+
+	return flag;
+}
+
+
+/*
+ * ODE::World#servos
+ * --
+ * Returns the world's enabled servos, in the order #setServoTargets expects
+ * their targets.
+ */
+static VALUE
+ode_world_servos( self )
+	 VALUE self;
+{
+	ode_WORLD	*world = ode_get_world_struct( self );
+	VALUE		ary = rb_ary_new2( world->servoCount );
+	long		i;
+
+	for ( i = 0; i < world->servoCount; i++ )
+		rb_ary_push( ary, world->servos[i]->object );
+
+	return ary;
+}
+
+
+/*
+ * ODE::World#setServoTargets( buffer )
+ * --
+ * Set the targets of all of the world's enabled servos at once from a String
+ * of native doubles with a target position and a target velocity for each
+ * servo, in the order of #servos (ie., an Array of them packed with 'd*').
+ * Returns the number of servos set.
+ */
+static VALUE
+ode_world_set_servo_targets( self, buffer )
+	 VALUE self, buffer;
+{
+	ode_WORLD	*world = ode_get_world_struct( self );
+	double		*values;
+	long		i;
+
+	StringValue( buffer );
+	if ( RSTRING(buffer)->len !=
+		 world->servoCount * ODE_SERVO_TARGET_DOUBLES * (long)sizeof(double) )
+		rb_raise( rb_eArgError, "expected targets for %ld servos, got %ld bytes",
+				  world->servoCount, RSTRING(buffer)->len );
+
+	values = (double *)RSTRING( buffer )->ptr;
+	for ( i = 0; i < world->servoCount; i++ ) {
+		world->servos[i]->target = (dReal)values[ i * ODE_SERVO_TARGET_DOUBLES ];
+		world->servos[i]->targetVel = (dReal)values[ i * ODE_SERVO_TARGET_DOUBLES + 1 ];
+	}
+
+	return LONG2NUM( world->servoCount );
+}
+
+
+/*
+ * ODE::World#servoTargets
+ * --
+ * Returns the targets of the world's enabled servos in the form
+ * #setServoTargets takes them.
+ */
+static VALUE
+ode_world_servo_targets( self )
+	 VALUE self;
+{
+	ode_WORLD	*world = ode_get_world_struct( self );
+	VALUE		buffer;
+	double		*values;
+	long		i;
+
+	buffer = rb_str_new( 0, world->servoCount * ODE_SERVO_TARGET_DOUBLES * sizeof(double) );
+	values = (double *)RSTRING( buffer )->ptr;
+
+	for ( i = 0; i < world->servoCount; i++ ) {
+		values[ i * ODE_SERVO_TARGET_DOUBLES ] = world->servos[i]->target;
+		values[ i * ODE_SERVO_TARGET_DOUBLES + 1 ] = world->servos[i]->targetVel;
+	}
+
+	return buffer;
+}
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_servo()
+{
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeWorld = rb_define_class_under( ode_mOde, "World", rb_cObject );
+	ode_cOdeServo = rb_define_class_under( ode_mOde, "Servo", rb_cObject );
+#endif
+
+	rb_define_alloc_func( ode_cOdeServo, ode_servo_s_alloc );
+
+	rb_define_method( ode_cOdeServo, "initialize", ode_servo_init, -1 );
+
+	rb_define_method( ode_cOdeServo, "joint", ode_servo_joint, 0 );
+	rb_define_method( ode_cOdeServo, "axis", ode_servo_axis, 0 );
+	rb_define_method( ode_cOdeServo, "target", ode_servo_target, 0 );
+	rb_define_method( ode_cOdeServo, "target=", ode_servo_target_eq, 1 );
+	rb_define_method( ode_cOdeServo, "targetVelocity", ode_servo_target_velocity, 0 );
+	rb_define_alias ( ode_cOdeServo, "target_velocity", "targetVelocity" );
+	rb_define_method( ode_cOdeServo, "targetVelocity=", ode_servo_target_velocity_eq, 1 );
+	rb_define_alias ( ode_cOdeServo, "target_velocity=", "targetVelocity=" );
+	rb_define_method( ode_cOdeServo, "kp", ode_servo_kp, 0 );
+	rb_define_method( ode_cOdeServo, "kp=", ode_servo_kp_eq, 1 );
+	rb_define_method( ode_cOdeServo, "kd", ode_servo_kd, 0 );
+	rb_define_method( ode_cOdeServo, "kd=", ode_servo_kd_eq, 1 );
+	rb_define_method( ode_cOdeServo, "maxForce", ode_servo_max_force, 0 );
+	rb_define_alias ( ode_cOdeServo, "max_force", "maxForce" );
+	rb_define_method( ode_cOdeServo, "maxForce=", ode_servo_max_force_eq, 1 );
+	rb_define_alias ( ode_cOdeServo, "max_force=", "maxForce=" );
+	rb_define_method( ode_cOdeServo, "command", ode_servo_command_m, 0 );
+	rb_define_method( ode_cOdeServo, "enabled?", ode_servo_enabled_p, 0 );
+	rb_define_method( ode_cOdeServo, "enabled=", ode_servo_enabled_eq, 1 );
+
+	rb_define_method( ode_cOdeWorld, "servos", ode_world_servos, 0 );
+	rb_define_method( ode_cOdeWorld, "servoTargets", ode_world_servo_targets, 0 );
+	rb_define_alias ( ode_cOdeWorld, "servo_targets", "servoTargets" );
+	rb_define_method( ode_cOdeWorld, "setServoTargets", ode_world_set_servo_targets, 1 );
+	rb_define_alias ( ode_cOdeWorld, "set_servo_targets", "setServoTargets" );
+	rb_define_alias ( ode_cOdeWorld, "servoTargets=", "setServoTargets" );
+	rb_define_alias ( ode_cOdeWorld, "servo_targets=", "setServoTargets" );
+}
+
@@ -28,6 +28,9 @@
  * Macros and constants
  * -------------------------------------------------- */
 
+/* Generation counter used to mark the members of a replacement set in
+   ode_space_geometries_eq() */
+static unsigned long ode_space_stamp = 0;
 
 
 
@@ -99,6 +102,7 @@ ode_space_gc_free( ptr )
 		debugMsg(( "Freeing Space <%p>.", ptr ));
 		dGeomSetData( (dGeomID)space, 0 );
 		dSpaceDestroy( space );
+		if ( ptr->nearCallback ) xfree( ptr->nearCallback );
 		
 		ptr->id			= NULL;
 		ptr->container	= Qnil;
@@ -124,6 +128,10 @@ ode_space_alloc()
 	ptr->object		= Qnil;
 	ptr->container	= Qnil;
 	ptr->body		= Qnil;
+	ptr->stamp		= 0;
+	ptr->serial		= ode_geometry_next_serial();
+	ptr->nearCallback	= NULL;
+	ptr->sensor		= 0;
 
 	debugMsg(( "Initialized ode_GEOMETRY <%p> for an ODE::Space.", ptr ));
 	return ptr;
@@ -285,11 +293,41 @@ ode_space_geometries( self )
 }
 
 
+/*
+ * Add the geometry pointed to by <tt>cptr</tt> to the space <tt>self</tt>
+ * (whose struct is <tt>ptr</tt>), taking it out of the space it's currently
+ * in, if any, since ODE only allows a geometry to be in one space at a time.
+ * Geometries inside a Transform or Compound can't be added to a space.
+ */
+static void
+ode_space_add_geom( self, ptr, cptr )
+	 VALUE			self;
+	 ode_GEOMETRY	*ptr, *cptr;
+{
+	if ( cptr->container == self ) return;
+
+	if ( RTEST(cptr->container) && !IsSpace(cptr->container) )
+		rb_raise( ode_eOdeGeometryError,
+				  "geometry is in a transform or compound" );
+
+	if ( RTEST(cptr->container) ) {
+		ode_GEOMETRY	*oldptr = get_space( cptr->container );
+		dSpaceRemove( (dSpaceID)oldptr->id, (dGeomID)cptr->id );
+	}
+
+	dSpaceAdd( (dSpaceID)ptr->id, (dGeomID)cptr->id );
+	cptr->container = self;
+}
+
+
 /*
  * geometries=( geometryArray )
  * --
  * Set the geometries in the receiving space to the given Array of geometries
- * (ODE::Geometry objects).
+ * (ODE::Geometry objects). This is done in linear time, so it's suitable for
+ * swapping large sets of geometries in and out at once. ODE doesn't rebuild
+ * the space's broadphase structures until the next collision pass, so
+ * replacing the set several times between steps only costs the bookkeeping.
  */
 static VALUE
 ode_space_geometries_eq( self, geometryArray )
@@ -297,41 +335,47 @@ ode_space_geometries_eq( self, geometryArray )
 {
 	ode_GEOMETRY	*ptr = get_space( self );
 	dSpaceID		thisSpace = (dSpaceID)( ptr->id );
-	int				i, geomCount = dSpaceGetNumGeoms( (dSpaceID)ptr->id );
-	VALUE			removeGeoms = rb_ary_new(),
-					addGeoms = rb_ary_new();
+	unsigned long	stamp = ++ode_space_stamp;
+	int				i, geomCount, removeCount = 0;
+	dGeomID			*removeGeoms;
 
 	Check_Type( geometryArray, T_ARRAY );
 
-	/* First remove any geometries that aren't in the new array -- Build an
-	   array of all geometries that are currently in the space but aren't in the
-	   new array. */
+	/* Stamp every member of the new set so the ones already in the space
+	   can be recognized without searching the Array, checking that they can
+	   all be added before changing anything */
+	for ( i = 0 ; i < RARRAY(geometryArray)->len ; i++ ) {
+		ode_GEOMETRY	*gptr = ode_get_geom( *(RARRAY(geometryArray)->ptr + i) );
+
+		if ( RTEST(gptr->container) && !IsSpace(gptr->container) )
+			rb_raise( ode_eOdeGeometryError,
+					  "geometry is in a transform or compound" );
+		gptr->stamp = stamp;
+	}
+
+	/* Gather the current members that aren't in the new set first, as
+	   removing them while walking the space would restart ODE's index cache
+	   on every lookup. */
+	geomCount = dSpaceGetNumGeoms( thisSpace );
+	removeGeoms = ALLOC_N( dGeomID, geomCount + 1 );
+
 	for ( i = 0 ; i < geomCount ; i++ ) {
 		dGeomID			geom = dSpaceGetGeom( thisSpace, i );
 		ode_GEOMETRY	*gptr = dGeomGetData( geom );
 
-		if ( !RTEST(rb_ary_includes( geometryArray, gptr->object )) )
-			rb_ary_push( removeGeoms, gptr->object );
+		if ( gptr->stamp != stamp )
+			removeGeoms[ removeCount++ ] = geom;
 	}
 
-	/* If there are any geometries to remove, remove them via #removeGeometries to give
-	   derivatives a chance to act on the removals. */
-	if ( RARRAY(removeGeoms)->len )
-		rb_funcall( self, rb_intern("removeGeometries"), 1, &removeGeoms );
-
-	/* Now make an array of geometries which are in the new array, but aren't in
-	   the space currently. */
-	for ( i = 0 ; i < RARRAY(geometryArray)->len ; i++ ) {
-		ode_GEOMETRY *geom = ode_get_geom( *(RARRAY(geometryArray)->ptr + i) );
-
-		if ( !dSpaceQuery(thisSpace, geom->id) )
-			rb_ary_push( addGeoms, geom->object );
+	for ( i = 0 ; i < removeCount ; i++ ) {
+		dSpaceRemove( thisSpace, removeGeoms[i] );
+		((ode_GEOMETRY *)dGeomGetData( removeGeoms[i] ))->container = Qnil;
 	}
+	xfree( removeGeoms );
 
-	/* If there are any geometries to add, add them via #addGeometries to give
-	   derivatives a chance to act on the additions. */
-	if ( RARRAY(addGeoms)->len )
-		rb_funcall( self, rb_intern("addGeometries"), 1, &addGeoms );
+	/* Now add the ones that aren't already here */
+	for ( i = 0 ; i < RARRAY(geometryArray)->len ; i++ )
+		ode_space_add_geom( self, ptr, ode_get_geom(*(RARRAY(geometryArray)->ptr + i)) );
 
 	/* It doesn't really matter what we return here, as Matz decided assignment
 	   methods always return what was assigned, so... */
@@ -343,7 +387,8 @@ ode_space_geometries_eq( self, geometryArray )
  * addGeometries( *geometries )
  * --
  * Add the specified geometries (ODE::Geometry objects) to the receiving
- * space and return the space itself.
+ * space and return the space itself. Geometries which are in another space
+ * are moved to this one.
  */
 static VALUE
 ode_space_insert( self, args )
@@ -355,10 +400,8 @@ ode_space_insert( self, args )
 	if ( TYPE(args) != T_ARRAY )
 		rb_bug( "Expected array, got a %s.", rb_class2name(CLASS_OF(args)) );
 
-	for ( i = 0; i < RARRAY(args)->len; i++ ) {
-		ode_GEOMETRY	*cptr = ode_get_geom( *(RARRAY(args)->ptr + i) );
-		dSpaceAdd( (dSpaceID)ptr->id, (dGeomID)cptr->id );
-	}
+	for ( i = 0; i < RARRAY(args)->len; i++ )
+		ode_space_add_geom( self, ptr, ode_get_geom(*(RARRAY(args)->ptr + i)) );
 
 	return self;
 }
@@ -383,9 +426,12 @@ ode_space_remove( self, args )
 
 	for ( i = 0; i < RARRAY(args)->len; i++ ) {
 		ode_GEOMETRY	*cptr = ode_get_geom( *(RARRAY(args)->ptr + i) );
-		if ( dSpaceQuery((dSpaceID)ptr->id, (dGeomID)cptr->id) ) {
+
+		/* The container link says whether it's here without asking ODE */
+		if ( cptr->container == self ) {
 			rb_ary_push( rary, *(RARRAY(args)->ptr + i) );
 			dSpaceRemove( (dSpaceID)ptr->id, (dGeomID)cptr->id );
+			cptr->container = Qnil;
 		}
 	}
 
@@ -394,23 +440,26 @@ ode_space_remove( self, args )
 
 
 /*
- * Utility recursive containment tester function for ode_space_contains_p().
+ * Utility containment function for ode_space_contains_p() and
+ * ode_space_depth_of(). Walks up the chain of containers from the given
+ * geometry until it reaches the specified space, returning the number of
+ * levels climbed, or 0 if the geometry isn't in the space at any depth. A
+ * geometry inside a Transform or Compound isn't in any space itself.
  */
 static int
-ode_spaceId_contains( space, geom )
-	 dSpaceID space;
-	 dGeomID  geom;
+ode_space_depth_of_geom( self, geomPtr )
+	 VALUE			self;
+	 ode_GEOMETRY	*geomPtr;
 {
-	int i, numGeoms = dSpaceGetNumGeoms( space );
-
-	if ( dSpaceQuery(space, geom) )
-		return 1;
+	VALUE	container = geomPtr->container;
+	int		depth = 1;
 
-	for ( i = 0 ; i < numGeoms ; i++ ) {
-		dGeomID containedGeom = dSpaceGetGeom( space, i );
+	while ( RTEST(container) && IsSpace(container) ) {
+		if ( container == self )
+			return depth;
 
-		if ( dGeomIsSpace(containedGeom) && ode_spaceId_contains((dSpaceID)containedGeom, geom) )
-			return 1;
+		container = get_space( container )->container;
+		depth++;
 	}
 
 	return 0;
@@ -428,16 +477,39 @@ static VALUE
 ode_space_contains_p( self, geom )
 	 VALUE self, geom;
 {
-	ode_GEOMETRY	*ptr = get_space( self );
 	ode_GEOMETRY	*targetPtr = ode_get_geom( geom );
 
-	if ( ode_spaceId_contains((dSpaceID)ptr->id, targetPtr->id) )
+	get_space( self );
+	if ( ode_space_depth_of_geom(self, targetPtr) )
 		return Qtrue;
 	else
 		return Qfalse;
 }
 
 
+/*
+ * depthOf( geom )
+ * --
+ * Returns the number of levels of nesting between the receiving space and
+ * the specified <tt>geom</tt> (an ODE::Geometry object): 1 if the space
+ * contains it directly, 2 if it's in a space contained by this one, and so
+ * on. Returns nil if the geometry isn't in the space at all.
+ */
+static VALUE
+ode_space_depth_of( self, geom )
+	 VALUE self, geom;
+{
+	ode_GEOMETRY	*targetPtr = ode_get_geom( geom );
+	int				depth;
+
+	get_space( self );
+	if (( depth = ode_space_depth_of_geom(self, targetPtr) ))
+		return INT2FIX( depth );
+	else
+		return Qnil;
+}
+
+
 
 
 /*
@@ -493,7 +565,10 @@ ode_space_each( self )
  * --
  * Call the specified <tt>block</tt> once for each adjacent pair of
  * ODE::Geometry objects in the receiving space. The block must accept three
- * arguments: the two geometries and a <tt>data</tt> Array.
+ * arguments: the two geometries and a <tt>data</tt> Array. If no block is
+ * given, the native near callback another extension has registered for the
+ * space (see #nativeNearCallback?) is called for each pair instead, without
+ * going through Ruby at all.
  */
 static VALUE
 ode_space_each_adjacent_pair( argc, argv, self )
@@ -506,6 +581,15 @@ ode_space_each_adjacent_pair( argc, argv, self )
 
 	rb_scan_args( argc, argv, "0*&", &data, &block );
 
+	if ( NIL_P(block) && ptr->nearCallback ) {
+		dSpaceCollide( (dSpaceID)ptr->id, ptr->nearCallback,
+					   (dNearCallback *)(ode_native_near_callback) );
+		return Qtrue;
+	}
+	else if ( NIL_P(block) ) {
+		rb_raise( ruby_eLocalJumpError, "no block given" );
+	}
+
 	ode_check_arity( block, 3 );
 
 	callback = ALLOCA_N( ode_CALLBACK, 1 );
@@ -522,6 +606,62 @@ ode_space_each_adjacent_pair( argc, argv, self )
 
 
 
+/*
+ * nativeNearCallback?
+ * --
+ * Returns true if a C extension has registered a native near callback for
+ * the receiving space with ode_space_set_near_callback() (see rubyode.h).
+ */
+static VALUE
+ode_space_native_near_callback_p( self )
+	 VALUE self;
+{
+	ode_GEOMETRY *ptr = get_space( self );
+	return ptr->nearCallback ? Qtrue : Qfalse;
+}
+
+
+/*
+ * Dispatch a near callback for the pair (<tt>o1</tt>, <tt>o2</tt>) to the
+ * registered native callback <tt>callback</tt>.
+ */
+void
+ode_native_near_callback( callback, o1, o2 )
+	 ode_NEARCALLBACK	*callback;
+	 dGeomID			o1, o2;
+{
+	callback->func( callback->data, dGeomGetData(o1), dGeomGetData(o2) );
+}
+
+
+/*
+ * Register <tt>func</tt> (to be called with <tt>data</tt>) as the native near
+ * callback for the given <tt>space</tt>, replacing any already registered. A
+ * NULL <tt>func</tt> removes it. Part of the API for other C extensions in
+ * rubyode.h.
+ */
+void
+ode_space_set_near_callback( space, func, data )
+	 VALUE			space;
+	 ode_NEARFUNC	func;
+	 void			*data;
+{
+	ode_GEOMETRY *ptr = get_space( space );
+
+	if ( !func ) {
+		if ( ptr->nearCallback ) xfree( ptr->nearCallback );
+		ptr->nearCallback = NULL;
+		return;
+	}
+
+	if ( !ptr->nearCallback )
+		ptr->nearCallback = ALLOC( ode_NEARCALLBACK );
+	ptr->nearCallback->func = func;
+	ptr->nearCallback->data = data;
+}
+
+
+
 /* --- ODE::HashSpace ------------------------------ */
 
 /*
@@ -629,6 +769,8 @@ void ode_init_space()
 
 	rb_define_method( ode_cOdeSpace, "contains?", ode_space_contains_p, 1 );
 	rb_define_method( ode_cOdeSpace, "directlyContains?", ode_space_directly_contains_p, 1 );
+	rb_define_method( ode_cOdeSpace, "depthOf", ode_space_depth_of, 1 );
+	rb_define_alias ( ode_cOdeSpace, "depth_of", "depthOf" );
 
 	rb_define_method( ode_cOdeSpace, "each", ode_space_each, 0 );
 	rb_define_alias ( ode_cOdeSpace, "eachGeometry", "each" );
@@ -638,6 +780,8 @@ void ode_init_space()
 	rb_define_alias ( ode_cOdeSpace, "each_adjacent_pair", "eachAdjacentPair" );
 	rb_define_alias ( ode_cOdeSpace, "eachNearPair", "eachAdjacentPair" );
 	rb_define_alias ( ode_cOdeSpace, "each_near_pair", "eachAdjacentPair" );
+	rb_define_method( ode_cOdeSpace, "nativeNearCallback?", ode_space_native_near_callback_p, 0 );
+	rb_define_alias ( ode_cOdeSpace, "native_near_callback?", "nativeNearCallback?" );
 
 
 	/* --- ODE::HashSpace ------------------------------ */
@@ -0,0 +1,640 @@
+/*
+ *		spring.c - ODE Ruby Binding - Spring Class
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 22:48:19 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* Which ways a spring pushes and pulls */
+#define ODE_SPRING_BOTH			0
+#define ODE_SPRING_TENSION		1	/* Only pulls, like a cable or bungee */
+#define ODE_SPRING_COMPRESSION	2	/* Only pushes, like a bump stop */
+
+/* The size of one spring's record in a packed state buffer */
+#define ODE_SPRING_STATE_DOUBLES	3
+
+/* Springs shorter than this have no direction to act in */
+#define ODE_SPRING_EPSILON		1e-9
+
+
+
+/* --------------------------------------------------
+ *	Memory-management functions
+ * -------------------------------------------------- */
+
+/*
+ * Allocation function
+ */
+static ode_SPRINGSET *
+ode_spring_alloc()
+{
+	ode_SPRINGSET *ptr = ALLOC( ode_SPRINGSET );
+
+	ptr->object		= Qnil;
+	ptr->world		= Qnil;
+	ptr->bodies		= Qnil;
+	ptr->springs	= NULL;
+	ptr->count		= 0;
+	ptr->capacity	= 0;
+	ptr->worldIndex	= -1;
+
+	debugMsg(( "Initialized ode_SPRINGSET <%p>", ptr ));
+	return ptr;
+}
+
+
+/*
+ * GC Mark function
+ */
+static void
+ode_spring_gc_mark( ptr )
+	 ode_SPRINGSET *ptr;
+{
+	debugMsg(( "Marking an ODE::Spring" ));
+
+	if ( ptr ) {
+		rb_gc_mark( ptr->world );
+		rb_gc_mark( ptr->bodies );
+	}
+}
+
+
+/*
+ * GC Free function. Enabled spring sets are kept alive by their world, so
+ * one that's being freed is either disabled or going down with its world.
+ */
+static void
+ode_spring_gc_free( ptr )
+	 ode_SPRINGSET *ptr;
+{
+	if ( ptr ) {
+		debugMsg(( "Destroying Spring <%p>", ptr ));
+		if ( ptr->springs ) xfree( ptr->springs );
+		ptr->springs = NULL;
+
+		xfree( ptr );
+		ptr = NULL;
+	}
+}
+
+
+/*
+ * Object validity checker. Returns the data pointer.
+ */
+static ode_SPRINGSET *
+check_spring( self )
+	 VALUE	self;
+{
+	debugMsg(( "Checking a Spring object (%d).", self ));
+	Check_Type( self, T_DATA );
+
+    if ( !rb_obj_is_kind_of(self, ode_cOdeSpring) ) {
+		rb_raise( rb_eTypeError, "wrong argument type %s (expected ODE::Spring)",
+				  rb_class2name(CLASS_OF( self )) );
+    }
+
+	return DATA_PTR( self );
+}
+
+
+/*
+ * Fetch the data pointer and check it for sanity.
+ */
+static ode_SPRINGSET *
+get_spring( self )
+	 VALUE self;
+{
+	ode_SPRINGSET *ptr = check_spring( self );
+
+	debugMsg(( "Fetching an ode_SPRINGSET (%p).", ptr ));
+	if ( !ptr )
+		rb_raise( rb_eRuntimeError, "uninitialized spring" );
+
+	return ptr;
+}
+
+
+/*
+ * Return the spring at the given index, raising an IndexError if there
+ * isn't one.
+ */
+static ode_SPRING *
+ode_spring_at( ptr, index )
+	 ode_SPRINGSET	*ptr;
+	 VALUE			index;
+{
+	long	i = NUM2LONG( index );
+
+	if ( i < 0 || i >= ptr->count )
+		rb_raise( rb_eIndexError, "no spring %ld (%ld springs)", i, ptr->count );
+
+	return ptr->springs + i;
+}
+
+
+
+/* --------------------------------------------------
+ * Stepping
+ * -------------------------------------------------- */
+
+/*
+ * Set <tt>pos</tt> and <tt>vel</tt> to the world position and velocity of
+ * the anchor of a spring end on the given <tt>body</tt>, or to the anchor
+ * itself and zero if the end is fixed to the static environment.
+ */
+static void
+ode_spring_end( body, anchor, pos, vel )
+	 dBodyID		body;
+	 const dReal	*anchor;
+	 dVector3		pos, vel;
+{
+	if ( body ) {
+		dBodyGetRelPointPos( body, anchor[0], anchor[1], anchor[2], pos );
+		dBodyGetRelPointVel( body, anchor[0], anchor[1], anchor[2], vel );
+	} else {
+		pos[0] = anchor[0]; pos[1] = anchor[1]; pos[2] = anchor[2];
+		vel[0] = vel[1] = vel[2] = 0;
+	}
+}
+
+
+/*
+ * Apply the forces of each of the world's enabled springs to their bodies.
+ * Called just before the world is stepped.
+ */
+void
+ode_spring_prestep( world )
+	 ode_WORLD	*world;
+{
+	ode_SPRINGSET	*set;
+	ode_SPRING		*spring;
+	dVector3		p1, p2, v1, v2, dir;
+	dReal			len, stretch, force;
+	long			i, j;
+	int				k;
+
+	for ( i = 0; i < world->springSetCount; i++ ) {
+		set = world->springSets[i];
+
+		for ( j = 0; j < set->count; j++ ) {
+			spring = set->springs + j;
+			ode_spring_end( spring->body1, spring->anchor1, p1, v1 );
+			ode_spring_end( spring->body2, spring->anchor2, p2, v2 );
+
+			for ( k = 0; k < 3; k++ ) dir[k] = p2[k] - p1[k];
+			len = dSqrt( dir[0]*dir[0] + dir[1]*dir[1] + dir[2]*dir[2] );
+			spring->length = len;
+			if ( len < ODE_SPRING_EPSILON ) {
+				spring->rate = spring->force = 0;
+				continue;
+			}
+
+			for ( k = 0; k < 3; k++ ) dir[k] /= len;
+			spring->rate = ( v2[0] - v1[0] ) * dir[0] + ( v2[1] - v1[1] ) * dir[1] +
+				( v2[2] - v1[2] ) * dir[2];
+
+			/* Positive force is tension, pulling the ends together */
+			stretch = len - spring->restLength;
+			if ( (spring->mode == ODE_SPRING_TENSION && stretch <= 0) ||
+				 (spring->mode == ODE_SPRING_COMPRESSION && stretch >= 0) )
+				force = 0;
+			else
+				force = spring->stiffness * stretch + spring->damping * spring->rate;
+
+			/* Damping mustn't turn a one-way spring the other way */
+			if ( (spring->mode == ODE_SPRING_TENSION && force < 0) ||
+				 (spring->mode == ODE_SPRING_COMPRESSION && force > 0) )
+				force = 0;
+
+			spring->force = force;
+			if ( force == 0 ) continue;
+
+			if ( spring->body1 )
+				dBodyAddForceAtPos( spring->body1, force * dir[0], force * dir[1], force * dir[2],
+									p1[0], p1[1], p1[2] );
+			if ( spring->body2 )
+				dBodyAddForceAtPos( spring->body2, -force * dir[0], -force * dir[1], -force * dir[2],
+									p2[0], p2[1], p2[2] );
+		}
+	}
+}
+
+
+/*
+ * Add the given spring set to its world's list of enabled ones.
+ */
+static void
+ode_spring_enable( ptr )
+	 ode_SPRINGSET	*ptr;
+{
+	ode_WORLD	*world = ode_get_world_struct( ptr->world );
+
+	if ( ptr->worldIndex >= 0 ) return;
+
+	if ( world->springSetCount == world->springSetCapacity ) {
+		world->springSetCapacity = world->springSetCapacity ? world->springSetCapacity * 2 : 4;
+		REALLOC_N( world->springSets, ode_SPRINGSET *, world->springSetCapacity );
+	}
+
+	ptr->worldIndex = world->springSetCount;
+	world->springSets[ world->springSetCount++ ] = ptr;
+}
+
+
+/*
+ * Remove the given spring set from its world's list of enabled ones.
+ */
+static void
+ode_spring_disable( ptr )
+	 ode_SPRINGSET	*ptr;
+{
+	ode_WORLD		*world = ode_get_world_struct( ptr->world );
+	ode_SPRINGSET	*last;
+
+	if ( ptr->worldIndex < 0 || ptr->worldIndex >= world->springSetCount ||
+		 world->springSets[ptr->worldIndex] != ptr )
+		return;
+
+	last = world->springSets[ --world->springSetCount ];
+	world->springSets[ ptr->worldIndex ] = last;
+	last->worldIndex = ptr->worldIndex;
+	ptr->worldIndex = -1;
+}
+
+
+
+/* --------------------------------------------------
+ * Class Methods
+ * -------------------------------------------------- */
+
+/*
+ * allocate()
+ * --
+ * Allocate a new ODE::Spring object.
+ */
+static VALUE
+ode_spring_s_alloc( klass )
+{
+	debugMsg(( "Wrapping an uninitialized ODE::Spring pointer." ));
+	return Data_Wrap_Struct( klass, ode_spring_gc_mark, ode_spring_gc_free, 0 );
+}
+
+
+
+/* --------------------------------------------------
+ * Instance Methods
+ * -------------------------------------------------- */
+
+/*
+ * ODE::Spring#initialize( world )
+ * --
+ * Create a new, empty, collection of spring-dampers in the given
+ * <tt>world</tt>. Springs are added to it with #add. Just before each step
+ * of the world, each spring applies equal and opposite forces to its ends
+ * along the line between them:
+ *
+ *   stiffness * (length - restLength) + damping * lengthRate
+ *
+ * The collection starts out enabled, and the world holds on to it while
+ * it is.
+ */
+static VALUE
+ode_spring_init( self, world )
+	 VALUE self, world;
+{
+	ode_SPRINGSET	*ptr;
+
+	if ( check_spring(self) )
+		rb_raise( rb_eRuntimeError, "Cannot re-initialize a spring set." );
+
+	ode_get_world_struct( world );
+
+	DATA_PTR(self) = ptr = ode_spring_alloc();
+	ptr->object = self;
+	ptr->world = world;
+	ptr->bodies = rb_ary_new();
+
+	ode_spring_enable( ptr );
+	return self;
+}
+
+
+/*
+ * ODE::Spring#add( body1, anchor1, body2, anchor2, stiffness, damping=0, restLength=nil, mode=BOTH )
+ * --
+ * Add a spring between the point <tt>anchor1</tt> on <tt>body1</tt> and the
+ * point <tt>anchor2</tt> on <tt>body2</tt> (each relative to its body, or
+ * in world coordinates if the body is <tt>nil</tt>, for a spring fixed to
+ * the static environment). If no <tt>restLength</tt> is given, the current
+ * distance between the points is used. The <tt>mode</tt> is one of BOTH,
+ * TENSION (it only pulls, like a cable or bungee), or COMPRESSION (it only
+ * pushes). Returns the index of the new spring.
+ */
+static VALUE
+ode_spring_add( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_SPRINGSET	*ptr = get_spring( self );
+	ode_SPRING		*spring;
+	VALUE			body1, anchor1, body2, anchor2, stiffness, damping, restLength, mode;
+	dVector3		p1, p2, v;
+	int				m = ODE_SPRING_BOTH;
+
+	rb_scan_args( argc, argv, "53", &body1, &anchor1, &body2, &anchor2, &stiffness,
+				  &damping, &restLength, &mode );
+
+	anchor1 = ode_obj_to_ary3( anchor1, "anchor1" );
+	anchor2 = ode_obj_to_ary3( anchor2, "anchor2" );
+	CheckPositiveNumber( NUM2DBL(stiffness), "stiffness" );
+	if ( RTEST(damping) ) CheckPositiveNumber( NUM2DBL(damping), "damping" );
+	if ( RTEST(restLength) ) CheckPositiveNumber( NUM2DBL(restLength), "restLength" );
+	if ( RTEST(mode) ) {
+		m = NUM2INT( mode );
+		if ( m != ODE_SPRING_BOTH && m != ODE_SPRING_TENSION && m != ODE_SPRING_COMPRESSION )
+			rb_raise( rb_eArgError, "invalid spring mode %d", m );
+	}
+	if ( !RTEST(body1) && !RTEST(body2) )
+		rb_raise( rb_eArgError, "a spring needs at least one body" );
+
+	if ( ptr->count == ptr->capacity ) {
+		ptr->capacity = ptr->capacity ? ptr->capacity * 2 : 16;
+		REALLOC_N( ptr->springs, ode_SPRING, ptr->capacity );
+	}
+
+	spring = ptr->springs + ptr->count;
+	spring->body1 = RTEST( body1 ) ? ode_get_body( body1 )->id : 0;
+	spring->body2 = RTEST( body2 ) ? ode_get_body( body2 )->id : 0;
+	SetVec3FromArray( spring->anchor1, anchor1 );
+	SetVec3FromArray( spring->anchor2, anchor2 );
+	spring->stiffness = (dReal)NUM2DBL( stiffness );
+	spring->damping = RTEST( damping ) ? (dReal)NUM2DBL( damping ) : 0;
+	spring->mode = m;
+
+	ode_spring_end( spring->body1, spring->anchor1, p1, v );
+	ode_spring_end( spring->body2, spring->anchor2, p2, v );
+	spring->length = dSqrt( (p2[0]-p1[0])*(p2[0]-p1[0]) + (p2[1]-p1[1])*(p2[1]-p1[1]) +
+							(p2[2]-p1[2])*(p2[2]-p1[2]) );
+	spring->restLength = RTEST( restLength ) ? (dReal)NUM2DBL( restLength ) : spring->length;
+	spring->rate = spring->force = 0;
+
+	rb_ary_push( ptr->bodies, rb_assoc_new(body1, body2) );
+	return LONG2NUM( ptr->count++ );
+}
+
+
+/*
+ * ODE::Spring#remove( index )
+ * --
+ * Remove the spring at the given <tt>index</tt>. The last spring takes its
+ * index.
+ */
+static VALUE
+ode_spring_remove( self, index )
+	 VALUE self, index;
+{
+	ode_SPRINGSET	*ptr = get_spring( self );
+	ode_SPRING		*spring = ode_spring_at( ptr, index );
+	long			i = spring - ptr->springs;
+
+	ptr->count--;
+	ptr->springs[i] = ptr->springs[ ptr->count ];
+	rb_ary_store( ptr->bodies, i, RARRAY(ptr->bodies)->ptr[ptr->count] );
+	rb_ary_pop( ptr->bodies );
+
+	return self;
+}
+
+
+/*
+ * ODE::Spring#size
+ * --
+ * Returns the number of springs in the collection.
+ */
+static VALUE
+ode_spring_size( self )
+	 VALUE self;
+{
+	return LONG2NUM( get_spring(self)->count );
+}
+
+
+/*
+ * ODE::Spring#spring( index )
+ * --
+ * Returns the settings of the spring at the given <tt>index</tt> as an
+ * Array: <tt>[body1, anchor1, body2, anchor2, stiffness, damping,
+ * restLength, mode]</tt>.
+ */
+static VALUE
+ode_spring_spring( self, index )
+	 VALUE self, index;
+{
+	ode_SPRINGSET	*ptr = get_spring( self );
+	ode_SPRING		*spring = ode_spring_at( ptr, index );
+	VALUE			bodies = RARRAY( ptr->bodies )->ptr[ spring - ptr->springs ];
+
+	return rb_ary_new3( 8,
+		RARRAY(bodies)->ptr[0], ode_vector3_to_rArray(spring->anchor1),
+		RARRAY(bodies)->ptr[1], ode_vector3_to_rArray(spring->anchor2),
+		rb_float_new(spring->stiffness), rb_float_new(spring->damping),
+		rb_float_new(spring->restLength), INT2FIX(spring->mode) );
+}
+
+
+/*
+ * ODE::Spring#setRestLength( index, length )
+ * --
+ * Set the rest length of the spring at the given <tt>index</tt> (to wind
+ * a winch in or out, for instance).
+ */
+static VALUE
+ode_spring_set_rest_length( self, index, length )
+	 VALUE self, index, length;
+{
+	ode_SPRING	*spring = ode_spring_at( get_spring(self), index );
+
+	CheckPositiveNumber( NUM2DBL(length), "length" );
+	spring->restLength = (dReal)NUM2DBL( length );
+
+	return length;
+}
+
+
+/*
+ * ODE::Spring#setStiffness( index, stiffness, damping=nil )
+ * --
+ * Set the stiffness, and optionally the damping, of the spring at the given
+ * <tt>index</tt>.
+ */
+static VALUE
+ode_spring_set_stiffness( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_SPRING	*spring;
+	VALUE		index, stiffness, damping;
+
+	rb_scan_args( argc, argv, "21", &index, &stiffness, &damping );
+	spring = ode_spring_at( get_spring(self), index );
+
+	CheckPositiveNumber( NUM2DBL(stiffness), "stiffness" );
+	if ( RTEST(damping) ) CheckPositiveNumber( NUM2DBL(damping), "damping" );
+
+	spring->stiffness = (dReal)NUM2DBL( stiffness );
+	if ( RTEST(damping) ) spring->damping = (dReal)NUM2DBL( damping );
+
+	return self;
+}
+
+
+/*
+ * ODE::Spring#stateInto( buffer=nil )
+ * --
+ * Returns the state of all of the springs as of the last step, as a String
+ * of native doubles with STATE_SIZE of them for each spring, in index order:
+ * its length, the rate its length is changing at, and the force it applied
+ * (positive for tension). Unpack it with 'd*'. If a <tt>buffer</tt> String
+ * is given, its contents are replaced with the state and it's returned
+ * instead.
+ */
+static VALUE
+ode_spring_state_into( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_SPRINGSET	*ptr = get_spring( self );
+	VALUE			buffer;
+	double			*out;
+	long			i;
+
+	if ( rb_scan_args(argc, argv, "01", &buffer) && RTEST(buffer) )
+		StringValue( buffer );
+	else
+		buffer = rb_str_new( 0, 0 );
+
+	rb_str_modify( buffer );
+	rb_str_resize( buffer, ptr->count * ODE_SPRING_STATE_DOUBLES * sizeof(double) );
+	out = (double *)RSTRING( buffer )->ptr;
+
+	for ( i = 0; i < ptr->count; i++ ) {
+		*out++ = ptr->springs[i].length;
+		*out++ = ptr->springs[i].rate;
+		*out++ = ptr->springs[i].force;
+	}
+
+	return buffer;
+}
+
+
+/*
+ * ODE::Spring#enabled?
+ * --
+ * Returns true if the springs act on their bodies when the world is stepped.
+ */
+static VALUE
+ode_spring_enabled_p( self )
+	 VALUE self;
+{
+	return get_spring( self )->worldIndex >= 0 ? Qtrue : Qfalse;
+}
+
+
+/*
+ * ODE::Spring#enabled=( flag )
+ * --
+ * Enable or disable all of the springs in the collection.
+ */
+static VALUE
+ode_spring_enabled_eq( self, flag )
+	 VALUE self, flag;
+{
+	ode_SPRINGSET	*ptr = get_spring( self );
+
+	if ( RTEST(flag) )
+		ode_spring_enable( ptr );
+	else
+		ode_spring_disable( ptr );
+
+	return flag;
+}
+
+
+/*
+ * ODE::World#springs
+ * --
+ * Returns the world's enabled spring collections.
+ */
+static VALUE
+ode_world_springs( self )
+	 VALUE self;
+{
+	ode_WORLD	*world = ode_get_world_struct( self );
+	VALUE		ary = rb_ary_new2( world->springSetCount );
+	long		i;
+
+	for ( i = 0; i < world->springSetCount; i++ )
+		rb_ary_push( ary, world->springSets[i]->object );
+
+	return ary;
+}
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_spring()
+{
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeWorld = rb_define_class_under( ode_mOde, "World", rb_cObject );
+	ode_cOdeSpring = rb_define_class_under( ode_mOde, "Spring", rb_cObject );
+#endif
+
+	rb_define_const( ode_cOdeSpring, "BOTH", INT2FIX(ODE_SPRING_BOTH) );
+	rb_define_const( ode_cOdeSpring, "TENSION", INT2FIX(ODE_SPRING_TENSION) );
+	rb_define_const( ode_cOdeSpring, "COMPRESSION", INT2FIX(ODE_SPRING_COMPRESSION) );
+	rb_define_const( ode_cOdeSpring, "STATE_SIZE", INT2FIX(ODE_SPRING_STATE_DOUBLES) );
+
+	rb_define_alloc_func( ode_cOdeSpring, ode_spring_s_alloc );
+
+	rb_define_method( ode_cOdeSpring, "initialize", ode_spring_init, 1 );
+
+	rb_define_method( ode_cOdeSpring, "add", ode_spring_add, -1 );
+	rb_define_method( ode_cOdeSpring, "remove", ode_spring_remove, 1 );
+	rb_define_method( ode_cOdeSpring, "size", ode_spring_size, 0 );
+	rb_define_alias ( ode_cOdeSpring, "length", "size" );
+	rb_define_method( ode_cOdeSpring, "spring", ode_spring_spring, 1 );
+	rb_define_alias ( ode_cOdeSpring, "[]", "spring" );
+	rb_define_method( ode_cOdeSpring, "setRestLength", ode_spring_set_rest_length, 2 );
+	rb_define_alias ( ode_cOdeSpring, "set_rest_length", "setRestLength" );
+	rb_define_method( ode_cOdeSpring, "setStiffness", ode_spring_set_stiffness, -1 );
+	rb_define_alias ( ode_cOdeSpring, "set_stiffness", "setStiffness" );
+	rb_define_method( ode_cOdeSpring, "stateInto", ode_spring_state_into, -1 );
+	rb_define_alias ( ode_cOdeSpring, "state_into", "stateInto" );
+	rb_define_alias ( ode_cOdeSpring, "state", "stateInto" );
+	rb_define_method( ode_cOdeSpring, "enabled?", ode_spring_enabled_p, 0 );
+	rb_define_method( ode_cOdeSpring, "enabled=", ode_spring_enabled_eq, 1 );
+
+	rb_define_method( ode_cOdeWorld, "springs", ode_world_springs, 0 );
+}
+
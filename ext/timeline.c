@@ -0,0 +1,822 @@
+/*
+ *		timeline.c - ODE Ruby Binding - Timeline Class
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 21:14:05 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+#include <math.h>
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* Interpolation between keyframes */
+#define ODE_TIMELINE_LINEAR		0
+#define ODE_TIMELINE_CUBIC		1
+
+/* What the keyframe values drive */
+#define ODE_TIMELINE_VELOCITY	0
+#define ODE_TIMELINE_POSITION	1
+
+/* Steps ending this close to the last keyframe end on it, so rounding in the
+   accumulated time doesn't leave a timeline a step short */
+#define ODE_TIMELINE_EPSILON	1e-9
+
+
+
+/* --------------------------------------------------
+ *	Memory-management functions
+ * -------------------------------------------------- */
+
+/*
+ * Allocation function
+ */
+static ode_TIMELINE *
+ode_timeline_alloc()
+{
+	ode_TIMELINE *ptr = ALLOC( ode_TIMELINE );
+
+	ptr->object			= Qnil;
+	ptr->joint			= Qnil;
+	ptr->world			= Qnil;
+	ptr->jointptr		= NULL;
+	ptr->axis			= 1;
+	ptr->mode			= ODE_TIMELINE_VELOCITY;
+	ptr->interpolation	= ODE_TIMELINE_LINEAR;
+	ptr->loop			= 0;
+	ptr->times			= NULL;
+	ptr->values			= NULL;
+	ptr->count			= 0;
+	ptr->time			= 0;
+	ptr->worldIndex		= -1;
+
+	debugMsg(( "Initialized ode_TIMELINE <%p>", ptr ));
+	return ptr;
+}
+
+
+/*
+ * GC Mark function
+ */
+static void
+ode_timeline_gc_mark( ptr )
+	 ode_TIMELINE *ptr;
+{
+	debugMsg(( "Marking an ODE::Timeline" ));
+
+	if ( ptr ) {
+		rb_gc_mark( ptr->joint );
+		rb_gc_mark( ptr->world );
+	}
+}
+
+
+/*
+ * GC Free function. Running timelines are kept alive by their world, so one
+ * that's being freed is either stopped or going down with its world.
+ */
+static void
+ode_timeline_gc_free( ptr )
+	 ode_TIMELINE *ptr;
+{
+	if ( ptr ) {
+		debugMsg(( "Destroying Timeline <%p>", ptr ));
+		if ( ptr->times ) xfree( ptr->times );
+		if ( ptr->values ) xfree( ptr->values );
+		ptr->times = ptr->values = NULL;
+		ptr->jointptr = NULL;
+
+		xfree( ptr );
+		ptr = NULL;
+	}
+}
+
+
+/*
+ * Object validity checker. Returns the data pointer.
+ */
+static ode_TIMELINE *
+check_timeline( self )
+	 VALUE	self;
+{
+	debugMsg(( "Checking a Timeline object (%d).", self ));
+	Check_Type( self, T_DATA );
+
+    if ( !rb_obj_is_kind_of(self, ode_cOdeTimeline) ) {
+		rb_raise( rb_eTypeError, "wrong argument type %s (expected ODE::Timeline)",
+				  rb_class2name(CLASS_OF( self )) );
+    }
+
+	return DATA_PTR( self );
+}
+
+
+/*
+ * Fetch the data pointer and check it for sanity.
+ */
+static ode_TIMELINE *
+get_timeline( self )
+	 VALUE self;
+{
+	ode_TIMELINE *ptr = check_timeline( self );
+
+	debugMsg(( "Fetching an ode_TIMELINE (%p).", ptr ));
+	if ( !ptr )
+		rb_raise( rb_eRuntimeError, "uninitialized timeline" );
+
+	return ptr;
+}
+
+
+
+/* --------------------------------------------------
+ * Evaluation and stepping
+ * -------------------------------------------------- */
+
+/*
+ * Return the slope of the curve at keyframe <tt>i</tt>, for cubic
+ * interpolation: the slope between its neighbours, or the slope of the one
+ * segment at either end.
+ */
+static double
+ode_timeline_slope( ptr, i )
+	 ode_TIMELINE	*ptr;
+	 long			i;
+{
+	long	lo = i > 0 ? i - 1 : i;
+	long	hi = i < ptr->count - 1 ? i + 1 : i;
+
+	if ( ptr->times[hi] <= ptr->times[lo] ) return 0;
+	return ( ptr->values[hi] - ptr->values[lo] ) / ( ptr->times[hi] - ptr->times[lo] );
+}
+
+
+/*
+ * Return the value of the timeline's curve at time <tt>t</tt>. It holds the
+ * first and last keyframes' values before and after them.
+ */
+static double
+ode_timeline_value_at( ptr, t )
+	 ode_TIMELINE	*ptr;
+	 double			t;
+{
+	long	lo = 0, hi = ptr->count - 1, mid;
+	double	span, u, u2, u3;
+
+	if ( t <= ptr->times[lo] ) return ptr->values[lo];
+	if ( t >= ptr->times[hi] ) return ptr->values[hi];
+
+	/* Find the segment [lo, lo+1] containing t */
+	while ( hi - lo > 1 ) {
+		mid = ( lo + hi ) / 2;
+		if ( ptr->times[mid] <= t ) lo = mid;
+		else hi = mid;
+	}
+
+	span = ptr->times[hi] - ptr->times[lo];
+	u = ( t - ptr->times[lo] ) / span;
+
+	if ( ptr->interpolation == ODE_TIMELINE_LINEAR )
+		return ptr->values[lo] + u * ( ptr->values[hi] - ptr->values[lo] );
+
+	/* Cubic Hermite segment */
+	u2 = u * u;
+	u3 = u2 * u;
+	return ( 2*u3 - 3*u2 + 1 ) * ptr->values[lo] +
+		( u3 - 2*u2 + u ) * span * ode_timeline_slope( ptr, lo ) +
+		( -2*u3 + 3*u2 ) * ptr->values[hi] +
+		( u3 - u2 ) * span * ode_timeline_slope( ptr, hi );
+}
+
+
+/*
+ * Return the duration of the timeline (the time of its last keyframe).
+ */
+static double
+ode_timeline_duration( ptr )
+	 ode_TIMELINE	*ptr;
+{
+	return ptr->count ? ptr->times[ ptr->count - 1 ] : 0;
+}
+
+
+/*
+ * Return true if the current position of the timeline's joint axis can be
+ * read, which position mode needs.
+ */
+static int
+ode_timeline_has_position( ptr )
+	 ode_TIMELINE	*ptr;
+{
+	int	type = dJointGetType( ptr->jointptr->id );
+
+	if ( type == dJointTypeAMotor ) return 1;
+	return ptr->axis <= ode_servo_axis_count( type );
+}
+
+
+/*
+ * Return the current position of the timeline's joint axis.
+ */
+static dReal
+ode_timeline_position( ptr )
+	 ode_TIMELINE	*ptr;
+{
+	int		type = dJointGetType( ptr->jointptr->id );
+	dReal	pos, rate;
+
+	if ( type == dJointTypeAMotor )
+		return dJointGetAMotorAngle( ptr->jointptr->id, ptr->axis - 1 );
+
+	ode_servo_axis_state( ptr->jointptr, type, ptr->axis, &pos, &rate );
+	return pos;
+}
+
+
+/*
+ * Set the motor velocity of the timeline's joint axis.
+ */
+static void
+ode_timeline_set_vel( ptr, vel )
+	 ode_TIMELINE	*ptr;
+	 dReal			vel;
+{
+	dReal	(* getParam)( dJointID, int );
+	void	(* setParam)( dJointID, int, dReal );
+
+	ode_paramJoint_functions( ptr->jointptr, &getParam, &setParam );
+	(setParam)( ptr->jointptr->id, dParamVel + dParamGroup * (ptr->axis - 1), vel );
+}
+
+
+/*
+ * Add the given timeline to its world's list of running timelines.
+ */
+static void
+ode_timeline_start( ptr )
+	 ode_TIMELINE	*ptr;
+{
+	ode_WORLD	*world = ode_get_world_struct( ptr->world );
+
+	if ( ptr->worldIndex >= 0 ) return;
+
+	if ( world->timelineCount == world->timelineCapacity ) {
+		world->timelineCapacity = world->timelineCapacity ? world->timelineCapacity * 2 : 16;
+		REALLOC_N( world->timelines, ode_TIMELINE *, world->timelineCapacity );
+	}
+
+	ptr->worldIndex = world->timelineCount;
+	world->timelines[ world->timelineCount++ ] = ptr;
+}
+
+
+/*
+ * Remove the given timeline from its world's list of running timelines. The
+ * last one in the list takes its place.
+ */
+static void
+ode_timeline_stop( world, ptr )
+	 ode_WORLD		*world;
+	 ode_TIMELINE	*ptr;
+{
+	ode_TIMELINE	*last;
+
+	if ( ptr->worldIndex < 0 || ptr->worldIndex >= world->timelineCount ||
+		 world->timelines[ptr->worldIndex] != ptr )
+		return;
+
+	last = world->timelines[ --world->timelineCount ];
+	world->timelines[ ptr->worldIndex ] = last;
+	last->worldIndex = ptr->worldIndex;
+	ptr->worldIndex = -1;
+}
+
+
+/*
+ * Advance all of the world's running timelines by the coming step of
+ * <tt>size</tt> seconds, setting their joints' motor velocities: in velocity
+ * mode to the curve's value at the end of the step, and in position mode to
+ * the velocity which would take the joint to the curve's value by then.
+ * Timelines which reached their end on the last step are stopped instead
+ * (zeroing the motor velocity in position mode, so the joint holds there),
+ * and added to the list returned by World#completedTimelines. Called just
+ * before the world is stepped.
+ */
+void
+ode_timeline_prestep( world, size )
+	 ode_WORLD	*world;
+	 dReal		size;
+{
+	ode_TIMELINE	*ptr;
+	ode_EVENT		*event;
+	ode_JOINT		*joint;
+	double			duration, t, value;
+	dReal			vel;
+	long			i = 0;
+
+	if ( RTEST(world->completedTimelines) )
+		rb_ary_clear( world->completedTimelines );
+
+	while ( i < world->timelineCount ) {
+		ptr = world->timelines[i];
+		joint = ptr->jointptr;
+		if ( RTEST(joint->obsolete) ) {
+			i++;
+			continue;
+		}
+
+		duration = ode_timeline_duration( ptr );
+		if ( ptr->loop || ptr->time < duration ) {
+			t = ptr->time + size;
+			if ( ptr->loop && duration > 0 )
+				t = fmod( t, duration );
+			else if ( t > duration - ODE_TIMELINE_EPSILON )
+				t = duration;
+
+			value = ode_timeline_value_at( ptr, t );
+			if ( ptr->mode == ODE_TIMELINE_POSITION )
+				vel = size > 0 ? (dReal)( (value - ode_timeline_position(ptr)) / size ) : 0;
+			else
+				vel = (dReal)value;
+
+			ode_timeline_set_vel( ptr, vel );
+			ptr->time = t;
+			i++;
+			continue;
+		}
+
+		if ( ptr->mode == ODE_TIMELINE_POSITION )
+			ode_timeline_set_vel( ptr, 0 );
+
+		if ( world->events ) {
+			event = ode_eventqueue_push( world->events, ODE_EVENT_TIMELINE_DONE, world->stepCount,
+				RTEST(joint->body1) ? ode_get_body(joint->body1)->serial : 0,
+				RTEST(joint->body2) ? ode_get_body(joint->body2)->serial : 0 );
+			event->payload[0] = duration;
+			event->payload[1] = ptr->values[ ptr->count - 1 ];
+		}
+
+		/* Stopping it moves the last timeline into this slot, so don't advance */
+		ode_timeline_stop( world, ptr );
+		if ( !RTEST(world->completedTimelines) )
+			world->completedTimelines = rb_ary_new();
+		rb_ary_push( world->completedTimelines, ptr->object );
+	}
+}
+
+
+
+/* --------------------------------------------------
+ * Class Methods
+ * -------------------------------------------------- */
+
+/*
+ * allocate()
+ * --
+ * Allocate a new ODE::Timeline object.
+ */
+static VALUE
+ode_timeline_s_alloc( klass )
+{
+	debugMsg(( "Wrapping an uninitialized ODE::Timeline pointer." ));
+	return Data_Wrap_Struct( klass, ode_timeline_gc_mark, ode_timeline_gc_free, 0 );
+}
+
+
+
+/* --------------------------------------------------
+ * Instance Methods
+ * -------------------------------------------------- */
+
+/*
+ * ODE::Timeline#initialize( joint, keyframes, axis=1 )
+ * --
+ * Create a new timeline which drives the motor on the given <tt>axis</tt> of
+ * the specified <tt>joint</tt> (an ODE::ParameterizedJoint) from a curve
+ * through <tt>keyframes</tt>, an Array of <tt>[time, value]</tt> pairs in
+ * order of time. By default the values are motor velocities (see #mode=)
+ * interpolated linearly (see #interpolation=). The timeline doesn't run
+ * until it's #start-ed.
+ */
+static VALUE
+ode_timeline_init( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_TIMELINE	*ptr;
+	ode_JOINT		*joint;
+	dReal			(* getParam)( dJointID, int );
+	void			(* setParam)( dJointID, int, dReal );
+	VALUE			jointObj, keyframes, axisObj, key, scratch;
+	double			*times, *values;
+	long			i, count;
+	int				axes, axis = 1;
+
+	rb_scan_args( argc, argv, "21", &jointObj, &keyframes, &axisObj );
+
+	if ( check_timeline(self) )
+		rb_raise( rb_eRuntimeError, "Cannot re-initialize a timeline." );
+
+	joint = ode_get_joint( jointObj );
+	Check_Type( keyframes, T_ARRAY );
+	if ( (count = RARRAY(keyframes)->len) < 1 )
+		rb_raise( rb_eArgError, "a timeline needs at least one keyframe" );
+	if ( RTEST(axisObj) ) axis = NUM2INT( axisObj );
+
+	axes = ode_paramJoint_functions( joint, &getParam, &setParam );
+	if ( axis < 1 || axis > axes )
+		rb_raise( rb_eIndexError, "No such axis %d for %s",
+				  axis, rb_class2name(CLASS_OF(jointObj)) );
+
+	/* Check the keyframes before attaching anything */
+	scratch = rb_str_new( 0, count * 2 * sizeof(double) );
+	times = (double *)RSTRING( scratch )->ptr;
+	values = times + count;
+
+	for ( i = 0; i < count; i++ ) {
+		key = RARRAY( keyframes )->ptr[i];
+		Check_Type( key, T_ARRAY );
+		if ( RARRAY(key)->len != 2 )
+			rb_raise( rb_eArgError, "keyframe %ld isn't a [time, value] pair", i );
+		times[i] = NUM2DBL( RARRAY(key)->ptr[0] );
+		values[i] = NUM2DBL( RARRAY(key)->ptr[1] );
+
+		if ( i > 0 && times[i] < times[i-1] )
+			rb_raise( rb_eArgError, "keyframes must be in order of time" );
+	}
+
+	DATA_PTR(self) = ptr = ode_timeline_alloc();
+	ptr->object = self;
+	ptr->joint = jointObj;
+	ptr->jointptr = joint;
+	ptr->world = joint->world;
+	ptr->axis = axis;
+
+	ptr->count = count;
+	ptr->times = ALLOC_N( double, count );
+	ptr->values = ALLOC_N( double, count );
+	MEMCPY( ptr->times, times, double, count );
+	MEMCPY( ptr->values, values, double, count );
+
+	return self;
+}
+
+
+/*
+ * ODE::Timeline#joint
+ * --
+ * Returns the joint the timeline drives.
+ */
+static VALUE
+ode_timeline_joint( self )
+	 VALUE self;
+{
+	return get_timeline( self )->joint;
+}
+
+
+/*
+ * ODE::Timeline#axis
+ * --
+ * Returns the number of the joint axis the timeline drives.
+ */
+static VALUE
+ode_timeline_axis( self )
+	 VALUE self;
+{
+	return INT2FIX( get_timeline(self)->axis );
+}
+
+
+/*
+ * ODE::Timeline#keyframes
+ * --
+ * Returns the timeline's keyframes as an Array of <tt>[time, value]</tt>
+ * pairs.
+ */
+static VALUE
+ode_timeline_keyframes( self )
+	 VALUE self;
+{
+	ode_TIMELINE	*ptr = get_timeline( self );
+	VALUE			ary = rb_ary_new2( ptr->count );
+	long			i;
+
+	for ( i = 0; i < ptr->count; i++ )
+		rb_ary_push( ary, rb_assoc_new(rb_float_new(ptr->times[i]),
+									   rb_float_new(ptr->values[i])) );
+
+	return ary;
+}
+
+
+/*
+ * ODE::Timeline#duration
+ * --
+ * Returns the time of the timeline's last keyframe.
+ */
+static VALUE
+ode_timeline_duration_m( self )
+	 VALUE self;
+{
+	return rb_float_new( ode_timeline_duration(get_timeline(self)) );
+}
+
+
+/*
+ * ODE::Timeline#valueAt( time )
+ * --
+ * Returns the value of the timeline's curve at the given <tt>time</tt>.
+ */
+static VALUE
+ode_timeline_value_at_m( self, time )
+	 VALUE self, time;
+{
+	return rb_float_new( ode_timeline_value_at(get_timeline(self), NUM2DBL(time)) );
+}
+
+
+/*
+ * ODE::Timeline#time
+ * --
+ * Returns how far into the curve the timeline has run.
+ */
+static VALUE
+ode_timeline_time( self )
+	 VALUE self;
+{
+	return rb_float_new( get_timeline(self)->time );
+}
+
+
+/*
+ * ODE::Timeline#time=( seconds )
+ * --
+ * Move the timeline to the given point in its curve.
+ */
+static VALUE
+ode_timeline_time_eq( self, seconds )
+	 VALUE self, seconds;
+{
+	ode_TIMELINE	*ptr = get_timeline( self );
+
+	CheckPositiveNumber( NUM2DBL(seconds), "time" );
+	ptr->time = NUM2DBL( seconds );
+
+	return seconds;
+}
+
+
+/*
+ * ODE::Timeline#mode
+ * --
+ * Returns what the timeline's values drive: ODE::Timeline::VELOCITY or
+ * ODE::Timeline::POSITION.
+ */
+static VALUE
+ode_timeline_mode( self )
+	 VALUE self;
+{
+	return INT2FIX( get_timeline(self)->mode );
+}
+
+
+/*
+ * ODE::Timeline#mode=( mode )
+ * --
+ * Set what the timeline's values drive. In VELOCITY mode each value is set
+ * as the motor velocity directly. In POSITION mode each value is a target
+ * position for the joint axis, and the motor velocity is set to whatever
+ * would reach it by the end of the step (limited by the joint's fMax, so
+ * set that too). POSITION mode needs an axis whose position ODE reports: any
+ * but the second axis of a Hinge2Joint.
+ */
+static VALUE
+ode_timeline_mode_eq( self, mode )
+	 VALUE self, mode;
+{
+	ode_TIMELINE	*ptr = get_timeline( self );
+	int				m = NUM2INT( mode );
+
+	if ( m != ODE_TIMELINE_VELOCITY && m != ODE_TIMELINE_POSITION )
+		rb_raise( rb_eArgError, "invalid timeline mode %d", m );
+	if ( m == ODE_TIMELINE_POSITION && !ode_timeline_has_position(ptr) )
+		rb_raise( rb_eArgError, "can't read the position of axis %d of a %s",
+				  ptr->axis, rb_class2name(CLASS_OF( ptr->joint )) );
+
+	ptr->mode = m;
+	return mode;
+}
+
+
+/*
+ * ODE::Timeline#interpolation
+ * --
+ * Returns how the timeline interpolates between keyframes:
+ * ODE::Timeline::LINEAR or ODE::Timeline::CUBIC.
+ */
+static VALUE
+ode_timeline_interpolation( self )
+	 VALUE self;
+{
+	return INT2FIX( get_timeline(self)->interpolation );
+}
+
+
+/*
+ * ODE::Timeline#interpolation=( interpolation )
+ * --
+ * Set how the timeline interpolates between keyframes: LINEAR, or CUBIC for
+ * a smooth curve through them (a Catmull-Rom style spline).
+ */
+static VALUE
+ode_timeline_interpolation_eq( self, interpolation )
+	 VALUE self, interpolation;
+{
+	ode_TIMELINE	*ptr = get_timeline( self );
+	int				i = NUM2INT( interpolation );
+
+	if ( i != ODE_TIMELINE_LINEAR && i != ODE_TIMELINE_CUBIC )
+		rb_raise( rb_eArgError, "invalid timeline interpolation %d", i );
+
+	ptr->interpolation = i;
+	return interpolation;
+}
+
+
+/*
+ * ODE::Timeline#loop?
+ * --
+ * Returns true if the timeline starts over when it reaches its end instead
+ * of completing.
+ */
+static VALUE
+ode_timeline_loop_p( self )
+	 VALUE self;
+{
+	return get_timeline( self )->loop ? Qtrue : Qfalse;
+}
+
+
+/*
+ * ODE::Timeline#loop=( flag )
+ * --
+ * Set whether the timeline starts over when it reaches its end.
+ */
+static VALUE
+ode_timeline_loop_eq( self, flag )
+	 VALUE self, flag;
+{
+	get_timeline( self )->loop = RTEST( flag ) ? 1 : 0;
+	return flag;
+}
+
+
+/*
+ * ODE::Timeline#start
+ * --
+ * Start (or restart) the timeline from the beginning. From the next step of
+ * the joint's world on, World#step advances it and sets the motor. While it
+ * runs, the world holds on to it. Returns the timeline.
+ */
+static VALUE
+ode_timeline_start_m( self )
+	 VALUE self;
+{
+	ode_TIMELINE	*ptr = get_timeline( self );
+
+	ode_get_joint( ptr->joint );
+	ptr->time = 0;
+	ode_timeline_start( ptr );
+
+	return self;
+}
+
+
+/*
+ * ODE::Timeline#stop
+ * --
+ * Stop the timeline where it is, leaving the motor as it last set it.
+ */
+static VALUE
+ode_timeline_stop_m( self )
+	 VALUE self;
+{
+	ode_TIMELINE	*ptr = get_timeline( self );
+
+	ode_timeline_stop( ode_get_world_struct(ptr->world), ptr );
+	return self;
+}
+
+
+/*
+ * ODE::Timeline#running?
+ * --
+ * Returns true if the timeline is being advanced by its world's steps.
+ */
+static VALUE
+ode_timeline_running_p( self )
+	 VALUE self;
+{
+	return get_timeline( self )->worldIndex >= 0 ? Qtrue : Qfalse;
+}
+
+
+/*
+ * ODE::World#timelines
+ * --
+ * Returns the world's running timelines.
+ */
+static VALUE
+ode_world_timelines( self )
+	 VALUE self;
+{
+	ode_WORLD	*world = ode_get_world_struct( self );
+	VALUE		ary = rb_ary_new2( world->timelineCount );
+	long		i;
+
+	for ( i = 0; i < world->timelineCount; i++ )
+		rb_ary_push( ary, world->timelines[i]->object );
+
+	return ary;
+}
+
+
+/*
+ * ODE::World#completedTimelines
+ * --
+ * Returns the timelines that were stopped at the start of the last step
+ * because the step before it had taken them to their end. A timeline's
+ * completion is therefore seen one step after the step which reaches the
+ * end of its curve, once that step has driven its joint there.
+ */
+static VALUE
+ode_world_completed_timelines( self )
+	 VALUE self;
+{
+	ode_WORLD	*world = ode_get_world_struct( self );
+
+	if ( !RTEST(world->completedTimelines) ) return rb_ary_new();
+	return rb_ary_dup( world->completedTimelines );
+}
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_timeline()
+{
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeWorld = rb_define_class_under( ode_mOde, "World", rb_cObject );
+	ode_cOdeTimeline = rb_define_class_under( ode_mOde, "Timeline", rb_cObject );
+#endif
+
+	rb_define_const( ode_cOdeTimeline, "LINEAR", INT2FIX(ODE_TIMELINE_LINEAR) );
+	rb_define_const( ode_cOdeTimeline, "CUBIC", INT2FIX(ODE_TIMELINE_CUBIC) );
+	rb_define_const( ode_cOdeTimeline, "VELOCITY", INT2FIX(ODE_TIMELINE_VELOCITY) );
+	rb_define_const( ode_cOdeTimeline, "POSITION", INT2FIX(ODE_TIMELINE_POSITION) );
+
+	rb_define_alloc_func( ode_cOdeTimeline, ode_timeline_s_alloc );
+
+	rb_define_method( ode_cOdeTimeline, "initialize", ode_timeline_init, -1 );
+
+	rb_define_method( ode_cOdeTimeline, "joint", ode_timeline_joint, 0 );
+	rb_define_method( ode_cOdeTimeline, "axis", ode_timeline_axis, 0 );
+	rb_define_method( ode_cOdeTimeline, "keyframes", ode_timeline_keyframes, 0 );
+	rb_define_method( ode_cOdeTimeline, "duration", ode_timeline_duration_m, 0 );
+	rb_define_method( ode_cOdeTimeline, "valueAt", ode_timeline_value_at_m, 1 );
+	rb_define_alias ( ode_cOdeTimeline, "value_at", "valueAt" );
+	rb_define_method( ode_cOdeTimeline, "time", ode_timeline_time, 0 );
+	rb_define_method( ode_cOdeTimeline, "time=", ode_timeline_time_eq, 1 );
+	rb_define_method( ode_cOdeTimeline, "mode", ode_timeline_mode, 0 );
+	rb_define_method( ode_cOdeTimeline, "mode=", ode_timeline_mode_eq, 1 );
+	rb_define_method( ode_cOdeTimeline, "interpolation", ode_timeline_interpolation, 0 );
+	rb_define_method( ode_cOdeTimeline, "interpolation=", ode_timeline_interpolation_eq, 1 );
+	rb_define_method( ode_cOdeTimeline, "loop?", ode_timeline_loop_p, 0 );
+	rb_define_method( ode_cOdeTimeline, "loop=", ode_timeline_loop_eq, 1 );
+	rb_define_method( ode_cOdeTimeline, "start", ode_timeline_start_m, 0 );
+	rb_define_method( ode_cOdeTimeline, "stop", ode_timeline_stop_m, 0 );
+	rb_define_method( ode_cOdeTimeline, "running?", ode_timeline_running_p, 0 );
+
+	rb_define_method( ode_cOdeWorld, "timelines", ode_world_timelines, 0 );
+	rb_define_method( ode_cOdeWorld, "completedTimelines", ode_world_completed_timelines, 0 );
+	rb_define_alias ( ode_cOdeWorld, "completed_timelines", "completedTimelines" );
+}
+
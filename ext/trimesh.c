@@ -0,0 +1,627 @@
+/*
+ *		trimesh.c - ODE Ruby Binding - ODE::TriMeshData and ODE::Geometry::TriMesh
+ *		$Id$
+ *		Time-stamp: <18-Oct-2026 10:02:17 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* Vertices are three floats (or doubles), triangles are three ints */
+#define TriStride			( sizeof(int) * 3 )
+#define VertexStride( d )	( (d) ? sizeof(double) * 3 : sizeof(float) * 3 )
+
+
+/* --------------------------------------------------
+ * Memory-management functions
+ * -------------------------------------------------- */
+
+/*
+ * Allocation function
+ */
+static ode_TRIMESHDATA *
+ode_trimeshdata_alloc()
+{
+	ode_TRIMESHDATA *ptr = ALLOC( ode_TRIMESHDATA );
+
+	ptr->id				= 0;
+	ptr->object			= Qnil;
+	ptr->vertices		= Qnil;
+	ptr->indices		= Qnil;
+	ptr->mapping		= NULL;
+	ptr->mappingLength	= 0;
+	ptr->vertexCount	= 0;
+	ptr->indexCount		= 0;
+	ptr->isDouble		= 0;
+
+	debugMsg(( "Initialized ode_TRIMESHDATA <%p>", ptr ));
+	return ptr;
+}
+
+
+/*
+ * GC mark function
+ */
+static void
+ode_trimeshdata_gc_mark( ptr )
+	 ode_TRIMESHDATA *ptr;
+{
+	debugMsg(( "Marking an ODE::TriMeshData." ));
+
+	if ( ptr ) {
+		rb_gc_mark( ptr->vertices );
+		rb_gc_mark( ptr->indices );
+	}
+
+	else {
+		debugMsg(( "Not marking NULL pointer." ));
+	}
+}
+
+
+/*
+ * GC free function
+ */
+static void
+ode_trimeshdata_gc_free( ptr )
+	 ode_TRIMESHDATA *ptr;
+{
+	debugMsg(( "Freeing an ODE::TriMeshData." ));
+
+	if ( ptr ) {
+#ifdef HAVE_TRIMESH_GEOM
+		if ( ptr->id )
+			dGeomTriMeshDataDestroy( ptr->id );
+#endif
+#ifdef HAVE_SYS_MMAN_H
+		if ( ptr->mapping )
+			munmap( ptr->mapping, ptr->mappingLength );
+#endif
+
+		ptr->id			= NULL;
+		ptr->mapping	= NULL;
+		ptr->object		= Qnil;
+		ptr->vertices	= Qnil;
+		ptr->indices	= Qnil;
+
+		xfree( ptr );
+		ptr = NULL;
+	}
+
+	else {
+		debugMsg(( "Not freeing NULL pointer." ));
+	}
+}
+
+
+/*
+ * Object validity checker. Returns the data pointer.
+ */
+static ode_TRIMESHDATA *
+check_trimeshdata( self )
+	 VALUE	self;
+{
+	debugMsg(( "Checking a TriMeshData object (%d).", self ));
+	Check_Type( self, T_DATA );
+
+    if ( !IsTriMeshData(self) ) {
+		rb_raise( rb_eTypeError, "wrong argument type %s (expected ODE::TriMeshData)",
+				  rb_class2name(CLASS_OF( self )) );
+    }
+
+	return DATA_PTR( self );
+}
+
+
+/*
+ * Fetch the data pointer and check it for sanity.
+ */
+static ode_TRIMESHDATA *
+get_trimeshdata( self )
+	 VALUE self;
+{
+	ode_TRIMESHDATA *ptr = check_trimeshdata( self );
+
+	debugMsg(( "Fetching an ode_TRIMESHDATA (%p).", ptr ));
+	if ( !ptr )
+		rb_raise( rb_eRuntimeError, "uninitialized trimesh data" );
+
+	return ptr;
+}
+
+
+/*
+ * Publicly-usable trimesh data fetcher.
+ */
+ode_TRIMESHDATA *
+ode_get_trimeshdata( self )
+	 VALUE self;
+{
+	return get_trimeshdata( self );
+}
+
+
+/*
+ * Check the given vertex and index buffers for sanity and hand them to ODE. ODE
+ * doesn't copy the buffers; it builds its collision tree over them and refers
+ * to them for the life of the data object, so the caller has to make sure they
+ * stay put.
+ */
+static void
+ode_trimeshdata_build( ptr, vertices, verticesLength, indices, indicesLength )
+	 ode_TRIMESHDATA	*ptr;
+	 const void			*vertices, *indices;
+	 long				verticesLength, indicesLength;
+{
+#ifdef HAVE_TRIMESH_GEOM
+	const int	*index = (const int *)indices;
+	long		vertexStride = VertexStride( ptr->isDouble );
+	long		i;
+
+	if ( verticesLength == 0 || verticesLength % vertexStride )
+		rb_raise( rb_eArgError, "vertex buffer length (%ld) is not a multiple of %ld",
+				  verticesLength, vertexStride );
+	if ( indicesLength == 0 || indicesLength % TriStride )
+		rb_raise( rb_eArgError, "index buffer length (%ld) is not a multiple of %ld",
+				  indicesLength, (long)TriStride );
+
+	ptr->vertexCount = verticesLength / vertexStride;
+	ptr->indexCount	 = indicesLength / sizeof(int);
+
+	/* ODE trusts the indices blindly, so check them once here rather than
+	   segfaulting inside the collider later. */
+	for ( i = 0; i < ptr->indexCount; i++ ) {
+		if ( index[i] < 0 || index[i] >= ptr->vertexCount )
+			rb_raise( rb_eIndexError, "vertex index %d at offset %ld out of range (0...%d)",
+					  index[i], i, ptr->vertexCount );
+	}
+
+	if ( !ptr->id )
+		ptr->id = dGeomTriMeshDataCreate();
+
+	debugMsg(( "Building trimesh data <%p>: %d vertices, %d triangles",
+			   ptr->id, ptr->vertexCount, ptr->indexCount / 3 ));
+	if ( ptr->isDouble )
+		dGeomTriMeshDataBuildDouble( ptr->id, vertices, vertexStride, ptr->vertexCount,
+									 indices, ptr->indexCount, TriStride );
+	else
+		dGeomTriMeshDataBuildSingle( ptr->id, vertices, vertexStride, ptr->vertexCount,
+									 indices, ptr->indexCount, TriStride );
+#else
+	rb_notimplement();
+#endif /* HAVE_TRIMESH_GEOM */
+}
+
+
+
+/* --------------------------------------------------
+ * Class Methods
+ * -------------------------------------------------- */
+
+/*
+ * Allocator
+ */
+static VALUE
+ode_trimeshdata_s_alloc( klass )
+	 VALUE klass;
+{
+	debugMsg(( "Wrapping an uninitialized ODE::TriMeshData pointer." ));
+	return Data_Wrap_Struct( klass, ode_trimeshdata_gc_mark, ode_trimeshdata_gc_free, 0 );
+}
+
+
+/*
+ * ODE::TriMeshData::mmap( path, vertexOffset, vertexCount, indexOffset, triangleCount,
+ *                         precision=:single )
+ * --
+ * Create a new TriMeshData object from a mesh stored in the file at the given
+ * <tt>path</tt>, which is mapped read-only into memory. The vertices
+ * (<tt>vertexCount</tt> packed triples of floats or doubles, depending on the
+ * <tt>precision</tt>) start at <tt>vertexOffset</tt> bytes into the file, and
+ * the triangles (<tt>triangleCount</tt> packed triples of native 32-bit ints)
+ * start at <tt>indexOffset</tt>. Neither buffer is ever copied.
+ */
+static VALUE
+ode_trimeshdata_s_mmap( argc, argv, klass )
+	 int	argc;
+	 VALUE	*argv, klass;
+{
+#ifdef HAVE_SYS_MMAN_H
+	VALUE			path, vertexOffset, vertexCount, indexOffset, triangleCount, precision;
+	VALUE			self;
+	ode_TRIMESHDATA	*ptr;
+	struct stat		st;
+	long			voff, vcount, ioff, tcount, vlen, ilen;
+	void			*mapping;
+	int				fd, isDouble;
+
+	rb_scan_args( argc, argv, "51", &path, &vertexOffset, &vertexCount,
+				  &indexOffset, &triangleCount, &precision );
+
+	SafeStringValue( path );
+	isDouble = ode_precision_flag( precision );
+	voff	 = NUM2LONG( vertexOffset );
+	vcount	 = NUM2LONG( vertexCount );
+	ioff	 = NUM2LONG( indexOffset );
+	tcount	 = NUM2LONG( triangleCount );
+
+	CheckPositiveNumber( (double)voff, "vertexOffset" );
+	CheckPositiveNumber( (double)ioff, "indexOffset" );
+	CheckPositiveNonZeroNumber( (double)vcount, "vertexCount" );
+	CheckPositiveNonZeroNumber( (double)tcount, "triangleCount" );
+	if ( voff % sizeof(float) || ioff % sizeof(int) )
+		rb_raise( rb_eArgError, "buffer offsets must be 4-byte aligned" );
+
+	vlen = vcount * VertexStride( isDouble );
+	ilen = tcount * TriStride;
+
+	/* Map the whole file and make sure both buffers fit in it */
+	if ( (fd = open(RSTRING(path)->ptr, O_RDONLY)) < 0 )
+		rb_sys_fail( RSTRING(path)->ptr );
+	if ( fstat(fd, &st) < 0 ) {
+		close( fd );
+		rb_sys_fail( RSTRING(path)->ptr );
+	}
+	if ( voff + vlen > st.st_size || ioff + ilen > st.st_size ) {
+		close( fd );
+		rb_raise( rb_eArgError, "%s is too short (%ld bytes) for the specified mesh",
+				  RSTRING(path)->ptr, (long)st.st_size );
+	}
+
+	mapping = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	close( fd );
+	if ( mapping == MAP_FAILED )
+		rb_sys_fail( RSTRING(path)->ptr );
+
+	/* Hang the mapping off the new object first so it gets cleaned up even if
+	   the build raises. */
+	self = rb_obj_alloc( klass );
+	DATA_PTR(self) = ptr = ode_trimeshdata_alloc();
+	ptr->object			= self;
+	ptr->mapping		= mapping;
+	ptr->mappingLength	= st.st_size;
+	ptr->isDouble		= isDouble;
+
+	ode_trimeshdata_build( ptr,
+						   (char *)mapping + voff, vlen,
+						   (char *)mapping + ioff, ilen );
+
+	return self;
+#else
+	rb_notimplement();
+#endif /* HAVE_SYS_MMAN_H */
+}
+
+
+
+/* --------------------------------------------------
+ * Instance Methods
+ * -------------------------------------------------- */
+
+/* --- ODE::TriMeshData ------------------------------ */
+
+/*
+ * ODE::TriMeshData::new( vertices, indices, precision=:single )
+ * --
+ * Create a new triangle mesh data object from the given binary
+ * <tt>vertices</tt> (packed native floats, or doubles if <tt>precision</tt> is
+ * <tt>:double</tt>, three per vertex: <tt>[x,y,z,...].pack('f*')</tt>) and
+ * <tt>indices</tt> (packed native 32-bit ints, three per triangle:
+ * <tt>[a,b,c,...].pack('L*')</tt>) Strings. ODE refers to the Strings' buffers
+ * directly, so they are frozen and held by the data object; the collision tree
+ * is built once and shared by every ODE::Geometry::TriMesh created from it.
+ */
+static VALUE
+ode_trimeshdata_init( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_TRIMESHDATA	*ptr;
+	VALUE			vertices, indices, precision;
+
+	rb_scan_args( argc, argv, "21", &vertices, &indices, &precision );
+
+	if ( !(ptr = check_trimeshdata(self)) ) {
+		DATA_PTR(self) = ptr = ode_trimeshdata_alloc();
+		ptr->object = self;
+	}
+	if ( ptr->mapping )
+		rb_raise( rb_eRuntimeError, "can't reinitialize mapped trimesh data" );
+
+	StringValue( vertices );
+	StringValue( indices );
+	ptr->isDouble = ode_precision_flag( precision );
+
+	/* Take frozen copies that share the originals' buffers: if the caller
+	   later modifies theirs, it'll get its own copy rather than pulling the
+	   rug out from under ODE. */
+	ptr->vertices = rb_str_new4( vertices );
+	ptr->indices  = rb_str_new4( indices );
+
+	ode_trimeshdata_build( ptr,
+						   RSTRING(ptr->vertices)->ptr, RSTRING(ptr->vertices)->len,
+						   RSTRING(ptr->indices)->ptr, RSTRING(ptr->indices)->len );
+
+	return self;
+}
+
+
+/*
+ * ODE::TriMeshData#vertexCount
+ * --
+ * Returns the number of vertices in the mesh.
+ */
+static VALUE
+ode_trimeshdata_vertex_count( self )
+	 VALUE self;
+{
+	ode_TRIMESHDATA	*ptr = get_trimeshdata( self );
+	return INT2FIX( ptr->vertexCount );
+}
+
+
+/*
+ * ODE::TriMeshData#triangleCount
+ * --
+ * Returns the number of triangles in the mesh.
+ */
+static VALUE
+ode_trimeshdata_triangle_count( self )
+	 VALUE self;
+{
+	ode_TRIMESHDATA	*ptr = get_trimeshdata( self );
+	return INT2FIX( ptr->indexCount / 3 );
+}
+
+
+/*
+ * ODE::TriMeshData#precision
+ * --
+ * Returns the precision of the vertex buffer (<tt>:single</tt> or
+ * <tt>:double</tt>).
+ */
+static VALUE
+ode_trimeshdata_precision( self )
+	 VALUE self;
+{
+	ode_TRIMESHDATA	*ptr = get_trimeshdata( self );
+	return ID2SYM( rb_intern(ptr->isDouble ? "double" : "single") );
+}
+
+
+/*
+ * ODE::TriMeshData#mapped?
+ * --
+ * Returns <tt>true</tt> if the mesh was loaded with ODE::TriMeshData::mmap.
+ */
+static VALUE
+ode_trimeshdata_mapped_p( self )
+	 VALUE self;
+{
+	ode_TRIMESHDATA	*ptr = get_trimeshdata( self );
+	return ptr->mapping ? Qtrue : Qfalse;
+}
+
+
+/*
+ * ODE::TriMeshData#preprocess
+ * --
+ * Precompute the edge and vertex usage information ODE uses to cull redundant
+ * contacts. Doing this once at load time saves doing it lazily during the
+ * first collision with the mesh.
+ */
+static VALUE
+ode_trimeshdata_preprocess( self )
+	 VALUE self;
+{
+#ifdef HAVE_TRIMESH_GEOM
+	ode_TRIMESHDATA	*ptr = get_trimeshdata( self );
+
+	dGeomTriMeshDataPreprocess( ptr->id );
+	return self;
+#else
+	rb_notimplement();
+#endif /* HAVE_TRIMESH_GEOM */
+}
+
+
+
+/* --- ODE::Geometry::TriMesh ------------------------------ */
+
+/*
+ * ODE::Geometry::TriMesh::new( data, space=nil )
+ * --
+ * Create a new triangle mesh collision geometry from the given
+ * ODE::TriMeshData, inserting it into the specified space, if given. Any
+ * number of meshes can share one data object.
+ */
+static VALUE
+ode_geometry_trimesh_init( argc, argv, self )
+	 int		argc;
+	 VALUE		*argv, self;
+{
+#ifdef HAVE_TRIMESH_GEOM
+	VALUE			data, spaceObj;
+	dSpaceID		space = 0;
+	ode_GEOMETRY	*geometry = 0;
+	ode_TRIMESHDATA	*meshData;
+
+	debugMsg(( "Calling super()" ));
+	rb_call_super( 0, 0 );
+	debugMsg(( "Back from super()" ));
+
+	/* Fetch the ode_GEOMETRY pointer */
+	geometry = ode_get_geom( self );
+	if ( !geometry ) rb_bug( "Superclass's initialize didn't return a valid Geometry." );
+
+	if ( rb_scan_args(argc, argv, "11", &data, &spaceObj) == 2 ) {
+		SetContainer( spaceObj, space, geometry );
+	}
+
+	meshData = get_trimeshdata( data );
+
+	debugMsg(( "Creating new TriMesh geometry." ));
+	geometry->id = dCreateTriMesh( space, meshData->id, 0, 0, 0 );
+
+	/* Set the ode_GEOMETRY pointer as the data pointer of the dGeomID, and
+	   keep the mesh data alive as long as the geometry refers to it */
+	dGeomSetData( geometry->id, geometry );
+	rb_iv_set( self, "@data", data );
+
+	return self;
+#else
+	rb_notimplement();
+#endif /* HAVE_TRIMESH_GEOM */
+}
+
+
+/*
+ * ODE::Geometry::TriMesh#data
+ * --
+ * Returns the ODE::TriMeshData the mesh was built from.
+ */
+static VALUE
+ode_geometry_trimesh_data( self )
+	 VALUE self;
+{
+	return rb_iv_get( self, "@data" );
+}
+
+
+/*
+ * ODE::Geometry::TriMesh#data=( trimeshData )
+ * --
+ * Replace the mesh's vertex and index data with that of the specified
+ * ODE::TriMeshData.
+ */
+static VALUE
+ode_geometry_trimesh_data_eq( self, data )
+	 VALUE self, data;
+{
+#ifdef HAVE_TRIMESH_GEOM
+	ode_GEOMETRY	*geometry = ode_get_geom( self );
+	ode_TRIMESHDATA	*meshData = get_trimeshdata( data );
+
+	dGeomTriMeshSetData( geometry->id, meshData->id );
+	rb_iv_set( self, "@data", data );
+
+	return data;
+#else
+	rb_notimplement();
+#endif /* HAVE_TRIMESH_GEOM */
+}
+
+
+/*
+ * ODE::Geometry::TriMesh#triangleCount
+ * --
+ * Returns the number of triangles in the mesh.
+ */
+static VALUE
+ode_geometry_trimesh_triangle_count( self )
+	 VALUE self;
+{
+#ifdef HAVE_TRIMESH_GEOM
+	ode_GEOMETRY	*geometry = ode_get_geom( self );
+	return INT2FIX( dGeomTriMeshGetTriangleCount(geometry->id) );
+#else
+	rb_notimplement();
+#endif /* HAVE_TRIMESH_GEOM */
+}
+
+
+/*
+ * ODE::Geometry::TriMesh#triangle( index )
+ * --
+ * Returns the three vertices of the triangle at the specified
+ * <tt>index</tt> as ODE::Position objects in world coordinates.
+ */
+static VALUE
+ode_geometry_trimesh_triangle( self, index )
+	 VALUE self, index;
+{
+#ifdef HAVE_TRIMESH_GEOM
+	ode_GEOMETRY	*geometry = ode_get_geom( self );
+	dVector3		v0, v1, v2;
+	VALUE			p0, p1, p2;
+	int				i = NUM2INT( index );
+
+	if ( i < 0 || i >= dGeomTriMeshGetTriangleCount(geometry->id) )
+		rb_raise( rb_eIndexError, "triangle index %d out of range", i );
+
+	dGeomTriMeshGetTriangle( geometry->id, i, &v0, &v1, &v2 );
+	Vec3ToOdePosition( v0, p0 );
+	Vec3ToOdePosition( v1, p1 );
+	Vec3ToOdePosition( v2, p2 );
+
+	return rb_ary_new3( 3, p0, p1, p2 );
+#else
+	rb_notimplement();
+#endif /* HAVE_TRIMESH_GEOM */
+}
+
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_trimesh()
+{
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeTriMeshData		= rb_define_class_under( ode_mOde, "TriMeshData", rb_cObject );
+	ode_cOdeGeometry		= rb_define_class_under( ode_mOde, "Geometry", rb_cObject );
+	ode_cOdePlaceable		= rb_define_class_under( ode_cOdeGeometry, "Placeable", ode_cOdeGeometry );
+	ode_cOdeGeometryTriMesh	= rb_define_class_under( ode_cOdeGeometry, "TriMesh", ode_cOdePlaceable );
+#endif
+
+	/* ODE::TriMeshData */
+	rb_define_alloc_func( ode_cOdeTriMeshData, ode_trimeshdata_s_alloc );
+	rb_define_singleton_method( ode_cOdeTriMeshData, "mmap", ode_trimeshdata_s_mmap, -1 );
+
+	rb_define_method( ode_cOdeTriMeshData, "initialize", ode_trimeshdata_init, -1 );
+
+	rb_define_method( ode_cOdeTriMeshData, "vertexCount", ode_trimeshdata_vertex_count, 0 );
+	rb_define_alias ( ode_cOdeTriMeshData, "vertex_count", "vertexCount" );
+	rb_define_method( ode_cOdeTriMeshData, "triangleCount", ode_trimeshdata_triangle_count, 0 );
+	rb_define_alias ( ode_cOdeTriMeshData, "triangle_count", "triangleCount" );
+	rb_define_method( ode_cOdeTriMeshData, "precision", ode_trimeshdata_precision, 0 );
+	rb_define_method( ode_cOdeTriMeshData, "mapped?", ode_trimeshdata_mapped_p, 0 );
+	rb_define_method( ode_cOdeTriMeshData, "preprocess", ode_trimeshdata_preprocess, 0 );
+
+	/* ODE::Geometry::TriMesh */
+	rb_define_method( ode_cOdeGeometryTriMesh, "initialize", ode_geometry_trimesh_init, -1 );
+	rb_enable_super ( ode_cOdeGeometryTriMesh, "initialize" );
+
+	rb_define_method( ode_cOdeGeometryTriMesh, "data", ode_geometry_trimesh_data, 0 );
+	rb_define_method( ode_cOdeGeometryTriMesh, "data=", ode_geometry_trimesh_data_eq, 1 );
+	rb_define_method( ode_cOdeGeometryTriMesh, "triangleCount", ode_geometry_trimesh_triangle_count, 0 );
+	rb_define_alias ( ode_cOdeGeometryTriMesh, "triangle_count", "triangleCount" );
+	rb_define_method( ode_cOdeGeometryTriMesh, "triangle", ode_geometry_trimesh_triangle, 1 );
+}
+
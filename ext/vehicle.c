@@ -0,0 +1,1001 @@
+/*
+ *		vehicle.c - ODE Ruby Binding - Vehicle Class
+ *		$Id$
+ *		Time-stamp: <19-Oct-2026 00:42:15 ged>
+ *
+ *		Authors:
+ *		  * Michael Granger <ged@FaerieMUD.org>
+ *
+ *		Copyright (c) 2002-2005 The FaerieMUD Consortium.
+ *
+ *		This work is licensed under the Creative Commons Attribution License. To
+ *		view a copy of this license, visit
+ *		http://creativecommons.org/licenses/by/1.0 or send a letter to Creative
+ *		Commons, 559 Nathan Abbott Way, Stanford, California 94305, USA.
+ *
+ */
+
+#include "ode.h"
+
+#include <math.h>
+
+
+/* --------------------------------------------------
+ * Macros and constants
+ * -------------------------------------------------- */
+
+/* The number of doubles in one wheel's record in a packed state buffer */
+#define ODE_WHEEL_STATE_DOUBLES		8
+
+/* The number of doubles of controls for one vehicle in a packed buffer */
+#define ODE_VEHICLE_CONTROL_DOUBLES	3
+
+/* Vectors shorter than this have no direction */
+#define ODE_VEHICLE_EPSILON			1e-9
+
+
+/* Nearest-hit query for one wheel's ray */
+typedef struct {
+	dGeomID			ray;
+	dBodyID			chassis;
+	dContactGeom	hit;
+	int				found;
+} ode_WHEELQUERY;
+
+
+
+/* --------------------------------------------------
+ *	Memory-management functions
+ * -------------------------------------------------- */
+
+/*
+ * Allocation function
+ */
+static ode_VEHICLE *
+ode_vehicle_alloc()
+{
+	ode_VEHICLE *ptr = ALLOC( ode_VEHICLE );
+
+	ptr->object		= Qnil;
+	ptr->chassis	= Qnil;
+	ptr->space		= Qnil;
+	ptr->world		= Qnil;
+	ptr->body		= 0;
+	ptr->ray		= 0;
+	ptr->wheels		= NULL;
+	ptr->count		= 0;
+	ptr->capacity	= 0;
+	ptr->steering	= 0;
+	ptr->drive		= 0;
+	ptr->brake		= 0;
+	ptr->worldIndex	= -1;
+
+	debugMsg(( "Initialized ode_VEHICLE <%p>", ptr ));
+	return ptr;
+}
+
+
+/*
+ * GC Mark function
+ */
+static void
+ode_vehicle_gc_mark( ptr )
+	 ode_VEHICLE *ptr;
+{
+	debugMsg(( "Marking an ODE::Vehicle" ));
+
+	if ( ptr ) {
+		rb_gc_mark( ptr->chassis );
+		rb_gc_mark( ptr->space );
+		rb_gc_mark( ptr->world );
+	}
+}
+
+
+/*
+ * GC Free function. Enabled vehicles are kept alive by their world, so one
+ * that's being freed is either disabled or going down with its world.
+ */
+static void
+ode_vehicle_gc_free( ptr )
+	 ode_VEHICLE *ptr;
+{
+	if ( ptr ) {
+		debugMsg(( "Destroying Vehicle <%p>", ptr ));
+		if ( ptr->ray ) dGeomDestroy( ptr->ray );
+		if ( ptr->wheels ) xfree( ptr->wheels );
+		ptr->ray = 0;
+		ptr->wheels = NULL;
+
+		xfree( ptr );
+		ptr = NULL;
+	}
+}
+
+
+/*
+ * Object validity checker. Returns the data pointer.
+ */
+static ode_VEHICLE *
+check_vehicle( self )
+	 VALUE	self;
+{
+	debugMsg(( "Checking a Vehicle object (%d).", self ));
+	Check_Type( self, T_DATA );
+
+    if ( !rb_obj_is_kind_of(self, ode_cOdeVehicle) ) {
+		rb_raise( rb_eTypeError, "wrong argument type %s (expected ODE::Vehicle)",
+				  rb_class2name(CLASS_OF( self )) );
+    }
+
+	return DATA_PTR( self );
+}
+
+
+/*
+ * Fetch the data pointer and check it for sanity.
+ */
+static ode_VEHICLE *
+get_vehicle( self )
+	 VALUE self;
+{
+	ode_VEHICLE *ptr = check_vehicle( self );
+
+	debugMsg(( "Fetching an ode_VEHICLE (%p).", ptr ));
+	if ( !ptr )
+		rb_raise( rb_eRuntimeError, "uninitialized vehicle" );
+
+	return ptr;
+}
+
+
+/*
+ * Return the wheel at the given index, raising an IndexError if there
+ * isn't one.
+ */
+static ode_WHEEL *
+ode_vehicle_wheel_at( ptr, index )
+	 ode_VEHICLE	*ptr;
+	 VALUE			index;
+{
+	long	i = NUM2LONG( index );
+
+	if ( i < 0 || i >= ptr->count )
+		rb_raise( rb_eIndexError, "no wheel %ld (%ld wheels)", i, ptr->count );
+
+	return ptr->wheels + i;
+}
+
+
+/*
+ * Scale the given vector to unit length, returning its original length.
+ */
+static dReal
+ode_vehicle_normalize( vec )
+	 dReal	*vec;
+{
+	dReal	len = dSqrt( Dot3(vec, vec) );
+
+	if ( len > ODE_VEHICLE_EPSILON ) {
+		vec[0] /= len; vec[1] /= len; vec[2] /= len;
+	}
+
+	return len;
+}
+
+
+
+/* --------------------------------------------------
+ * Stepping
+ * -------------------------------------------------- */
+
+/*
+ * Near callback for a wheel's ray: keep the nearest hit against anything
+ * but the chassis's own geometries and sensors, descending into spaces.
+ */
+static void
+ode_vehicle_ray_callback( query, o1, o2 )
+	 ode_WHEELQUERY	*query;
+	 dGeomID		o1, o2;
+{
+	dGeomID			other = ( o1 == query->ray ) ? o2 : o1;
+	ode_GEOMETRY	*geom;
+	dContactGeom	hit;
+
+	if ( dGeomIsSpace(other) ) {
+		dSpaceCollide2( query->ray, other, query,
+						(dNearCallback *)ode_vehicle_ray_callback );
+		return;
+	}
+
+	if ( dGeomGetBody(other) == query->chassis ) return;
+	if ( !(geom = dGeomGetData(other)) || geom->sensor ) return;
+
+	if ( dCollide(query->ray, other, 1, &hit, sizeof(dContactGeom)) &&
+		 (!query->found || hit.depth < query->hit.depth) )
+	{
+		query->hit = hit;
+		query->found = 1;
+	}
+}
+
+
+/*
+ * Cast the given wheel's ray and apply its suspension and tire forces to
+ * the vehicle's chassis (and whatever it's resting on).
+ */
+static void
+ode_vehicle_step_wheel( ptr, wheel, query, up, forward, share, size )
+	 ode_VEHICLE	*ptr;
+	 ode_WHEEL		*wheel;
+	 ode_WHEELQUERY	*query;
+	 const dReal	*up, *forward;
+	 dReal			share, size;
+{
+	dVector3	mount, localForward, heading, side, vel, groundVel, force;
+	dReal		angle, compression, rate, vLong, vLat, grip, total;
+	dBodyID		ground;
+	int			k;
+
+	/* Turn the wheel about the chassis's up axis */
+	wheel->steer = angle = ptr->steering * wheel->steerFactor;
+	Cross3( side, up, forward );
+	for ( k = 0; k < 3; k++ )
+		localForward[k] = forward[k] * cos(angle) + side[k] * sin(angle);
+
+	dBodyGetRelPointPos( ptr->body, wheel->mount[0], wheel->mount[1], wheel->mount[2], mount );
+	dBodyVectorToWorld( ptr->body, up[0], up[1], up[2], force );
+	dGeomRaySet( ptr->ray, mount[0], mount[1], mount[2], -force[0], -force[1], -force[2] );
+	dGeomRaySetLength( ptr->ray, wheel->restLength + wheel->radius );
+
+	query->found = 0;
+	dSpaceCollide2( ptr->ray, ode_get_space(ptr->space)->id, query,
+					(dNearCallback *)ode_vehicle_ray_callback );
+
+	/* In the air: hang at full extension, and stop spinning if braked */
+	if ( !query->found ) {
+		wheel->length = wheel->restLength;
+		wheel->load = wheel->longForce = wheel->latForce = 0;
+		wheel->contact = 0;
+		if ( ptr->brake > 0 ) wheel->spinRate = 0;
+		wheel->spinAngle = fmod( wheel->spinAngle + wheel->spinRate * size, 2 * M_PI );
+		return;
+	}
+
+	wheel->contact = 1;
+	wheel->length = query->hit.depth - wheel->radius;
+	if ( wheel->length < 0 ) wheel->length = 0;
+	compression = wheel->restLength + wheel->radius - query->hit.depth;
+
+	/* Velocity of the chassis relative to the ground under the wheel */
+	dBodyGetRelPointVel( ptr->body, wheel->mount[0], wheel->mount[1], wheel->mount[2], vel );
+	if (( ground = dGeomGetBody(query->hit.g1 == ptr->ray ? query->hit.g2 : query->hit.g1) )) {
+		dBodyGetPointVel( ground, query->hit.pos[0], query->hit.pos[1], query->hit.pos[2],
+						  groundVel );
+		for ( k = 0; k < 3; k++ ) vel[k] -= groundVel[k];
+	}
+
+	/* Suspension: a spring-damper along the chassis's up axis which can only
+	   push */
+	rate = -Dot3( vel, force );
+	wheel->load = wheel->stiffness * compression + wheel->damping * rate;
+	if ( wheel->load < 0 ) wheel->load = 0;
+
+	/* Tire: the wheel's heading and side in the plane of the ground */
+	dBodyVectorToWorld( ptr->body, localForward[0], localForward[1], localForward[2], heading );
+	total = Dot3( heading, query->hit.normal );
+	for ( k = 0; k < 3; k++ ) heading[k] -= query->hit.normal[k] * total;
+	if ( ode_vehicle_normalize(heading) <= ODE_VEHICLE_EPSILON ) {
+		wheel->longForce = wheel->latForce = 0;
+	} else {
+		Cross3( side, query->hit.normal, heading );
+		vLong = Dot3( vel, heading );
+		vLat = Dot3( vel, side );
+
+		/* Drive and brake along the heading; sideways, try to stop this
+		   wheel's share of the chassis from sliding within the step */
+		wheel->longForce = ptr->drive * wheel->driveFactor / wheel->radius;
+		if ( ptr->brake > 0 ) {
+			grip = -vLong * share / size;
+			if ( fabs(grip) > ptr->brake / wheel->radius )
+				grip = grip < 0 ? -ptr->brake / wheel->radius : ptr->brake / wheel->radius;
+			wheel->longForce += grip;
+		}
+		wheel->latForce = -vLat * share / size;
+
+		/* Limit the combined force to the friction circle */
+		grip = wheel->friction * wheel->load;
+		total = dSqrt( wheel->longForce * wheel->longForce + wheel->latForce * wheel->latForce );
+		if ( total > grip ) {
+			wheel->longForce *= grip / total;
+			wheel->latForce *= grip / total;
+		}
+
+		wheel->spinRate = vLong / wheel->radius;
+	}
+	wheel->spinAngle = fmod( wheel->spinAngle + wheel->spinRate * size, 2 * M_PI );
+
+	for ( k = 0; k < 3; k++ )
+		force[k] = force[k] * wheel->load + heading[k] * wheel->longForce +
+			side[k] * wheel->latForce;
+
+	dBodyAddForceAtPos( ptr->body, force[0], force[1], force[2],
+						query->hit.pos[0], query->hit.pos[1], query->hit.pos[2] );
+	if ( ground && dBodyIsEnabled(ground) )
+		dBodyAddForceAtPos( ground, -force[0], -force[1], -force[2],
+							query->hit.pos[0], query->hit.pos[1], query->hit.pos[2] );
+}
+
+
+/*
+ * Cast the wheel rays of each of the world's enabled vehicles and apply the
+ * resulting forces. Called just before the world is stepped.
+ */
+void
+ode_vehicle_prestep( world, size )
+	 ode_WORLD	*world;
+	 dReal		size;
+{
+	ode_VEHICLE		*ptr;
+	ode_WHEELQUERY	query;
+	dMass			mass;
+	dReal			share;
+	long			i, j;
+
+	if ( size <= 0 ) return;
+
+	for ( i = 0; i < world->vehicleCount; i++ ) {
+		ptr = world->vehicles[i];
+		if ( !ptr->count ) continue;
+
+		/* A parked vehicle can sleep until it's driven */
+		if ( !dBodyIsEnabled(ptr->body) ) {
+			if ( ptr->drive == 0 ) continue;
+			dBodyEnable( ptr->body );
+		}
+
+		dBodyGetMass( ptr->body, &mass );
+		share = mass.mass / ptr->count;
+		query.ray = ptr->ray;
+		query.chassis = ptr->body;
+
+		for ( j = 0; j < ptr->count; j++ )
+			ode_vehicle_step_wheel( ptr, ptr->wheels + j, &query, ptr->up, ptr->forward,
+									share, size );
+	}
+}
+
+
+/*
+ * Add the given vehicle to its world's list of enabled ones.
+ */
+static void
+ode_vehicle_enable( ptr )
+	 ode_VEHICLE	*ptr;
+{
+	ode_WORLD	*world = ode_get_world_struct( ptr->world );
+
+	if ( ptr->worldIndex >= 0 ) return;
+
+	if ( world->vehicleCount == world->vehicleCapacity ) {
+		world->vehicleCapacity = world->vehicleCapacity ? world->vehicleCapacity * 2 : 32;
+		REALLOC_N( world->vehicles, ode_VEHICLE *, world->vehicleCapacity );
+	}
+
+	ptr->worldIndex = world->vehicleCount;
+	world->vehicles[ world->vehicleCount++ ] = ptr;
+}
+
+
+/*
+ * Remove the given vehicle from its world's list of enabled ones.
+ */
+static void
+ode_vehicle_disable( ptr )
+	 ode_VEHICLE	*ptr;
+{
+	ode_WORLD	*world = ode_get_world_struct( ptr->world );
+	ode_VEHICLE	*last;
+
+	if ( ptr->worldIndex < 0 || ptr->worldIndex >= world->vehicleCount ||
+		 world->vehicles[ptr->worldIndex] != ptr )
+		return;
+
+	last = world->vehicles[ --world->vehicleCount ];
+	world->vehicles[ ptr->worldIndex ] = last;
+	last->worldIndex = ptr->worldIndex;
+	ptr->worldIndex = -1;
+}
+
+
+/*
+ * Set the controls of the given vehicle, checking the brake.
+ */
+static void
+ode_vehicle_set_controls( ptr, steering, drive, brake )
+	 ode_VEHICLE	*ptr;
+	 double			steering, drive, brake;
+{
+	CheckPositiveNumber( brake, "brake" );
+
+	ptr->steering = (dReal)steering;
+	ptr->drive = (dReal)drive;
+	ptr->brake = (dReal)brake;
+}
+
+
+/*
+ * Write the state of each of the given vehicle's wheels to <tt>out</tt>,
+ * returning the position after it.
+ */
+static double *
+ode_vehicle_write_state( ptr, out )
+	 ode_VEHICLE	*ptr;
+	 double			*out;
+{
+	ode_WHEEL	*wheel;
+	long		i;
+
+	for ( i = 0; i < ptr->count; i++ ) {
+		wheel = ptr->wheels + i;
+		*out++ = wheel->length;
+		*out++ = wheel->steer;
+		*out++ = wheel->spinAngle;
+		*out++ = wheel->spinRate;
+		*out++ = wheel->load;
+		*out++ = wheel->longForce;
+		*out++ = wheel->latForce;
+		*out++ = wheel->contact ? 1.0 : 0.0;
+	}
+
+	return out;
+}
+
+
+
+/* --------------------------------------------------
+ * Class Methods
+ * -------------------------------------------------- */
+
+/*
+ * allocate()
+ * --
+ * Allocate a new ODE::Vehicle object.
+ */
+static VALUE
+ode_vehicle_s_alloc( klass )
+{
+	debugMsg(( "Wrapping an uninitialized ODE::Vehicle pointer." ));
+	return Data_Wrap_Struct( klass, ode_vehicle_gc_mark, ode_vehicle_gc_free, 0 );
+}
+
+
+/*
+ * ODE::Vehicle::setControls( vehicles, controls )
+ * --
+ * Set the steering, drive and brake of each of the given
+ * <tt>vehicles</tt> from <tt>controls</tt>, which is either an Array of
+ * Numerics or a String of native doubles (as packed with 'd*'), with
+ * CONTROL_SIZE values for each vehicle in the order #setControls takes
+ * them. Every vehicle and value is checked before any are set. Returns the
+ * number of vehicles set.
+ */
+static VALUE
+ode_vehicle_s_set_controls( klass, vehicles, controls )
+	 VALUE klass, vehicles, controls;
+{
+	VALUE	scratch;
+	long	n, i;
+	double	*packed = NULL, *values, *row;
+
+	Check_Type( vehicles, T_ARRAY );
+	n = RARRAY( vehicles )->len * ODE_VEHICLE_CONTROL_DOUBLES;
+
+	if ( TYPE(controls) == T_STRING ) {
+		if ( RSTRING(controls)->len != n * (long)sizeof(double) )
+			rb_raise( rb_eArgError, "expected %ld packed values, got %ld bytes",
+					  n, RSTRING(controls)->len );
+		packed = (double *)RSTRING( controls )->ptr;
+	} else {
+		Check_Type( controls, T_ARRAY );
+		if ( RARRAY(controls)->len != n )
+			rb_raise( rb_eArgError, "expected %ld values, got %ld",
+					  n, RARRAY(controls)->len );
+	}
+
+	/* Check every vehicle and value first, so a bad one doesn't leave the
+	   vehicles before it changed */
+	scratch = rb_str_new( 0, n * sizeof(double) );
+	values = (double *)RSTRING( scratch )->ptr;
+
+	for ( i = 0; i < n; i++ )
+		values[i] = packed ? packed[i] : NUM2DBL( RARRAY(controls)->ptr[i] );
+	for ( i = 0; i < RARRAY(vehicles)->len; i++ ) {
+		get_vehicle( RARRAY(vehicles)->ptr[i] );
+		CheckPositiveNumber( values[i * ODE_VEHICLE_CONTROL_DOUBLES + 2], "brake" );
+	}
+
+	for ( i = 0; i < RARRAY(vehicles)->len; i++ ) {
+		row = values + i * ODE_VEHICLE_CONTROL_DOUBLES;
+		ode_vehicle_set_controls( get_vehicle(RARRAY(vehicles)->ptr[i]),
+								  row[0], row[1], row[2] );
+	}
+
+	return LONG2NUM( RARRAY(vehicles)->len );
+}
+
+
+/*
+ * ODE::Vehicle::stateInto( vehicles, buffer=nil )
+ * --
+ * Returns the state of the wheels of all of the given <tt>vehicles</tt>,
+ * one after another, as a String of native doubles in the format of
+ * ODE::Vehicle#stateInto. If a <tt>buffer</tt> String is given, its
+ * contents are replaced with the state and it's returned instead.
+ */
+static VALUE
+ode_vehicle_s_state_into( argc, argv, klass )
+	 int	argc;
+	 VALUE	*argv, klass;
+{
+	VALUE	vehicles, buffer;
+	double	*out;
+	long	n = 0, i;
+
+	rb_scan_args( argc, argv, "11", &vehicles, &buffer );
+	Check_Type( vehicles, T_ARRAY );
+	if ( RTEST(buffer) )
+		StringValue( buffer );
+	else
+		buffer = rb_str_new( 0, 0 );
+
+	for ( i = 0; i < RARRAY(vehicles)->len; i++ )
+		n += get_vehicle( RARRAY(vehicles)->ptr[i] )->count;
+
+	rb_str_modify( buffer );
+	rb_str_resize( buffer, n * ODE_WHEEL_STATE_DOUBLES * sizeof(double) );
+	out = (double *)RSTRING( buffer )->ptr;
+
+	for ( i = 0; i < RARRAY(vehicles)->len; i++ )
+		out = ode_vehicle_write_state( get_vehicle(RARRAY(vehicles)->ptr[i]), out );
+
+	return buffer;
+}
+
+
+
+/* --------------------------------------------------
+ * Instance Methods
+ * -------------------------------------------------- */
+
+/*
+ * ODE::Vehicle#initialize( chassis, space, up=[0,0,1], forward=[1,0,0] )
+ * --
+ * Create a raycast vehicle out of the given <tt>chassis</tt> ODE::Body,
+ * which drives on whatever is in the given <tt>space</tt>. Wheels are added
+ * with #addWheel; rather than being bodies of their own, each is a ray cast
+ * down from its mount point on the chassis before every step of the world,
+ * which applies suspension, drive, brake and tire forces to the chassis
+ * where it hits. The <tt>up</tt> and <tt>forward</tt> directions are
+ * relative to the chassis. The chassis's own geometries are ignored by the
+ * rays.
+ *
+ * The vehicle starts out enabled, and the world holds on to it while it is.
+ */
+static VALUE
+ode_vehicle_init( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_VEHICLE	*ptr;
+	ode_BODY	*body;
+	VALUE		chassis, space, up, forward;
+	dVector3	upDir, forwardDir;
+	dReal		along;
+	int			k;
+
+	rb_scan_args( argc, argv, "22", &chassis, &space, &up, &forward );
+
+	if ( check_vehicle(self) )
+		rb_raise( rb_eRuntimeError, "Cannot re-initialize a vehicle." );
+
+	body = ode_get_body( chassis );
+	if ( !IsSpace(space) )
+		rb_raise( rb_eTypeError, "no implicit conversion to ODE::Space from %s",
+				  rb_class2name(CLASS_OF( space )) );
+	up = RTEST( up ) ? ode_obj_to_ary3( up, "up" ) : rb_ary_new3( 3, INT2FIX(0), INT2FIX(0), INT2FIX(1) );
+	forward = RTEST( forward ) ? ode_obj_to_ary3( forward, "forward" ) :
+		rb_ary_new3( 3, INT2FIX(1), INT2FIX(0), INT2FIX(0) );
+
+	/* Make the axes an orthonormal pair, before anything is attached to
+	   the vehicle */
+	SetVec3FromArray( upDir, up );
+	SetVec3FromArray( forwardDir, forward );
+	if ( ode_vehicle_normalize(upDir) <= ODE_VEHICLE_EPSILON )
+		rb_raise( rb_eArgError, "the up direction can't be zero" );
+	along = Dot3( forwardDir, upDir );
+	for ( k = 0; k < 3; k++ ) forwardDir[k] -= upDir[k] * along;
+	if ( ode_vehicle_normalize(forwardDir) <= ODE_VEHICLE_EPSILON )
+		rb_raise( rb_eArgError, "the forward direction must be across the up direction" );
+
+	DATA_PTR(self) = ptr = ode_vehicle_alloc();
+	ptr->object		= self;
+	ptr->chassis	= chassis;
+	ptr->space		= space;
+	ptr->world		= body->world;
+	ptr->body		= body->id;
+	ptr->ray		= dCreateRay( 0, 1 );
+#ifdef HAVE_DGEOMRAYSETCLOSESTHIT
+	dGeomRaySetClosestHit( ptr->ray, 1 );
+#endif
+	for ( k = 0; k < 3; k++ ) {
+		ptr->up[k] = upDir[k];
+		ptr->forward[k] = forwardDir[k];
+	}
+
+	ode_vehicle_enable( ptr );
+	return self;
+}
+
+
+/*
+ * ODE::Vehicle#addWheel( mount, radius, restLength, stiffness, damping, friction=1.0, steerFactor=0, driveFactor=0 )
+ * --
+ * Add a wheel of the given <tt>radius</tt>, hanging from the point
+ * <tt>mount</tt> (relative to the chassis) on a suspension which is
+ * <tt>restLength</tt> long when it's fully extended, with the given
+ * spring <tt>stiffness</tt> and <tt>damping</tt>. The tire's grip is
+ * limited to <tt>friction</tt> times the load on it. The wheel is turned by
+ * <tt>steerFactor</tt> times the vehicle's #steering (1 for a front
+ * wheel, 0 for a rear one, -1 for rear-wheel steering), and gets
+ * <tt>driveFactor</tt> times its #drive torque. Returns the index of the new
+ * wheel.
+ */
+static VALUE
+ode_vehicle_add_wheel( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_VEHICLE	*ptr = get_vehicle( self );
+	ode_WHEEL	*wheel;
+	VALUE		mount, radius, restLength, stiffness, damping, friction, steerFactor, driveFactor;
+
+	rb_scan_args( argc, argv, "53", &mount, &radius, &restLength, &stiffness, &damping,
+				  &friction, &steerFactor, &driveFactor );
+
+	mount = ode_obj_to_ary3( mount, "mount" );
+	CheckPositiveNonZeroNumber( NUM2DBL(radius), "radius" );
+	CheckPositiveNumber( NUM2DBL(restLength), "restLength" );
+	CheckPositiveNumber( NUM2DBL(stiffness), "stiffness" );
+	CheckPositiveNumber( NUM2DBL(damping), "damping" );
+	if ( RTEST(friction) ) CheckPositiveNumber( NUM2DBL(friction), "friction" );
+
+	if ( ptr->count == ptr->capacity ) {
+		ptr->capacity = ptr->capacity ? ptr->capacity * 2 : 4;
+		REALLOC_N( ptr->wheels, ode_WHEEL, ptr->capacity );
+	}
+
+	wheel = ptr->wheels + ptr->count;
+	SetVec3FromArray( wheel->mount, mount );
+	wheel->radius		= (dReal)NUM2DBL( radius );
+	wheel->restLength	= (dReal)NUM2DBL( restLength );
+	wheel->stiffness	= (dReal)NUM2DBL( stiffness );
+	wheel->damping		= (dReal)NUM2DBL( damping );
+	wheel->friction		= RTEST( friction ) ? (dReal)NUM2DBL( friction ) : 1.0;
+	wheel->steerFactor	= RTEST( steerFactor ) ? (dReal)NUM2DBL( steerFactor ) : 0;
+	wheel->driveFactor	= RTEST( driveFactor ) ? (dReal)NUM2DBL( driveFactor ) : 0;
+
+	wheel->length		= wheel->restLength;
+	wheel->steer		= 0;
+	wheel->spinAngle	= 0;
+	wheel->spinRate		= 0;
+	wheel->load			= 0;
+	wheel->longForce	= 0;
+	wheel->latForce		= 0;
+	wheel->contact		= 0;
+
+	return LONG2NUM( ptr->count++ );
+}
+
+
+/*
+ * ODE::Vehicle#wheel( index )
+ * --
+ * Returns the settings of the wheel at the given <tt>index</tt> as an
+ * Array: <tt>[mount, radius, restLength, stiffness, damping, friction,
+ * steerFactor, driveFactor]</tt>.
+ */
+static VALUE
+ode_vehicle_wheel( self, index )
+	 VALUE self, index;
+{
+	ode_WHEEL	*wheel = ode_vehicle_wheel_at( get_vehicle(self), index );
+
+	return rb_ary_new3( 8,
+		ode_vector3_to_rArray(wheel->mount), rb_float_new(wheel->radius),
+		rb_float_new(wheel->restLength), rb_float_new(wheel->stiffness),
+		rb_float_new(wheel->damping), rb_float_new(wheel->friction),
+		rb_float_new(wheel->steerFactor), rb_float_new(wheel->driveFactor) );
+}
+
+
+/*
+ * ODE::Vehicle#size
+ * --
+ * Returns the number of wheels the vehicle has.
+ */
+static VALUE
+ode_vehicle_size( self )
+	 VALUE self;
+{
+	return LONG2NUM( get_vehicle(self)->count );
+}
+
+
+/*
+ * ODE::Vehicle#chassis
+ * --
+ * Returns the vehicle's chassis body.
+ */
+static VALUE
+ode_vehicle_chassis( self )
+	 VALUE self;
+{
+	return get_vehicle( self )->chassis;
+}
+
+
+/*
+ * ODE::Vehicle#space
+ * --
+ * Returns the space the vehicle's wheels are cast against.
+ */
+static VALUE
+ode_vehicle_space( self )
+	 VALUE self;
+{
+	return get_vehicle( self )->space;
+}
+
+
+/*
+ * ODE::Vehicle#steering
+ * --
+ * Returns the angle (in radians) the vehicle's steering wheels are turned
+ * to, left of forward about the up direction.
+ */
+static VALUE
+ode_vehicle_steering( self )
+	 VALUE self;
+{
+	return rb_float_new( get_vehicle(self)->steering );
+}
+
+
+/*
+ * ODE::Vehicle#steering=( angle )
+ * --
+ * Turn the vehicle's steering wheels to the given <tt>angle</tt> (in
+ * radians).
+ */
+static VALUE
+ode_vehicle_steering_eq( self, angle )
+	 VALUE self, angle;
+{
+	get_vehicle( self )->steering = (dReal)NUM2DBL( angle );
+	return angle;
+}
+
+
+/*
+ * ODE::Vehicle#drive
+ * --
+ * Returns the torque applied to the vehicle's driven wheels (negative to
+ * reverse).
+ */
+static VALUE
+ode_vehicle_drive( self )
+	 VALUE self;
+{
+	return rb_float_new( get_vehicle(self)->drive );
+}
+
+
+/*
+ * ODE::Vehicle#drive=( torque )
+ * --
+ * Set the torque applied to the vehicle's driven wheels.
+ */
+static VALUE
+ode_vehicle_drive_eq( self, torque )
+	 VALUE self, torque;
+{
+	get_vehicle( self )->drive = (dReal)NUM2DBL( torque );
+	return torque;
+}
+
+
+/*
+ * ODE::Vehicle#brake
+ * --
+ * Returns the braking torque applied to each of the vehicle's wheels.
+ */
+static VALUE
+ode_vehicle_brake( self )
+	 VALUE self;
+{
+	return rb_float_new( get_vehicle(self)->brake );
+}
+
+
+/*
+ * ODE::Vehicle#brake=( torque )
+ * --
+ * Set the braking torque applied to each of the vehicle's wheels.
+ */
+static VALUE
+ode_vehicle_brake_eq( self, torque )
+	 VALUE self, torque;
+{
+	ode_VEHICLE	*ptr = get_vehicle( self );
+
+	CheckPositiveNumber( NUM2DBL(torque), "torque" );
+	ptr->brake = (dReal)NUM2DBL( torque );
+
+	return torque;
+}
+
+
+/*
+ * ODE::Vehicle#setControls( steering, drive, brake )
+ * --
+ * Set the vehicle's #steering, #drive and #brake all at once.
+ */
+static VALUE
+ode_vehicle_set_controls_m( self, steering, drive, brake )
+	 VALUE self, steering, drive, brake;
+{
+	ode_vehicle_set_controls( get_vehicle(self), NUM2DBL(steering), NUM2DBL(drive),
+							  NUM2DBL(brake) );
+	return self;
+}
+
+
+/*
+ * ODE::Vehicle#stateInto( buffer=nil )
+ * --
+ * Returns the state of the vehicle's wheels as of the last step, as a
+ * String of native doubles with WHEEL_STATE_SIZE of them for each wheel, in
+ * index order: its suspension length (from the mount to the wheel's
+ * center), its steering angle, its spin angle and rate, the load on it, the
+ * tire's drive and side forces, and 1.0 if it's touching something (or 0.0
+ * if it isn't). Unpack it with 'd*'. If a <tt>buffer</tt> String is given,
+ * its contents are replaced with the state and it's returned instead.
+ */
+static VALUE
+ode_vehicle_state_into( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_VEHICLE	*ptr = get_vehicle( self );
+	VALUE		buffer;
+
+	if ( rb_scan_args(argc, argv, "01", &buffer) && RTEST(buffer) )
+		StringValue( buffer );
+	else
+		buffer = rb_str_new( 0, 0 );
+
+	rb_str_modify( buffer );
+	rb_str_resize( buffer, ptr->count * ODE_WHEEL_STATE_DOUBLES * sizeof(double) );
+	ode_vehicle_write_state( ptr, (double *)RSTRING(buffer)->ptr );
+
+	return buffer;
+}
+
+
+/*
+ * ODE::Vehicle#enabled?
+ * --
+ * Returns true if the vehicle's wheels act on its chassis when the world is
+ * stepped.
+ */
+static VALUE
+ode_vehicle_enabled_p( self )
+	 VALUE self;
+{
+	return get_vehicle( self )->worldIndex >= 0 ? Qtrue : Qfalse;
+}
+
+
+/*
+ * ODE::Vehicle#enabled=( flag )
+ * --
+ * Enable or disable the vehicle's wheels.
+ */
+static VALUE
+ode_vehicle_enabled_eq( self, flag )
+	 VALUE self, flag;
+{
+	ode_VEHICLE	*ptr = get_vehicle( self );
+
+	if ( RTEST(flag) )
+		ode_vehicle_enable( ptr );
+	else
+		ode_vehicle_disable( ptr );
+
+	return flag;
+}
+
+
+/*
+ * ODE::World#vehicles
+ * --
+ * Returns the world's enabled vehicles.
+ */
+static VALUE
+ode_world_vehicles( self )
+	 VALUE self;
+{
+	ode_WORLD	*world = ode_get_world_struct( self );
+	VALUE		ary = rb_ary_new2( world->vehicleCount );
+	long		i;
+
+	for ( i = 0; i < world->vehicleCount; i++ )
+		rb_ary_push( ary, world->vehicles[i]->object );
+
+	return ary;
+}
+
+
+
+/* --------------------------------------------------
+ * Initializer
+ * -------------------------------------------------- */
+
+void ode_init_vehicle()
+{
+#if FOR_RDOC_PARSER
+	ode_mOde = rb_define_module( "ODE" );
+	ode_cOdeWorld = rb_define_class_under( ode_mOde, "World", rb_cObject );
+	ode_cOdeVehicle = rb_define_class_under( ode_mOde, "Vehicle", rb_cObject );
+#endif
+
+	rb_define_const( ode_cOdeVehicle, "WHEEL_STATE_SIZE", INT2FIX(ODE_WHEEL_STATE_DOUBLES) );
+	rb_define_const( ode_cOdeVehicle, "CONTROL_SIZE", INT2FIX(ODE_VEHICLE_CONTROL_DOUBLES) );
+
+	rb_define_alloc_func( ode_cOdeVehicle, ode_vehicle_s_alloc );
+
+	rb_define_singleton_method( ode_cOdeVehicle, "setControls", ode_vehicle_s_set_controls, 2 );
+	rb_define_singleton_method( ode_cOdeVehicle, "set_controls", ode_vehicle_s_set_controls, 2 );
+	rb_define_singleton_method( ode_cOdeVehicle, "stateInto", ode_vehicle_s_state_into, -1 );
+	rb_define_singleton_method( ode_cOdeVehicle, "state_into", ode_vehicle_s_state_into, -1 );
+
+	rb_define_method( ode_cOdeVehicle, "initialize", ode_vehicle_init, -1 );
+
+	rb_define_method( ode_cOdeVehicle, "addWheel", ode_vehicle_add_wheel, -1 );
+	rb_define_alias ( ode_cOdeVehicle, "add_wheel", "addWheel" );
+	rb_define_method( ode_cOdeVehicle, "wheel", ode_vehicle_wheel, 1 );
+	rb_define_method( ode_cOdeVehicle, "size", ode_vehicle_size, 0 );
+	rb_define_alias ( ode_cOdeVehicle, "wheelCount", "size" );
+	rb_define_alias ( ode_cOdeVehicle, "wheel_count", "size" );
+	rb_define_method( ode_cOdeVehicle, "chassis", ode_vehicle_chassis, 0 );
+	rb_define_method( ode_cOdeVehicle, "space", ode_vehicle_space, 0 );
+
+	rb_define_method( ode_cOdeVehicle, "steering", ode_vehicle_steering, 0 );
+	rb_define_method( ode_cOdeVehicle, "steering=", ode_vehicle_steering_eq, 1 );
+	rb_define_method( ode_cOdeVehicle, "drive", ode_vehicle_drive, 0 );
+	rb_define_method( ode_cOdeVehicle, "drive=", ode_vehicle_drive_eq, 1 );
+	rb_define_method( ode_cOdeVehicle, "brake", ode_vehicle_brake, 0 );
+	rb_define_method( ode_cOdeVehicle, "brake=", ode_vehicle_brake_eq, 1 );
+	rb_define_method( ode_cOdeVehicle, "setControls", ode_vehicle_set_controls_m, 3 );
+	rb_define_alias ( ode_cOdeVehicle, "set_controls", "setControls" );
+
+	rb_define_method( ode_cOdeVehicle, "stateInto", ode_vehicle_state_into, -1 );
+	rb_define_alias ( ode_cOdeVehicle, "state_into", "stateInto" );
+	rb_define_alias ( ode_cOdeVehicle, "state", "stateInto" );
+	rb_define_method( ode_cOdeVehicle, "enabled?", ode_vehicle_enabled_p, 0 );
+	rb_define_method( ode_cOdeVehicle, "enabled=", ode_vehicle_enabled_eq, 1 );
+
+	rb_define_method( ode_cOdeWorld, "vehicles", ode_world_vehicles, 0 );
+}
+
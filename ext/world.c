@@ -37,14 +37,97 @@
  *	Memory-management functions
  * -------------------------------------------------- */
 
+/*
+ * Allocation function
+ */
+static ode_WORLD *
+ode_world_alloc()
+{
+	ode_WORLD *ptr = ALLOC( ode_WORLD );
+
+	ptr->id				= NULL;
+	ptr->object			= Qnil;
+	ptr->stepCount		= 0;
+	ptr->lastStepSize	= 0;
+	ptr->contacts		= NULL;
+	ptr->retiredContacts = NULL;
+	ptr->sensors		= NULL;
+	ptr->reuse			= NULL;
+	ptr->events			= NULL;
+	ptr->ccd			= NULL;
+	ptr->bodies			= NULL;
+	ptr->bodyCount		= 0;
+	ptr->bodyCapacity	= 0;
+	ptr->feedbackJoints	= NULL;
+	ptr->feedbackCount	= 0;
+	ptr->feedbackCapacity = 0;
+	ptr->brokenJoints	= Qnil;
+	ptr->servos			= NULL;
+	ptr->servoCount		= 0;
+	ptr->servoCapacity	= 0;
+	ptr->timelines		= NULL;
+	ptr->timelineCount	= 0;
+	ptr->timelineCapacity = 0;
+	ptr->completedTimelines = Qnil;
+	ptr->springSets		= NULL;
+	ptr->springSetCount	= 0;
+	ptr->springSetCapacity = 0;
+	ptr->vehicles		= NULL;
+	ptr->vehicleCount	= 0;
+	ptr->vehicleCapacity = 0;
+
+	debugMsg(( "Initialized ode_WORLD <%p>", ptr ));
+	return ptr;
+}
+
+
 /*
  * GC mark function 
  */
 static void
-ode_world_gc_mark( id )
-	 dWorldID id;
+ode_world_gc_mark( ptr )
+	 ode_WORLD *ptr;
 {
-	debugMsg(( "Marking World <%p>", id ));
+	debugMsg(( "Marking World <%p>", ptr ));
+
+	if ( ptr && ptr->contacts )
+		ode_contacttable_mark( ptr->contacts );
+	if ( ptr && ptr->sensors )
+		ode_contacttable_mark( ptr->sensors );
+	if ( ptr && ptr->ccd )
+		ode_ccd_mark( ptr->ccd );
+	if ( ptr ) {
+		rb_gc_mark( ptr->brokenJoints );
+		rb_gc_mark( ptr->completedTimelines );
+	}
+
+	/* Enabled servos are kept alive by their world */
+	if ( ptr && ptr->servos ) {
+		long i;
+		for ( i = 0; i < ptr->servoCount; i++ )
+			rb_gc_mark( ptr->servos[i]->object );
+	}
+
+	/* ...as are running timelines */
+	if ( ptr && ptr->timelines ) {
+		long i;
+		for ( i = 0; i < ptr->timelineCount; i++ )
+			rb_gc_mark( ptr->timelines[i]->object );
+	}
+
+	/* ...and enabled springs */
+	if ( ptr && ptr->springSets ) {
+		long i;
+		for ( i = 0; i < ptr->springSetCount; i++ )
+			rb_gc_mark( ptr->springSets[i]->object );
+	}
+
+	/* ...and enabled vehicles */
+	if ( ptr && ptr->vehicles ) {
+		long i;
+		for ( i = 0; i < ptr->vehicleCount; i++ )
+			rb_gc_mark( ptr->vehicles[i]->object );
+	}
 }
 
 
@@ -52,21 +135,52 @@ ode_world_gc_mark( id )
  * GC free function
  */
 static void
-ode_world_gc_free( id )
-	 dWorldID id;
+ode_world_gc_free( ptr )
+	 ode_WORLD *ptr;
 {
-	debugMsg(( "Destroying World <%p>", id ));
-
-	// Destroy the world =:)
-	dWorldDestroy( id );
-	id = NULL;
+	debugMsg(( "Destroying World <%p>", ptr ));
+
+	if ( ptr ) {
+		// Destroy the world =:)
+		dWorldDestroy( ptr->id );
+		ptr->id = NULL;
+
+		if ( ptr->contacts ) ode_contacttable_free( ptr->contacts );
+		if ( ptr->retiredContacts ) ode_contacttable_free( ptr->retiredContacts );
+		if ( ptr->sensors ) ode_contacttable_free( ptr->sensors );
+		if ( ptr->reuse ) ode_contactreuse_free( ptr->reuse );
+		if ( ptr->events ) ode_eventqueue_free( ptr->events );
+		if ( ptr->ccd ) ode_ccd_free( ptr->ccd );
+		if ( ptr->bodies ) xfree( ptr->bodies );
+		if ( ptr->feedbackJoints ) xfree( ptr->feedbackJoints );
+		if ( ptr->servos ) xfree( ptr->servos );
+		if ( ptr->timelines ) xfree( ptr->timelines );
+		if ( ptr->springSets ) xfree( ptr->springSets );
+		if ( ptr->vehicles ) xfree( ptr->vehicles );
+		ptr->contacts = NULL;
+		ptr->retiredContacts = NULL;
+		ptr->sensors = NULL;
+		ptr->reuse = NULL;
+		ptr->events = NULL;
+		ptr->ccd = NULL;
+		ptr->bodies = NULL;
+		ptr->feedbackJoints = NULL;
+		ptr->servos = NULL;
+		ptr->timelines = NULL;
+		ptr->springSets = NULL;
+		ptr->vehicles = NULL;
+		ptr->object = Qnil;
+
+		xfree( ptr );
+		ptr = NULL;
+	}
 }
 
 
 /*
  * Object validity checker. Returns the data pointer.
  */
-static dWorldID
+static ode_WORLD *
 check_world( self )
 	 VALUE	self;
 {
@@ -85,13 +199,13 @@ check_world( self )
 /*
  * Fetch the data pointer and check it for sanity.
  */
-static dWorldID
+static ode_WORLD *
 get_world( self )
 	 VALUE self;
 {
-	dWorldID ptr = check_world( self );
+	ode_WORLD *ptr = check_world( self );
 
-	debugMsg(( "Fetching a dWorldID (%p).", ptr ));
+	debugMsg(( "Fetching an ode_WORLD (%p).", ptr ));
 	if ( !ptr )
 		rb_raise( rb_eRuntimeError, "uninitialized world" );
 
@@ -105,11 +219,214 @@ get_world( self )
 dWorldID
 ode_get_world( self )
 	 VALUE self;
+{
+	return get_world(self)->id;
+}
+
+
+/*
+ * Publicly-usable fetcher for the whole world struct.
+ */
+ode_WORLD *
+ode_get_world_struct( self )
+	 VALUE self;
 {
 	return get_world(self);
 }
 
 
+/*
+ * Add the given body to the list of the world's bodies (which is used to
+ * notice them falling asleep or waking up).
+ */
+void
+ode_world_add_body( ptr, body )
+	 ode_WORLD	*ptr;
+	 ode_BODY	*body;
+{
+	if ( ptr->bodyCount == ptr->bodyCapacity ) {
+		ptr->bodyCapacity = ptr->bodyCapacity ? ptr->bodyCapacity * 2 : 32;
+		REALLOC_N( ptr->bodies, ode_BODY *, ptr->bodyCapacity );
+	}
+
+	body->worldIndex = ptr->bodyCount;
+	body->enabled = dBodyIsEnabled( body->id ) ? 1 : 0;
+	ptr->bodies[ ptr->bodyCount++ ] = body;
+}
+
+
+/*
+ * Remove the given body from the list of the world's bodies.
+ */
+void
+ode_world_remove_body( ptr, body )
+	 ode_WORLD	*ptr;
+	 ode_BODY	*body;
+{
+	ode_BODY	*last;
+
+	if ( ptr->ccd )
+		ode_ccd_remove_body( ptr->ccd, body );
+
+	if ( body->worldIndex < 0 || body->worldIndex >= ptr->bodyCount ||
+		 ptr->bodies[body->worldIndex] != body )
+		return;
+
+	last = ptr->bodies[ --ptr->bodyCount ];
+	ptr->bodies[ body->worldIndex ] = last;
+	last->worldIndex = body->worldIndex;
+	body->worldIndex = -1;
+}
+
+
+/*
+ * Add the given joint to the list of the world's joints with feedback
+ * enabled (which #jointFeedback exports).
+ */
+void
+ode_world_add_feedback_joint( ptr, joint )
+	 ode_WORLD	*ptr;
+	 ode_JOINT	*joint;
+{
+	if ( ptr->feedbackCount == ptr->feedbackCapacity ) {
+		ptr->feedbackCapacity = ptr->feedbackCapacity ? ptr->feedbackCapacity * 2 : 32;
+		REALLOC_N( ptr->feedbackJoints, ode_JOINT *, ptr->feedbackCapacity );
+	}
+
+	joint->feedbackIndex = ptr->feedbackCount;
+	ptr->feedbackJoints[ ptr->feedbackCount++ ] = joint;
+}
+
+
+/*
+ * Remove the given joint from the list of the world's joints with feedback
+ * enabled. The last joint in the list takes its place.
+ */
+void
+ode_world_remove_feedback_joint( ptr, joint )
+	 ode_WORLD	*ptr;
+	 ode_JOINT	*joint;
+{
+	ode_JOINT	*last;
+
+	if ( joint->feedbackIndex < 0 || joint->feedbackIndex >= ptr->feedbackCount ||
+		 ptr->feedbackJoints[joint->feedbackIndex] != joint )
+		return;
+
+	last = ptr->feedbackJoints[ --ptr->feedbackCount ];
+	ptr->feedbackJoints[ joint->feedbackIndex ] = last;
+	last->feedbackIndex = joint->feedbackIndex;
+	joint->feedbackIndex = -1;
+}
+
+
+/*
+ * Return the larger of the magnitudes of two vectors.
+ */
+static dReal
+ode_world_max_length( a, b )
+	 const dReal *a, *b;
+{
+	dReal	la = dSqrt( a[0]*a[0] + a[1]*a[1] + a[2]*a[2] );
+	dReal	lb = dSqrt( b[0]*b[0] + b[1]*b[1] + b[2]*b[2] );
+
+	return la > lb ? la : lb;
+}
+
+
+/*
+ * Break each of the world's breakable joints whose force or torque has been
+ * over its threshold for its number of steps: detach it, mark it obsolete,
+ * and add it to the list returned by #brokenJoints.
+ */
+static void
+ode_world_break_joints( ptr )
+	 ode_WORLD	*ptr;
+{
+	ode_JOINT	*joint;
+	ode_EVENT	*event;
+	dReal		force, torque;
+	long		i = 0;
+
+	if ( RTEST(ptr->brokenJoints) )
+		rb_ary_clear( ptr->brokenJoints );
+
+	while ( i < ptr->feedbackCount ) {
+		joint = ptr->feedbackJoints[i];
+		if ( joint->breakForce <= 0 && joint->breakTorque <= 0 ) {
+			i++;
+			continue;
+		}
+
+		force = ode_world_max_length( joint->feedback->f1, joint->feedback->f2 );
+		torque = ode_world_max_length( joint->feedback->t1, joint->feedback->t2 );
+
+		if ( (joint->breakForce > 0 && force > joint->breakForce) ||
+			 (joint->breakTorque > 0 && torque > joint->breakTorque) )
+			joint->overSteps++;
+		else
+			joint->overSteps = 0;
+
+		if ( joint->overSteps < joint->breakSteps ) {
+			i++;
+			continue;
+		}
+
+		if ( ptr->events ) {
+			event = ode_eventqueue_push( ptr->events, ODE_EVENT_JOINT_BREAK, ptr->stepCount,
+				RTEST(joint->body1) ? ode_get_body(joint->body1)->serial : 0,
+				RTEST(joint->body2) ? ode_get_body(joint->body2)->serial : 0 );
+			event->payload[0] = force;
+			event->payload[1] = torque;
+		}
+
+		/* Removing it moves the last joint into this slot, so don't advance */
+		dJointAttach( joint->id, 0, 0 );
+		joint->body1 = Qnil;
+		joint->body2 = Qnil;
+		joint->obsolete = Qtrue;
+		ode_world_remove_feedback_joint( ptr, joint );
+
+		if ( !RTEST(ptr->brokenJoints) )
+			ptr->brokenJoints = rb_ary_new();
+		rb_ary_push( ptr->brokenJoints, joint->object );
+	}
+}
+
+
+/*
+ * Queue a sleep or wake event for each of the world's bodies which has been
+ * disabled or enabled since the last step.
+ */
+static void
+ode_world_queue_body_events( ptr )
+	 ode_WORLD	*ptr;
+{
+	ode_BODY	*body;
+	ode_EVENT	*event;
+	const dReal	*pos;
+	long		i;
+	int			enabled;
+
+	for ( i = 0; i < ptr->bodyCount; i++ ) {
+		body = ptr->bodies[i];
+		enabled = dBodyIsEnabled( body->id ) ? 1 : 0;
+		if ( enabled == body->enabled ) continue;
+
+		body->enabled = enabled;
+		if ( !ptr->events ) continue;
+
+		event = ode_eventqueue_push( ptr->events,
+			enabled ? ODE_EVENT_BODY_WAKE : ODE_EVENT_BODY_SLEEP,
+			ptr->stepCount, body->serial, 0 );
+		pos = dBodyGetPosition( body->id );
+		event->payload[0] = pos[0];
+		event->payload[1] = pos[1];
+		event->payload[2] = pos[2];
+	}
+}
+
+
 
 /* --------------------------------------------------
  * Class Methods
@@ -141,10 +458,12 @@ ode_world_init( argc, argv, self )
 	debugMsg(( "ODE::World init" ));
 
 	if ( !check_world(self) ) {
-		dWorldID	id;
+		ode_WORLD	*ptr;
 
-		DATA_PTR(self) = id = dWorldCreate();
-		debugMsg(( "Created world <%p>", id ));
+		DATA_PTR(self) = ptr = ode_world_alloc();
+		ptr->object = self;
+		ptr->id = dWorldCreate();
+		debugMsg(( "Created world <%p>", ptr->id ));
 	}
 
 	rb_call_super( argc, argv );
@@ -162,7 +481,7 @@ static VALUE
 ode_world_gravity( self, args )
 	 VALUE self, args;
 {
-	dWorldID	world = get_world( self );
+	dWorldID	world = get_world( self )->id;
 	dVector3	gravity;
 	VALUE		rvec;
 
@@ -186,7 +505,7 @@ static VALUE
 ode_world_gravity_eq( self, gravity )
 	 VALUE self, gravity;
 {
-	dWorldID	world = get_world( self );
+	dWorldID	world = get_world( self )->id;
 	VALUE		gravArray;
 
 	// Make sure we got an array argument
@@ -217,7 +536,7 @@ static VALUE
 ode_world_erp( self, args )
 	 VALUE self, args;
 {
-	dWorldID	world = get_world( self );
+	dWorldID	world = get_world( self )->id;
 	return rb_float_new( dWorldGetERP(world) );
 }
 
@@ -233,7 +552,7 @@ static VALUE
 ode_world_erp_eq( self, erp )
 	 VALUE self, erp;
 {
-	dWorldID	world = get_world( self );
+	dWorldID	world = get_world( self )->id;
 
 	dWorldSetERP( world, NUM2DBL(erp) );
 	return erp;
@@ -251,7 +570,7 @@ static VALUE
 ode_world_cfm( self, args )
 	 VALUE self, args;
 {
-	dWorldID	world = get_world( self );
+	dWorldID	world = get_world( self )->id;
 	return rb_float_new( dWorldGetCFM(world) );
 }
 
@@ -267,7 +586,7 @@ static VALUE
 ode_world_cfm_eq( self, cfm )
 	 VALUE self, cfm;
 {
-	dWorldID	world = get_world( self );
+	dWorldID	world = get_world( self )->id;
 
 	dWorldSetCFM( world, NUM2DBL(cfm) );
 	return cfm;
@@ -285,13 +604,560 @@ static VALUE
 ode_world_step( self, stepsize )
 	 VALUE self, stepsize;
 {
-	dWorldID	world = get_world( self );
+	ode_WORLD	*ptr = get_world( self );
+	dReal		size = (dReal)NUM2DBL( stepsize );
+
+	/* Advance keyframed motor timelines */
+	if ( ptr->timelineCount || RTEST(ptr->completedTimelines) )
+		ode_timeline_prestep( ptr, size );
+
+	/* Drive servo motors towards their targets */
+	if ( ptr->servoCount )
+		ode_servo_prestep( ptr );
+
+	/* Apply spring-damper forces */
+	if ( ptr->springSetCount )
+		ode_spring_prestep( ptr );
+
+	/* Cast vehicle wheels and apply their suspension and tire forces */
+	if ( ptr->vehicleCount )
+		ode_vehicle_prestep( ptr, size );
+
+	if ( ptr->ccd )
+		ode_ccd_prestep( ptr->ccd );
+
+	dWorldStep( ptr->id, size );
+
+	/* Catch fast bodies that passed through something during the step */
+	if ( ptr->ccd )
+		ode_ccd_poststep( ptr );
+
+	/* Break joints that have been overloaded */
+	if ( ptr->feedbackCount || RTEST(ptr->brokenJoints) )
+		ode_world_break_joints( ptr );
+
+	/* Settle the contacts made for this step before moving on to the next */
+	if ( ptr->contacts )
+		ode_contacttable_step( ptr->contacts, ptr->stepCount, size );
+	if ( ptr->sensors )
+		ode_contacttable_step( ptr->sensors, ptr->stepCount, size );
+	if ( ptr->reuse )
+		ode_contactreuse_step( ptr->reuse, ptr->stepCount );
+	if ( ptr->events )
+		ode_world_queue_body_events( ptr );
+
+	ptr->stepCount++;
+	ptr->lastStepSize = size;
 
-	dWorldStep( world, NUM2DBL(stepsize) );
 	return Qtrue;
 }
 
 
+/*
+ * stepCount()
+ * --
+ * Returns the number of times the world has been stepped.
+ */
+static VALUE
+ode_world_step_count( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = get_world( self );
+	return ULONG2NUM( ptr->stepCount );
+}
+
+
+/*
+ * trackContacts?()
+ * --
+ * Returns <tt>true</tt> if the world is keeping track of which geometries
+ * are touching (see #trackContacts=).
+ */
+static VALUE
+ode_world_track_contacts_p( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = get_world( self );
+	return ptr->contacts ? Qtrue : Qfalse;
+}
+
+
+/*
+ * trackContacts=( flag )
+ * --
+ * Turn tracking of touching geometry pairs on or off. When it's on, the
+ * contact joints made by ODE::Space#collide for this world are recorded in a
+ * table of pairs keyed by their geometries, along with the step on which
+ * they first touched, the last step they touched on, and the total impulse
+ * of their contacts. Each #step then notes only the pairs that started or
+ * stopped touching, which can be fetched with #contactChanges. Turning it off
+ * discards the recorded pairs and changes. It's safe to do so between
+ * ODE::Space#collide and #step.
+ */
+static VALUE
+ode_world_track_contacts_eq( self, flag )
+	 VALUE self, flag;
+{
+	ode_WORLD	*ptr = get_world( self );
+
+	if ( RTEST(flag) && !ptr->contacts ) {
+		if ( ptr->retiredContacts ) {
+			ptr->contacts = ptr->retiredContacts;
+			ptr->retiredContacts = NULL;
+		} else {
+			ptr->contacts = ode_contacttable_new( ODE_EVENT_CONTACT_BEGIN,
+												  ODE_EVENT_CONTACT_END );
+		}
+		ptr->contacts->events = ptr->events;
+	}
+
+	/* Contact joints which haven't been destroyed yet still point at the
+	   table's feedback slots, and ODE writes to them on every step, so the
+	   table is only emptied here; it's freed along with the world (after its
+	   joints), or reused if tracking is turned back on. */
+	else if ( !RTEST(flag) && ptr->contacts ) {
+		ode_contacttable_clear( ptr->contacts );
+		ptr->contacts->events = NULL;
+		ptr->retiredContacts = ptr->contacts;
+		ptr->contacts = NULL;
+	}
+
+	return flag;
+}
+
+
+/*
+ * contactChanges()
+ * --
+ * Returns (and forgets) the changes in touching geometry pairs since the
+ * last call, in the order they happened, as an Array of Arrays of the form:
+ *
+ *   [ type, geom1, geom2, firstStep, lastStep, impulse ]
+ *
+ * where <tt>type</tt> is <tt>:begin</tt> or <tt>:end</tt>. Pairs which keep
+ * touching don't appear. Returns an empty Array if contact tracking isn't
+ * on (see #trackContacts=), or if the changes are going to the event queue
+ * instead (see #eventCapacity=).
+ */
+static VALUE
+ode_world_contact_changes( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = get_world( self );
+
+	if ( !ptr->contacts ) return rb_ary_new();
+	return ode_contacttable_drain_changes( ptr->contacts, "begin", "end" );
+}
+
+
+/*
+ * contacts()
+ * --
+ * Returns the geometry pairs which are currently touching as an Array of
+ * Arrays of the form:
+ *
+ *   [ geom1, geom2, firstStep, lastStep, impulse ]
+ *
+ * Returns an empty Array if contact tracking isn't on (see #trackContacts=).
+ */
+static VALUE
+ode_world_contacts( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = get_world( self );
+
+	if ( !ptr->contacts ) return rb_ary_new();
+	return ode_contacttable_pairs( ptr->contacts );
+}
+
+
+/*
+ * sensorChanges()
+ * --
+ * Returns (and forgets) the changes in which geometries overlap sensor
+ * geometries (see ODE::Geometry#sensor=) since the last call, in the order
+ * they happened, as an Array of Arrays of the form:
+ *
+ *   [ type, sensor, geom, firstStep, lastStep, 0.0 ]
+ *
+ * where <tt>type</tt> is <tt>:enter</tt> or <tt>:exit</tt>. Returns an
+ * empty Array if the changes are going to the event queue instead (see
+ * #eventCapacity=).
+ */
+static VALUE
+ode_world_sensor_changes( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = get_world( self );
+
+	if ( !ptr->sensors ) return rb_ary_new();
+	return ode_contacttable_drain_changes( ptr->sensors, "enter", "exit" );
+}
+
+
+/*
+ * sensorOverlaps()
+ * --
+ * Returns the geometries which are currently overlapping sensor geometries
+ * as an Array of Arrays of the form:
+ *
+ *   [ sensor, geom, firstStep, lastStep, 0.0 ]
+ */
+static VALUE
+ode_world_sensor_overlaps( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = get_world( self );
+
+	if ( !ptr->sensors ) return rb_ary_new();
+	return ode_contacttable_pairs( ptr->sensors );
+}
+
+
+/*
+ * Return the world's table of geometries overlapping sensors, creating it
+ * the first time.
+ */
+ode_CONTACTTABLE *
+ode_world_sensor_table( ptr )
+	 ode_WORLD	*ptr;
+{
+	if ( !ptr->sensors ) {
+		ptr->sensors = ode_contacttable_new( ODE_EVENT_SENSOR_ENTER,
+											 ODE_EVENT_SENSOR_EXIT );
+		ptr->sensors->events = ptr->events;
+	}
+
+	return ptr->sensors;
+}
+
+
+/*
+ * contactReuse()
+ * --
+ * Returns the linear and angular thresholds of the world's contact reuse
+ * cache as a two-element Array, or nil if contact reuse is off (see
+ * #contactReuse=).
+ */
+static VALUE
+ode_world_contact_reuse( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = get_world( self );
+
+	if ( !ptr->reuse ) return Qnil;
+	return rb_ary_new3( 2,
+						rb_float_new(ptr->reuse->linearThreshold),
+						rb_float_new(ptr->reuse->angularThreshold) );
+}
+
+
+/*
+ * contactReuse=( [linearThreshold, angularThreshold] )
+ * --
+ * Turn on contact reuse for the world, or turn it off if given
+ * <tt>nil</tt>. With it on, ODE::Space#collide caches the contacts it
+ * generates for each pair of geometries for this world, and re-uses them
+ * instead of colliding the pair again for as long as each of the pair's
+ * bodies is disabled, or has moved less than <tt>linearThreshold</tt> and
+ * turned less than <tt>angularThreshold</tt> radians since they were
+ * generated. Changing the thresholds clears the cache and its counters.
+ */
+static VALUE
+ode_world_contact_reuse_eq( self, thresholds )
+	 VALUE self, thresholds;
+{
+	ode_WORLD	*ptr = get_world( self );
+	VALUE		linear, angular;
+
+	if ( ptr->reuse ) {
+		ode_contactreuse_free( ptr->reuse );
+		ptr->reuse = NULL;
+	}
+
+	if ( RTEST(thresholds) ) {
+		Check_Type( thresholds, T_ARRAY );
+		if ( RARRAY(thresholds)->len != 2 )
+			rb_raise( rb_eArgError, "expected [linearThreshold, angularThreshold]" );
+
+		linear = *(RARRAY(thresholds)->ptr);
+		angular = *(RARRAY(thresholds)->ptr+1);
+		CheckPositiveNumber( NUM2DBL(linear), "linearThreshold" );
+		CheckPositiveNumber( NUM2DBL(angular), "angularThreshold" );
+
+		ptr->reuse = ode_contactreuse_new( (dReal)NUM2DBL(linear),
+										   (dReal)NUM2DBL(angular) );
+	}
+
+	return thresholds;
+}
+
+
+/*
+ * contactReuseHits()
+ * --
+ * Returns the number of times ODE::Space#collide has been able to reuse a
+ * pair's contacts since contact reuse was turned on.
+ */
+static VALUE
+ode_world_contact_reuse_hits( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = get_world( self );
+	return ULONG2NUM( ptr->reuse ? ptr->reuse->hits : 0 );
+}
+
+
+/*
+ * contactReuseMisses()
+ * --
+ * Returns the number of times ODE::Space#collide has had to collide a pair
+ * since contact reuse was turned on.
+ */
+static VALUE
+ode_world_contact_reuse_misses( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = get_world( self );
+	return ULONG2NUM( ptr->reuse ? ptr->reuse->misses : 0 );
+}
+
+
+/*
+ * eventCapacity()
+ * --
+ * Returns the number of events the world's event queue can hold, or nil if
+ * it isn't queueing events (see #eventCapacity=).
+ */
+static VALUE
+ode_world_event_capacity( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = get_world( self );
+
+	if ( !ptr->events ) return Qnil;
+	return LONG2NUM( ptr->events->capacity );
+}
+
+
+/*
+ * eventCapacity=( capacity )
+ * --
+ * Start queueing physics events in a native ring buffer which holds up to
+ * <tt>capacity</tt> of them, or stop if given <tt>nil</tt>. Once the queue
+ * is full, each new event overwrites the oldest one (see #eventsDropped).
+ * Queued events are fetched all at once with #drainEvents. The events are:
+ *
+ * [EVENT_CONTACT_BEGIN, EVENT_CONTACT_END]
+ *   Two geometries started or stopped touching (only while contact
+ *   tracking is on; see #trackContacts=). The indexes are the geometries'
+ *   serials (ODE::Geometry#serial); the payload is the pair's total impulse
+ *   so far and the step on which it started touching.
+ * [EVENT_BODY_SLEEP, EVENT_BODY_WAKE]
+ *   A body was disabled or enabled, by auto-disabling or otherwise, during
+ *   the step. The first index is its serial (ODE::Body#serial); the payload
+ *   is its position.
+ * [EVENT_SENSOR_ENTER, EVENT_SENSOR_EXIT]
+ *   A geometry started or stopped overlapping a sensor (see
+ *   ODE::Geometry#sensor=). The first index is the sensor's serial and the
+ *   second the other geometry's; the payload is 0 and the step on which the
+ *   overlap started.
+ * [EVENT_CCD_HIT]
+ *   A body being swept for continuous collision detection hit something
+ *   during the step (see ODE::Body#ccdRadius=). The indexes are the body's
+ *   and the geometry's serials; the payload is the point of impact and the
+ *   time of impact as a fraction of the step.
+ * [EVENT_JOINT_BREAK]
+ *   A joint broke during the step (see ODE::Joint#breakForce=). The indexes
+ *   are the serials of the bodies it was attached to (0 for the static
+ *   environment); the payload is the force and torque it broke under.
+ * [EVENT_TIMELINE_DONE]
+ *   A timeline which reached its end on the previous step completed (see
+ *   ODE::Timeline#start). The indexes are the serials of the bodies its
+ *   joint is attached to; the payload is the timeline's duration and final
+ *   value.
+ *
+ * While the queue is on, contact and sensor changes go to it instead of to
+ * #contactChanges and #sensorChanges.
+ *
+ * Changing the capacity discards any queued events.
+ */
+static VALUE
+ode_world_event_capacity_eq( self, capacity )
+	 VALUE self, capacity;
+{
+	ode_WORLD	*ptr = get_world( self );
+	long		i;
+
+	if ( ptr->events ) {
+		ode_eventqueue_free( ptr->events );
+		ptr->events = NULL;
+	}
+
+	if ( RTEST(capacity) ) {
+		CheckPositiveNonZeroNumber( NUM2DBL(capacity), "capacity" );
+		ptr->events = ode_eventqueue_new( NUM2LONG(capacity) );
+
+		/* Don't report bodies that changed while nobody was listening */
+		for ( i = 0; i < ptr->bodyCount; i++ )
+			ptr->bodies[i]->enabled = dBodyIsEnabled( ptr->bodies[i]->id ) ? 1 : 0;
+	}
+
+	if ( ptr->contacts ) ptr->contacts->events = ptr->events;
+	if ( ptr->sensors ) ptr->sensors->events = ptr->events;
+
+	return capacity;
+}
+
+
+/*
+ * drainEvents( buffer=nil )
+ * --
+ * Returns (and forgets) the queued events, oldest first, packed into a
+ * String of fixed-size records (EVENT_SIZE bytes each) which can be
+ * unpacked with EVENT_FORMAT:
+ *
+ *   type, step, index1, index2, *payload = record.unpack( ODE::World::EVENT_FORMAT )
+ *
+ * If a <tt>buffer</tt> String is given, its contents are replaced with the
+ * events and it's returned instead, so the same String can be reused every
+ * step. Returns an empty String if the world isn't queueing events (see
+ * #eventCapacity=).
+ */
+static VALUE
+ode_world_drain_events( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_WORLD	*ptr = get_world( self );
+	VALUE		buffer;
+
+	rb_scan_args( argc, argv, "01", &buffer );
+
+	if ( NIL_P(buffer) )
+		buffer = rb_str_new( 0, 0 );
+	else
+		StringValue( buffer );
+
+	if ( !ptr->events ) {
+		rb_str_resize( buffer, 0 );
+		return buffer;
+	}
+
+	return ode_eventqueue_drain( ptr->events, buffer );
+}
+
+
+/*
+ * eventsDropped()
+ * --
+ * Returns the number of events which have been overwritten because the
+ * event queue was full since it was created.
+ */
+static VALUE
+ode_world_events_dropped( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = get_world( self );
+	return ULONG2NUM( ptr->events ? ptr->events->dropped : 0 );
+}
+
+
+/*
+ * jointFeedback( buffer=nil )
+ * --
+ * Returns the forces and torques applied by every joint with feedback
+ * enabled during the last step, packed into a String of fixed-size records
+ * (FEEDBACK_SIZE bytes each) which can be unpacked with FEEDBACK_FORMAT:
+ *
+ *   f1x, f1y, f1z, t1x, t1y, t1z, f2x, f2y, f2z, t2x, t2y, t2z =
+ *       record.unpack( ODE::World::FEEDBACK_FORMAT )
+ *
+ * The records are in the same order as #feedbackJoints (the record for a
+ * joint is at its ODE::Joint#feedbackIndex). If a <tt>buffer</tt> String is
+ * given, its contents are replaced with the records and it's returned
+ * instead, so the same String can be reused every step.
+ */
+static VALUE
+ode_world_joint_feedback( argc, argv, self )
+	 int	argc;
+	 VALUE	*argv, self;
+{
+	ode_WORLD		*ptr = get_world( self );
+	dJointFeedback	*feedback;
+	VALUE			buffer;
+	double			*out;
+	long			i;
+	int				j;
+
+	rb_scan_args( argc, argv, "01", &buffer );
+
+	if ( NIL_P(buffer) )
+		buffer = rb_str_new( 0, 0 );
+	else
+		StringValue( buffer );
+
+	rb_str_modify( buffer );
+	rb_str_resize( buffer, ptr->feedbackCount * 12 * sizeof(double) );
+	out = (double *)RSTRING( buffer )->ptr;
+
+	for ( i = 0; i < ptr->feedbackCount; i++ ) {
+		feedback = ptr->feedbackJoints[i]->feedback;
+		for ( j = 0; j < 3; j++ ) {
+			out[j]		= feedback->f1[j];
+			out[j+3]	= feedback->t1[j];
+			out[j+6]	= feedback->f2[j];
+			out[j+9]	= feedback->t2[j];
+		}
+		out += 12;
+	}
+
+	return buffer;
+}
+
+
+/*
+ * feedbackJoints()
+ * --
+ * Returns an Array of the joints with feedback enabled, in the order of the
+ * records returned by #jointFeedback. The order changes only when feedback
+ * is turned off for a joint (the last joint takes its place) or a joint is
+ * destroyed, so this only needs to be fetched again after that happens.
+ */
+static VALUE
+ode_world_feedback_joints( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = get_world( self );
+	VALUE		ary = rb_ary_new2( ptr->feedbackCount );
+	long		i;
+
+	for ( i = 0; i < ptr->feedbackCount; i++ )
+		rb_ary_push( ary, ptr->feedbackJoints[i]->object );
+
+	return ary;
+}
+
+
+/*
+ * brokenJoints()
+ * --
+ * Returns an Array of the joints which broke during the last step because
+ * their force or torque was over one of their thresholds (see
+ * ODE::Joint#breakForce=). Broken joints are detached from their bodies and
+ * marked obsolete.
+ */
+static VALUE
+ode_world_broken_joints( self )
+	 VALUE self;
+{
+	ode_WORLD	*ptr = get_world( self );
+
+	if ( !RTEST(ptr->brokenJoints) ) return rb_ary_new();
+	return rb_ary_dup( ptr->brokenJoints );
+}
+
+
 /*
  * createBody()
  * --
@@ -329,7 +1195,7 @@ static VALUE
 ode_world_imp2force( self, stepsize, ix, iy, iz )
 	 VALUE self, stepsize, ix, iy, iz;
 {
-	dWorldID	world = get_world( self );
+	dWorldID	world = get_world( self )->id;
 	dVector3	fvec;
 	VALUE		force;
 
@@ -379,6 +1245,66 @@ ode_init_world() {
 
 	/* Operations */
 	rb_define_method( ode_cOdeWorld, "step", ode_world_step, 1 );
+	rb_define_method( ode_cOdeWorld, "stepCount", ode_world_step_count, 0 );
+	rb_define_alias ( ode_cOdeWorld, "step_count", "stepCount" );
+
+	/* Contact tracking */
+	rb_define_method( ode_cOdeWorld, "trackContacts?", ode_world_track_contacts_p, 0 );
+	rb_define_alias ( ode_cOdeWorld, "track_contacts?", "trackContacts?" );
+	rb_define_method( ode_cOdeWorld, "trackContacts=", ode_world_track_contacts_eq, 1 );
+	rb_define_alias ( ode_cOdeWorld, "track_contacts=", "trackContacts=" );
+	rb_define_method( ode_cOdeWorld, "contactChanges", ode_world_contact_changes, 0 );
+	rb_define_alias ( ode_cOdeWorld, "contact_changes", "contactChanges" );
+	rb_define_method( ode_cOdeWorld, "contacts", ode_world_contacts, 0 );
+
+	/* Sensors */
+	rb_define_method( ode_cOdeWorld, "sensorChanges", ode_world_sensor_changes, 0 );
+	rb_define_alias ( ode_cOdeWorld, "sensor_changes", "sensorChanges" );
+	rb_define_method( ode_cOdeWorld, "sensorOverlaps", ode_world_sensor_overlaps, 0 );
+	rb_define_alias ( ode_cOdeWorld, "sensor_overlaps", "sensorOverlaps" );
+
+	/* Contact reuse */
+	rb_define_method( ode_cOdeWorld, "contactReuse", ode_world_contact_reuse, 0 );
+	rb_define_alias ( ode_cOdeWorld, "contact_reuse", "contactReuse" );
+	rb_define_method( ode_cOdeWorld, "contactReuse=", ode_world_contact_reuse_eq, 1 );
+	rb_define_alias ( ode_cOdeWorld, "contact_reuse=", "contactReuse=" );
+	rb_define_method( ode_cOdeWorld, "contactReuseHits", ode_world_contact_reuse_hits, 0 );
+	rb_define_alias ( ode_cOdeWorld, "contact_reuse_hits", "contactReuseHits" );
+	rb_define_method( ode_cOdeWorld, "contactReuseMisses", ode_world_contact_reuse_misses, 0 );
+	rb_define_alias ( ode_cOdeWorld, "contact_reuse_misses", "contactReuseMisses" );
+
+	/* Event queue */
+	rb_define_const( ode_cOdeWorld, "EVENT_CONTACT_BEGIN", INT2FIX(ODE_EVENT_CONTACT_BEGIN) );
+	rb_define_const( ode_cOdeWorld, "EVENT_CONTACT_END", INT2FIX(ODE_EVENT_CONTACT_END) );
+	rb_define_const( ode_cOdeWorld, "EVENT_BODY_SLEEP", INT2FIX(ODE_EVENT_BODY_SLEEP) );
+	rb_define_const( ode_cOdeWorld, "EVENT_BODY_WAKE", INT2FIX(ODE_EVENT_BODY_WAKE) );
+	rb_define_const( ode_cOdeWorld, "EVENT_SENSOR_ENTER", INT2FIX(ODE_EVENT_SENSOR_ENTER) );
+	rb_define_const( ode_cOdeWorld, "EVENT_SENSOR_EXIT", INT2FIX(ODE_EVENT_SENSOR_EXIT) );
+	rb_define_const( ode_cOdeWorld, "EVENT_CCD_HIT", INT2FIX(ODE_EVENT_CCD_HIT) );
+	rb_define_const( ode_cOdeWorld, "EVENT_JOINT_BREAK", INT2FIX(ODE_EVENT_JOINT_BREAK) );
+	rb_define_const( ode_cOdeWorld, "EVENT_TIMELINE_DONE", INT2FIX(ODE_EVENT_TIMELINE_DONE) );
+	rb_define_const( ode_cOdeWorld, "EVENT_FORMAT", rb_str_new2("IIIIdddd") );
+	rb_define_const( ode_cOdeWorld, "EVENT_SIZE", INT2FIX(sizeof(ode_EVENT)) );
+
+	rb_define_method( ode_cOdeWorld, "eventCapacity", ode_world_event_capacity, 0 );
+	rb_define_alias ( ode_cOdeWorld, "event_capacity", "eventCapacity" );
+	rb_define_method( ode_cOdeWorld, "eventCapacity=", ode_world_event_capacity_eq, 1 );
+	rb_define_alias ( ode_cOdeWorld, "event_capacity=", "eventCapacity=" );
+	rb_define_method( ode_cOdeWorld, "drainEvents", ode_world_drain_events, -1 );
+	rb_define_alias ( ode_cOdeWorld, "drain_events", "drainEvents" );
+	rb_define_method( ode_cOdeWorld, "eventsDropped", ode_world_events_dropped, 0 );
+	rb_define_alias ( ode_cOdeWorld, "events_dropped", "eventsDropped" );
+
+	/* Joint feedback */
+	rb_define_const( ode_cOdeWorld, "FEEDBACK_FORMAT", rb_str_new2("d12") );
+	rb_define_const( ode_cOdeWorld, "FEEDBACK_SIZE", INT2FIX(12 * sizeof(double)) );
+
+	rb_define_method( ode_cOdeWorld, "jointFeedback", ode_world_joint_feedback, -1 );
+	rb_define_alias ( ode_cOdeWorld, "joint_feedback", "jointFeedback" );
+	rb_define_method( ode_cOdeWorld, "feedbackJoints", ode_world_feedback_joints, 0 );
+	rb_define_alias ( ode_cOdeWorld, "feedback_joints", "feedbackJoints" );
+	rb_define_method( ode_cOdeWorld, "brokenJoints", ode_world_broken_joints, 0 );
+	rb_define_alias ( ode_cOdeWorld, "broken_joints", "brokenJoints" );
 }
 
 
@@ -0,0 +1,99 @@
+#!/usr/bin/ruby
+
+$LOAD_PATH.unshift File::dirname(__FILE__)
+require "odeunittest"
+
+class ArticulationTestCase < ODE::TestCase
+
+	Tolerance = ODE::Precision == 'dDOUBLE' ? 1e-5 : 1e-2
+
+	def setup
+		@world = ODE::World::new
+
+		@hinge = ODE::HingeJoint::new( @world )
+		@hinge.attach( @world.createBody, nil )
+		@hinge.axis = 0, 0, 1
+		@slider = ODE::SliderJoint::new( @world )
+		@sliderBody = @world.createBody
+		@slider.attach( @sliderBody, nil )
+		@slider.axis = 1, 0, 0
+		@universal = ODE::UniversalJoint::new( @world )
+		@universal.attach( @world.createBody, nil )
+
+		@joints = [ @hinge, @slider, @universal ]
+	end
+
+
+	#################################################################
+	###	T E S T S
+	#################################################################
+
+	def test_00_create
+		printTestHeader "Articulation: Instantiation"
+		art = nil
+
+		assert_nothing_raised { art = ODE::Articulation::new(@joints) }
+		assert_equal @joints, art.joints
+		assert_equal 4, art.dof
+		assert_equal [[@hinge, 1], [@slider, 1], [@universal, 1], [@universal, 2]],
+			art.coordinates
+
+		assert_raises( TypeError ) {
+			ODE::Articulation::new( [@hinge, ODE::BallJoint::new(@world)] )
+		}
+		assert_raises( RuntimeError ) { art.send(:initialize, [@hinge]) }
+		assert_equal 4, art.dof
+	end
+
+	def test_01_state
+		printTestHeader "Articulation: Joint-space state"
+		art = ODE::Articulation::new( @joints )
+		@sliderBody.linearVelocity = 2, 0, 0
+		@world.step( 0.01 )
+
+		state = nil
+		assert_nothing_raised { state = art.stateInto }
+		values = state.unpack( "d*" )
+		assert_equal 8, values.length
+		assert_in_delta @hinge.angle, values[0], Tolerance
+		assert_in_delta @slider.position, values[1], Tolerance
+		assert_in_delta @slider.positionRate, values[5], Tolerance
+
+		buffer = ""
+		assert_same buffer, art.state_into( buffer )
+		assert_equal state, buffer
+	end
+
+	def test_02_targets
+		printTestHeader "Articulation: Servo targets"
+		art = ODE::Articulation::new( @joints )
+
+		assert_nothing_raised { art.setTargets([0.1, 0.2, 0.3, 0.4].pack("d*")) }
+		servos = art.servos
+		assert_equal 4, servos.length
+		assert_equal servos, @world.servos
+		assert_equal [@universal, 2], [servos[3].joint, servos[3].axis]
+		assert_in_delta 0.4, servos[3].target, Tolerance
+
+		art.set_targets( [0, 0, 0, 0, 1, 2, 3, 4] )
+		assert_in_delta 3.0, servos[2].targetVelocity, Tolerance
+		assert_raises( ArgumentError ) { art.setTargets([1.0, 2.0]) }
+		assert_raises( TypeError ) { art.setTargets([9, 9, 9, "nine"]) }
+		assert_in_delta 0.0, servos[0].target, Tolerance
+	end
+
+	def test_03_obsolete_joints
+		printTestHeader "Articulation: Obsolete joints"
+		group = ODE::JointGroup::new
+		hinge = ODE::HingeJoint::new( @world, group )
+		hinge.attach( @world.createBody, nil )
+		art = ODE::Articulation::new( [@slider, hinge] )
+
+		group.empty
+		assert_raises( ODE::ObsoleteJointError ) { art.setTargets([1.0, 2.0]) }
+		assert_raises( ODE::ObsoleteJointError ) { art.servos }
+		assert_equal [], @world.servos
+	end
+
+end
+
@@ -0,0 +1,384 @@
+#!/usr/bin/ruby
+
+$LOAD_PATH.unshift File::dirname(__FILE__)
+require "odeunittest"
+
+class CollisionTestCase < ODE::TestCase
+
+	def setup
+		@world = ODE::World::new
+		@space = ODE::HashSpace::new
+		@jointGroup = ODE::JointGroup::new
+
+		# A row of overlapping spheres on bodies, resting on a static box
+		@bodies = []
+		@geoms = (0...40).collect {|i|
+			body = @world.createBody
+			body.position = [ i * 1.5, 0.9, 0 ]
+			geom = ODE::Geometry::Sphere::new( 1.0, @space )
+			geom.body = body
+			@bodies << body
+			geom
+		}
+		@ground = ODE::Geometry::Box::new( 100.0, 1.0, 100.0, @space )
+		@ground.position = [ 0, -0.5, 0 ]
+	end
+
+	def teardown
+		@jointGroup.empty
+		ODE::Space::collisionThreads = 0
+		ODE::Surface::setManifoldReduction( nil, nil, nil )
+	end
+
+
+	### Unpack the records in a String returned by World#drainEvents
+	def unpackEvents( buffer )
+		size = ODE::World::EVENT_SIZE
+		return (0...buffer.length / size).collect {|i|
+			buffer[ i * size, size ].unpack( ODE::World::EVENT_FORMAT )
+		}
+	end
+
+
+	#################################################################
+	###	T E S T S
+	#################################################################
+
+	def test_00_collide
+		printTestHeader "Space#collide: Native contact joints"
+		count = nil
+
+		assert_raises( ArgumentError ) { @space.collide(@world) }
+		assert_raises( TypeError ) { @space.collide(@world, "group") }
+		assert_nothing_raised { count = @space.collide(@world, @jointGroup, 4) }
+		assert count > 0, "expected contacts between the spheres and the ground"
+		assert @bodies[0].getNumberOfJoints > 0
+		assert_equal [], @bodies[0].joints
+		assert_nothing_raised { @world.step(0.01) }
+		assert_nothing_raised { @jointGroup.empty }
+	end
+
+	def test_01_nested_spaces
+		printTestHeader "Space#collide: Nested spaces"
+		inner = ODE::Space::new( @space )
+		body = @world.createBody
+		body.position = [ 0, 0.5, 0 ]
+		geom = ODE::Geometry::Box::new( 1.0, 1.0, 1.0, inner )
+		geom.body = body
+
+		@space.collide( @world, @jointGroup )
+		assert body.getNumberOfJoints > 0, "expected the nested geometry to collide"
+	end
+
+	def test_02_threaded_collide
+		printTestHeader "Space#collide: Threaded narrowphase"
+
+		unless ODE::Features[:ThreadedCollision]
+			assert_raises( NotImplementedError ) { ODE::Space::collisionThreads = 2 }
+			return
+		end
+
+		serial = @space.collide( @world, @jointGroup )
+		@jointGroup.empty
+
+		assert_nothing_raised { ODE::Space::collisionThreads = 3 }
+		assert_equal 3, ODE::Space::collisionThreads
+		5.times {
+			assert_equal serial, @space.collide( @world, @jointGroup )
+			@jointGroup.empty
+		}
+		assert_raises( RangeError ) { ODE::Space::collisionThreads = -1 }
+	end
+
+	def test_10_contact_tracking
+		printTestHeader "World#trackContacts: Begin/end changes"
+		step = lambda {
+			@space.collide( @world, @jointGroup )
+			@world.step( 0.01 )
+			@jointGroup.empty
+		}
+
+		assert !@world.trackContacts?
+		assert_nothing_raised { @world.trackContacts = true }
+		assert @world.trackContacts?
+
+		step.call
+		changes = @world.contactChanges
+		assert changes.length > 0
+		assert changes.all? {|change| change[0] == :begin }
+		assert_equal changes.length, @world.contacts.length
+		assert_equal 1, @world.stepCount
+
+		# Resting contacts produce no changes
+		step.call
+		assert_equal [], @world.contactChanges
+		assert @world.contacts.all? {|pair| pair[4] > 0.0 },
+			"expected the resting contacts to accumulate impulse"
+
+		# Separate the first sphere from everything
+		@geoms[0].body.position = [ -50, 50, 0 ]
+		step.call
+		changes = @world.contactChanges
+		assert changes.find {|change| change[0] == :end && change[1] == @geoms[0] }
+		assert !@world.contacts.find {|pair| pair[0] == @geoms[0] }
+
+		@world.trackContacts = false
+		assert_equal [], @world.contacts
+	end
+
+	def test_11_contact_reuse
+		printTestHeader "World#contactReuse: Skipping resting pairs"
+
+		assert_nil @world.contactReuse
+		assert_raises( ArgumentError ) { @world.contactReuse = [0.01] }
+		assert_nothing_raised { @world.contactReuse = [0.01, 0.02] }
+		assert_equal [0.01, 0.02], @world.contactReuse
+
+		count = @space.collide( @world, @jointGroup )
+		@jointGroup.empty
+		misses = @world.contactReuseMisses
+		assert misses > 0
+		assert_equal 0, @world.contactReuseHits
+
+		# Resting bodies reuse everything
+		@bodies.each {|body| body.disable }
+		@world.step( 0.01 )
+		assert_equal count, @space.collide( @world, @jointGroup )
+		@jointGroup.empty
+		assert_equal misses, @world.contactReuseHits
+		assert_equal misses, @world.contactReuseMisses
+
+		# Moving one body past the threshold collides its pairs again
+		@bodies[5].enable
+		@bodies[5].position = [ 5 * 1.5, 1.0, 0 ]
+		@world.step( 0.01 )
+		@space.collide( @world, @jointGroup )
+		@jointGroup.empty
+		assert @world.contactReuseMisses > misses
+
+		# So does moving a static geometry
+		misses = @world.contactReuseMisses
+		@ground.position = [ 0, -0.6, 0 ]
+		@space.collide( @world, @jointGroup )
+		@jointGroup.empty
+		assert @world.contactReuseMisses > misses
+
+		@world.contactReuse = nil
+		assert_nil @world.contactReuse
+		assert_equal 0, @world.contactReuseHits
+	end
+
+	def test_12_manifold_reduction
+		printTestHeader "Surface::setManifoldReduction: Fewer contacts per pair"
+		surface = ODE::Surface::new
+		body = @world.createBody
+		body.position = [ 0, 0.45, 20 ]
+		box = ODE::Geometry::Box::new( 2.0, 1.0, 2.0, @space )
+		box.body = body
+
+		assert_nil ODE::Surface::manifoldReduction( nil, nil )
+		assert_raises( TypeError ) { ODE::Surface::setManifoldReduction("a", nil, 2) }
+		assert_raises( RangeError ) { ODE::Surface::setManifoldReduction(nil, nil, 0) }
+
+		full = 0
+		box.collideWith( @ground, 8 ) { full += 1 }
+		assert full > 2, "expected a full box-on-box manifold"
+
+		# A default rule applies to every pair
+		ODE::Surface::setManifoldReduction( nil, nil, 2, 0.01 )
+		rule = ODE::Surface::manifoldReduction( nil, nil )
+		assert_equal 2, rule[0]
+		assert_in_delta 0.01, rule[1], 1e-6
+		assert_equal 2, box.collideWith( @ground, 8 ) {}
+		assert @space.collide( @world, @jointGroup, 8 ) <= 2 * 41
+		@jointGroup.empty
+
+		# A rule for a specific surface wins over the default
+		box.surface = surface
+		ODE::Surface::setManifoldReduction( surface, nil, 3 )
+		assert_equal [3, 0.0], ODE::Surface::manifoldReduction( nil, surface )
+		assert_equal 3, box.collideWith( @ground, 8 ) {}
+
+		ODE::Surface::setManifoldReduction( surface, nil, nil )
+		assert_equal 2, box.collideWith( @ground, 8 ) {}
+	end
+
+	def test_13_event_queue
+		printTestHeader "World#drainEvents: Native event queue"
+		assert_nil @world.eventCapacity
+		assert_equal "", @world.drainEvents
+		assert_raises( RangeError ) { @world.eventCapacity = 0 }
+
+		@world.trackContacts = true
+		@world.eventCapacity = 1024
+		assert_equal 1024, @world.eventCapacity
+
+		@space.collide( @world, @jointGroup )
+		@world.step( 0.01 )
+		@jointGroup.empty
+
+		buffer = ""
+		assert_same buffer, @world.drainEvents( buffer )
+		assert buffer.length > 0
+		assert_equal 0, buffer.length % ODE::World::EVENT_SIZE
+
+		events = unpackEvents( buffer )
+		assert events.all? {|ev| ev[0] == ODE::World::EVENT_CONTACT_BEGIN }
+		assert events.find {|ev| ev[2] == @ground.serial || ev[3] == @ground.serial }
+		assert_equal "", @world.drainEvents
+
+		# A body going to sleep
+		body = @world.createBody
+		body.disable
+		@world.step( 0.01 )
+		sleeps = unpackEvents( @world.drainEvents ).
+			select {|ev| ev[0] == ODE::World::EVENT_BODY_SLEEP }
+		assert_equal [body.serial], sleeps.collect {|ev| ev[2] }
+
+		# Overflow drops the oldest
+		@world.eventCapacity = 1
+		body.enable
+		@bodies[0].disable
+		@world.step( 0.01 )
+		assert_equal ODE::World::EVENT_SIZE, @world.drainEvents.length
+		assert_equal 1, @world.eventsDropped
+
+		@world.eventCapacity = nil
+		@world.trackContacts = false
+	end
+
+	def test_14_sensors
+		printTestHeader "Geometry#sensor=: Overlaps without contacts"
+		count = @space.collide( @world, @jointGroup )
+		@jointGroup.empty
+
+		sensor = ODE::Geometry::Box::new( 0.5, 0.5, 0.5, @space )
+		sensor.position = [ 3 * 1.5, 0.9, 0 ]
+		assert_equal false, sensor.sensor?
+		sensor.sensor = true
+		assert sensor.sensor?
+
+		# No extra joints, but the overlap is recorded
+		assert_equal count, @space.collide( @world, @jointGroup )
+		@jointGroup.empty
+		assert_equal [[sensor, @geoms[3]]], @world.sensorOverlaps.collect {|o| o[0,2] }
+		@world.step( 0.01 )
+		changes = @world.sensorChanges
+		assert_equal 1, changes.length
+		assert_equal [:enter, sensor, @geoms[3]], changes[0][0,3]
+
+		# Moving it away ends the overlap
+		sensor.position = [ 0, 10, 40 ]
+		@space.collide( @world, @jointGroup )
+		@jointGroup.empty
+		@world.step( 0.01 )
+		assert_equal [[:exit, sensor, @geoms[3]]], @world.sensorChanges.collect {|c| c[0,3] }
+		assert_equal [], @world.sensorOverlaps
+	end
+
+	def test_15_ccd
+		printTestHeader "Body#ccdRadius=: Continuous collision detection"
+		bullet = @world.createBody
+		bullet.position = [ 0, 3, 30 ]
+		bullet.linearVelocity = [ 0, -1000, 0 ]
+
+		assert_nil bullet.ccdRadius
+		assert_raises( RangeError ) { bullet.ccdRadius = -1 }
+		assert_raises( TypeError ) { @world.ccdSpace = @world }
+
+		bullet.ccdRadius = 0.1
+		@world.ccdSpace = @space
+		assert_in_delta 0.1, bullet.ccdRadius, 1e-6
+		assert_equal @space, @world.ccdSpace
+
+		# Without CCD the step would put it through the ground
+		@world.step( 0.01 )
+		assert_in_delta 0.1, bullet.position.y, 1e-4
+
+		hits = @world.ccdHits
+		assert_equal 1, hits.length
+		assert_equal [bullet, @ground], hits[0][0,2]
+		assert hits[0][4] > 0 && hits[0][4] < 1
+
+		# The contact made at the hit stops it during the next step
+		@world.step( 0.01 )
+		assert_in_delta 0.1, bullet.position.y, 1e-3
+		assert_in_delta 0.0, bullet.linearVelocity.y, 1e-3
+		assert_equal [], @world.ccdHits
+
+		# ...or bounces it, with the ground's surface
+		@ground.surface = ODE::Surface::new
+		@ground.surface.bounce = 1.0
+		bullet.position = [ 0, 3, 30 ]
+		bullet.linearVelocity = [ 0, -1000, 0 ]
+		2.times { @world.step(0.01) }
+		assert bullet.linearVelocity.y > 500, "expected the bullet to bounce"
+
+		# Turned off, it tunnels
+		bullet.ccdRadius = nil
+		bullet.position = [ 0, 3, 30 ]
+		bullet.linearVelocity = [ 0, -1000, 0 ]
+		@world.step( 0.01 )
+		assert bullet.position.y < -1.0
+		assert_equal [], @world.ccdHits
+	end
+
+	def test_16_distance
+		printTestHeader "Geometry#distanceTo: Closest points and separation"
+		ball = ODE::Geometry::Sphere::new( 1.0 )
+		ball.position = [ 0, 5, 0 ]
+
+		# Sphere against box, analytically
+		dist, onBall, onGround = ball.distanceTo( @ground )
+		assert_in_delta 4.0, dist, 1e-6
+		assertSimilar [ 0, 4, 0 ], onBall
+		assertSimilar [ 0, 0, 0 ], onGround
+
+		# Overlapping spheres give the penetration depth
+		dist, = @geoms[0].distanceTo( @geoms[1] )
+		assert_in_delta -0.5, dist, 1e-6
+
+		# Capsule against plane, box against box (with GJK)
+		floor = ODE::Geometry::Plane::new( 0, 1, 0, 0 )
+		capsule = ODE::Geometry::Capsule::new( 0.5, 2.0 )
+		capsule.position = [ 0, 3, 0 ]
+		assert_in_delta 2.5, capsule.distanceTo( floor )[0], 1e-6
+		assert_in_delta 2.5, floor.distanceTo( capsule )[0], 1e-6
+
+		box = ODE::Geometry::Box::new( 1.0, 1.0, 1.0 )
+		box.position = [ 3, 2.5, 0 ]
+		dist, onBox, onGround = box.distanceTo( @ground )
+		assert_in_delta 2.0, dist, 1e-5
+		assert_in_delta 2.0, onBox[1], 1e-5
+		assert_in_delta 0.0, onGround[1], 1e-5
+
+		# One against many
+		results = ball.distancesTo([ @ground, capsule, box ])
+		assert_equal 3, results.length
+		assert_in_delta 4.0, results[0][0], 1e-6
+		assert_in_delta 0.5, results[1][0], 1e-6
+
+		assert_raises( ODE::GeometryError ) { ball.distanceTo(ODE::Geometry::Ray::new(1.0)) }
+		assert_raises( ODE::GeometryError ) { floor.distanceTo(floor) }
+	end
+
+	def test_17_tracking_off_mid_step
+		printTestHeader "World#trackContacts: Turning tracking off between collide and step"
+		@world.trackContacts = true
+		@space.collide( @world, @jointGroup )
+
+		# The contact joints still refer to the table's feedback slots
+		assert_nothing_raised { @world.trackContacts = false }
+		assert_nothing_raised { @world.step(0.01) }
+		assert_equal [], @world.contacts
+		@jointGroup.empty
+
+		@world.trackContacts = true
+		@space.collide( @world, @jointGroup )
+		@world.step( 0.01 )
+		@jointGroup.empty
+		assert @world.contacts.length > 0
+		assert @world.contactChanges.all? {|change| change[0] == :begin }
+	end
+
+end
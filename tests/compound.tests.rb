@@ -0,0 +1,135 @@
+#!/usr/bin/ruby
+
+$LOAD_PATH.unshift File::dirname(__FILE__)
+require "odeunittest"
+
+class CompoundTestCase < ODE::TestCase
+
+	def setup
+		@world = ODE::World::new
+		@space = ODE::HashSpace::new
+	end
+
+
+	#################################################################
+	###	T E S T S
+	#################################################################
+
+	def test_00_transform
+		printTestHeader "Geometry::Transform: Encapsulated geometry"
+		sphere = ODE::Geometry::Sphere::new( 0.5 )
+		sphere.position = [ 2, 0, 0 ]
+		xform = nil
+
+		assert_nothing_raised { xform = ODE::Geometry::Transform::new(sphere, @space) }
+		assert_kind_of ODE::Geometry::Placeable, xform
+		assert_same sphere, xform.geometry
+		assert_equal xform, sphere.container
+
+		# Can't encapsulate something that's already in a space
+		assert_raises( ODE::GeometryError ) {
+			ODE::Geometry::Transform::new( ODE::Geometry::Sphere::new(1.0, @space) )
+		}
+
+		other = ODE::Geometry::Sphere::new( 0.5 )
+		other.position = [ 2.8, 0, 0 ]
+		assert xform.collideWith( other ) {|contact| } > 0
+
+		xform.geometry = nil
+		assert_nil xform.geometry
+		assert_nil sphere.container
+	end
+
+	def test_01_compound
+		printTestHeader "Geometry::Compound: Children and bounds"
+		compound = ODE::Geometry::Compound::new( @space )
+		left = ODE::Geometry::Box::new( 1.0, 1.0, 1.0 )
+		right = ODE::Geometry::Sphere::new( 0.5 )
+
+		assert_equal [], compound.geometries
+		assert_nothing_raised {
+			compound.add( left, [-2, 0, 0] )
+			compound.add( right, [2, 0, 0], nil, 2.0 )
+		}
+		assert_equal [left, right], compound.geometries
+		assert_equal compound, left.container
+		assert_raises( ODE::GeometryError ) { compound.add(left) }
+		assert_raises( RangeError ) {
+			compound.add( ODE::Geometry::Sphere::new(1.0), nil, nil, 0 )
+		}
+
+		compound.position = [ 0, 10, 0 ]
+		aabb = compound.aabb
+		[ -2.5, 2.5, 9.5, 10.5, -0.5, 0.5 ].each_with_index do |val, i|
+			assert_in_delta val, aabb[i], 1e-5
+		end
+
+		# Only the children touch, not the space between them
+		probe = ODE::Geometry::Sphere::new( 0.25 )
+		probe.position = [ 0, 10, 0 ]
+		assert_equal 0, compound.collideWith( probe ) {|contact| }
+		probe.position = [ 2.5, 10, 0 ]
+		assert compound.collideWith( probe ) {|contact| } > 0
+
+		assert_same right, compound.remove( right )
+		assert_nil compound.remove( right )
+		assert_in_delta -1.5, compound.aabb[1], 1e-5
+	end
+
+	def test_02_compound_mass
+		printTestHeader "Geometry::Compound: Composite mass"
+		compound = ODE::Geometry::Compound::new
+		compound.add( ODE::Geometry::Box::new(1.0, 1.0, 1.0), [1, 0, 0] )
+		compound.add( ODE::Geometry::Box::new(1.0, 1.0, 1.0), [3, 0, 0] )
+
+		mass = compound.mass
+		assert_in_delta 2.0, mass.totalMass, 1e-5
+		assert_in_delta 2.0, mass.cog[0], 1e-5
+
+		# Attaching it to a body recenters the children on the center of mass
+		body = @world.createBody
+		compound.body = body
+		assert_in_delta 2.0, body.mass.totalMass, 1e-5
+		assert_in_delta 2.0, body.position.x, 1e-5
+		assert_in_delta 0.0, compound.mass.cog[0], 1e-5
+		assert_in_delta 0.5, compound.aabb[0], 1e-5
+	end
+
+	def test_03_children_and_spaces
+		printTestHeader "Geometry::Compound: Children aren't in the compound's space"
+		compound = ODE::Geometry::Compound::new( @space )
+		child = ODE::Geometry::Sphere::new( 0.5 )
+		compound.add( child, [1, 0, 0] )
+
+		assert @space.contains?( compound )
+		assert !@space.contains?( child )
+		assert_nil @space.depthOf( child )
+		assert_raises( ODE::GeometryError ) { @space << child }
+		assert_raises( ODE::GeometryError ) { @space.geometries = [compound, child] }
+		assert @space.contains?( compound )
+
+		# The child follows the compound once it's collided
+		compound.position = [ 0, 5, 0 ]
+		@space.collide( @world, ODE::JointGroup::new )
+		assert_in_delta 1.0, child.position.x, 1e-5
+		assert_in_delta 5.0, child.position.y, 1e-5
+	end
+
+	def test_04_cycles
+		printTestHeader "Geometry::Compound: Geometries can't contain themselves"
+		outer = ODE::Geometry::Compound::new
+		inner = ODE::Geometry::Compound::new
+		outer.add( inner )
+
+		assert_raises( ODE::GeometryError ) { outer.add(outer) }
+		assert_raises( ODE::GeometryError ) { inner.add(outer) }
+		assert_raises( ODE::GeometryError ) { inner.add(inner) }
+		assert_equal [], inner.geometries
+
+		xform = ODE::Geometry::Transform::new
+		inner.add( xform )
+		assert_raises( ODE::GeometryError ) { xform.geometry = outer }
+		assert_nil xform.geometry
+	end
+
+end
@@ -0,0 +1,116 @@
+#!/usr/bin/ruby
+
+$LOAD_PATH.unshift File::dirname(__FILE__)
+require "odeunittest"
+
+class ConvexTestCase < ODE::TestCase
+
+	# The corners of a unit cube centered on the origin, plus some interior
+	# points that shouldn't end up on the hull
+	CubePoints = [
+		-0.5,-0.5,-0.5,   0.5,-0.5,-0.5,   0.5, 0.5,-0.5,  -0.5, 0.5,-0.5,
+		-0.5,-0.5, 0.5,   0.5,-0.5, 0.5,   0.5, 0.5, 0.5,  -0.5, 0.5, 0.5,
+		 0.0, 0.0, 0.0,   0.1, 0.2,-0.3,
+	]
+
+	# A tetrahedron, by planes
+	TetraPoints = [ [0,0,0], [1,0,0], [0,1,0], [0,0,1] ]
+	TetraPolygons = [ [0,2,1], [0,1,3], [0,3,2], [1,2,3] ]
+	TetraPlanes = [
+		[ 0, 0,-1, 0], [ 0,-1, 0, 0], [-1, 0, 0, 0],
+		[ 1/Math::sqrt(3), 1/Math::sqrt(3), 1/Math::sqrt(3), 1/Math::sqrt(3) ],
+	]
+
+
+	#################################################################
+	###	T E S T S
+	#################################################################
+
+	def test_00_new_data
+		printTestHeader "ConvexData: Hull construction"
+		data = nil
+
+		assert_nothing_raised {
+			data = ODE::ConvexData::new( CubePoints.pack('f*') )
+		}
+		assert_instance_of ODE::ConvexData, data
+		assert_equal 8, data.pointCount
+		assert_equal 12, data.planeCount
+		assert_in_delta 1.0, data.volume, 1e-5
+		assert_in_delta 0.0, data.centroid.x, 1e-5
+
+		assert_nothing_raised {
+			data = ODE::ConvexData::new( CubePoints.pack('d*'), :double )
+		}
+		assert_equal 8, data.points.length
+	end
+
+	def test_01_new_data_with_bad_points
+		printTestHeader "ConvexData: Degenerate point clouds"
+
+		assert_raises( ArgumentError ) {
+			ODE::ConvexData::new( CubePoints[0,9].pack('f*') )
+		}
+		assert_raises( ArgumentError ) {
+			ODE::ConvexData::new( [0,0,0, 1,0,0, 0,1,0, 1,1,0].pack('f*') )
+		}
+		assert_raises( ArgumentError ) {
+			ODE::ConvexData::new( CubePoints.pack('f*')[0..-2] )
+		}
+	end
+
+	def test_02_data_from_planes
+		printTestHeader "ConvexData: Explicit planes"
+		data = nil
+
+		assert_nothing_raised {
+			data = ODE::ConvexData::fromPlanes( TetraPlanes, TetraPoints, TetraPolygons )
+		}
+		assert_equal 4, data.pointCount
+		assert_in_delta 1.0/6, data.volume, 1e-5
+		assert_in_delta 0.25, data.centroid.z, 1e-5
+
+		assert_raises( IndexError ) {
+			ODE::ConvexData::fromPlanes( TetraPlanes, TetraPoints, [[0,2,4]] * 4 )
+		}
+		assert_raises( ArgumentError ) {
+			ODE::ConvexData::fromPlanes( TetraPlanes, TetraPoints, TetraPolygons[0,3] )
+		}
+	end
+
+	def test_10_new_convex
+		printTestHeader "Convex: Instantiation and collision"
+		data = ODE::ConvexData::new( CubePoints.pack('f*') )
+		space = ODE::Space::new
+		hull = nil
+
+		assert_raises( TypeError ) { ODE::Geometry::Convex::new("data") }
+		assert_nothing_raised { hull = ODE::Geometry::Convex::new(data, space) }
+		assert_kind_of ODE::Geometry::Placeable, hull
+		assert_same data, hull.data
+		assert_equal space, hull.container
+
+		sphere = ODE::Geometry::Sphere::new( 0.5 )
+		sphere.position = [ 0.8, 0, 0 ]
+		assert hull.collideWith( sphere ) {|contact| } > 0,
+			"expected the sphere to touch the hull"
+	end
+
+	def test_20_mass
+		printTestHeader "Mass::Convex: Hull mass"
+		data = ODE::ConvexData::new( CubePoints.pack('f*') )
+		mass = box = nil
+
+		assert_nothing_raised { mass = ODE::Mass::Convex::new(2.0, data) }
+		box = ODE::Mass::Box::new( 2.0, 1.0, 1.0, 1.0 )
+		assert_in_delta box.totalMass, mass.totalMass, 1e-5
+		assert_in_delta box.inertia[0][0], mass.inertia[0][0], 1e-5
+
+		assert_nothing_raised { mass = ODE::Mass::Convex::new(2.0, data, 10.0) }
+		assert_in_delta 10.0, mass.totalMass, 1e-5
+
+		assert_raises( RangeError ) { ODE::Mass::Convex::new(0, data) }
+	end
+
+end
+
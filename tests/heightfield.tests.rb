@@ -0,0 +1,91 @@
+#!/usr/bin/ruby
+
+$LOAD_PATH.unshift File::dirname(__FILE__)
+require "odeunittest"
+
+class HeightfieldTestCase < ODE::TestCase
+
+	# A 4x4 field sloping up along X
+	Samples = [ 0.0, 1.0, 2.0, 3.0 ] * 4
+
+
+	#################################################################
+	###	T E S T S
+	#################################################################
+
+	def test_00_new_data
+		printTestHeader "HeightfieldData: Instantiation"
+		data = nil
+
+		assert_nothing_raised {
+			data = ODE::HeightfieldData::new( Samples.pack('f*'), 4, 4, 10.0, 10.0 )
+		}
+		assert_instance_of ODE::HeightfieldData, data
+		assert_equal 4, data.widthSamples
+		assert_equal 4, data.depthSamples
+		assert_equal 4, data.sampleSize
+		assert_equal [0.0, 3.0], data.bounds
+
+		assert_nothing_raised {
+			data = ODE::HeightfieldData::new( Samples.pack('s*'), 4, 4, 10, 10, 0.5, 0, 2 )
+		}
+		assert_equal 2, data.sampleSize
+
+		assert_raises( ArgumentError ) {
+			ODE::HeightfieldData::new( Samples.pack('f*'), 3, 4, 10, 10 )
+		}
+		assert_raises( RangeError ) {
+			ODE::HeightfieldData::new( Samples.pack('f*'), 4, 4, 0, 10 )
+		}
+
+		# A bad buffer leaves the object uninitialized, not half-built
+		data = ODE::HeightfieldData::allocate
+		assert_raises( ArgumentError ) {
+			data.send( :initialize, Samples.pack('f*'), 3, 4, 10, 10 )
+		}
+		assert_raises( RuntimeError ) { data.sampleSize }
+		assert_nothing_raised {
+			data.send( :initialize, Samples.pack('f*'), 4, 4, 10, 10 )
+		}
+		assert_equal 4, data.sampleSize
+	end
+
+	def test_01_update
+		printTestHeader "HeightfieldData: In-place sub-rectangle update"
+		data = ODE::HeightfieldData::new( Samples.pack('f*'), 4, 4, 10.0, 10.0 )
+
+		assert_nothing_raised {
+			data.update( 1, 2, 2, 2, [5.0, 6.0, 7.0, 8.0].pack('f*') )
+		}
+		assert_in_delta 5.0, data.sample( 1, 2 ), 1e-5
+		assert_in_delta 8.0, data.sample( 2, 3 ), 1e-5
+		assert_in_delta 3.0, data.sample( 3, 3 ), 1e-5
+		assert_equal [0.0, 8.0], data.bounds
+
+		assert_raises( IndexError ) { data.update(3, 3, 2, 2, ([0.0]*4).pack("f*")) }
+		assert_raises( ArgumentError ) { data.update(0, 0, 2, 2, [0.0].pack('f*')) }
+	end
+
+	def test_10_new_heightfield
+		printTestHeader "Heightfield: Instantiation and collision"
+		data = ODE::HeightfieldData::new( Samples.pack('f*'), 4, 4, 10.0, 10.0 )
+		space = ODE::Space::new
+		field = nil
+
+		assert_raises( TypeError ) { ODE::Geometry::Heightfield::new("data") }
+		assert_nothing_raised { field = ODE::Geometry::Heightfield::new(data, space) }
+		assert_kind_of ODE::Geometry::Placeable, field
+		assert_same data, field.data
+		assert_equal space, field.container
+
+		sphere = ODE::Geometry::Sphere::new( 1.0 )
+		sphere.position = [ 0, 10, 0 ]
+		assert_equal 0, field.collideWith( sphere ) {|contact| }
+
+		field.update( 0, 0, 4, 4, ([10.0] * 16).pack('f*') )
+		assert field.collideWith( sphere ) {|contact| } > 0,
+			"expected raised terrain to touch the sphere"
+	end
+
+end
+
@@ -0,0 +1,87 @@
+#!/usr/bin/ruby
+
+$LOAD_PATH.unshift File::dirname(__FILE__)
+require "odeunittest"
+
+class IKChainTestCase < ODE::TestCase
+
+	Tolerance = ODE::Precision == 'dDOUBLE' ? 1e-5 : 1e-2
+
+	# A two-link planar arm along the X axis, hinged at the origin, with its
+	# tip at [2, 0, 0]
+	def setup
+		@world = ODE::World::new
+
+		@upper = @world.createBody
+		@upper.position = 0.5, 0, 0
+		@lower = @world.createBody
+		@lower.position = 1.5, 0, 0
+
+		@shoulder = ODE::HingeJoint::new( @world )
+		@shoulder.attach( @upper, nil )
+		@shoulder.anchor = 0, 0, 0
+		@shoulder.axis = 0, 0, 1
+
+		@elbow = ODE::HingeJoint::new( @world )
+		@elbow.attach( @lower, @upper )
+		@elbow.anchor = 1, 0, 0
+		@elbow.axis = 0, 0, 1
+	end
+
+
+	#################################################################
+	###	T E S T S
+	#################################################################
+
+	def test_00_create
+		printTestHeader "IKChain: Instantiation"
+		chain = nil
+
+		assert_nothing_raised {
+			chain = ODE::IKChain::new( [@shoulder, @elbow], @lower, [0.5, 0, 0] )
+		}
+		assert_equal [@shoulder, @elbow], chain.joints
+		assert_same @lower, chain.effector
+
+		# Out of order, so the joints don't connect
+		assert_raises( ArgumentError ) { ODE::IKChain::new([@elbow, @shoulder], @lower) }
+		assert_raises( TypeError ) {
+			ODE::IKChain::new( [ODE::SliderJoint::new(@world)], @lower )
+		}
+	end
+
+	def test_01_solve
+		printTestHeader "IKChain: Solving for a target"
+		chain = ODE::IKChain::new( [@shoulder, @elbow], @lower, [0.5, 0, 0] )
+
+		error = chain.solve( [1, 1, 0], 50 )
+		assert error < 1e-3, "error #{error} too large"
+		assert_in_delta error, chain.error, Tolerance
+		assert chain.iterations <= 50
+
+		# Either solution bends the elbow by 90 degrees
+		shoulder, elbow = chain.deltas
+		assert_in_delta Math::PI / 2, elbow.abs, 0.01
+
+		# Already there
+		chain.solve( [2, 0, 0] )
+		assert_equal 0, chain.iterations
+		assert_equal [0.0, 0.0], chain.deltas
+	end
+
+	def test_02_apply
+		printTestHeader "IKChain: Applying motor velocities"
+		chain = ODE::IKChain::new( [@shoulder, @elbow], @lower, [0.5, 0, 0] )
+		chain.solve( [1, 1, 0], 50 )
+		shoulder, elbow = chain.deltas
+
+		assert_same chain, chain.applyVelocities( 0.5 )
+		assert_in_delta shoulder * 2, @shoulder.vel, Tolerance
+		assert_in_delta elbow * 2, @elbow.vel, Tolerance
+
+		chain.apply_velocities( 0.5, 0.5 )
+		assert_in_delta shoulder, @shoulder.vel, Tolerance
+	end
+
+end
+
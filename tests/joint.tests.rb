@@ -635,6 +635,143 @@ class Joint_tests < ODE::TestCase
 		assert rval, "FixedJoint#fix didn't return a true value"
 	end
 
+
+	# Test World#jointFeedback
+	def test_06_bulk_joint_feedback
+		printTestHeader "World#jointFeedback: Packed feedback for all joints"
+		@world.gravity = 0, -9.81, 0
+
+		joints = (0...3).collect {|i|
+			body = @world.createBody
+			body.position = i * 2, 0, 0
+			joint = ODE::BallJoint::new( @world )
+			joint.attach( body, nil )
+			joint.anchor = i * 2, 1, 0
+			joint
+		}
+		assert_equal "", @world.jointFeedback
+
+		joints.each {|joint| joint.feedback = true }
+		assert_equal joints, @world.feedbackJoints
+		assert_equal [0, 1, 2], joints.collect {|joint| joint.feedbackIndex }
+
+		@world.step( 0.01 )
+		buffer = ''
+		assert_same buffer, @world.jointFeedback( buffer )
+		assert_equal 3 * ODE::World::FEEDBACK_SIZE, buffer.length
+
+		# Each joint holds its body up against gravity
+		joints.each {|joint|
+			record = buffer[ joint.feedbackIndex * ODE::World::FEEDBACK_SIZE,
+				ODE::World::FEEDBACK_SIZE ].unpack( ODE::World::FEEDBACK_FORMAT )
+			assert_in_delta joint.feedback[:body1][:force].y, record[1], Tolerance
+			assert record[1] > 0
+		}
+
+		# Turning one off moves the last into its place
+		joints[0].feedback = false
+		assert_nil joints[0].feedbackIndex
+		assert_equal [joints[2], joints[1]], @world.feedbackJoints
+		assert_equal 2 * ODE::World::FEEDBACK_SIZE, @world.jointFeedback.length
+	end
+
+
+	# Test breakable joints
+	def test_07_breakable_joints
+		printTestHeader "Joint#breakForce=: Native joint breaking"
+		@world.gravity = 0, -9.81, 0
+
+		body = @world.createBody
+		weak = ODE::BallJoint::new( @world )
+		weak.attach( body, nil )
+		weak.anchor = 0, 1, 0
+		strong = ODE::BallJoint::new( @world )
+		strong.attach( @world.createBody, nil )
+
+		assert_nil weak.breakForce
+		assert_raises( RangeError ) { weak.breakForce = 0 }
+		assert_raises( RangeError ) { weak.breakSteps = 0 }
+
+		# Holding the body up takes about 41 newtons
+		weak.breakForce = 10.0
+		weak.breakSteps = 3
+		strong.breakForce = 1000.0
+		strong.breakTorque = 1000.0
+		assert weak.feedback?
+		assert_in_delta 10.0, weak.breakForce, Tolerance
+		assert_equal 3, weak.breakSteps
+
+		2.times {
+			@world.step( 0.01 )
+			assert_equal [], @world.brokenJoints
+		}
+		@world.step( 0.01 )
+		assert_equal [weak], @world.brokenJoints
+		assert weak.obsolete?
+		assert_equal [strong], @world.feedbackJoints
+
+		# The list only holds the last step's breaks
+		@world.step( 0.01 )
+		assert_equal [], @world.brokenJoints
+	end
+
+	def test_08_batch_params
+		printTestHeader "ParameterizedJoint::setParams: Batch parameter access"
+
+		hinges = (1..3).collect {
+			joint = ODE::HingeJoint::new( @world )
+			joint.attach( @world.createBody, nil )
+			joint
+		}
+		amotor = ODE::AngularMotorJoint::new( @world )
+		amotor.attach( @world.createBody, nil )
+		amotor.numAxes = 3
+		joints = hinges + [amotor]
+
+		rval = nil
+		assert_nothing_raised {
+			rval = ODE::ParameterizedJoint::setParams( joints, :vel, 1, [1.0, 2.0, 3.0, 4.0] )
+		}
+		assert_equal 4, rval
+		assert_in_delta 2.0, hinges[1].vel, Tolerance
+		assert_in_delta 4.0, amotor.vel, Tolerance
+
+		ODE::ParameterizedJoint::set_params( joints, :f_max, 1, [5.0, 6.0, 7.0, 8.0].pack("d*") )
+		values = ODE::ParameterizedJoint::getParams( joints, :fMax ).unpack( "d*" )
+		assert_equal 4, values.length
+		[5.0, 6.0, 7.0, 8.0].each_with_index {|val,i| assert_in_delta val, values[i], Tolerance }
+
+		ODE::ParameterizedJoint::setParams( [amotor], :vel, 3, [0.5] )
+		assert_in_delta 0.5, amotor.vel3, Tolerance
+
+		assert_raises( IndexError ) { ODE::ParameterizedJoint::setParams(hinges, :vel, 2, [1,1,1]) }
+		assert_raises( RangeError ) { ODE::ParameterizedJoint::setParams(hinges, :bounce, 1, [2,0,0]) }
+		assert_raises( ArgumentError ) { ODE::ParameterizedJoint::setParams(hinges, :vel, 1, [1]) }
+		assert_raises( ArgumentError ) { ODE::ParameterizedJoint::setParams(hinges, :nonesuch, 1, [1,1,1]) }
+		assert_raises( TypeError ) { ODE::ParameterizedJoint::setParams([ODE::BallJoint::new(@world)], :vel, 1, [1]) }
+
+		# A bad joint or value partway through doesn't set any of them
+		assert_raises( TypeError ) {
+			ODE::ParameterizedJoint::setParams( hinges + [ODE::BallJoint::new(@world)], :vel, 1, [9,9,9,9] )
+		}
+		assert_raises( RangeError ) { ODE::ParameterizedJoint::setParams(hinges, :bounce, 1, [0.5,0.5,2]) }
+		assert_in_delta 2.0, hinges[1].vel, Tolerance
+		assert_in_delta 0.0, hinges[0].bounce, Tolerance
+
+		# Hash access
+		hinges[0].params = { :lo_stop => -0.5, :hiStop => 0.5, :bounce => 0.25 }
+		assert_in_delta -0.5, hinges[0].loStop, Tolerance
+		assert_in_delta 0.5, hinges[0].hiStop, Tolerance
+		assert_in_delta 0.25, hinges[0].params[:bounce], Tolerance
+
+		amotor.params = { :vel2 => 1.5, :f_max3 => 2.5 }
+		assert_in_delta 1.5, amotor.vel2, Tolerance
+		assert_in_delta 2.5, amotor.params(3)[:f_max], Tolerance
+
+		assert_raises( RangeError ) { hinges[0].params = { :lo_stop => 0.0, :bounce => 2.0 } }
+		assert_in_delta -0.5, hinges[0].loStop, Tolerance
+	end
+
 end
 
 
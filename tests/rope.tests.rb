@@ -0,0 +1,102 @@
+#!/usr/bin/ruby
+
+$LOAD_PATH.unshift File::dirname(__FILE__)
+require "odeunittest"
+
+class RopeTestCase < ODE::TestCase
+
+	Tolerance = ODE::Precision == 'dDOUBLE' ? 1e-5 : 1e-2
+
+	def setup
+		@world = ODE::World::new
+		@space = ODE::HashSpace::new
+	end
+
+
+	#################################################################
+	###	T E S T S
+	#################################################################
+
+	def test_00_create
+		printTestHeader "Rope: Instantiation"
+		rope = nil
+
+		assert_nothing_raised {
+			rope = ODE::Rope::new( @world, @space, [0,0,10], [10,0,10], 20, 2.0, 0.1 )
+		}
+		assert_same @world, rope.world
+		assert_equal 20, rope.size
+		assert_in_delta 0.5, rope.segmentLength, Tolerance
+		assert_equal 20, rope.bodies.length
+		assert_equal 20, rope.geometries.length
+		assert_equal 19, rope.joints.length
+		assert_instance_of ODE::BallJoint, rope.joints.first
+		assert_in_delta 0.1, rope.bodies.first.mass.totalMass, Tolerance
+		assert rope.bodies[0].connectedTo?( rope.bodies[1] )
+
+		assert_raises( ArgumentError ) { ODE::Rope::new(@world, nil, [0,0,0], [0,0,0], 2, 1, 0.1) }
+		assert_raises( ArgumentError ) { ODE::Rope::new(@world, nil, [0,0,0], [1,0,0], 10, 1, 0.1) }
+		assert_raises( ArgumentError ) {
+			ODE::Rope::new( @world, nil, [0,0,0], [1,0,0], 2, 1, 0.1, ODE::SliderJoint )
+		}
+		assert_raises( RangeError ) { ODE::Rope::new(@world, nil, [0,0,0], [1,0,0], 0, 1, 0.1) }
+
+		# A failed build leaves nothing half-made
+		rope = ODE::Rope::allocate
+		assert_raises( ArgumentError ) {
+			rope.send( :initialize, @world, nil, [0,0,0], [0,0,0], 2, 1, 0.1 )
+		}
+		assert_raises( RuntimeError ) { rope.pinStart }
+		assert_nothing_raised {
+			rope.send( :initialize, @world, nil, [0,0,0], [1,0,0], 2, 1, 0.1 )
+		}
+		assert_equal 2, rope.size
+	end
+
+	def test_01_layout
+		printTestHeader "Rope: Segment layout"
+		rope = ODE::Rope::new( @world, nil, [0,0,0], [0,4,0], 4, 4.0, 0.1, ODE::UniversalJoint )
+
+		assert_equal [], rope.geometries
+		positions = rope.positionsInto.unpack( 'd*' )
+		assert_equal 12, positions.length
+		[ 0.5, 1.5, 2.5, 3.5 ].each_with_index do |y,i|
+			assert_in_delta 0.0, positions[i*3], Tolerance
+			assert_in_delta y, positions[i*3 + 1], Tolerance
+		end
+		assert_in_delta 1.0, rope.joints[0].anchor.y, Tolerance
+	end
+
+	def test_02_pinned_rope_hangs
+		printTestHeader "Rope: Pinning the ends"
+		@world.gravity = 0, 0, -9.81
+		rope = ODE::Rope::new( @world, nil, [0,0,0], [2,0,0], 8, 1.0, 0.05 )
+		rope.pinStart
+		rope.pinEnd
+		assert_equal 9, rope.joints.length
+
+		100.times { @world.step(0.01) }
+		middle = rope.positionsInto.unpack( 'd*' )[ 3*3 + 2 ]
+		assert middle < 0, "the middle of the rope should sag"
+		assert_in_delta 0.0, rope.joints.last.anchor.z, 0.01
+	end
+
+	def test_03_state
+		printTestHeader "Rope: Saving and restoring state"
+		rope = ODE::Rope::new( @world, nil, [0,0,0], [1,0,0], 4, 1.0, 0.05 )
+		saved = rope.stateInto
+		assert_equal ODE::Rope::STATE_SIZE * 4 * 8, saved.length
+
+		rope.bodies.first.linearVelocity = 0, 1, 0
+		@world.step( 0.1 )
+		assert_not_equal saved, rope.state
+
+		buffer = ''
+		rope.state = saved
+		assert_same buffer, rope.stateInto( buffer )
+		assert_equal saved, buffer
+		assert_raises( ArgumentError ) { rope.setState("") }
+	end
+
+end
+
@@ -0,0 +1,82 @@
+#!/usr/bin/ruby
+
+$LOAD_PATH.unshift File::dirname(__FILE__)
+require "odeunittest"
+
+class ServoTestCase < ODE::TestCase
+
+	Tolerance = ODE::Precision == 'dDOUBLE' ? 1e-5 : 1e-2
+
+	def setup
+		@world = ODE::World::new
+		@body = @world.createBody
+		@hinge = ODE::HingeJoint::new( @world )
+		@hinge.attach( @body, nil )
+		@hinge.anchor = 0, 0, 0
+		@hinge.axis = 0, 0, 1
+	end
+
+
+	#################################################################
+	###	T E S T S
+	#################################################################
+
+	def test_00_create
+		printTestHeader "Servo: Instantiation"
+		servo = nil
+
+		assert_nothing_raised { servo = ODE::Servo::new(@hinge) }
+		assert_same @hinge, servo.joint
+		assert_equal 1, servo.axis
+		assert servo.enabled?
+		assert_equal [servo], @world.servos
+
+		assert_raises( IndexError ) { ODE::Servo::new(@hinge, 2) }
+		assert_raises( TypeError ) { ODE::Servo::new(ODE::BallJoint::new(@world)) }
+		assert_raises( RangeError ) { servo.kp = -1 }
+		assert_raises( RangeError ) { servo.maxForce = -1 }
+		assert_raises( RuntimeError ) { servo.send(:initialize, @hinge) }
+		assert_equal [servo], @world.servos
+
+		servo.enabled = false
+		assert !servo.enabled?
+		assert_equal [], @world.servos
+	end
+
+	def test_01_drive_to_target
+		printTestHeader "Servo: Driving a hinge to its target"
+		servo = ODE::Servo::new( @hinge )
+		servo.target = 0.5
+		servo.kp = 10.0
+		servo.kd = 0.1
+		servo.maxForce = 100.0
+
+		assert_in_delta 5.0, servo.command, Tolerance
+		200.times { @world.step(0.01) }
+		assert_in_delta 0.5, @hinge.angle, 0.01
+		assert_in_delta 100.0, @hinge.fMax, Tolerance
+	end
+
+	def test_02_packed_targets
+		printTestHeader "Servo: Packed targets"
+		servos = [ ODE::Servo::new(@hinge) ]
+		slider = ODE::SliderJoint::new( @world )
+		slider.attach( @world.createBody, nil )
+		servos << ODE::Servo::new( slider )
+		assert_equal servos, @world.servos
+
+		rval = nil
+		assert_nothing_raised {
+			rval = @world.setServoTargets( [0.25, 0.0, 1.5, 0.5].pack("d*") )
+		}
+		assert_equal 2, rval
+		assert_in_delta 0.25, servos[0].target, Tolerance
+		assert_in_delta 1.5, servos[1].target, Tolerance
+		assert_in_delta 0.5, servos[1].targetVelocity, Tolerance
+		assert_equal [0.25, 0.0, 1.5, 0.5], @world.servoTargets.unpack( "d*" )
+
+		assert_raises( ArgumentError ) { @world.servo_targets = [1.0].pack("d*") }
+	end
+
+end
+
@@ -189,7 +189,67 @@ class SpaceTestCase < ODE::TestCase
 	###	T E S T S
 	#################################################################
 
-	# :TODO: Test deep containment/marking functions/geom+space interaction
+	# :TODO: Test marking functions/geom+space interaction
+
+	def test_10_deep_containment
+		printTestHeader "Space: Deep containment"
+		outer = ODE::Space::new
+		middle = ODE::Space::new( outer )
+		inner = ODE::HashSpace::new( middle )
+		geom = ODE::Geometry::Sphere::new( 1.0, inner )
+		stray = ODE::Geometry::Sphere::new( 1.0 )
+
+		assert outer.contains?( geom )
+		assert middle.contains?( geom )
+		assert !outer.directlyContains?( geom )
+		assert !outer.contains?( stray )
+
+		assert_equal 1, inner.depthOf( geom )
+		assert_equal 3, outer.depth_of( geom )
+		assert_nil inner.depthOf( stray )
+
+		middle.removeGeometries( inner )
+		assert !outer.contains?( geom )
+		assert_nil inner.container
+
+		outer.addGeometries( inner )
+		assert_equal outer, inner.container
+		assert_equal 2, outer.depthOf( geom )
+	end
 
-end
+	def test_11_bulk_replace
+		printTestHeader "Space: Bulk geometry replacement"
+		space = ODE::Space::new
+		other = ODE::Space::new
+		chunkA = (0...20).collect { ODE::Geometry::Sphere::new(1.0, space) }
+		chunkB = (0...20).collect { ODE::Geometry::Box::new(1.0, 1.0, 1.0, other) }
+
+		assert_nothing_raised { space.geometries = chunkA[10..-1] + chunkB }
+		assert_equal 30, space.geometries.length
+		assert chunkA[0...10].all? {|geom| geom.container.nil? }
+		assert chunkB.all? {|geom| geom.container == space }
+		assert other.geometries.empty?
+
+		assert_nothing_raised { space.geometries = [] }
+		assert space.geometries.empty?
+
+		space.addGeometries( chunkA[0] )
+		assert_equal [chunkA[0]], space.removeGeometries( chunkA[0], chunkA[1] )
+	end
 
+	def test_12_native_near_callback
+		printTestHeader "Space: Native near callback"
+		space = ODE::Space::new
+		ODE::Geometry::Sphere::new( 1.0, space )
+		ODE::Geometry::Sphere::new( 1.0, space )
+
+		# No extension has registered one, so a block is still required
+		assert_equal false, space.nativeNearCallback?
+		assert_raises( LocalJumpError ) { space.eachAdjacentPair }
+
+		pairs = 0
+		space.eachAdjacentPair {|g1, g2, data| pairs += 1 }
+		assert_equal 1, pairs
+	end
+
+end
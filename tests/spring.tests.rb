@@ -0,0 +1,95 @@
+#!/usr/bin/ruby
+
+$LOAD_PATH.unshift File::dirname(__FILE__)
+require "odeunittest"
+
+class SpringTestCase < ODE::TestCase
+
+	Tolerance = ODE::Precision == 'dDOUBLE' ? 1e-5 : 1e-2
+
+	def setup
+		@world = ODE::World::new
+		@body = @world.createBody
+		@body.position = 2, 0, 0
+		@springs = ODE::Spring::new( @world )
+	end
+
+
+	#################################################################
+	###	T E S T S
+	#################################################################
+
+	def test_00_create
+		printTestHeader "Spring: Instantiation"
+		index = nil
+
+		assert @springs.enabled?
+		assert_equal [@springs], @world.springs
+		assert_equal 0, @springs.size
+
+		assert_nothing_raised {
+			index = @springs.add( nil, [0,0,0], @body, [0,0,0], 10.0 )
+		}
+		assert_equal 0, index
+		assert_equal 1, @springs.size
+
+		config = @springs.spring( 0 )
+		assert_nil config[0]
+		assert_same @body, config[2]
+		assert_in_delta 2.0, config[6], Tolerance
+		assert_equal ODE::Spring::BOTH, config[7]
+
+		assert_raises( RangeError ) { @springs.add(nil, [0,0,0], @body, [0,0,0], -1) }
+		assert_raises( ArgumentError ) { @springs.add(nil, [0,0,0], nil, [0,0,0], 1) }
+		assert_raises( IndexError ) { @springs.spring(1) }
+		assert_raises( RuntimeError ) { @springs.send(:initialize, @world) }
+		assert_equal [@springs], @world.springs
+
+		@springs.enabled = false
+		assert !@springs.enabled?
+		assert_equal [], @world.springs
+	end
+
+	def test_01_pull
+		printTestHeader "Spring: Pulling a body towards its anchor"
+		@springs.add( nil, [0,0,0], @body, [0,0,0], 10.0, 0, 1.0 )
+		@world.step( 0.01 )
+
+		length, rate, force = @springs.stateInto.unpack( 'd*' )
+		assert_in_delta 2.0, length, Tolerance
+		assert_in_delta 0.0, rate, Tolerance
+		assert_in_delta 10.0, force, Tolerance
+		assert @body.linearVel[0] < 0, "body should move towards the anchor"
+	end
+
+	def test_02_one_way
+		printTestHeader "Spring: Compression-only springs"
+		@springs.add( nil, [0,0,0], @body, [0,0,0], 10.0, 0, 1.0, ODE::Spring::COMPRESSION )
+		@world.step( 0.01 )
+
+		assert_in_delta 0.0, @springs.state.unpack('d*')[2], Tolerance
+		assert_in_delta 0.0, @body.linearVel[0], Tolerance
+
+		@springs.setRestLength( 0, 3.0 )
+		@world.step( 0.01 )
+		assert_in_delta( -10.0, @springs.state.unpack('d*')[2], Tolerance )
+		assert @body.linearVel[0] > 0, "body should be pushed away"
+	end
+
+	def test_03_remove
+		printTestHeader "Spring: Removing springs"
+		other = @world.createBody
+		@springs.add( nil, [0,0,0], @body, [0,0,0], 1.0 )
+		@springs.add( @body, [0,0,0], other, [0,0,0], 2.0 )
+
+		@springs.remove( 0 )
+		assert_equal 1, @springs.size
+		assert_same other, @springs[0][2]
+
+		buffer = ''
+		assert_same buffer, @springs.stateInto( buffer )
+		assert_equal ODE::Spring::STATE_SIZE * 8, buffer.length
+	end
+
+end
+
@@ -0,0 +1,112 @@
+#!/usr/bin/ruby
+
+$LOAD_PATH.unshift File::dirname(__FILE__)
+require "odeunittest"
+
+class TimelineTestCase < ODE::TestCase
+
+	Tolerance = ODE::Precision == 'dDOUBLE' ? 1e-5 : 1e-2
+
+	def setup
+		@world = ODE::World::new
+		@body = @world.createBody
+		@hinge = ODE::HingeJoint::new( @world )
+		@hinge.attach( @body, nil )
+		@hinge.axis = 0, 0, 1
+		@hinge.fMax = 100.0
+	end
+
+
+	#################################################################
+	###	T E S T S
+	#################################################################
+
+	def test_00_create
+		printTestHeader "Timeline: Instantiation and evaluation"
+		timeline = nil
+
+		assert_nothing_raised {
+			timeline = ODE::Timeline::new( @hinge, [[0, 0], [1, 2], [2, 0]] )
+		}
+		assert_same @hinge, timeline.joint
+		assert_equal 1, timeline.axis
+		assert_in_delta 2.0, timeline.duration, Tolerance
+		assert_equal [[0.0, 0.0], [1.0, 2.0], [2.0, 0.0]], timeline.keyframes
+		assert_equal ODE::Timeline::VELOCITY, timeline.mode
+		assert_equal ODE::Timeline::LINEAR, timeline.interpolation
+		assert !timeline.running?
+
+		assert_in_delta 1.0, timeline.valueAt( 0.5 ), Tolerance
+		assert_in_delta 0.0, timeline.value_at( 5.0 ), Tolerance
+		timeline.interpolation = ODE::Timeline::CUBIC
+		assert_in_delta 2.0, timeline.valueAt( 1.0 ), Tolerance
+
+		assert_raises( ArgumentError ) { ODE::Timeline::new(@hinge, []) }
+		assert_raises( ArgumentError ) { ODE::Timeline::new(@hinge, [[1, 0], [0, 1]]) }
+		assert_raises( IndexError ) { ODE::Timeline::new(@hinge, [[0, 0]], 2) }
+		assert_raises( TypeError ) { ODE::Timeline::new(ODE::BallJoint::new(@world), [[0, 0]]) }
+		assert_raises( ArgumentError ) { timeline.mode = 12 }
+
+		timeline.start
+		assert_raises( RuntimeError ) { timeline.send(:initialize, @hinge, [[0, 1]]) }
+		assert_equal [timeline], @world.timelines
+		assert_in_delta 2.0, timeline.duration, Tolerance
+	end
+
+	def test_01_velocity
+		printTestHeader "Timeline: Driving motor velocity"
+		timeline = ODE::Timeline::new( @hinge, [[0, 0], [1, 1]] )
+		assert_same timeline, timeline.start
+		assert timeline.running?
+		assert_equal [timeline], @world.timelines
+
+		@world.step( 0.5 )
+		assert_in_delta 0.5, @hinge.vel, Tolerance
+		assert_equal [], @world.completedTimelines
+
+		@world.step( 0.5 )
+		assert_in_delta 1.0, @hinge.vel, Tolerance
+		assert_equal [], @world.completedTimelines
+
+		# It completes on the step after the one that reaches its end
+		@world.step( 0.5 )
+		assert_equal [timeline], @world.completedTimelines
+		assert !timeline.running?
+		assert_equal [], @world.timelines
+		assert_in_delta 1.0, @hinge.vel, Tolerance
+
+		@world.step( 0.5 )
+		assert_equal [], @world.completed_timelines
+	end
+
+	def test_02_position
+		printTestHeader "Timeline: Driving joint position"
+		timeline = ODE::Timeline::new( @hinge, [[0, 0], [1, 0.5]] )
+		timeline.mode = ODE::Timeline::POSITION
+		timeline.start
+
+		100.times { @world.step(0.01) }
+		assert_in_delta 0.5, @hinge.angle, 0.01
+		assert timeline.running?
+
+		@world.step( 0.01 )
+		assert !timeline.running?
+		assert_in_delta 0.0, @hinge.vel, Tolerance
+	end
+
+	def test_03_loop
+		printTestHeader "Timeline: Looping"
+		timeline = ODE::Timeline::new( @hinge, [[0, 0], [1, 1]] )
+		timeline.loop = true
+		timeline.start
+
+		15.times { @world.step(0.1) }
+		assert timeline.running?
+		assert_in_delta 0.5, timeline.time, Tolerance
+
+		timeline.stop
+		assert !timeline.running?
+	end
+
+end
+
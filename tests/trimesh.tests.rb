@@ -0,0 +1,130 @@
+#!/usr/bin/ruby
+
+$LOAD_PATH.unshift File::dirname(__FILE__)
+require "odeunittest"
+
+class TriMeshTestCase < ODE::TestCase
+
+	# A unit tetrahedron
+	Vertices = [ 0,0,0,  1,0,0,  0,1,0,  0,0,1 ]
+	Indices = [ 0,2,1,  0,1,3,  0,3,2,  1,2,3 ]
+
+
+	#################################################################
+	###	T E S T S
+	#################################################################
+
+	def test_00_new_data
+		printTestHeader "TriMeshData: Instantiation"
+		data = nil
+
+		assert_nothing_raised {
+			data = ODE::TriMeshData::new( Vertices.pack('f*'), Indices.pack('L*') )
+		}
+		assert_instance_of ODE::TriMeshData, data
+		assert_equal 4, data.vertexCount
+		assert_equal 4, data.triangleCount
+		assert_equal :single, data.precision
+		assert !data.mapped?
+
+		assert_nothing_raised {
+			data = ODE::TriMeshData::new( Vertices.pack('d*'), Indices.pack('L*'), :double )
+		}
+		assert_equal 4, data.vertexCount
+		assert_equal :double, data.precision
+	end
+
+	def test_01_new_data_with_bad_buffers
+		printTestHeader "TriMeshData: Buffer validation"
+
+		assert_raises( ArgumentError ) {
+			ODE::TriMeshData::new( Vertices.pack('f*')[0..-2], Indices.pack('L*') )
+		}
+		assert_raises( ArgumentError ) {
+			ODE::TriMeshData::new( Vertices.pack('f*'), Indices[0..-2].pack('L*') )
+		}
+		assert_raises( IndexError ) {
+			ODE::TriMeshData::new( Vertices.pack('f*'), [0,1,4].pack('L*') )
+		}
+		assert_raises( ArgumentError ) {
+			ODE::TriMeshData::new( Vertices.pack('f*'), Indices.pack('L*'), :quad )
+		}
+	end
+
+	def test_02_data_buffers_are_isolated
+		printTestHeader "TriMeshData: Caller's buffers can still be modified"
+		vertices = Vertices.pack('f*')
+		data = ODE::TriMeshData::new( vertices, Indices.pack('L*') )
+
+		assert !vertices.frozen?
+		assert_nothing_raised { vertices << "junk" }
+	end
+
+	def test_03_mmap_data
+		printTestHeader "TriMeshData: Memory-mapped mesh"
+		path = File::join( File::dirname(__FILE__), "trimesh.#{$$}.bin" )
+		File::open( path, "wb" ) {|fh|
+			fh.write( Vertices.pack('f*') )
+			fh.write( Indices.pack('L*') )
+		}
+
+		data = nil
+		assert_nothing_raised {
+			data = ODE::TriMeshData::mmap( path, 0, 4, 48, 4 )
+		}
+		assert data.mapped?
+		assert_equal 4, data.triangleCount
+		assert_raises( ArgumentError ) {
+			ODE::TriMeshData::mmap( path, 0, 4, 48, 5 )
+		}
+	ensure
+		File::delete( path ) if path && File::exists?( path )
+	end
+
+	def test_10_new_trimesh
+		printTestHeader "TriMesh: Instantiation"
+		data = ODE::TriMeshData::new( Vertices.pack('f*'), Indices.pack('L*') )
+		space = ODE::Space::new
+		mesh = nil
+
+		assert_raises( ArgumentError ) { ODE::Geometry::TriMesh::new }
+		assert_raises( TypeError ) { ODE::Geometry::TriMesh::new("data") }
+		assert_nothing_raised { mesh = ODE::Geometry::TriMesh::new(data, space) }
+		assert_kind_of ODE::Geometry::Placeable, mesh
+		assert_same data, mesh.data
+		assert_equal space, mesh.container
+		assert_equal 4, mesh.triangleCount
+	end
+
+	def test_11_shared_data
+		printTestHeader "TriMesh: Instances sharing mesh data"
+		data = ODE::TriMeshData::new( Vertices.pack('f*'), Indices.pack('L*') )
+		meshes = []
+
+		assert_nothing_raised {
+			50.times { meshes << ODE::Geometry::TriMesh::new(data) }
+		}
+		meshes.each_with_index {|mesh,i|
+			mesh.position = [ i * 2, 0, 0 ]
+			assert_same data, mesh.data
+		}
+
+		tri = meshes[1].triangle( 0 )
+		assert_equal 3, tri.length
+		assert_in_delta 2.0, tri[0].x, 1e-5
+		assert_raises( IndexError ) { meshes[1].triangle(4) }
+	end
+
+	def test_12_collide
+		printTestHeader "TriMesh: Collision with a sphere"
+		data = ODE::TriMeshData::new( Vertices.pack('f*'), Indices.pack('L*') )
+		mesh = ODE::Geometry::TriMesh::new( data )
+		sphere = ODE::Geometry::Sphere::new( 0.5 )
+		sphere.position = [ 0.25, 0.25, 0.25 ]
+
+		count = mesh.collideWith( sphere ) {|contact| }
+		assert count > 0, "expected sphere to touch the mesh"
+	end
+
+end
+
@@ -0,0 +1,136 @@
+#!/usr/bin/ruby
+
+$LOAD_PATH.unshift File::dirname(__FILE__)
+require "odeunittest"
+
+class VehicleTestCase < ODE::TestCase
+
+	Tolerance = ODE::Precision == 'dDOUBLE' ? 1e-5 : 1e-2
+
+	Mounts = [ [1,0.5,0], [1,-0.5,0], [-1,0.5,0], [-1,-0.5,0] ]
+
+	def setup
+		@world = ODE::World::new
+		@world.gravity = 0, 0, -9.81
+		@space = ODE::HashSpace::new
+		@floor = ODE::Geometry::Plane::new( 0, 0, 1, 0, @space )
+
+		@chassis = @world.createBody
+		@chassis.position = 0, 0, 0.5
+		@mass = @chassis.mass.totalMass
+		@chassisGeom = ODE::Geometry::Box::new( 2, 1, 0.2, @space )
+		@chassisGeom.body = @chassis
+	end
+
+	def make_car
+		car = ODE::Vehicle::new( @chassis, @space )
+		Mounts.each_with_index do |mount,i|
+			front = i < 2 ? 1 : 0
+			car.addWheel( mount, 0.3, 0.3, 100.0, 10.0, 1.0, front, 1 - front )
+		end
+		return car
+	end
+
+
+	#################################################################
+	###	T E S T S
+	#################################################################
+
+	def test_00_create
+		printTestHeader "Vehicle: Instantiation"
+		car = nil
+
+		assert_nothing_raised { car = ODE::Vehicle::new(@chassis, @space) }
+		assert_same @chassis, car.chassis
+		assert_same @space, car.space
+		assert car.enabled?
+		assert_equal [car], @world.vehicles
+		assert_equal 0, car.size
+
+		assert_equal 0, car.addWheel( [1,0,0], 0.3, 0.3, 100.0, 10.0 )
+		settings = car.wheel( 0 )
+		assert_in_delta 0.3, settings[1], Tolerance
+		assert_in_delta 1.0, settings[5], Tolerance
+
+		assert_raises( TypeError ) { ODE::Vehicle::new(@chassis, nil) }
+		assert_raises( ArgumentError ) { ODE::Vehicle::new(@chassis, @space, [0,0,1], [0,0,2]) }
+		assert_raises( RangeError ) { car.addWheel([0,0,0], 0, 0.3, 1, 1) }
+		assert_raises( RangeError ) { car.brake = -1 }
+		assert_raises( IndexError ) { car.wheel(1) }
+
+		# A failed initialize leaves nothing half-made
+		broken = ODE::Vehicle::allocate
+		assert_raises( ArgumentError ) { broken.send(:initialize, @chassis, @space, [0,0,0]) }
+		assert_raises( RuntimeError ) { broken.size }
+		assert_equal [car], @world.vehicles
+
+		car.enabled = false
+		assert !car.enabled?
+		assert_equal [], @world.vehicles
+	end
+
+	def test_01_suspension
+		printTestHeader "Vehicle: Resting on its suspension"
+		car = make_car
+		300.times { @world.step(0.01) }
+
+		state = car.stateInto.unpack( 'd*' )
+		assert_equal ODE::Vehicle::WHEEL_STATE_SIZE * 4, state.length
+
+		load = 0.0
+		4.times do |i|
+			wheel = state[ i * ODE::Vehicle::WHEEL_STATE_SIZE, ODE::Vehicle::WHEEL_STATE_SIZE ]
+			assert_equal 1.0, wheel[7], "wheel #{i} should be on the ground"
+			assert wheel[0] < 0.3, "wheel #{i}'s suspension should be compressed"
+			load += wheel[4]
+		end
+
+		assert_in_delta 9.81 * @mass, load, 0.05 * @mass
+		assert_in_delta 0.6 - 9.81 * @mass / 400.0, @chassis.position.z, 0.01
+	end
+
+	def test_02_drive_and_steer
+		printTestHeader "Vehicle: Driving and steering"
+		car = make_car
+		100.times { @world.step(0.01) }
+
+		car.drive = 0.5
+		100.times { @world.step(0.01) }
+		assert @chassis.linearVelocity.x > 0.1, "car should drive forward"
+		assert_in_delta 0.0, @chassis.linearVelocity.y, 0.01
+
+		car.steering = 0.3
+		100.times { @world.step(0.01) }
+		assert @chassis.angularVelocity.z > 0, "car should turn left"
+		assert_in_delta 0.3, car.state.unpack('d*')[1], Tolerance
+
+		car.setControls( 0, 0, 10.0 )
+		200.times { @world.step(0.01) }
+		assert_in_delta 0.0, @chassis.linearVelocity.x, 0.05
+	end
+
+	def test_03_batch
+		printTestHeader "Vehicle: Batch controls and state"
+		cars = [ make_car ]
+
+		assert_equal 1, ODE::Vehicle::setControls( cars, [0.1, 2.0, 0.0].pack('d*') )
+		assert_in_delta 0.1, cars[0].steering, Tolerance
+		assert_in_delta 2.0, cars[0].drive, Tolerance
+		assert_raises( ArgumentError ) { ODE::Vehicle::setControls(cars, [1.0]) }
+
+		# A bad vehicle or value leaves all of them alone
+		cars << make_car
+		assert_raises( RangeError ) { ODE::Vehicle::setControls(cars, [0.5, 0.5, 0.0, 0.5, 0.5, -1.0]) }
+		assert_raises( TypeError ) { ODE::Vehicle::setControls(cars + [@chassis], [0.5] * 9) }
+		assert_in_delta 0.1, cars[0].steering, Tolerance
+		assert_in_delta 0.0, cars[1].steering, Tolerance
+		cars.pop.enabled = false
+
+		@world.step( 0.01 )
+		buffer = ''
+		assert_same buffer, ODE::Vehicle::stateInto( cars, buffer )
+		assert_equal cars[0].state, buffer
+	end
+
+end
+